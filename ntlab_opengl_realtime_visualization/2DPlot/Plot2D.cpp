@@ -43,11 +43,91 @@ namespace ntlab
 
     Plot2D::~Plot2D()
     {
+        viewLinesOf (nullptr);
+
+        {
+            // views might be rendered by another window's context at the same time
+            std::lock_guard<std::mutex> renderLock (windowOpenGLContext.getResourcePool().getRenderLock());
+            for (auto* view : views)
+                view->viewedPlot = nullptr;
+        }
+
         windowOpenGLContext.removeRenderingTarget (this);
     }
 
+    void Plot2D::viewLinesOf (Plot2D* sourcePlot)
+    {
+        // A plot can't view itself
+        jassert (sourcePlot != this);
+
+        // Views of views are not supported, view the source plot directly
+        jassert ((sourcePlot == nullptr) || (sourcePlot->viewedPlot.load() == nullptr));
+        jassert ((sourcePlot == nullptr) || views.isEmpty());
+
+        // The line buffers of the source can only be drawn by contexts sharing the resources of the source context
+        jassert ((sourcePlot == nullptr) || (&sourcePlot->windowOpenGLContext.getResourcePool() == &windowOpenGLContext.getResourcePool()));
+
+        if (auto* previousSource = viewedPlot.load())
+            previousSource->views.removeFirstMatchingValue (this);
+
+        if (sourcePlot == nullptr)
+        {
+            viewedPlot = nullptr;
+            openGLContext.triggerRepaint();
+            return;
+        }
+
+        sourcePlot->views.addIfNotAlreadyThere (this);
+
+        yValueRange = sourcePlot->yValueRange;
+        yLogScaling = sourcePlot->yLogScaling;
+
+        viewedPlot = sourcePlot;
+
+        adoptLinesOf (*sourcePlot);
+        adoptXValuesOf (*sourcePlot);
+    }
+
+    void Plot2D::adoptLinesOf (const Plot2D& sourcePlot)
+    {
+        lineNames   = sourcePlot.lineNames;
+        lineColours = sourcePlot.lineColours;
+
+        {
+            std::lock_guard<std::mutex> scopedLock (frameDataLock);
+            numLines = sourcePlot.numLines;
+        }
+
+        invalidateGridLayer();
+        invalidateLabels();
+    }
+
+    void Plot2D::adoptXValuesOf (const Plot2D& sourcePlot)
+    {
+        // The visible range of the view is mapped to the points of the source, so it has to be based on the same x values
+        xLogScaling = sourcePlot.xLogScaling;
+        xDataRange  = sourcePlot.xDataRange;
+        setXRange (sourcePlot.xValueRange);
+    }
+
     void Plot2D::setLines (int numLines, juce::StringArray &legend, juce::Array<juce::Colour> lineColours)
     {
+        // A view draws the buffers of the viewed plot, so only the legend and colours are updated
+        if (viewedPlot.load() != nullptr)
+        {
+            lineNames = legend;
+            this->lineColours = (lineColours.size() == 0) ? automaticLineColours (numLines) : lineColours;
+
+            {
+                std::lock_guard<std::mutex> scopedLock (frameDataLock);
+                this->numLines = numLines;
+            }
+
+            invalidateGridLayer();
+            invalidateLabels();
+            return;
+        }
+
         // first delete all buffers
         auto deleteAllGLBuffers = [this] (juce::OpenGLContext &openGLContext)
         {
@@ -55,6 +135,7 @@ namespace ntlab
                 openGLContext.extensions.glDeleteBuffers (1, &l);
 
             lineGLBuffers.clear();
+            linesForViews.glBuffers.clear();
         };
 
         windowOpenGLContext.executeOnGLThread (deleteAllGLBuffers);
@@ -65,17 +146,21 @@ namespace ntlab
         {
             auto fillTempBufferYWithZeros = [this] (juce::OpenGLContext&)
             {
+                std::lock_guard<std::mutex> scopedLock (frameDataLock);
                 for (auto &tb : tempRenderDataBuffer)
                     tb.y = 0;
             };
             windowOpenGLContext.executeOnGLThread (fillTempBufferYWithZeros);
         }
 
-        GLvoid* data =       (updatesAtFramerate) ? NULL           : tempRenderDataBuffer.data();
         GLenum bufferUsage = (updatesAtFramerate) ? GL_STREAM_DRAW : GL_STATIC_DRAW;
 
-        auto addGLBuffer = [this, data, bufferUsage] (juce::OpenGLContext &openGLContext)
+        auto addGLBuffer = [this, bufferUsage] (juce::OpenGLContext &openGLContext)
         {
+            // the x values might have been changed since the buffer was requested
+            std::lock_guard<std::mutex> scopedLock (frameDataLock);
+            GLvoid* data = (updatesAtFramerate) ? NULL : tempRenderDataBuffer.data();
+
             GLuint glBufferLocation;
             openGLContext.extensions.glGenBuffers (1, &glBufferLocation);
             openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, glBufferLocation);
@@ -93,19 +178,37 @@ namespace ntlab
             this->lineColours = automaticLineColours (numLines);
         else
             this->lineColours = lineColours;
-        this->numLines = numLines;
+
+        {
+            std::lock_guard<std::mutex> scopedLock (frameDataLock);
+            this->numLines = numLines;
+        }
+
+        // the legend box size depends on the line names
+        invalidateGridLayer();
+        invalidateLabels();
+
+        for (auto* view : views)
+            view->adoptLinesOf (*this);
     }
 
     void Plot2D::setBackgroundColour (juce::Colour newBackgroundColour, bool changeGridColour)
     {
         backgroundColour = newBackgroundColour;
         if (changeGridColour)
+        {
             gridLineColour = backgroundColour.contrasting (0.5);
+            invalidateLabels();
+        }
+
+        invalidateGridLayer();
     }
 
     void Plot2D::setGridColour (juce::Colour newGridColour)
     {
         gridLineColour = newGridColour;
+        invalidateGridLayer();
+        invalidateLabels();
     }
 
     void Plot2D::setLineWidthIfPossibleForGPU (const double desiredLineWidth)
@@ -116,7 +219,8 @@ namespace ntlab
             double usedLineWidth = lineWidthRange.clipValue (desiredLineWidth);
             if (!lineWidthRange.contains (desiredLineWidth))
                 DBG ("Desired line width " << desiredLineWidth << " is not possible for GPU, applied width of " << usedLineWidth << " from possible range " << lineWidthRange.getStart() << " to " << lineWidthRange.getEnd());
-            glLineWidth (static_cast<GLfloat> (usedLineWidth));
+            lineWidth = static_cast<GLfloat> (usedLineWidth);
+            glLineWidth (lineWidth);
         });
     }
 
@@ -139,8 +243,6 @@ namespace ntlab
          */
         jassert (updatesAtFramerate == false);
 
-        GLuint lineBuffer = lineGLBuffers[lineIdx];
-
         std::vector<juce::Point<float>> tempRenderDataBufferCopy (tempRenderDataBuffer);
 
         for (auto &p : tempRenderDataBufferCopy) {
@@ -148,18 +250,7 @@ namespace ntlab
             ++yValues;
         }
 
-        auto updateLineBuffer = [tempRenderDataBufferCopy = std::move (tempRenderDataBufferCopy), lineBuffer] (juce::OpenGLContext& openGLContext)
-        {
-            openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, lineBuffer);
-            openGLContext.extensions.glBufferSubData (GL_ARRAY_BUFFER,
-                                                      0,
-                                                      static_cast<GLsizeiptr> (tempRenderDataBufferCopy.size() * sizeof (juce::Point<float>)),
-                                                      tempRenderDataBufferCopy.data());
-        };
-
-        windowOpenGLContext.executeOnGLThread (updateLineBuffer);
-
-        openGLContext.triggerRepaint();
+        uploadLineData (std::move (tempRenderDataBufferCopy), lineIdx);
     }
 
     void Plot2D::setYValues (const juce::Array<float> &yValues, int lineIdx)
@@ -179,23 +270,200 @@ namespace ntlab
         for (int i = 0; i < numDatapointsExpected; ++i)
             tempRenderDataBufferCopy[i].y = yValues[i];
 
-        auto updateLineBuffer = [this, tempRenderDataBufferCopy = std::move (tempRenderDataBufferCopy), lineIdx] (juce::OpenGLContext& openGLContext)
+        uploadLineData (std::move (tempRenderDataBufferCopy), lineIdx);
+    }
+
+    void Plot2D::uploadLineData (std::vector<juce::Point<float>>&& lineData, int lineIdx)
+    {
+        // A view has no line buffers, set the values on the viewed plot instead
+        jassert (viewedPlot.load() == nullptr);
+
+        if (windowOpenGLContext.isUsingAsyncBufferUploads())
         {
-            openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, lineGLBuffers[lineIdx]);
-            openGLContext.extensions.glBufferSubData (GL_ARRAY_BUFFER,
-                                                      0,
-                                                      static_cast<GLsizeiptr> (tempRenderDataBufferCopy.size() * sizeof (juce::Point<float>)),
-                                                      tempRenderDataBufferCopy.data());
-        };
+            const size_t numPoints = lineData.size();
+
+            // The data is copied into a new buffer by the uploader, which replaces the current line buffer when ready
+            auto swapLineBuffer = [this, lineIdx, numPoints] (juce::OpenGLContext& openGLContext, GLuint newLineBuffer)
+            {
+                // the lines or x values might have been changed while the upload was in progress
+                std::lock_guard<std::mutex> scopedLock (frameDataLock);
+                if ((lineIdx >= lineGLBuffers.size()) || (numPoints != static_cast<size_t> (numDatapointsExpected)))
+                {
+                    openGLContext.extensions.glDeleteBuffers (1, &newLineBuffer);
+                    return;
+                }
+
+                GLuint oldLineBuffer = lineGLBuffers[lineIdx];
+                openGLContext.extensions.glDeleteBuffers (1, &oldLineBuffer);
+                lineGLBuffers.set (lineIdx, newLineBuffer);
+            };
+
+            windowOpenGLContext.getAsyncBufferUploader().uploadBuffer (this, std::move (lineData), GL_STATIC_DRAW, swapLineBuffer);
+        }
+        else
+        {
+            auto updateLineBuffer = [this, lineData = std::move (lineData), lineIdx] (juce::OpenGLContext& openGLContext)
+            {
+                openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, lineGLBuffers[lineIdx]);
+                openGLContext.extensions.glBufferSubData (GL_ARRAY_BUFFER,
+                                                          0,
+                                                          static_cast<GLsizeiptr> (lineData.size() * sizeof (juce::Point<float>)),
+                                                          lineData.data());
+            };
+
+            windowOpenGLContext.executeOnGLThread (updateLineBuffer);
+        }
+
+        openGLContext.triggerRepaint();
+    }
+
+    int Plot2D::addReferenceTraceFromLine (int lineIdx, juce::Colour traceColour)
+    {
+        // A view has no line buffers, add the reference trace to the viewed plot instead
+        jassert (viewedPlot.load() == nullptr);
+        jassert (juce::isPositiveAndBelow (lineIdx, numLines));
+
+        windowOpenGLContext.executeOnGLThread ([this, lineIdx, traceColour] (juce::OpenGLContext& openGLContext)
+        {
+            std::lock_guard<std::mutex> scopedLock (frameDataLock);
+            ReferenceTrace trace;
+            trace.colour = traceColour;
+
+            if (glFunctions.isCopyBufferAvailable() && (lineIdx < lineGLBuffers.size()))
+            {
+                const auto numBytes = static_cast<GLsizeiptr> (numDatapointsExpected * sizeof (juce::Point<float>));
+
+                openGLContext.extensions.glGenBuffers (1, &trace.glBuffer);
+                openGLContext.extensions.glBindBuffer (GL_COPY_WRITE_BUFFER, trace.glBuffer);
+                openGLContext.extensions.glBufferData (GL_COPY_WRITE_BUFFER, numBytes, nullptr, GL_STATIC_DRAW);
+                openGLContext.extensions.glBindBuffer (GL_COPY_READ_BUFFER, lineGLBuffers[lineIdx]);
+                glFunctions.glCopyBufferSubData (GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, numBytes);
+                openGLContext.extensions.glBindBuffer (GL_COPY_READ_BUFFER, 0);
+                openGLContext.extensions.glBindBuffer (GL_COPY_WRITE_BUFFER, 0);
+
+                trace.numDatapoints = numDatapointsExpected;
+            }
+            else
+            {
+                DBG ("Plot2D: Buffer copies are not supported by this OpenGL context, the reference trace can't be captured");
+            }
+
+            referenceTraces.push_back (trace);
+        });
+
+        openGLContext.triggerRepaint();
+        return numReferenceTraces++;
+    }
+
+    int Plot2D::addReferenceTrace (const juce::Array<float>& yValues, juce::Colour traceColour)
+    {
+        // Make sure you pass a buffer that matches the number of x values set
+        jassert (numDatapointsExpected == yValues.size());
+
+        std::vector<juce::Point<float>> traceData (tempRenderDataBuffer);
+        for (int i = 0; i < numDatapointsExpected; ++i)
+            traceData[i].y = yValues[i];
+
+        windowOpenGLContext.executeOnGLThread ([this, traceData = std::move (traceData), traceColour] (juce::OpenGLContext& openGLContext)
+        {
+            ReferenceTrace trace;
+            trace.colour = traceColour;
+            trace.numDatapoints = static_cast<int> (traceData.size());
+
+            openGLContext.extensions.glGenBuffers (1, &trace.glBuffer);
+            openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, trace.glBuffer);
+            openGLContext.extensions.glBufferData (GL_ARRAY_BUFFER,
+                                                   static_cast<GLsizeiptr> (traceData.size() * sizeof (juce::Point<float>)),
+                                                   traceData.data(),
+                                                   GL_STATIC_DRAW);
+
+            referenceTraces.push_back (trace);
+        });
+
+        openGLContext.triggerRepaint();
+        return numReferenceTraces++;
+    }
+
+    void Plot2D::removeReferenceTrace (int referenceTraceIdx)
+    {
+        jassert (juce::isPositiveAndBelow (referenceTraceIdx, numReferenceTraces));
+
+        windowOpenGLContext.executeOnGLThread ([this, referenceTraceIdx] (juce::OpenGLContext& openGLContext)
+        {
+            if (referenceTraceIdx >= static_cast<int> (referenceTraces.size()))
+                return;
+
+            auto trace = referenceTraces.begin() + referenceTraceIdx;
+            if (trace->glBuffer != 0)
+                openGLContext.extensions.glDeleteBuffers (1, &trace->glBuffer);
 
-        windowOpenGLContext.executeOnGLThread (updateLineBuffer);
+            referenceTraces.erase (trace);
+        });
 
+        --numReferenceTraces;
         openGLContext.triggerRepaint();
     }
 
+    void Plot2D::clearReferenceTraces()
+    {
+        windowOpenGLContext.executeOnGLThread ([this] (juce::OpenGLContext&)
+        {
+            deleteReferenceTraceBuffers();
+            referenceTraces.clear();
+        });
+
+        numReferenceTraces = 0;
+        openGLContext.triggerRepaint();
+    }
+
+    int Plot2D::getNumReferenceTraces()
+    {
+        return numReferenceTraces;
+    }
+
+    void Plot2D::deleteReferenceTraceBuffers()
+    {
+        // The traces are kept with an invalid buffer, so the indices known to the message thread stay valid
+        for (auto& trace : referenceTraces)
+        {
+            if (trace.glBuffer != 0)
+                openGLContext.extensions.glDeleteBuffers (1, &trace.glBuffer);
+
+            trace.glBuffer = 0;
+        }
+    }
+
+    void Plot2D::drawReferenceTraces (int decimation)
+    {
+        const auto numVerticesToDraw = static_cast<GLsizei> (juce::jmax (0, numDatapointsExpected - 1) / decimation);
+
+        for (auto& trace : referenceTraces)
+        {
+            // The trace was captured with other x values than those currently displayed
+            if ((trace.glBuffer == 0) || (trace.numDatapoints != numDatapointsExpected))
+                continue;
+
+            openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, trace.glBuffer);
+            lineShader->setLineColour (trace.colour);
+            lineShader->enableAttributes (openGLContext, decimation);
+            glDrawArrays (GL_LINE_STRIP, 0, numVerticesToDraw);
+            lineShader->disableAttributes (openGLContext);
+        }
+    }
+
     int Plot2D::setXValues (juce::Range<float> xValueRange, float xValueDelta, LogScaling xValueScaling)
     {
-        int newNumDatapointsExpected = std::floor (xValueRange.getLength() / xValueDelta);
+        return setXValues (xValueRange, static_cast<int> (std::floor (xValueRange.getLength() / xValueDelta)), xValueScaling);
+    }
+
+    int Plot2D::setXValues (juce::Range<float> xValueRange, int newNumDatapointsExpected, LogScaling xValueScaling)
+    {
+        jassert (newNumDatapointsExpected > 0);
+        const float xValueDelta = xValueRange.getLength() / newNumDatapointsExpected;
+
+        // prepareNextFrame reads the x values on a worker thread
+        std::lock_guard<std::mutex> scopedLock (frameDataLock);
+
         tempRenderDataBuffer.resize (newNumDatapointsExpected);
 
         if (newNumDatapointsExpected > numDatapointsExpected)
@@ -256,8 +524,20 @@ namespace ntlab
         }
 
         xLogScaling = xValueScaling;
+        xDataRange = xValueRange;
         setXRange (xValueRange);
 
+        // The views read the x values on their own GL thread, so they are handed over together with the line buffers
+        windowOpenGLContext.executeOnGLThread ([this, newNumDatapointsExpected, xValueRange, xValueScaling] (juce::OpenGLContext&)
+        {
+            linesForViews.numDatapoints = newNumDatapointsExpected;
+            linesForViews.xDataRange    = xValueRange;
+            linesForViews.xLogScaling   = xValueScaling;
+        });
+
+        for (auto* view : views)
+            view->adoptXValuesOf (*this);
+
         return numDatapointsExpected;
     }
 
@@ -268,19 +548,98 @@ namespace ntlab
 
         yValueRange = newYValueRange;
         yLogScaling = logScaling;
-        juce::MessageManager::callAsync ([this](){repaint(); });
+        invalidateLabels();
     }
 
     void Plot2D::setXRange (juce::Range<float> newXValueRange)
     {
         xValueRange = newXValueRange;
-        juce::MessageManager::callAsync ([this](){repaint(); });
+        invalidateLabels();
+    }
+
+    float Plot2D::LinesForViews::normalizeXValue (float xValue) const
+    {
+        if (xLogScaling == LogScaling::baseE)
+        {
+            const float minLogValue = std::log (xDataRange.getStart() + 1.0f);
+            const float maxLogValue = std::log (xDataRange.getEnd()   + 1.0f);
+            return (std::log (xValue + 1.0f) - minLogValue) / (maxLogValue - minLogValue);
+        }
+
+        return (xValue - xDataRange.getStart()) / xDataRange.getLength();
+    }
+
+    float Plot2D::LinesForViews::getPointIndex (float xValue) const
+    {
+        if (xDataRange.isEmpty())
+            return 0.0f;
+
+        // Before the log scaling is applied, the x values are equally spaced for all scalings
+        const float index = (xValue - xDataRange.getStart()) / xDataRange.getLength() * numDatapoints;
+        return juce::jlimit (-1.0f, numDatapoints + 1.0f, index);
+    }
+
+    void Plot2D::drawLinesOf (Plot2D& sourcePlot, int decimation)
+    {
+        if (sourcePlot.linesHoldMinMaxPairs())
+            decimation = 1;
+
+        // Only what the source published in its last frame is read, see LinesForViews
+        const auto& sourceLines = sourcePlot.linesForViews;
+        const int numSourcePoints = sourceLines.numDatapoints;
+        if (numSourcePoints < 2)
+            return;
+
+        // Compute the points inside the visible range and keep one point on each side so lines reach the borders
+        const float visibleStart = sourceLines.getPointIndex (labelSettings.xValueRange.getStart());
+        const float visibleEnd   = sourceLines.getPointIndex (labelSettings.xValueRange.getEnd());
+
+        const int firstPoint = juce::jlimit (0, numSourcePoints, static_cast<int> (std::ceil (visibleStart)) - 1);
+        const int endPoint   = juce::jlimit (0, numSourcePoints, static_cast<int> (std::floor (visibleEnd)) + 2);
+
+        const int firstVertex = firstPoint / decimation;
+        const int endVertex   = juce::jmin ((numSourcePoints - 1) / decimation, (endPoint + decimation - 1) / decimation);
+        if (endVertex - firstVertex < 2)
+            return;
+
+        // The legend and colours of this view are passed on by the source, but might be one frame behind its buffers
+        const int numLinesToDraw = juce::jmin (static_cast<int> (sourceLines.glBuffers.size()), labelSettings.lineColours.size());
+
+        for (int i = 0; i < numLinesToDraw; ++i)
+        {
+            // A line without data in the last frame is not drawn by the source either
+            const GLuint glBuffer = sourceLines.glBuffers[static_cast<size_t> (i)];
+            if (glBuffer == 0)
+                continue;
+
+            openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, glBuffer);
+            lineShader->setLineColour (labelSettings.lineColours[i]);
+            lineShader->enableAttributes (openGLContext, decimation);
+            glDrawArrays (GL_LINE_STRIP, firstVertex, endVertex - firstVertex);
+            lineShader->disableAttributes (openGLContext);
+        }
     }
 
     void Plot2D::newOpenGLContextCreated ()
     {
-        lineShader.reset (LineShader2D::create (openGLContext));
+        acquireSharedResources();
+        glFunctions.initialise();
         openGLContext.extensions.glGenBuffers (1, &gridLineGLBuffer);
+        openGLContext.extensions.glGenBuffers (1, &legendBoxGLBuffer);
+        openGLContext.extensions.glGenBuffers (1, &labelGLBuffer);
+
+        // A quad filling the whole viewport
+        const TextureShader2D::Vertex gridLayerQuad[4] =
+        {
+            {-1.0f, -1.0f, 0.0f, 0.0f}, {1.0f, -1.0f, 1.0f, 0.0f}, {-1.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 1.0f, 1.0f, 1.0f}
+        };
+
+        openGLContext.extensions.glGenBuffers (1, &gridLayerQuadGLBuffer);
+        openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, gridLayerQuadGLBuffer);
+        openGLContext.extensions.glBufferData (GL_ARRAY_BUFFER, sizeof (gridLayerQuad), gridLayerQuad, GL_STATIC_DRAW);
+
+        gridLayerNeedsUpdate = true;
+        labelsNeedUpdate     = true;
     }
 
     void Plot2D::setGridProperties (int newNumXGridLines, int newNumYGridLines, bool applyGridColourContrastingBackground)
@@ -297,6 +656,8 @@ namespace ntlab
         jassert (newNumYGridLines >= 0);
 
         gridLineColour = newGridLineColour;
+        invalidateGridLayer();
+        invalidateLabels();
 
         if ((newNumXGridLines == numXGridLines) && (newNumYGridLines == numYGridLines))
             return;
@@ -343,6 +704,10 @@ namespace ntlab
                                                    GL_STATIC_DRAW);
 
             shouldRenderGrid = true;
+
+            // the ticks depend on the number of grid lines
+            gridLayerNeedsUpdate = true;
+            labelsNeedUpdate     = true;
         };
 
         windowOpenGLContext.executeOnGLThread (fillGridLineGLBuffer);
@@ -361,11 +726,33 @@ namespace ntlab
     void Plot2D::openGLContextClosing () {
         // delete all buffers
         openGLContext.extensions.glDeleteBuffers (1, &gridLineGLBuffer);
+        openGLContext.extensions.glDeleteBuffers (1, &gridLayerQuadGLBuffer);
+        openGLContext.extensions.glDeleteBuffers (1, &legendBoxGLBuffer);
+        openGLContext.extensions.glDeleteBuffers (1, &labelGLBuffer);
 
         for (GLuint l : lineGLBuffers)
             openGLContext.extensions.glDeleteBuffers (1, &l);
 
         lineGLBuffers.clearQuick();
+        linesForViews.glBuffers.clear();
+
+        deleteReferenceTraceBuffers();
+
+        gridLayer.release();
+        numLabelVertices = 0;
+
+        windowOpenGLContext.getAsyncBufferUploader().cancelUploads (openGLContext, this);
+
+        // the shaders and the glyph atlas are owned by the resource pool
+        lineShader    = nullptr;
+        textureShader = nullptr;
+        textShader    = nullptr;
+        glyphAtlasTexture = 0;
+    }
+
+    int Plot2D::getPhysicalWidth ()
+    {
+        return juce::roundToInt (getWidth() * openGLContext.getRenderingScale());
     }
 
     void Plot2D::getLineWidthRangePossibleForGPU ()
@@ -378,13 +765,32 @@ namespace ntlab
         lineWidthRange.setEnd   (static_cast<double> (glLineWidthRange[1]));
     }
 
+    bool Plot2D::acquireSharedResources ()
+    {
+        auto& resourcePool = windowOpenGLContext.getResourcePool();
+
+        lineShader    = resourcePool.getShader<LineShader2D>    ("LineShader2D",    openGLContext);
+        textureShader = resourcePool.getShader<TextureShader2D> ("TextureShader2D", openGLContext);
+        textShader    = resourcePool.getShader<TextShader2D>    ("TextShader2D",    openGLContext);
+
+        glyphAtlasTexture = resourcePool.getAlphaTexture ("SDFGlyphAtlas",
+                                                          glyphAtlas->getDistanceField(),
+                                                          glyphAtlas->getWidth(),
+                                                          glyphAtlas->getHeight());
+
+        return (lineShader != nullptr) && (textureShader != nullptr);
+    }
+
     void Plot2D::resizeLineGLBuffers ()
     {
-        GLvoid* data =       (updatesAtFramerate) ? NULL           : tempRenderDataBuffer.data();
         GLenum bufferUsage = (updatesAtFramerate) ? GL_STREAM_DRAW : GL_STATIC_DRAW;
 
-        auto resizeAllLineGLBuffers = [this, data, bufferUsage] (juce::OpenGLContext &openGLContext)
+        auto resizeAllLineGLBuffers = [this, bufferUsage] (juce::OpenGLContext &openGLContext)
         {
+            // the x values might have been changed again since the resize was requested
+            std::lock_guard<std::mutex> scopedLock (frameDataLock);
+            GLvoid* data = (updatesAtFramerate) ? NULL : tempRenderDataBuffer.data();
+
             for (auto glBufferLocation : lineGLBuffers)
             {
                 openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, glBufferLocation);
@@ -420,108 +826,189 @@ namespace ntlab
 
     void Plot2D::renderOpenGL ()
     {
+        if (!acquireSharedResources())
+            return;
+
         // This is the region relative to the GL rendering parent component where our rendering should take place
         auto clip = windowOpenGLContext.getComponentClippingBoundsRelativeToGLRenderingTarget (this);
-        glViewport (clip.getX(), clip.getY(), clip.getWidth(), clip.getHeight());
 
-        // enabling the scissor test leads to clearing just the part of the screen where drawing should take place
-        juce::OpenGLHelpers::enableScissorTest (clip);
-        juce::OpenGLHelpers::clear (backgroundColour);
-        glDisable (GL_SCISSOR_TEST);
+        // The grid layer and the labels are only built from the settings copied on the message thread
+        fetchLabelSettings();
 
-        glEnable (GL_BLEND);
-        glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        if (gridLayerNeedsUpdate || (gridLayer.getWidth() != clip.getWidth()) || (gridLayer.getHeight() != clip.getHeight()))
+            renderGridLayer (clip.getWidth(), clip.getHeight());
 
-        lineShader->use();
+        if (labelsNeedUpdate || (labelsWidth != clip.getWidth()) || (labelsHeight != clip.getHeight()))
+            updateLabels (clip.getWidth(), clip.getHeight());
 
-        if (shouldRenderGrid)
-        {
-            //lineShader->setCoordinateSystemMatchingTo2DDrawing();
-            lineShader->setCustomScalingAndTranslation (2.0f, -2.0f, -1.0f, 1.0f);
+        glViewport (clip.getX(), clip.getY(), clip.getWidth(), clip.getHeight());
 
-            openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, gridLineGLBuffer);
-            lineShader->setLineColour (gridLineColour);
-            lineShader->enableAttributes (openGLContext);
-            glDrawArrays (GL_LINES, 0, static_cast<GLuint> (2 * (numXGridLines + numYGridLines)));
-            lineShader->disableAttributes (openGLContext);
+        if (gridLayer.isValid())
+        {
+            // the grid layer is opaque and covers the whole viewport, so no clearing is needed
+            glDisable (GL_BLEND);
+            drawGridLayer();
+            glEnable (GL_BLEND);
+            glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            lineShader->use();
+        }
+        else
+        {
+            // enabling the scissor test leads to clearing just the part of the screen where drawing should take place
+            juce::OpenGLHelpers::enableScissorTest (clip);
+            juce::OpenGLHelpers::clear (backgroundColour);
+            glDisable (GL_SCISSOR_TEST);
+
+            glEnable (GL_BLEND);
+            glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            lineShader->use();
+            drawGridLines();
+            drawLegendBox (clip.getWidth(), clip.getHeight());
         }
 
+        renderBeneathLines (openGLContext, clip.getWidth(), clip.getHeight());
+        lineShader->use();
+
+        // A view zooms into the buffers of the viewed plot by mapping its own x range onto the normalized x values
+        auto* sourcePlot = viewedPlot.load();
+        const juce::Range<float> visibleXRange = (sourcePlot == nullptr) ? juce::Range<float> (0, 1)
+                                                                         : juce::Range<float> (sourcePlot->linesForViews.normalizeXValue (labelSettings.xValueRange.getStart()),
+                                                                                               sourcePlot->linesForViews.normalizeXValue (labelSettings.xValueRange.getEnd()));
+
         switch (yLogScaling)
         {
             case base10:
-                lineShader->setCoordinateSystemFittingRange (juce::Range<float> (0, 1), yValueRange, true, LineShader2D::LogScaling::base10);
+                lineShader->setCoordinateSystemFittingRange (visibleXRange, yValueRange, true, LineShader2D::LogScaling::base10);
                 break;
             case dBPower:
-                lineShader->setCoordinateSystemFittingRange (juce::Range<float> (0, 1), yValueRange, true, LineShader2D::LogScaling::dBPower);
+                lineShader->setCoordinateSystemFittingRange (visibleXRange, yValueRange, true, LineShader2D::LogScaling::dBPower);
                 break;
             case dbVoltage:
-                lineShader->setCoordinateSystemFittingRange (juce::Range<float> (0, 1), yValueRange, true, LineShader2D::LogScaling::dbVoltage);
+                lineShader->setCoordinateSystemFittingRange (visibleXRange, yValueRange, true, LineShader2D::LogScaling::dbVoltage);
                 break;
             default:
-                lineShader->setCoordinateSystemFittingRange (juce::Range<float> (0, 1), yValueRange);
+                lineShader->setCoordinateSystemFittingRange (visibleXRange, yValueRange);
                 break;
         }
 
-        if (updatesAtFramerate)
+        // If the frame budget is exceeded, the frame pacer requests thinner lines and fewer vertices
+        const auto qualityTier = windowOpenGLContext.getFramePacer().getQualityTier();
+        const int decimation = linesHoldMinMaxPairs() ? 1 : FramePacer::getDecimationFactor (qualityTier);
+
+        // The number of lines and points are changed by the message thread
+        std::lock_guard<std::mutex> scopedLock (frameDataLock);
+        const auto numVerticesToDraw = static_cast<GLuint> (juce::jmax (0, numDatapointsExpected - 1) / decimation);
+        glLineWidth ((qualityTier == FramePacer::fullQuality) ? lineWidth : 1.0f);
+
+        // Reference traces are drawn beneath the live lines
+        if (sourcePlot == nullptr)
+            drawReferenceTraces (decimation);
+
+        if (sourcePlot != nullptr)
         {
-            beginFrame();
+            drawLinesOf (*sourcePlot, decimation);
+        }
+        else if (updatesAtFramerate)
+        {
+            // The vertex data has been prepared by prepareNextFrame on a worker thread, so only upload and draw it here
+            const int numPreparedLines = juce::jmin (numLines, lineGLBuffers.size(), static_cast<int> (preparedLineData.size()));
 
-            for (int i = 0; i < numLines; ++i)
-            {
-                lineShader->setLineColour (lineColours[i]);
-                float* y = const_cast<float*> (getBufferForLine (i));
-                if (y != nullptr)
-                {
+            // Only the lines drawn in this frame are published to the views
+            linesForViews.glBuffers.assign (static_cast<size_t> (lineGLBuffers.size()), 0);
 
-                    for (auto &p : tempRenderDataBuffer) {
-                        p.y = *y;
-                        ++y;
-                    }
+            for (int i = 0; i < numPreparedLines; ++i)
+            {
+                auto& lineData = preparedLineData[i];
+                if (lineData.size() != static_cast<size_t> (numDatapointsExpected))
+                    continue;
 
-                    openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, lineGLBuffers[i]);
-                    openGLContext.extensions.glBufferSubData (GL_ARRAY_BUFFER,
-                                                              0,
-                                                              static_cast<GLsizeiptr> (numDatapointsExpected * sizeof (juce::Point<float>)),
-                                                              tempRenderDataBuffer.data());
+                lineShader->setLineColour (lineColours[i]);
 
-                    lineShader->enableAttributes (openGLContext);
-                    // seems that the "count" value passes the number of primitives, not vertices??
-                    glDrawArrays (GL_LINE_STRIP, 0, static_cast<GLuint> (numDatapointsExpected - 1));
-                    lineShader->disableAttributes (openGLContext);
+                openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, lineGLBuffers[i]);
+                openGLContext.extensions.glBufferSubData (GL_ARRAY_BUFFER,
+                                                          0,
+                                                          static_cast<GLsizeiptr> (numDatapointsExpected * sizeof (juce::Point<float>)),
+                                                          lineData.data());
+
+                lineShader->enableAttributes (openGLContext, decimation);
+                // seems that the "count" value passes the number of primitives, not vertices??
+                glDrawArrays (GL_LINE_STRIP, 0, numVerticesToDraw);
+                lineShader->disableAttributes (openGLContext);
 
-                }
+                linesForViews.glBuffers[static_cast<size_t> (i)] = lineGLBuffers[i];
             }
-
-            endFrame();
         }
         else
         {
+            linesForViews.glBuffers.assign (lineGLBuffers.begin(), lineGLBuffers.end());
+
             for (int i = 0; i < numLines; ++i)
             {
                 openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, lineGLBuffers[i]);
                 lineShader->setLineColour (lineColours[i]);
-                lineShader->enableAttributes (openGLContext);
-                glDrawArrays (GL_LINE_STRIP, 0, static_cast<GLuint> (numDatapointsExpected - 1));
+                lineShader->enableAttributes (openGLContext, decimation);
+                glDrawArrays (GL_LINE_STRIP, 0, numVerticesToDraw);
                 lineShader->disableAttributes (openGLContext);
             }
         }
-        
+
+        drawLabels (clip.getWidth(), clip.getHeight());
+
         // Reset the element buffers so child Components draw correctly
         openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, 0);
         openGLContext.extensions.glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
+    void Plot2D::prepareNextFrame ()
+    {
+        if (!updatesAtFramerate || (viewedPlot.load() != nullptr))
+            return;
+
+        // setXValues and setLines resize the buffers read here on the message thread
+        std::lock_guard<std::mutex> scopedLock (frameDataLock);
+        const size_t numPoints = tempRenderDataBuffer.size();
+        preparedLineData.resize (static_cast<size_t> (numLines));
+
+        beginFrame();
+
+        for (int i = 0; i < numLines; ++i)
+        {
+            auto& lineData = preparedLineData[i];
+            const float* y = getBufferForLine (i);
+
+            if (y == nullptr)
+            {
+                lineData.clear();
+                continue;
+            }
+
+            // only allocates if the number of datapoints changed
+            lineData.resize (numPoints);
+            for (size_t p = 0; p < numPoints; ++p)
+            {
+                lineData[p].x = tempRenderDataBuffer[p].x;
+                lineData[p].y = y[p];
+            }
+        }
+
+        endFrame();
+    }
+
     void Plot2D::enableLegend (bool shouldBeEnabled, LegendPosition legendPosition, bool withBorder, float backgroundTransparency)
     {
-        if (!shouldBeEnabled)
+        if (shouldBeEnabled)
+        {
+            legendState = legendPosition;
+            drawLegendBorder = withBorder;
+            legendBackgroundTransparency = backgroundTransparency;
+        }
+        else
         {
             legendState = -1;
-            return;
         }
 
-        legendState = legendPosition;
-        drawLegendBorder = withBorder;
-        legendBackgroundTransparency = backgroundTransparency;
+        invalidateGridLayer();
+        invalidateLabels();
     }
 
     void Plot2D::enableXAxisTicks (bool shouldBeEnabled, const juce::String unitPostfix, bool equalPrefixForEachTick)
@@ -529,6 +1016,7 @@ namespace ntlab
         drawXTicks = shouldBeEnabled;
         xTickPostfix = unitPostfix;
         equalPrefixForEachXTick = equalPrefixForEachTick;
+        invalidateLabels();
     }
 
     void Plot2D::enableYAxisTicks (bool shouldBeEnabled, const juce::String unitPostfix, bool equalPrefixForEachTick)
@@ -536,42 +1024,98 @@ namespace ntlab
         drawYTicks = shouldBeEnabled;
         yTickPostfix = unitPostfix;
         equalPrefixForEachYTick = equalPrefixForEachTick;
+        invalidateLabels();
+    }
+
+    void Plot2D::invalidateGridLayer()
+    {
+        updateLabelSettings();
+        gridLayerNeedsUpdate = true;
+        openGLContext.triggerRepaint();
+    }
+
+    void Plot2D::invalidateLabels()
+    {
+        updateLabelSettings();
+        labelsNeedUpdate = true;
+        openGLContext.triggerRepaint();
+    }
+
+    void Plot2D::updateLabelSettings()
+    {
+        std::lock_guard<std::mutex> scopedLock (labelSettingsLock);
+
+        auto& s = pendingLabelSettings;
+        s.lineNames                    = lineNames;
+        s.lineColours                  = lineColours;
+        s.numLines                     = numLines;
+        s.hasXValues                   = numDatapointsExpected > 0;
+        s.xValueRange                  = xValueRange;
+        s.yValueRange                  = yValueRange;
+        s.xLogScaling                  = xLogScaling;
+        s.gridLineColour               = gridLineColour;
+        s.drawXTicks                   = drawXTicks;
+        s.drawYTicks                   = drawYTicks;
+        s.equalPrefixForEachXTick      = equalPrefixForEachXTick;
+        s.equalPrefixForEachYTick      = equalPrefixForEachYTick;
+        s.xTickPostfix                 = xTickPostfix;
+        s.yTickPostfix                 = yTickPostfix;
+        s.legendState                  = legendState;
+        s.drawLegendBorder             = drawLegendBorder;
+        s.legendBackgroundTransparency = legendBackgroundTransparency;
+
+        labelSettingsChanged = true;
     }
 
-    void Plot2D::paint (juce::Graphics &g)
+    void Plot2D::fetchLabelSettings()
     {
-        if (tempRenderDataBuffer.size() > 0)
+        if (!labelSettingsChanged.exchange (false))
+            return;
+
+        std::lock_guard<std::mutex> scopedLock (labelSettingsLock);
+        labelSettings = pendingLabelSettings;
+    }
+
+    void Plot2D::updateLabels (int width, int height)
+    {
+        labelsNeedUpdate = false;
+        labelsWidth  = width;
+        labelsHeight = height;
+
+        labelVertices.clear();
+
+        // all positions are computed in physical pixels to match the viewport
+        const float renderingScale = static_cast<float> (openGLContext.getRenderingScale());
+        const float tickTextYOffset = 0.5f * (tickTextHeight - tickLabelTextHeight) * renderingScale;
+        const float tickTextSize = tickLabelTextHeight * renderingScale;
+
+        if ((width > 0) && (height > 0) && labelSettings.hasXValues)
         {
-            g.setColour (gridLineColour);
-            if (drawXTicks && (numXGridLines > 0))
+            if (labelSettings.drawXTicks && (numXGridLines > 0))
             {
+                float xTickYPos = height - tickTextHeight * renderingScale + tickTextYOffset;
+                float xTickXPos = renderingScale;
+                float xTickPosOffset = width / static_cast<float> (numXGridLines);
 
-                int   xTickYPos = getHeight() - tickTextHeight;
-                float xTickXPos = 1.0f;
-                float xTickPosOffset = getWidth() / static_cast<float> (numXGridLines);
-
-                juce::Rectangle<int> textArea (juce::roundToInt (xTickXPos), xTickYPos, juce::roundToInt (xTickPosOffset), tickTextHeight);
-                auto prefix = ntlab::Float2String::getBestSIPrefixForValue (xValueRange.getEnd(), 2);
+                auto prefix = ntlab::Float2String::getBestSIPrefixForValue (labelSettings.xValueRange.getEnd(), 2);
 
-                switch (xLogScaling)
+                switch (labelSettings.xLogScaling)
                 {
                     case LogScaling::baseE :
                     {
-                        float a = (xValueRange.getStart() + 1.0f);
-                        float b = (xValueRange.getEnd() + 1.0f) / a;
+                        float a = (labelSettings.xValueRange.getStart() + 1.0f);
+                        float b = (labelSettings.xValueRange.getEnd() + 1.0f) / a;
 
                         for (int i = 0; i < numXGridLines; ++i)
                         {
-                            textArea.setX (juce::roundToInt (xTickXPos));
                             float xFrac = static_cast<float> (i) / numXGridLines;
 
                             float nextXValue = a * std::pow (b, xFrac);
-                            if (equalPrefixForEachXTick == false)
+                            if (labelSettings.equalPrefixForEachXTick == false)
                                 prefix = ntlab::Float2String::getBestSIPrefixForValue (nextXValue, 3);
 
-                            g.drawText (ntlab::Float2String::withSIPrefix (nextXValue, 4, prefix) + xTickPostfix, textArea, juce::Justification::left, true);
+                            glyphAtlas->addText (labelVertices, ntlab::Float2String::withSIPrefix (nextXValue, 4, prefix) + labelSettings.xTickPostfix, xTickXPos, xTickYPos, tickTextSize, labelSettings.gridLineColour);
                             xTickXPos += xTickPosOffset;
-
                         }
                     }
                         break;
@@ -579,15 +1123,13 @@ namespace ntlab
                     {
                         for (int i = 0; i < numXGridLines; ++i)
                         {
-                            textArea.setX (juce::roundToInt (xTickXPos));
-                            float nextXValue = xValueRange.getEnd() * static_cast<float> (i) / numXGridLines;
-                            if (equalPrefixForEachXTick)
-                                g.drawText (ntlab::Float2String::withSIPrefix (nextXValue, 4, prefix) + xTickPostfix, textArea, juce::Justification::left, true);
+                            float nextXValue = labelSettings.xValueRange.getEnd() * static_cast<float> (i) / numXGridLines;
+                            if (labelSettings.equalPrefixForEachXTick)
+                                glyphAtlas->addText (labelVertices, ntlab::Float2String::withSIPrefix (nextXValue, 4, prefix) + labelSettings.xTickPostfix, xTickXPos, xTickYPos, tickTextSize, labelSettings.gridLineColour);
                             else
-                                g.drawText (ntlab::Float2String::withSIPrefix (nextXValue, 4) + xTickPostfix, textArea, juce::Justification::left, true);
+                                glyphAtlas->addText (labelVertices, ntlab::Float2String::withSIPrefix (nextXValue, 4) + labelSettings.xTickPostfix, xTickXPos, xTickYPos, tickTextSize, labelSettings.gridLineColour);
                             xTickXPos += xTickPosOffset;
                         }
-
                     }
                         break;
                     default:
@@ -595,99 +1137,193 @@ namespace ntlab
                 }
             }
 
-            if (drawYTicks && (numYGridLines > 0))
+            if (labelSettings.drawYTicks && (numYGridLines > 0))
             {
-                float yTickYPos = 1.0f;
-                int   yTickXPos = 1;
+                float yTickYPos = renderingScale + tickTextYOffset;
+                float yTickXPos = renderingScale;
 
-                float yTick = yValueRange.getEnd();
-                float yTickOffset = yValueRange.getLength() / numYGridLines;
-                float yTickPosOffset = getHeight() / static_cast<float> (numYGridLines);
+                float yTick = labelSettings.yValueRange.getEnd();
+                float yTickOffset = labelSettings.yValueRange.getLength() / numYGridLines;
+                float yTickPosOffset = height / static_cast<float> (numYGridLines);
 
-                juce::Rectangle<int> textArea (yTickXPos, juce::roundToInt (yTickYPos), getWidth(), tickTextHeight);
-                ntlab::Float2String::SIPrefix prefix = ntlab::Float2String::getBestSIPrefixForValue (yValueRange.getEnd(), 3);
+                ntlab::Float2String::SIPrefix prefix = ntlab::Float2String::getBestSIPrefixForValue (labelSettings.yValueRange.getEnd(), 3);
 
                 for (int i = 0; i < numYGridLines; ++i)
                 {
-                    textArea.setY (juce::roundToInt (yTickYPos));
-                    if (equalPrefixForEachYTick)
-                        g.drawText (ntlab::Float2String::withSIPrefix (yTick, 3, prefix) + yTickPostfix, textArea, juce::Justification::left, true);
+                    if (labelSettings.equalPrefixForEachYTick)
+                        glyphAtlas->addText (labelVertices, ntlab::Float2String::withSIPrefix (yTick, 3, prefix) + labelSettings.yTickPostfix, yTickXPos, yTickYPos, tickTextSize, labelSettings.gridLineColour);
                     else
-                        g.drawText (ntlab::Float2String::withSIPrefix (yTick, 3) + yTickPostfix, textArea, juce::Justification::left, true);
+                        glyphAtlas->addText (labelVertices, ntlab::Float2String::withSIPrefix (yTick, 3) + labelSettings.yTickPostfix, yTickXPos, yTickYPos, tickTextSize, labelSettings.gridLineColour);
                     yTickYPos += yTickPosOffset;
                     yTick -= yTickOffset;
                 }
             }
         }
 
+        if ((labelSettings.legendState != -1) && (width > 0) && (height > 0))
+        {
+            auto legendBounds = getLegendBounds (width, height, renderingScale);
 
-        if (legendState == -1)
-            return;
+            const float lineHeight = legendTextHeight * renderingScale;
+            float x = legendBounds.getX() + 5.0f * renderingScale;
+            float y = legendBounds.getY() + 5.0f * renderingScale;
+
+            for (int i = 0; i < labelSettings.numLines; ++i)
+            {
+                glyphAtlas->addText (labelVertices, labelSettings.lineNames[i], x, y, lineHeight, labelSettings.lineColours[i]);
+                y += lineHeight;
+            }
+        }
 
-        const int legendBoxBorderMargin = 20;
-        const int lineHeight = 15;
-        int legendBoxWidth = 0;
-        int legendBoxHeight = numLines * lineHeight + 10;
+        numLabelVertices = static_cast<GLsizei> (labelVertices.size());
 
-        for (auto& n : lineNames)
+        openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, labelGLBuffer);
+        openGLContext.extensions.glBufferData (GL_ARRAY_BUFFER,
+                                               static_cast<GLsizeiptr> (labelVertices.size() * sizeof (TextShader2D::Vertex)),
+                                               labelVertices.data(),
+                                               GL_DYNAMIC_DRAW);
+    }
+
+    void Plot2D::renderGridLayer (int width, int height)
+    {
+        gridLayerNeedsUpdate = false;
+
+        if ((width <= 0) || (height <= 0))
+            return;
+
+        if ((gridLayer.getWidth() != width) || (gridLayer.getHeight() != height))
         {
-            legendBoxWidth = std::max (g.getCurrentFont().getStringWidth (n), legendBoxWidth);
+            if (!gridLayer.initialise (openGLContext, width, height))
+                return;
         }
-        legendBoxWidth += 15;
 
+        gridLayer.makeCurrentRenderingTarget();
+        glViewport (0, 0, width, height);
+        juce::OpenGLHelpers::clear (backgroundColour);
 
-        juce::Rectangle<int> localBounds = getLocalBounds();
-        juce::Rectangle<int> legendBounds;
+        glEnable (GL_BLEND);
+        glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        switch (legendState)
+        lineShader->use();
+        drawGridLines();
+        drawLegendBox (width, height);
+
+        gridLayer.releaseAsRenderingTarget();
+    }
+
+    void Plot2D::drawGridLines()
+    {
+        if (shouldRenderGrid)
         {
-            case topLeft:
-                localBounds.removeFromTop  (legendBoxBorderMargin);
-                localBounds.removeFromLeft (legendBoxBorderMargin);
-                legendBounds = localBounds.removeFromLeft (legendBoxWidth).removeFromTop (legendBoxHeight);
-                break;
+            lineShader->setCustomScalingAndTranslation (2.0f, -2.0f, -1.0f, 1.0f);
 
-            case topRight:
-                localBounds.removeFromTop   (legendBoxBorderMargin);
-                localBounds.removeFromRight (legendBoxBorderMargin);
-                legendBounds = localBounds.removeFromRight (legendBoxWidth).removeFromTop (legendBoxHeight);
-                break;
+            openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, gridLineGLBuffer);
+            lineShader->setLineColour (labelSettings.gridLineColour);
+            lineShader->enableAttributes (openGLContext);
+            glDrawArrays (GL_LINES, 0, static_cast<GLuint> (2 * (numXGridLines + numYGridLines)));
+            lineShader->disableAttributes (openGLContext);
+        }
+    }
 
-            case bottomLeft:
-                localBounds.removeFromBottom (legendBoxBorderMargin);
-                localBounds.removeFromLeft   (legendBoxBorderMargin);
-                legendBounds = localBounds.removeFromLeft (legendBoxWidth).removeFromBottom (legendBoxHeight);
-                break;
+    void Plot2D::drawLegendBox (int width, int height)
+    {
+        if ((labelSettings.legendState == -1) || (width <= 0) || (height <= 0))
+            return;
 
-            case bottomRight:
-                localBounds.removeFromBottom (legendBoxBorderMargin);
-                localBounds.removeFromRight  (legendBoxBorderMargin);
-                legendBounds = localBounds.removeFromRight (legendBoxWidth).removeFromBottom (legendBoxHeight);
-                break;
+        auto b = getLegendBounds (width, height, static_cast<float> (openGLContext.getRenderingScale()));
 
-            default:
-                return;
-        }
+        // the first four points are drawn as a triangle strip filling the box, the last four as the border line loop
+        // which is shifted to the pixel centers
+        const juce::Point<float> legendBox[8] =
+        {
+            {b.getX(),            b.getY()},            {b.getRight(),        b.getY()},
+            {b.getX(),            b.getBottom()},       {b.getRight(),        b.getBottom()},
+            {b.getX() + 0.5f,     b.getY() + 0.5f},     {b.getRight() - 0.5f, b.getY() + 0.5f},
+            {b.getRight() - 0.5f, b.getBottom() - 0.5f}, {b.getX() + 0.5f,    b.getBottom() - 0.5f}
+        };
+
+        openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, legendBoxGLBuffer);
+        openGLContext.extensions.glBufferData (GL_ARRAY_BUFFER, sizeof (legendBox), legendBox, GL_DYNAMIC_DRAW);
+
+        // maps the pixel positions to the viewport with (0, 0) being the top left corner
+        lineShader->setCustomScalingAndTranslation (2.0f / width, -2.0f / height, -1.0f, 1.0f);
+        lineShader->enableAttributes (openGLContext);
 
-        g.setColour (gridLineColour.withAlpha (1.0f - legendBackgroundTransparency));
-        g.fillRect (legendBounds);
+        lineShader->setLineColour (labelSettings.gridLineColour.withAlpha (1.0f - labelSettings.legendBackgroundTransparency));
+        glDrawArrays (GL_TRIANGLE_STRIP, 0, 4);
 
-        if (drawLegendBorder)
+        if (labelSettings.drawLegendBorder)
         {
-            g.setColour (gridLineColour);
-            g.drawRect (legendBounds);
+            lineShader->setLineColour (labelSettings.gridLineColour);
+            glDrawArrays (GL_LINE_LOOP, 4, 4);
         }
 
+        lineShader->disableAttributes (openGLContext);
+    }
 
-        legendBounds.removeFromTop (5);
-        legendBounds.removeFromLeft (5);
-        g.setFont (lineHeight);
+    void Plot2D::drawGridLayer()
+    {
+        textureShader->use();
+        textureShader->bindTexture (openGLContext, gridLayer.getTextureID());
 
-        for (int i = 0; i < numLines; ++i)
+        openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, gridLayerQuadGLBuffer);
+        textureShader->enableAttributes (openGLContext);
+        glDrawArrays (GL_TRIANGLE_STRIP, 0, 4);
+        textureShader->disableAttributes (openGLContext);
+
+        textureShader->unbindTexture();
+    }
+
+    void Plot2D::drawLabels (int width, int height)
+    {
+        if ((numLabelVertices == 0) || (textShader == nullptr))
+            return;
+
+        // the glyph atlas contains no premultiplied colours, the text colour is applied per vertex
+        glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        auto renderingScale = static_cast<float> (openGLContext.getRenderingScale());
+
+        textShader->use();
+        textShader->bindGlyphAtlas (openGLContext, glyphAtlasTexture);
+        textShader->setViewportSize (width, height);
+        textShader->setSmoothing (glyphAtlas->getSmoothingForTextHeight (tickLabelTextHeight * renderingScale));
+
+        openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, labelGLBuffer);
+        textShader->enableAttributes (openGLContext);
+        glDrawArrays (GL_TRIANGLES, 0, numLabelVertices);
+        textShader->disableAttributes (openGLContext);
+
+        textShader->unbindGlyphAtlas();
+    }
+
+    juce::Rectangle<float> Plot2D::getLegendBounds (int width, int height, float renderingScale)
+    {
+        const float margin = legendBoxBorderMargin * renderingScale;
+        const float legendBoxHeight = (labelSettings.numLines * legendTextHeight + 10.0f) * renderingScale;
+        float legendBoxWidth = 0.0f;
+
+        for (auto& n : labelSettings.lineNames)
+            legendBoxWidth = std::max (glyphAtlas->getStringWidth (n, legendTextHeight * renderingScale), legendBoxWidth);
+
+        legendBoxWidth += 15.0f * renderingScale;
+
+        switch (labelSettings.legendState)
         {
-            g.setColour (lineColours[i]);
-            g.drawText (lineNames[i], legendBounds, juce::Justification::topLeft, false);
-            legendBounds.removeFromTop (lineHeight);
+            case topLeft:
+                return {margin, margin, legendBoxWidth, legendBoxHeight};
+
+            case topRight:
+                return {width - margin - legendBoxWidth, margin, legendBoxWidth, legendBoxHeight};
+
+            case bottomLeft:
+                return {margin, height - margin - legendBoxHeight, legendBoxWidth, legendBoxHeight};
+
+            case bottomRight:
+                return {width - margin - legendBoxWidth, height - margin - legendBoxHeight, legendBoxWidth, legendBoxHeight};
+
+            default:
+                return {};
         }
     }
 
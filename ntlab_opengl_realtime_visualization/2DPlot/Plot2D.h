@@ -29,8 +29,13 @@ SOFTWARE.
 #include <juce_core/juce_core.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <juce_opengl/juce_opengl.h>
+#include <atomic>
+#include <mutex>
 #include "../Shader/LineShader.h"
+#include "../Shader/TextureShader.h"
+#include "../Shader/TextShader.h"
 #include "../Utilities/Float2String.h"
+#include "../Utilities/SDFGlyphAtlas.h"
 #include "../Utilities/WindowOpenGLContext.h"
 
 namespace ntlab
@@ -42,9 +47,19 @@ namespace ntlab
      * override the member functions beginFrame, getBufferForLine and endFrame. In all other cases use setYValues to
      * update the plotted lines.
      *
-     * This component uses OpenGL for rendering.
+     * This component uses OpenGL for rendering. Background, grid and the legend box are static most of the time, so
+     * they are rendered into a cached frame buffer that is only re-rendered if the grid, size, colours or line names
+     * change and composited by drawing a single textured quad in every frame. Ticks and legend entries are drawn
+     * directly on the GPU from a shared signed distance field glyph atlas. Their vertices are only rebuilt on the GL
+     * thread if the ranges, size or line names change and all text is drawn with a single draw call.
+     *
+     * In updateAtFramerate mode the vertex data of the next frame is prepared on a worker thread of the
+     * WindowOpenGLContext while the GPU renders the current frame, so the realtime data displayed lags one frame
+     * behind unless late latching is enabled in the FramePacer. Therefore beginFrame, getBufferForLine and endFrame
+     * are called on a worker thread, not the GL thread. If the FramePacer lowers the quality tier, lines are drawn
+     * thinner and with fewer vertices.
      */
-    class Plot2D : public juce::Component, public juce::OpenGLRenderer
+    class Plot2D : public juce::Component, public juce::OpenGLRenderer, public WindowOpenGLContext::ParallelFramePreparation
     {
 
     public:
@@ -92,6 +107,21 @@ namespace ntlab
          */
         void setLines (int numLines, juce::StringArray &legend, juce::Array<juce::Colour> lineColours = {});
 
+        /**
+         * Turns this plot into a view of the lines held by the source plot. The view creates no line buffers of its
+         * own but draws the GPU buffers of the source, so any number of views only cost one upload and one draw call
+         * per view. This allows e.g. an overview plot and a zoomed view of the same data. The number of lines, the
+         * legend, the line colours and the x and y range are copied from the source when calling this, afterwards
+         * they can be changed independently through setLines, setXRange and setYRange. Whenever setLines or
+         * setXValues is called on the source, the new lines or x values are passed on to all its views again, which
+         * resets the x range of the views. Only the vertices inside the visible x range are drawn. Pass a nullptr to
+         * stop viewing the source plot.
+         *
+         * The source plot has to be rendered by the same WindowOpenGLContext or by one sharing its resources, as line
+         * buffers can't be accessed from unrelated OpenGL contexts. Views of views are not supported.
+         */
+        void viewLinesOf (Plot2D* sourcePlot);
+
         /**
          * Sets the background colour of the plot. If changeGridColour is set to true, a grid colour contrasting
          * the background colour is chosen automatically
@@ -118,7 +148,13 @@ namespace ntlab
         const juce::Range<double> getLineWidthRange();
 
         /**
-         * If updateAtFramerate mode is active, this will be called for every render frame to allow you to prepare
+         * Returns the width of the plot in physical pixels, which is the maximum number of distinguishable points along
+         * the x axis. Use it to choose the level of detail of the data to display.
+         */
+        int getPhysicalWidth();
+
+        /**
+         * If updateAtFramerate mode is active, this will be called on a worker thread for every render frame to allow you to prepare
          * your data to be read by getBufferForLine. Make sure to have as many buffers as there are lines, each of
          * them holding number of expected y-values matching the x-value buffer passed before. After all lines
          * have been loaded a call to endFrame will signal that it's now safe to release your resources.
@@ -147,6 +183,14 @@ namespace ntlab
          */
         int setXValues (juce::Range<float> xValueRange, float xValueDelta, LogScaling xValueScaling);
 
+        /**
+         * This will set the x value base for all data lines to be plotted, just like the version above, but creates
+         * exactly numXValues linear spaced x values with a delta of xValueRange.getLength() / numXValues. Use this if
+         * the number of y values is known, as dividing the range by a delta computed from the number of values might
+         * round down to one value less. Returns numXValues.
+         */
+        int setXValues (juce::Range<float> xValueRange, int numXValues, LogScaling xValueScaling);
+
         /** Returns the number of y-values expected for the current x values. */
         int getNumDatapointsExpected();
 
@@ -164,6 +208,30 @@ namespace ntlab
          */
         void setYValues (float* yValues, int lineIdx);
 
+        /**
+         * Takes a snapshot of the line currently displayed and keeps drawing it as reference trace beneath the live
+         * lines. The snapshot is copied from line buffer to a new buffer on the GPU, so neither capturing nor
+         * displaying it involves any transfer of the data from or to the CPU. Returns the index of the new reference
+         * trace. Reference traces are only drawn as long as the x values are not changed by setXValues.
+         */
+        int addReferenceTraceFromLine (int lineIdx, juce::Colour traceColour);
+
+        /**
+         * Adds a reference trace, e.g. a golden measurement, that is uploaded once and kept in GPU memory. The Array
+         * passed is expected to hold as many y values as getNumDatapointsExpected returns. Returns the index of the
+         * new reference trace.
+         */
+        int addReferenceTrace (const juce::Array<float>& yValues, juce::Colour traceColour);
+
+        /** Removes a reference trace. The indices of all following reference traces will be decremented by one */
+        void removeReferenceTrace (int referenceTraceIdx);
+
+        /** Removes all reference traces */
+        void clearReferenceTraces();
+
+        /** Returns the number of reference traces currently added */
+        int getNumReferenceTraces();
+
         /**
          * Changes the range of y values displayed independent of the range of values passed to setYValues. An optional
          * logarithmic scaling can be applied to the data if it suits the use case. Note that this computation is
@@ -209,7 +277,6 @@ namespace ntlab
          */
         void enableYAxisTicks (bool shouldBeEnabled, const juce::String unitPostfix = "", bool equalPrefixForEachTick = true);
 
-        void paint (juce::Graphics &g) override;
         void resized() override;
 
         /**
@@ -233,15 +300,89 @@ namespace ntlab
         void renderOpenGL() override;
         void openGLContextClosing() override;
 
+        // Called on a worker thread of the WindowOpenGLContext in updateAtFramerate mode
+        void prepareNextFrame() override;
+
+    protected:
+
+        /**
+         * Called on the GL thread for every frame after the grid has been drawn and before the lines are drawn, with
+         * the viewport set to the plot area and alpha blending enabled. Override this to draw additional content
+         * beneath the lines, e.g. a texture. You are free to use any shader program, the line shader is activated
+         * again afterwards.
+         */
+        virtual void renderBeneathLines (juce::OpenGLContext& /*openGLContext*/, int /*width*/, int /*height*/) {}
+
+        /**
+         * Override this to return true if the lines consist of pairs of a minimum and a maximum value, e.g. because
+         * the samples have been decimated bucket-wise. Skipping vertices would then drop the maxima, so the lines of
+         * such a plot and of all views of it are always drawn with all vertices, even at a lower quality tier.
+         */
+        virtual bool linesHoldMinMaxPairs() const { return false; }
+
     private:
 
         // OpenGL related member variables
         WindowOpenGLContext&          windowOpenGLContext;
         juce::OpenGLContext&          openGLContext;
-        std::unique_ptr<LineShader2D> lineShader;
+        LineShader2D*                 lineShader = nullptr; // owned by the GLResourcePool
         GLuint                        gridLineGLBuffer;
         bool                          shouldRenderGrid = false;
 
+        // Cached grid layer
+        TextureShader2D*                 textureShader = nullptr;
+        GLuint                           gridLayerQuadGLBuffer;
+        GLuint                           legendBoxGLBuffer;
+        juce::OpenGLFrameBuffer          gridLayer;
+        std::atomic<bool>                gridLayerNeedsUpdate {true};
+
+        // Text rendering for ticks and legend
+        juce::SharedResourcePointer<SDFGlyphAtlas> glyphAtlas;
+        TextShader2D*                              textShader = nullptr;
+        GLuint                                     glyphAtlasTexture = 0;
+        GLuint                                     labelGLBuffer;
+        std::vector<TextShader2D::Vertex>          labelVertices;
+        GLsizei                                    numLabelVertices = 0;
+        std::atomic<bool>                          labelsNeedUpdate {true};
+        int labelsWidth  = 0;
+        int labelsHeight = 0;
+
+        // A copy of everything the labels and the legend box are built from, taken on the message thread whenever
+        // one of the values changes and fetched by the GL thread before the grid layer or the labels are updated
+        struct LabelSettings
+        {
+            juce::StringArray         lineNames;
+            juce::Array<juce::Colour> lineColours;
+            int                       numLines = 0;
+            bool                      hasXValues = false;
+            juce::Range<float>        xValueRange, yValueRange;
+            LogScaling                xLogScaling = LogScaling::none;
+            juce::Colour              gridLineColour;
+            bool                      drawXTicks = false;
+            bool                      drawYTicks = false;
+            bool                      equalPrefixForEachXTick = true;
+            bool                      equalPrefixForEachYTick = true;
+            juce::String              xTickPostfix, yTickPostfix;
+            int                       legendState = -1;
+            bool                      drawLegendBorder = true;
+            float                     legendBackgroundTransparency = 0.5f;
+        };
+        std::mutex        labelSettingsLock;
+        LabelSettings     pendingLabelSettings; // guarded by labelSettingsLock
+        std::atomic<bool> labelSettingsChanged {false};
+        LabelSettings     labelSettings;        // only accessed on the GL thread and by views holding the render lock
+
+        // Reference traces kept in GPU memory, only accessed on the GL thread
+        struct ReferenceTrace
+        {
+            GLuint glBuffer = 0; // 0 if the trace could not be captured
+            juce::Colour colour;
+            int numDatapoints = 0;
+        };
+        std::vector<ReferenceTrace> referenceTraces;
+        int numReferenceTraces = 0; // only accessed on the message thread
+        GLExtraFunctions glFunctions;
+
         // Arrays containing information for each line
         juce::Array<GLuint>          lineGLBuffers; // the buffer location to use on the GPU side
         juce::StringArray            lineNames;
@@ -252,12 +393,44 @@ namespace ntlab
         // Needed for non-continous drawing
         bool updatesAtFramerate;
 
+        // If this is not a nullptr, the lines of this plot are drawn from the line buffers of the plot pointed to
+        std::atomic<Plot2D*> viewedPlot {nullptr};
+        juce::Array<Plot2D*> views; // the plots viewing this plot, only accessed from the message thread
+
         // A preallocated temporary buffer that holds the plot data prepared for copying them to the GPU memory
         std::vector<juce::Point<float>> tempRenderDataBuffer;
 
+        // The vertices of each line prepared by prepareNextFrame. An empty vector means the line should not be drawn
+        std::vector<std::vector<juce::Point<float>>> preparedLineData;
+
+        // Guards tempRenderDataBuffer, numDatapointsExpected and numLines, which are written on the message thread and
+        // read by prepareNextFrame on a worker thread and by renderOpenGL on the GL thread
+        std::mutex frameDataLock;
+
+        /**
+         * Everything the views of this plot need to draw its lines. It is only written on the GL thread of this plot
+         * and read on the GL threads of the views, which all hold the render lock of the shared resource pool.
+         */
+        struct LinesForViews
+        {
+            std::vector<GLuint> glBuffers; // 0 for lines that were not drawn in the last frame
+            int                 numDatapoints = 0;
+            juce::Range<float>  xDataRange {0.0f, 1.0f};
+            LogScaling          xLogScaling = LogScaling::none;
+
+            /** Returns the value of an x value as stored in the line buffers */
+            float normalizeXValue (float xValue) const;
+
+            /** Returns the fractional index of the point with the x value passed, limited to -1...numDatapoints + 1 */
+            float getPointIndex (float xValue) const;
+        };
+        LinesForViews linesForViews;
+
         // Some variables needed to compute the visual aperance
         juce::Range<double> lineWidthRange;
+        GLfloat lineWidth = 1.0f; // only accessed on the GL thread
         juce::Range<float> xValueRange, yValueRange;
+        juce::Range<float> xDataRange {0.0f, 1.0f}; // the range passed to setXValues, mapped to 0...1 in the buffers
         LogScaling xLogScaling = LogScaling::none;
         LogScaling yLogScaling = LogScaling::none;
         juce::Colour backgroundColour = juce::Colours::white;
@@ -270,6 +443,9 @@ namespace ntlab
         bool equalPrefixForEachYTick = true;
         juce::String xTickPostfix, yTickPostfix;
         static const int tickTextHeight = 20;
+        static const int legendBoxBorderMargin = 20;
+        static constexpr float tickLabelTextHeight = 14.0f;
+        static constexpr float legendTextHeight    = 15.0f;
         int legendState = -1;
         bool drawLegendBorder = true;
         float legendBackgroundTransparency = 0.5f;
@@ -279,6 +455,42 @@ namespace ntlab
         void getLineWidthRangePossibleForGPU();
         void resizeLineGLBuffers();
 
+        /**
+         * Uploads the vertices of a line either on the GL thread or through the AsyncBufferUploader if the
+         * WindowOpenGLContext is set up to use it
+         */
+        void uploadLineData (std::vector<juce::Point<float>>&& lineData, int lineIdx);
+
+        // Take over the lines or x values of the plot viewed, called on the message thread whenever the source changes
+        void adoptLinesOf (const Plot2D& sourcePlot);
+        void adoptXValuesOf (const Plot2D& sourcePlot);
+
+        // Draws the part of the lines of a viewed plot that is inside the x range of this plot
+        void drawLinesOf (Plot2D& sourcePlot, int decimation);
+
+        // Draws all reference traces that match the current x values
+        void drawReferenceTraces (int decimation);
+        void deleteReferenceTraceBuffers();
+
+        /**
+         * Fetches the shaders and the glyph atlas texture from the resource pool. Has to be called at the beginning of
+         * each render callback, as the pool re-creates shaders when the context that created them was closed.
+         */
+        bool acquireSharedResources();
+
+        // Member functions to manage the cached grid layer and the labels
+        void invalidateGridLayer();
+        void invalidateLabels();
+        void updateLabelSettings();
+        void fetchLabelSettings();
+        void updateLabels (int width, int height);
+        void renderGridLayer (int width, int height);
+        void drawGridLines();
+        void drawLegendBox (int width, int height);
+        void drawGridLayer();
+        void drawLabels (int width, int height);
+        juce::Rectangle<float> getLegendBounds (int width, int height, float renderingScale);
+
         // Called once in each constructor
         void setup (bool updateAtFramerate);
     };
@@ -0,0 +1,71 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+namespace ntlab
+{
+    /**
+     * A minimal second order IIR filter section in transposed direct form II. The state is kept in double precision,
+     * so that filters with poles close to the unit circle, e.g. low frequency highpass filters at high sample rates,
+     * stay accurate. The coefficients are expected to be normalized to a0 = 1.
+     */
+    class Biquad
+    {
+    public:
+
+        struct Coefficients
+        {
+            double b0 = 1.0, b1 = 0.0, b2 = 0.0;
+            double a1 = 0.0, a2 = 0.0;
+        };
+
+        void setCoefficients (const Coefficients& newCoefficients) { coefficients = newCoefficients; }
+
+        /** Clears the filter state */
+        void reset() { z1 = z2 = 0.0; }
+
+        /** Filters numSamples samples. Input and output might point to the same memory */
+        void process (const float* input, float* output, int numSamples)
+        {
+            const auto c = coefficients;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double x = input[i];
+                const double y = c.b0 * x + z1;
+                z1 = c.b1 * x - c.a1 * y + z2;
+                z2 = c.b2 * x - c.a2 * y;
+                output[i] = static_cast<float> (y);
+            }
+        }
+
+    private:
+        Coefficients coefficients;
+        double z1 = 0.0, z2 = 0.0;
+    };
+}
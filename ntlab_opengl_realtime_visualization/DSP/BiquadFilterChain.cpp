@@ -0,0 +1,173 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include "BiquadFilterChain.h"
+
+namespace ntlab
+{
+    BiquadFilterChain::BiquadFilterChain()
+    {
+        // Swapping the vectors never reallocates, so the realtime thread won't free any memory
+        activeCoefficients. reserve (maxNumSections);
+        pendingCoefficients.reserve (maxNumSections);
+    }
+
+    void BiquadFilterChain::prepare (int newNumChannels)
+    {
+        numChannels = newNumChannels;
+
+        z1.resize (static_cast<size_t> (maxNumSections * numChannels));
+        z2.resize (static_cast<size_t> (maxNumSections * numChannels));
+        currentSamples.resize (static_cast<size_t> (numChannels));
+        readPointers.  resize (static_cast<size_t> (numChannels));
+        writePointers. resize (static_cast<size_t> (numChannels));
+
+        reset();
+    }
+
+    void BiquadFilterChain::reset()
+    {
+        std::fill (z1.begin(), z1.end(), 0.0);
+        std::fill (z2.begin(), z2.end(), 0.0);
+    }
+
+    void BiquadFilterChain::setCoefficients (const std::vector<Biquad::Coefficients>& newCoefficients)
+    {
+        // A cascade with more than maxNumSections sections is not supported
+        jassert (newCoefficients.size() <= maxNumSections);
+
+        const auto numSections = std::min (newCoefficients.size(), static_cast<size_t> (maxNumSections));
+
+        const juce::SpinLock::ScopedLockType scopedLock (pendingCoefficientsLock);
+        pendingCoefficients.assign (newCoefficients.begin(), newCoefficients.begin() + static_cast<std::ptrdiff_t> (numSections));
+        newCoefficientsPending = true;
+    }
+
+    bool BiquadFilterChain::updateCoefficients()
+    {
+        if (newCoefficientsPending)
+        {
+            const juce::SpinLock::ScopedTryLockType scopedTryLock (pendingCoefficientsLock);
+
+            // If the coefficients are currently being set, they will be taken over with the next block
+            if (scopedTryLock.isLocked())
+            {
+                const auto numSectionsBefore = static_cast<int> (activeCoefficients.size());
+                std::swap (activeCoefficients, pendingCoefficients);
+                newCoefficientsPending = false;
+
+                // Sections that were added start with a cleared state, the state of all others is kept
+                const auto numSections = static_cast<int> (activeCoefficients.size());
+                if (numSections > numSectionsBefore)
+                {
+                    std::fill (z1.begin() + numSectionsBefore * numChannels, z1.begin() + numSections * numChannels, 0.0);
+                    std::fill (z2.begin() + numSectionsBefore * numChannels, z2.begin() + numSections * numChannels, 0.0);
+                }
+            }
+        }
+
+        return ! activeCoefficients.empty();
+    }
+
+    void BiquadFilterChain::process (const juce::AudioBuffer<float>& input, int startSample, juce::AudioBuffer<float>& output, int numSamples)
+    {
+        jassert ((input.getNumChannels() == numChannels) && (output.getNumChannels() == numChannels));
+
+        for (int c = 0; c < numChannels; ++c)
+        {
+            readPointers[static_cast<size_t> (c)]  = input.getReadPointer (c, startSample);
+            writePointers[static_cast<size_t> (c)] = output.getWritePointer (c);
+        }
+
+        const int numSections = static_cast<int> (activeCoefficients.size());
+        double* x = currentSamples.data();
+
+        for (int s = 0; s < numSamples; ++s)
+        {
+            for (int c = 0; c < numChannels; ++c)
+                x[c] = readPointers[static_cast<size_t> (c)][s];
+
+            for (int section = 0; section < numSections; ++section)
+            {
+                const auto coeffs = activeCoefficients[static_cast<size_t> (section)];
+                double* s1 = z1.data() + section * numChannels;
+                double* s2 = z2.data() + section * numChannels;
+
+                for (int c = 0; c < numChannels; ++c)
+                {
+                    const double y = coeffs.b0 * x[c] + s1[c];
+                    s1[c] = coeffs.b1 * x[c] - coeffs.a1 * y + s2[c];
+                    s2[c] = coeffs.b2 * x[c] - coeffs.a2 * y;
+                    x[c] = y;
+                }
+            }
+
+            for (int c = 0; c < numChannels; ++c)
+                writePointers[static_cast<size_t> (c)][s] = static_cast<float> (x[c]);
+        }
+    }
+
+    juce::String BiquadFilterChain::coefficientsToString (const std::vector<Biquad::Coefficients>& coefficients)
+    {
+        juce::StringArray sections;
+
+        for (auto& c : coefficients)
+        {
+            juce::StringArray values;
+            for (auto v : { c.b0, c.b1, c.b2, c.a1, c.a2 })
+                values.add (juce::String (v, 16, true));
+
+            sections.add (values.joinIntoString (" "));
+        }
+
+        return sections.joinIntoString ("|");
+    }
+
+    std::vector<Biquad::Coefficients> BiquadFilterChain::coefficientsFromString (const juce::String& coefficientsSerialized)
+    {
+        std::vector<Biquad::Coefficients> coefficients;
+
+        for (auto& section : juce::StringArray::fromTokens (coefficientsSerialized, "|", ""))
+        {
+            auto values = juce::StringArray::fromTokens (section, " ", "");
+
+            // Each section is expected to consist of b0, b1, b2, a1 and a2
+            jassert (values.size() == 5);
+            if (values.size() != 5)
+                continue;
+
+            Biquad::Coefficients c;
+            c.b0 = values[0].getDoubleValue();
+            c.b1 = values[1].getDoubleValue();
+            c.b2 = values[2].getDoubleValue();
+            c.a1 = values[3].getDoubleValue();
+            c.a2 = values[4].getDoubleValue();
+            coefficients.push_back (c);
+        }
+
+        return coefficients;
+    }
+}
@@ -0,0 +1,99 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "Biquad.h"
+
+namespace ntlab
+{
+    /**
+     * A cascade of up to maxNumSections biquad sections, filtering all channels of a multichannel signal at once.
+     * The samples are processed sample by sample with the innermost loops running over the channels, so that the
+     * state updates of all channels can be vectorized by the compiler. Like Biquad, the state is kept in double
+     * precision.
+     *
+     * New coefficients can be set from any thread while the realtime thread keeps filtering. They are handed over
+     * at the start of the next block without clearing the state of the sections that were already active, so a
+     * coefficient change doesn't produce a discontinuity. A chain without sections leaves the signal untouched.
+     */
+    class BiquadFilterChain
+    {
+    public:
+
+        static const int maxNumSections = 8;
+
+        BiquadFilterChain();
+
+        /** Allocates the filter state for numChannels channels and clears it. Must not be called while processing */
+        void prepare (int numChannels);
+
+        /** Clears the filter state of all channels */
+        void reset();
+
+        /**
+         * Sets the coefficients of all sections of the chain. Sections exceeding maxNumSections are ignored, an empty
+         * vector disables filtering. The new coefficients will be used from the next call to updateCoefficients on.
+         */
+        void setCoefficients (const std::vector<Biquad::Coefficients>& newCoefficients);
+
+        /**
+         * Call this on the realtime thread before filtering a block to take over coefficients that have been set in
+         * the meantime. Returns true if the chain has at least one section and process needs to be called.
+         */
+        bool updateCoefficients();
+
+        /**
+         * Filters numSamples samples of all channels starting at startSample of the input buffer and writes them to
+         * the start of the output buffer. Input and output might be the same buffer if startSample is 0.
+         */
+        void process (const juce::AudioBuffer<float>& input, int startSample, juce::AudioBuffer<float>& output, int numSamples);
+
+        /** Serializes a set of coefficients so that it can be sent as a setting */
+        static juce::String coefficientsToString (const std::vector<Biquad::Coefficients>& coefficients);
+
+        /** Restores a set of coefficients serialized by coefficientsToString */
+        static std::vector<Biquad::Coefficients> coefficientsFromString (const juce::String& coefficientsSerialized);
+
+    private:
+
+        int numChannels = 0;
+
+        // The active coefficients are only accessed by the realtime thread, the pending ones are protected by the lock
+        std::vector<Biquad::Coefficients> activeCoefficients, pendingCoefficients;
+        std::atomic<bool> newCoefficientsPending {false};
+        juce::SpinLock pendingCoefficientsLock;
+
+        // The states of all channels of one section are stored next to each other
+        std::vector<double> z1, z2;
+        std::vector<double> currentSamples;
+
+        std::vector<const float*> readPointers;
+        std::vector<float*> writePointers;
+    };
+}
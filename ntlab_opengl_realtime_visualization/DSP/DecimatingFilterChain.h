@@ -0,0 +1,133 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "BiquadFilterChain.h"
+#include "HalfBandDecimator.h"
+
+namespace ntlab
+{
+    /**
+     * The optional preprocessing shared by the collectors: the samples are decimated by a HalfBandDecimator and then
+     * filtered by a BiquadFilterChain. Both are applied chunk-wise to an internal processing buffer, the processed
+     * chunks are passed on to a callback. If neither decimation nor filtering is active, the buffer passed is handed
+     * to the callback as it is. Memory is only allocated in prepare, so process can be called on the realtime thread.
+     */
+    class DecimatingFilterChain
+    {
+    public:
+
+        /** Allocates the filter states and the processing buffer for numChannels channels. Must not be called while processing */
+        void prepare (int numChannels);
+
+        /**
+         * Sets the number of half-band stages the samples pass before being filtered, resulting in a decimation
+         * factor of 2^numStages. Pass 0 to disable decimation. Must not be called while processing.
+         */
+        void prepareDecimation (int numStages);
+
+        /**
+         * Sets the coefficients of the biquad sections applied after the decimation. This can safely be called while
+         * processing, the new coefficients are applied with the next buffer processed.
+         */
+        void setFilterCoefficients (const std::vector<Biquad::Coefficients>& coefficients);
+
+        int getNumStages() const { return decimator.getNumStages(); }
+
+        int getDecimationFactor() const { return decimator.getDecimationFactor(); }
+
+        /**
+         * Returns the buffer of maxNumSamplesPerChunk samples per channel the processed chunks are written to. A caller
+         * can use it to convert samples before processing them, as processing works in place if a buffer referring
+         * to the start of this buffer and holding no more than maxNumSamplesPerChunk samples is passed.
+         */
+        juce::AudioBuffer<float>& getProcessingBuffer() { return processingBuffer; }
+
+        /**
+         * Processes the samples of all channels of the buffer passed, which needs to hold the number of channels
+         * prepared, and calls processedSamplesCallback with an AudioBuffer<float>& for each processed chunk.
+         */
+        template <typename ProcessedSamplesCallback>
+        void process (juce::AudioBuffer<float>& buffer, ProcessedSamplesCallback&& processedSamplesCallback);
+
+        static constexpr int maxNumSamplesPerChunk = 4096;
+
+    private:
+        int numChannels = 0;
+
+        HalfBandDecimator decimator;
+        BiquadFilterChain filter;
+        juce::AudioBuffer<float> processingBuffer;
+    };
+
+    template <typename ProcessedSamplesCallback>
+    void DecimatingFilterChain::process (juce::AudioBuffer<float>& buffer, ProcessedSamplesCallback&& processedSamplesCallback)
+    {
+        jassert (buffer.getNumChannels() == numChannels);
+
+        const bool shouldFilter = filter.updateCoefficients();
+        const bool shouldDecimate = decimator.getNumStages() > 0;
+
+        if (! shouldFilter && ! shouldDecimate)
+        {
+            processedSamplesCallback (buffer);
+            return;
+        }
+
+        const int numSamplesInBuffer = buffer.getNumSamples();
+
+        for (int start = 0; start < numSamplesInBuffer; start += maxNumSamplesPerChunk)
+        {
+            int numSamplesInChunk = std::min (maxNumSamplesPerChunk, numSamplesInBuffer - start);
+
+            if (shouldDecimate)
+            {
+                int numDecimatedSamples = 0;
+                for (int n = 0; n < numChannels; ++n)
+                    numDecimatedSamples = decimator.process (n, buffer.getReadPointer (n, start), processingBuffer.getWritePointer (n), numSamplesInChunk);
+
+                numSamplesInChunk = numDecimatedSamples;
+
+                // the filter works in place on the decimated samples
+                if (shouldFilter)
+                    filter.process (processingBuffer, 0, processingBuffer, numSamplesInChunk);
+            }
+            else
+            {
+                // the filter output replaces copying the samples to the processing buffer
+                filter.process (buffer, start, processingBuffer, numSamplesInChunk);
+            }
+
+            if (numSamplesInChunk > 0)
+            {
+                juce::AudioBuffer<float> processedSamples (processingBuffer.getArrayOfWritePointers(), numChannels, numSamplesInChunk);
+                processedSamplesCallback (processedSamples);
+            }
+        }
+    }
+}
@@ -0,0 +1,182 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include "HalfBandDecimator.h"
+
+namespace ntlab
+{
+    HalfBandDecimator::HalfBandDecimator()
+    {
+        const int numTaps = 4 * numTapPairs - 1;
+        const double center = 0.5 * (numTaps - 1);
+        double gain = 0.0;
+
+        // A Blackman windowed sinc lowpass with the cutoff at a quarter of the sample rate. Only the taps with an
+        // even index are stored, all other taps are zero except for the center tap of 0.5
+        for (int tap = 0; tap < numTapPairs; ++tap)
+        {
+            const int n = 2 * tap;
+            const double x = n - center;
+            const double sinc = std::sin (juce::MathConstants<double>::halfPi * x) / (juce::MathConstants<double>::pi * x);
+            const double w = 2.0 * juce::MathConstants<double>::pi * n / (numTaps - 1);
+            const double window = 0.42 - 0.5 * std::cos (w) + 0.08 * std::cos (2.0 * w);
+
+            coefficients[tap] = static_cast<float> (sinc * window);
+            gain += 2.0 * sinc * window;
+        }
+
+        // Normalize the symmetric branch to a gain of 0.5 at DC, which adds up to unity gain with the center tap
+        for (auto& c : coefficients)
+            c = static_cast<float> (0.5 * c / gain);
+    }
+
+    void HalfBandDecimator::prepare (int newNumChannels, int newNumStages)
+    {
+        jassert (juce::isPositiveAndNotGreaterThan (newNumStages, maxNumStages));
+
+        numChannels = newNumChannels;
+        numStages = newNumStages;
+
+        stageStates.resize (static_cast<size_t> (numChannels * numStages));
+        for (auto& state : stageStates)
+        {
+            state.evenBranch.resize (evenHistoryLength + chunkSize);
+            state.oddBranch. resize (oddHistoryLength  + chunkSize);
+        }
+
+        pairSums.resize (chunkSize);
+
+        reset();
+    }
+
+    void HalfBandDecimator::reset()
+    {
+        for (auto& state : stageStates)
+        {
+            std::fill (state.evenBranch.begin(), state.evenBranch.end(), 0.0f);
+            std::fill (state.oddBranch. begin(), state.oddBranch. end(), 0.0f);
+            state.hasOddSample = false;
+        }
+    }
+
+    int HalfBandDecimator::process (int channel, const float* input, float* output, int numSamples)
+    {
+        jassert (juce::isPositiveAndBelow (channel, numChannels));
+
+        if (numStages == 0)
+        {
+            if (output != input)
+                juce::FloatVectorOperations::copy (output, input, numSamples);
+
+            return numSamples;
+        }
+
+        auto* states = stageStates.data() + channel * numStages;
+
+        // All stages after the first one work in place on the output buffer
+        numSamples = processStage (states[0], input, output, numSamples);
+
+        for (int stage = 1; stage < numStages; ++stage)
+            numSamples = processStage (states[stage], output, output, numSamples);
+
+        return numSamples;
+    }
+
+    int HalfBandDecimator::processStage (StageState& state, const float* input, float* output, int numSamples)
+    {
+        // Writing the output never overtakes reading the input, as each output sample consumes two input samples
+        int numOutputSamples = 0;
+        int inputIdx = 0;
+
+        while (inputIdx < numSamples)
+        {
+            float* even = state.evenBranch.data() + evenHistoryLength;
+            float* odd  = state.oddBranch. data() + oddHistoryLength;
+
+            // Split the input into the polyphase branches behind the history of the previous chunk. If no sample of
+            // the last call is left over, complete pairs can be split at once
+            int numPairs = 0;
+            if (! state.hasOddSample)
+            {
+                numPairs = std::min ((numSamples - inputIdx) / 2, chunkSize);
+                VectorKernels::deinterleavePairs (odd, even, input + inputIdx, numPairs);
+                inputIdx += 2 * numPairs;
+            }
+
+            for (; (inputIdx < numSamples) && (numPairs < chunkSize); ++inputIdx)
+            {
+                if (state.hasOddSample)
+                {
+                    odd[numPairs]  = state.oddSample;
+                    even[numPairs] = input[inputIdx];
+                    ++numPairs;
+                }
+                else
+                {
+                    state.oddSample = input[inputIdx];
+                }
+
+                state.hasOddSample = ! state.hasOddSample;
+            }
+
+            if (numPairs == 0)
+                break;
+
+            float* out = output + numOutputSamples;
+
+            // The delay branch only consists of the center tap
+            juce::FloatVectorOperations::copyWithMultiply (out, odd - oddHistoryLength, 0.5f, numPairs);
+
+            // Symmetric taps are applied to the sum of both samples they refer to
+            const float* evenHistory = even - evenHistoryLength;
+            for (int tap = 0; tap < numTapPairs; ++tap)
+            {
+                juce::FloatVectorOperations::add (pairSums.data(), evenHistory + tap, evenHistory + evenHistoryLength - tap, numPairs);
+                juce::FloatVectorOperations::addWithMultiply (out, pairSums.data(), coefficients[tap], numPairs);
+            }
+
+            // Keep the newest samples of both branches as history for the next chunk
+            std::copy (even + numPairs - evenHistoryLength, even + numPairs, state.evenBranch.data());
+            std::copy (odd  + numPairs - oddHistoryLength,  odd  + numPairs, state.oddBranch. data());
+
+            numOutputSamples += numPairs;
+        }
+
+        return numOutputSamples;
+    }
+
+    int HalfBandDecimator::getNumStagesForBandwidth (double sampleRate, double bandwidth)
+    {
+        if ((sampleRate <= 0.0) || (bandwidth <= 0.0))
+            return 0;
+
+        int stages = 0;
+        while ((stages < maxNumStages) && ((sampleRate / (2 << stages)) * usableBandwidth >= bandwidth))
+            ++stages;
+
+        return stages;
+    }
+}
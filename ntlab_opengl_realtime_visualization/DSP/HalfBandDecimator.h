@@ -0,0 +1,113 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "VectorKernels.h"
+
+namespace ntlab
+{
+    /**
+     * Decimates a multichannel signal by a power of two through a cascade of half-band FIR lowpass stages, each one
+     * decimating by two. Every stage is split into its two polyphase branches, so that only every second output
+     * sample is computed. As every second coefficient of a half-band filter except the center tap is zero, one
+     * branch reduces to a pure delay while the other one is symmetric, leaving numTapPairs multiplications per
+     * output sample and stage. The branches are filtered block-wise with the vector operations supplied by JUCE.
+     *
+     * Each stage passes the lower 0.19 of its input sample rate unchanged and attenuates everything that would alias
+     * into that band by more than 70 dB, so the output of the cascade is usable up to usableBandwidth times the
+     * output sample rate. Memory is only allocated in prepare, so process can be called on the realtime thread.
+     */
+    class HalfBandDecimator
+    {
+    public:
+
+        HalfBandDecimator();
+
+        /**
+         * Allocates the filter states for numChannels channels and a cascade of numStages stages, resulting in a
+         * decimation factor of 2^numStages. Passing 0 stages disables decimation.
+         */
+        void prepare (int numChannels, int numStages);
+
+        /** Clears the filter states of all channels */
+        void reset();
+
+        /**
+         * Decimates numSamples samples of one channel and returns the number of samples written to output. The output
+         * buffer needs space for at least numSamples / getDecimationFactor() + 1 samples and might point to the same
+         * memory as the input. Sample counts that are not a multiple of the decimation factor are handled by keeping
+         * the remaining samples for the next call.
+         */
+        int process (int channel, const float* input, float* output, int numSamples);
+
+        int getNumStages() const { return numStages; }
+
+        int getDecimationFactor() const { return 1 << numStages; }
+
+        /**
+         * Returns the number of stages needed to decimate a signal sampled at sampleRate as far as possible while
+         * keeping the bandwidth passed usable. Returns 0 if the bandwidth passed is 0 or no decimation is possible.
+         */
+        static int getNumStagesForBandwidth (double sampleRate, double bandwidth);
+
+        /** The fraction of the output sample rate that is passed unaltered and free of aliasing */
+        static constexpr double usableBandwidth = 0.375;
+
+        static const int numTapPairs = 12;
+        static const int maxNumStages = 10;
+
+    private:
+
+        // The number of input sample pairs processed at once
+        static constexpr int chunkSize = 256;
+
+        // The symmetric branch needs the last 2 * numTapPairs - 1 sample pairs, the delay branch numTapPairs - 1
+        static const int evenHistoryLength = 2 * numTapPairs - 1;
+        static const int oddHistoryLength  = numTapPairs - 1;
+
+        struct StageState
+        {
+            std::vector<float> evenBranch, oddBranch;
+            float oddSample = 0.0f;
+            bool  hasOddSample = false;
+        };
+
+        // The first half of the coefficients of the symmetric branch
+        float coefficients[numTapPairs];
+
+        int numStages = 0;
+        int numChannels = 0;
+
+        // numStages states per channel, stored channel after channel
+        std::vector<StageState> stageStates;
+        std::vector<float> pairSums;
+
+        int processStage (StageState& state, const float* input, float* output, int numSamples);
+    };
+}
@@ -0,0 +1,161 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "KWeightingFilter.h"
+
+namespace ntlab
+{
+    void KWeightingFilter::setSampleRate (double sampleRate)
+    {
+        jassert (sampleRate > 0.0);
+
+        // Stage 1: high shelf with about +4 dB above 1.5 kHz
+        {
+            const double f0 = 1681.974450955533;
+            const double gainDB = 3.999843853973347;
+            const double q = 0.7071752369554196;
+
+            const double k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+            const double vh = std::pow (10.0, gainDB / 20.0);
+            const double vb = std::pow (vh, 0.4996667741545416);
+            const double a0 = 1.0 + k / q + k * k;
+
+            Biquad::Coefficients c;
+            c.b0 = (vh + vb * k / q + k * k) / a0;
+            c.b1 = 2.0 * (k * k - vh) / a0;
+            c.b2 = (vh - vb * k / q + k * k) / a0;
+            c.a1 = 2.0 * (k * k - 1.0) / a0;
+            c.a2 = (1.0 - k / q + k * k) / a0;
+            highShelf.setCoefficients (c);
+        }
+
+        // Stage 2: RLB highpass at about 38 Hz
+        {
+            const double f0 = 38.13547087602444;
+            const double q = 0.5003270373238773;
+
+            const double k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+            const double a0 = 1.0 + k / q + k * k;
+
+            Biquad::Coefficients c;
+            c.b0 = 1.0;
+            c.b1 = -2.0;
+            c.b2 = 1.0;
+            c.a1 = 2.0 * (k * k - 1.0) / a0;
+            c.a2 = (1.0 - k / q + k * k) / a0;
+            highpass.setCoefficients (c);
+        }
+
+        reset();
+    }
+
+    void KWeightingFilter::reset()
+    {
+        highShelf.reset();
+        highpass.reset();
+    }
+
+    void KWeightingFilter::process (const float* input, float* output, int numSamples)
+    {
+        highShelf.process (input, output, numSamples);
+        highpass. process (output, output, numSamples);
+    }
+
+#if JUCE_UNIT_TESTS
+    /**
+     * Checks the filter at 48 kHz against a cascade built from the coefficients listed in ITU-R BS.1770-4 and checks
+     * the gain at 997 Hz, which the -0.691 dB offset of the loudness computation compensates.
+     */
+    class KWeightingFilterTests : public juce::UnitTest
+    {
+    public:
+        KWeightingFilterTests() : juce::UnitTest ("KWeightingFilter", "ntlab") {}
+
+        void runTest() override
+        {
+            beginTest ("Reference coefficients");
+
+            Biquad::Coefficients shelfReference;
+            shelfReference.b0 =  1.53512485958697;
+            shelfReference.b1 = -2.69169618940638;
+            shelfReference.b2 =  1.19839281085285;
+            shelfReference.a1 = -1.69065929318241;
+            shelfReference.a2 =  0.73248077421585;
+
+            Biquad::Coefficients highpassReference;
+            highpassReference.b0 =  1.0;
+            highpassReference.b1 = -2.0;
+            highpassReference.b2 =  1.0;
+            highpassReference.a1 = -1.99004745483398;
+            highpassReference.a2 =  0.99007225036621;
+
+            Biquad shelf, highpass;
+            shelf.   setCoefficients (shelfReference);
+            highpass.setCoefficients (highpassReference);
+
+            KWeightingFilter filter;
+            filter.setSampleRate (48000.0);
+
+            auto random = getRandom();
+            std::vector<float> input (numSamples), output (numSamples), expected (numSamples);
+
+            // An impulse followed by noise
+            for (auto& s : input)
+                s = random.nextFloat() * 2.0f - 1.0f;
+            input[0] = 1.0f;
+
+            filter.process (input.data(), output.data(), numSamples);
+            shelf.   process (input.data(), expected.data(), numSamples);
+            highpass.process (expected.data(), expected.data(), numSamples);
+
+            for (int i = 0; i < numSamples; ++i)
+                expectWithinAbsoluteError (output[static_cast<size_t> (i)], expected[static_cast<size_t> (i)], 1e-5f);
+
+            beginTest ("Gain at 997 Hz");
+
+            for (int i = 0; i < numSamples; ++i)
+                input[static_cast<size_t> (i)] = std::sin (juce::MathConstants<float>::twoPi * 997.0f * i / 48000.0f);
+
+            filter.setSampleRate (48000.0);
+            filter.process (input.data(), output.data(), numSamples);
+
+            // skip the settling of the highpass
+            double inputEnergy = 0.0, outputEnergy = 0.0;
+            for (int i = numSamples / 2; i < numSamples; ++i)
+            {
+                inputEnergy  += input [static_cast<size_t> (i)] * input [static_cast<size_t> (i)];
+                outputEnergy += output[static_cast<size_t> (i)] * output[static_cast<size_t> (i)];
+            }
+
+            expectWithinAbsoluteError (10.0 * std::log10 (outputEnergy / inputEnergy), 0.691, 0.01);
+        }
+
+    private:
+        static constexpr int numSamples = 48000;
+    };
+
+    static KWeightingFilterTests kWeightingFilterTests;
+#endif
+}
@@ -0,0 +1,53 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Biquad.h"
+
+namespace ntlab
+{
+    /**
+     * The K-weighting filter specified by ITU-R BS.1770 for loudness measurements, consisting of a high shelf
+     * modelling the acoustic effect of the head followed by the RLB highpass. The coefficients are derived for the
+     * sample rate passed, for 48 kHz they match the coefficients given in the specification.
+     */
+    class KWeightingFilter
+    {
+    public:
+
+        /** Computes the filter coefficients for the sample rate passed and clears the filter state */
+        void setSampleRate (double sampleRate);
+
+        /** Clears the filter state */
+        void reset();
+
+        /** Filters numSamples samples. Input and output might point to the same memory */
+        void process (const float* input, float* output, int numSamples);
+
+    private:
+        Biquad highShelf, highpass;
+    };
+}
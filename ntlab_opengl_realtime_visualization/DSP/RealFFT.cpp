@@ -0,0 +1,96 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include "RealFFT.h"
+
+namespace ntlab
+{
+    void RealFFT::prepare (int order)
+    {
+        jassert (order >= 1);
+
+        size = 1 << order;
+        const int halfSize = size / 2;
+
+        halfSizeFFT.reset (new juce::dsp::FFT (order - 1));
+        scratch.allocate (halfSize, true);
+        twiddles.allocate (halfSize, false);
+
+        for (int k = 0; k < halfSize; ++k)
+        {
+            const double phase = -2.0 * juce::MathConstants<double>::pi * k / size;
+            twiddles[k] = std::complex<float> (static_cast<float> (std::cos (phase)), static_cast<float> (std::sin (phase)));
+        }
+    }
+
+    void RealFFT::performForward (float* data)
+    {
+        const int halfSize = size / 2;
+        auto* bins = getBins (data);
+
+        // The samples are read as a complex signal with the even samples as real and the odd samples as imaginary part
+        halfSizeFFT->perform (bins, scratch.get(), false);
+
+        // The spectra of the even and odd samples are separated by their symmetry and combined like in a radix-2
+        // butterfly. The bins at DC and half the sample rate are both derived from the first bin
+        const auto first = scratch[0];
+        bins[0]        = std::complex<float> (first.real() + first.imag(), 0.0f);
+        bins[halfSize] = std::complex<float> (first.real() - first.imag(), 0.0f);
+
+        for (int k = 1; k < halfSize; ++k)
+        {
+            const auto z         = scratch[k];
+            const auto zMirrored = std::conj (scratch[halfSize - k]);
+
+            const auto evenSpectrum = 0.5f * (z + zMirrored);
+            const auto oddSpectrum  = std::complex<float> (0.0f, -0.5f) * (z - zMirrored);
+
+            bins[k] = evenSpectrum + twiddles[k] * oddSpectrum;
+        }
+    }
+
+    void RealFFT::performInverse (float* data)
+    {
+        const int halfSize = size / 2;
+        auto* bins = getBins (data);
+
+        // The reverse of the forward transform: the spectra of the even and odd samples are recovered from the bins and
+        // combined into the spectrum of the complex signal of half the length
+        for (int k = 0; k < halfSize; ++k)
+        {
+            const auto x         = bins[k];
+            const auto xMirrored = std::conj (bins[halfSize - k]);
+
+            const auto evenSpectrum = 0.5f * (x + xMirrored);
+            const auto oddSpectrum  = 0.5f * (x - xMirrored) * std::conj (twiddles[k]);
+
+            scratch[k] = evenSpectrum + std::complex<float> (0.0f, 1.0f) * oddSpectrum;
+        }
+
+        // Real and imaginary part of the result are the even and odd samples, so the complex values are real samples
+        halfSizeFFT->perform (scratch.get(), bins, true);
+    }
+}
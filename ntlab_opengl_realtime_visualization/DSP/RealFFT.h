@@ -0,0 +1,88 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_dsp/juce_dsp.h>
+#include <complex>
+
+namespace ntlab
+{
+    /**
+     * An FFT of real valued signals working in place on a buffer of getNumFloatsForBuffer floats. The forward
+     * transform turns the size real samples at the start of the buffer into the size / 2 + 1 bins of the non-negative
+     * frequencies, stored as interleaved complex values. The remaining bins are the complex conjugates of these and
+     * are not computed. The inverse transform takes these bins and turns them back into size real samples.
+     *
+     * Internally, the even and odd samples are interpreted as real and imaginary part of a complex signal of half the
+     * length, which is transformed by a juce::dsp::FFT of half the size and then split into the spectrum of the real
+     * signal. This needs a scratch buffer of size / 2 complex values, which is owned by the instance. An instance
+     * must therefore not be used by multiple threads at once, use one instance per thread instead.
+     *
+     * Compared to transforming the samples as complex values with zero imaginary part, this halves the work of the
+     * transform, and the samples and bins of a channel only need size + 2 floats instead of two complex buffers of
+     * size values each. Memory is only allocated in prepare.
+     */
+    class RealFFT
+    {
+    public:
+
+        /** Allocates the scratch buffer and twiddle factors for a transform of 2^order samples. Order must be >= 1 */
+        void prepare (int order);
+
+        /** Returns the number of real samples transformed */
+        int getSize() const { return size; }
+
+        /** Returns the number of bins computed by the forward transform */
+        int getNumBins() const { return size / 2 + 1; }
+
+        /** Returns the number of floats a buffer passed to performForward or performInverse must hold */
+        int getNumFloatsForBuffer() const { return size + 2; }
+
+        /** Transforms the real samples at the start of data in place into getNumBins complex bins */
+        void performForward (float* data);
+
+        /**
+         * Transforms the getNumBins complex bins stored in data in place back into real samples. Like the inverse
+         * transform of juce::dsp::FFT, the result is scaled by 1 / size.
+         */
+        void performInverse (float* data);
+
+        /** Returns the bins stored in a buffer after the forward transform */
+        static std::complex<float>* getBins (float* data) { return reinterpret_cast<std::complex<float>*> (data); }
+        static const std::complex<float>* getBins (const float* data) { return reinterpret_cast<const std::complex<float>*> (data); }
+
+    private:
+        int size = 0;
+
+        std::unique_ptr<juce::dsp::FFT> halfSizeFFT;
+        juce::HeapBlock<std::complex<float>> scratch;
+
+        // exp (-2 pi i k / size) for k = 0 ... size / 2 - 1
+        juce::HeapBlock<std::complex<float>> twiddles;
+    };
+}
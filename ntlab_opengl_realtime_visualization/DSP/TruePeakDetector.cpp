@@ -0,0 +1,95 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "TruePeakDetector.h"
+
+namespace ntlab
+{
+    TruePeakDetector::TruePeakDetector()
+    {
+        const int numTaps = oversamplingFactor * numTapsPerPhase;
+        const double center = 0.5 * (numTaps - 1);
+
+        for (int phase = 0; phase < oversamplingFactor; ++phase)
+        {
+            double phaseGain = 0.0;
+
+            for (int tap = 0; tap < numTapsPerPhase; ++tap)
+            {
+                // A lowpass with the cutoff at the nyquist frequency of the original sample rate, windowed by a
+                // Blackman window
+                const int n = phase + tap * oversamplingFactor;
+                const double x = (n - center) / oversamplingFactor;
+                const double sinc = (x == 0.0) ? 1.0 : std::sin (juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+                const double w = 2.0 * juce::MathConstants<double>::pi * n / (numTaps - 1);
+                const double window = 0.42 - 0.5 * std::cos (w) + 0.08 * std::cos (2.0 * w);
+
+                const double coefficient = sinc * window;
+                phaseCoefficients[phase][numTapsPerPhase - 1 - tap] = static_cast<float> (coefficient);
+                phaseGain += coefficient;
+            }
+
+            // Normalize each phase to unity gain at DC, so that a constant signal is not over- or underestimated
+            for (auto& c : phaseCoefficients[phase])
+                c = static_cast<float> (c / phaseGain);
+        }
+
+        reset();
+    }
+
+    void TruePeakDetector::reset()
+    {
+        std::fill (history, history + 2 * numTapsPerPhase, 0.0f);
+        newestSampleIdx = 0;
+    }
+
+    float TruePeakDetector::process (const float* samples, int numSamples)
+    {
+        float peak = 0.0f;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            newestSampleIdx = (newestSampleIdx + 1) % numTapsPerPhase;
+            history[newestSampleIdx]                   = samples[i];
+            history[newestSampleIdx + numTapsPerPhase] = samples[i];
+
+            // The last numTapsPerPhase samples, ordered from the oldest to the newest one
+            const float* window = history + newestSampleIdx + 1;
+
+            for (int phase = 0; phase < oversamplingFactor; ++phase)
+            {
+                const float* coefficients = phaseCoefficients[phase];
+
+                float y = 0.0f;
+                for (int tap = 0; tap < numTapsPerPhase; ++tap)
+                    y += coefficients[tap] * window[tap];
+
+                peak = std::max (peak, std::abs (y));
+            }
+        }
+
+        return peak;
+    }
+}
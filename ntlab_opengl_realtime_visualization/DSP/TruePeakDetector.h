@@ -0,0 +1,63 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+namespace ntlab
+{
+    /**
+     * Estimates the true peak of a signal as specified by ITU-R BS.1770 by upsampling it by a factor of four with a
+     * polyphase FIR interpolation filter and taking the maximum absolute value of the upsampled signal. The
+     * interpolation filter is a windowed sinc lowpass with 12 taps per phase. No memory is allocated after
+     * construction, so process can be called on the realtime thread.
+     */
+    class TruePeakDetector
+    {
+    public:
+
+        TruePeakDetector();
+
+        /** Clears the filter state */
+        void reset();
+
+        /** Returns the maximum absolute value of the upsampled version of the samples passed */
+        float process (const float* samples, int numSamples);
+
+        static const int oversamplingFactor = 4;
+        static const int numTapsPerPhase = 12;
+
+    private:
+
+        // The coefficients of each phase are stored in reversed order, so that they can be applied to the history
+        // buffer from the oldest to the newest sample
+        float phaseCoefficients[oversamplingFactor][numTapsPerPhase];
+
+        // Each sample is written twice, so that the last numTapsPerPhase samples are always contiguous in memory
+        float history[2 * numTapsPerPhase];
+        int newestSampleIdx = 0;
+    };
+}
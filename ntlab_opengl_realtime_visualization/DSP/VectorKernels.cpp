@@ -0,0 +1,795 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include "VectorKernels.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#elif defined (__aarch64__) || defined (_M_ARM64)
+ #include <arm_neon.h>
+ #define NTLAB_VECTOR_KERNELS_NEON 1
+#endif
+
+// MSVC allows using all intrinsics without enabling them explicitly
+#if JUCE_MSVC
+ #define NTLAB_TARGET(instructionSet)
+#else
+ #define NTLAB_TARGET(instructionSet) __attribute__ ((target (instructionSet)))
+#endif
+
+namespace ntlab
+{
+    namespace VectorKernelsImplementation
+    {
+        static int findFirstSetBit (juce::uint32 mask)
+        {
+            int idx = 0;
+            while ((mask & 1) == 0)
+            {
+                mask >>= 1;
+                ++idx;
+            }
+
+            return idx;
+        }
+
+        //==============================================================================================================
+        // The scalar kernels, also used by all vectorized kernels to process the remaining samples
+        namespace scalar
+        {
+            static void addMagnitudes (float* dest, const std::complex<float>* src, int numValues)
+            {
+                for (int i = 0; i < numValues; ++i)
+                    dest[i] += std::abs (src[i]);
+            }
+
+            static VectorKernels::MinMax findMinMax (const float* src, int numSamples)
+            {
+                VectorKernels::MinMax result { src[0], src[0], 0, 0 };
+
+                for (int i = 1; i < numSamples; ++i)
+                {
+                    if (src[i] < result.min)
+                    {
+                        result.min = src[i];
+                        result.minIdx = i;
+                    }
+
+                    if (src[i] > result.max)
+                    {
+                        result.max = src[i];
+                        result.maxIdx = i;
+                    }
+                }
+
+                return result;
+            }
+
+            static int findRisingZeroCrossing (const float* src, int numSamples, int startIdx)
+            {
+                for (int i = std::max (startIdx, 1); i < numSamples; ++i)
+                    if ((src[i - 1] <= 0.0f) && (src[i] > 0.0f))
+                        return i;
+
+                return -1;
+            }
+
+            static int findRisingZeroCrossing (const float* src, int numSamples)
+            {
+                return findRisingZeroCrossing (src, numSamples, 1);
+            }
+
+            static void deinterleavePairs (float* firstDest, float* secondDest, const float* src, int numPairs)
+            {
+                for (int i = 0; i < numPairs; ++i)
+                {
+                    firstDest[i]  = src[2 * i];
+                    secondDest[i] = src[2 * i + 1];
+                }
+            }
+
+            /** Returns the index of the first sample equal to value, starting the search at startIdx */
+            static int findFirst (const float* src, int numSamples, float value, int startIdx)
+            {
+                int i = startIdx;
+                while ((i < numSamples) && (src[i] != value))
+                    ++i;
+
+                return i;
+            }
+        }
+
+#if JUCE_INTEL
+        //==============================================================================================================
+        namespace sse2
+        {
+            static const int width = 4;
+
+            NTLAB_TARGET ("sse2") static float reduceMin (__m128 v)
+            {
+                v = _mm_min_ps (v, _mm_movehl_ps (v, v));
+                v = _mm_min_ss (v, _mm_shuffle_ps (v, v, 1));
+                return _mm_cvtss_f32 (v);
+            }
+
+            NTLAB_TARGET ("sse2") static float reduceMax (__m128 v)
+            {
+                v = _mm_max_ps (v, _mm_movehl_ps (v, v));
+                v = _mm_max_ss (v, _mm_shuffle_ps (v, v, 1));
+                return _mm_cvtss_f32 (v);
+            }
+
+            NTLAB_TARGET ("sse2") static int findFirst (const float* src, int numSamples, float value)
+            {
+                const auto v = _mm_set1_ps (value);
+                int i = 0;
+
+                for (; i <= numSamples - width; i += width)
+                {
+                    const auto mask = static_cast<juce::uint32> (_mm_movemask_ps (_mm_cmpeq_ps (_mm_loadu_ps (src + i), v)));
+
+                    if (mask != 0)
+                        return i + findFirstSetBit (mask);
+                }
+
+                return scalar::findFirst (src, numSamples, value, i);
+            }
+
+            NTLAB_TARGET ("sse2") static void addMagnitudes (float* dest, const std::complex<float>* src, int numValues)
+            {
+                auto* s = reinterpret_cast<const float*> (src);
+                int i = 0;
+
+                for (; i <= numValues - width; i += width)
+                {
+                    const auto a  = _mm_loadu_ps (s + 2 * i);
+                    const auto b  = _mm_loadu_ps (s + 2 * i + width);
+                    const auto re = _mm_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0));
+                    const auto im = _mm_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1));
+                    const auto magnitude = _mm_sqrt_ps (_mm_add_ps (_mm_mul_ps (re, re), _mm_mul_ps (im, im)));
+                    _mm_storeu_ps (dest + i, _mm_add_ps (_mm_loadu_ps (dest + i), magnitude));
+                }
+
+                scalar::addMagnitudes (dest + i, src + i, numValues - i);
+            }
+
+            NTLAB_TARGET ("sse2") static VectorKernels::MinMax findMinMax (const float* src, int numSamples)
+            {
+                if (numSamples < width)
+                    return scalar::findMinMax (src, numSamples);
+
+                auto min = _mm_loadu_ps (src);
+                auto max = min;
+                int i = width;
+
+                for (; i <= numSamples - width; i += width)
+                {
+                    const auto x = _mm_loadu_ps (src + i);
+                    min = _mm_min_ps (min, x);
+                    max = _mm_max_ps (max, x);
+                }
+
+                float minValue = reduceMin (min);
+                float maxValue = reduceMax (max);
+
+                for (; i < numSamples; ++i)
+                {
+                    minValue = std::min (minValue, src[i]);
+                    maxValue = std::max (maxValue, src[i]);
+                }
+
+                return { minValue, maxValue, sse2::findFirst (src, numSamples, minValue), sse2::findFirst (src, numSamples, maxValue) };
+            }
+
+            NTLAB_TARGET ("sse2") static int findRisingZeroCrossing (const float* src, int numSamples)
+            {
+                const auto zero = _mm_setzero_ps();
+                int i = 1;
+
+                for (; i <= numSamples - width; i += width)
+                {
+                    const auto notPositive = _mm_cmple_ps (_mm_loadu_ps (src + i - 1), zero);
+                    const auto positive    = _mm_cmpgt_ps (_mm_loadu_ps (src + i), zero);
+                    const auto mask = static_cast<juce::uint32> (_mm_movemask_ps (_mm_and_ps (notPositive, positive)));
+
+                    if (mask != 0)
+                        return i + findFirstSetBit (mask);
+                }
+
+                return scalar::findRisingZeroCrossing (src, numSamples, i);
+            }
+
+            NTLAB_TARGET ("sse2") static void deinterleavePairs (float* firstDest, float* secondDest, const float* src, int numPairs)
+            {
+                int i = 0;
+
+                for (; i <= numPairs - width; i += width)
+                {
+                    const auto a = _mm_loadu_ps (src + 2 * i);
+                    const auto b = _mm_loadu_ps (src + 2 * i + width);
+                    _mm_storeu_ps (firstDest + i,  _mm_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0)));
+                    _mm_storeu_ps (secondDest + i, _mm_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1)));
+                }
+
+                scalar::deinterleavePairs (firstDest + i, secondDest + i, src + 2 * i, numPairs - i);
+            }
+        }
+
+        //==============================================================================================================
+        namespace avx2
+        {
+            static const int width = 8;
+
+            // Restores the order of values that were split into even and odd elements lane-wise
+            #define NTLAB_AVX2_FIX_LANE_ORDER(v) _mm256_castpd_ps (_mm256_permute4x64_pd (_mm256_castps_pd (v), _MM_SHUFFLE (3, 1, 2, 0)))
+
+            NTLAB_TARGET ("avx2") static float reduceMin (__m256 v)
+            {
+                return sse2::reduceMin (_mm_min_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1)));
+            }
+
+            NTLAB_TARGET ("avx2") static float reduceMax (__m256 v)
+            {
+                return sse2::reduceMax (_mm_max_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1)));
+            }
+
+            NTLAB_TARGET ("avx2") static int findFirst (const float* src, int numSamples, float value)
+            {
+                const auto v = _mm256_set1_ps (value);
+                int i = 0;
+
+                for (; i <= numSamples - width; i += width)
+                {
+                    const auto mask = static_cast<juce::uint32> (_mm256_movemask_ps (_mm256_cmp_ps (_mm256_loadu_ps (src + i), v, _CMP_EQ_OQ)));
+
+                    if (mask != 0)
+                        return i + findFirstSetBit (mask);
+                }
+
+                return scalar::findFirst (src, numSamples, value, i);
+            }
+
+            NTLAB_TARGET ("avx2") static void addMagnitudes (float* dest, const std::complex<float>* src, int numValues)
+            {
+                auto* s = reinterpret_cast<const float*> (src);
+                int i = 0;
+
+                for (; i <= numValues - width; i += width)
+                {
+                    const auto a  = _mm256_loadu_ps (s + 2 * i);
+                    const auto b  = _mm256_loadu_ps (s + 2 * i + width);
+                    const auto re = _mm256_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0));
+                    const auto im = _mm256_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1));
+                    const auto magnitude = _mm256_sqrt_ps (_mm256_add_ps (_mm256_mul_ps (re, re), _mm256_mul_ps (im, im)));
+                    _mm256_storeu_ps (dest + i, _mm256_add_ps (_mm256_loadu_ps (dest + i), NTLAB_AVX2_FIX_LANE_ORDER (magnitude)));
+                }
+
+                sse2::addMagnitudes (dest + i, src + i, numValues - i);
+            }
+
+            NTLAB_TARGET ("avx2") static VectorKernels::MinMax findMinMax (const float* src, int numSamples)
+            {
+                if (numSamples < width)
+                    return sse2::findMinMax (src, numSamples);
+
+                auto min = _mm256_loadu_ps (src);
+                auto max = min;
+                int i = width;
+
+                for (; i <= numSamples - width; i += width)
+                {
+                    const auto x = _mm256_loadu_ps (src + i);
+                    min = _mm256_min_ps (min, x);
+                    max = _mm256_max_ps (max, x);
+                }
+
+                float minValue = reduceMin (min);
+                float maxValue = reduceMax (max);
+
+                for (; i < numSamples; ++i)
+                {
+                    minValue = std::min (minValue, src[i]);
+                    maxValue = std::max (maxValue, src[i]);
+                }
+
+                return { minValue, maxValue, avx2::findFirst (src, numSamples, minValue), avx2::findFirst (src, numSamples, maxValue) };
+            }
+
+            NTLAB_TARGET ("avx2") static int findRisingZeroCrossing (const float* src, int numSamples)
+            {
+                const auto zero = _mm256_setzero_ps();
+                int i = 1;
+
+                for (; i <= numSamples - width; i += width)
+                {
+                    const auto notPositive = _mm256_cmp_ps (_mm256_loadu_ps (src + i - 1), zero, _CMP_LE_OQ);
+                    const auto positive    = _mm256_cmp_ps (_mm256_loadu_ps (src + i),     zero, _CMP_GT_OQ);
+                    const auto mask = static_cast<juce::uint32> (_mm256_movemask_ps (_mm256_and_ps (notPositive, positive)));
+
+                    if (mask != 0)
+                        return i + findFirstSetBit (mask);
+                }
+
+                return scalar::findRisingZeroCrossing (src, numSamples, i);
+            }
+
+            NTLAB_TARGET ("avx2") static void deinterleavePairs (float* firstDest, float* secondDest, const float* src, int numPairs)
+            {
+                int i = 0;
+
+                for (; i <= numPairs - width; i += width)
+                {
+                    const auto a = _mm256_loadu_ps (src + 2 * i);
+                    const auto b = _mm256_loadu_ps (src + 2 * i + width);
+                    _mm256_storeu_ps (firstDest + i,  NTLAB_AVX2_FIX_LANE_ORDER (_mm256_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0))));
+                    _mm256_storeu_ps (secondDest + i, NTLAB_AVX2_FIX_LANE_ORDER (_mm256_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1))));
+                }
+
+                sse2::deinterleavePairs (firstDest + i, secondDest + i, src + 2 * i, numPairs - i);
+            }
+
+            #undef NTLAB_AVX2_FIX_LANE_ORDER
+        }
+
+        //==============================================================================================================
+        // GCC 12 warns about the undefined pass-through value its headers use for all unmasked AVX-512 intrinsics
+       #if JUCE_GCC
+        #pragma GCC diagnostic push
+        #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+       #endif
+
+        namespace avx512
+        {
+            static const int width = 16;
+
+            // Splits the vector into its two halves and reduces them with the AVX2 reductions. Unlike the
+            // _mm512_reduce_ intrinsics, this doesn't trigger maybe-uninitialized warnings on some compilers, and unlike
+            // _mm512_extractf32x8_ps it only needs AVX-512F
+            NTLAB_TARGET ("avx512f") static __m256 upperHalf (__m512 v)
+            {
+                return _mm256_castpd_ps (_mm512_extractf64x4_pd (_mm512_castps_pd (v), 1));
+            }
+
+            NTLAB_TARGET ("avx512f") static float reduceMin (__m512 v)
+            {
+                return avx2::reduceMin (_mm256_min_ps (_mm512_castps512_ps256 (v), upperHalf (v)));
+            }
+
+            NTLAB_TARGET ("avx512f") static float reduceMax (__m512 v)
+            {
+                return avx2::reduceMax (_mm256_max_ps (_mm512_castps512_ps256 (v), upperHalf (v)));
+            }
+
+            NTLAB_TARGET ("avx512f") static void addMagnitudes (float* dest, const std::complex<float>* src, int numValues)
+            {
+                auto* s = reinterpret_cast<const float*> (src);
+                const auto evenIdx = _mm512_setr_epi32 (0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+                const auto oddIdx  = _mm512_setr_epi32 (1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+                int i = 0;
+
+                for (; i <= numValues - width; i += width)
+                {
+                    const auto a  = _mm512_loadu_ps (s + 2 * i);
+                    const auto b  = _mm512_loadu_ps (s + 2 * i + width);
+                    const auto re = _mm512_permutex2var_ps (a, evenIdx, b);
+                    const auto im = _mm512_permutex2var_ps (a, oddIdx,  b);
+                    const auto magnitude = _mm512_sqrt_ps (_mm512_add_ps (_mm512_mul_ps (re, re), _mm512_mul_ps (im, im)));
+                    _mm512_storeu_ps (dest + i, _mm512_add_ps (_mm512_loadu_ps (dest + i), magnitude));
+                }
+
+                avx2::addMagnitudes (dest + i, src + i, numValues - i);
+            }
+
+            NTLAB_TARGET ("avx512f") static VectorKernels::MinMax findMinMax (const float* src, int numSamples)
+            {
+                if (numSamples < width)
+                    return avx2::findMinMax (src, numSamples);
+
+                auto min = _mm512_loadu_ps (src);
+                auto max = min;
+                int i = width;
+
+                for (; i <= numSamples - width; i += width)
+                {
+                    const auto x = _mm512_loadu_ps (src + i);
+                    min = _mm512_min_ps (min, x);
+                    max = _mm512_max_ps (max, x);
+                }
+
+                float minValue = reduceMin (min);
+                float maxValue = reduceMax (max);
+
+                for (; i < numSamples; ++i)
+                {
+                    minValue = std::min (minValue, src[i]);
+                    maxValue = std::max (maxValue, src[i]);
+                }
+
+                // Both indices are searched in a single pass without calling another function. Across calls, GCC keeps the
+                // values found in zmm16 and above, which vzeroupper doesn't clear, so every SSE instruction of the
+                // caller paid the AVX-SSE transition penalty afterwards, about 300 ns per call
+                const auto minVector = _mm512_set1_ps (minValue);
+                const auto maxVector = _mm512_set1_ps (maxValue);
+                int minIdx = -1;
+                int maxIdx = -1;
+
+                for (i = 0; (i <= numSamples - width) && ((minIdx < 0) || (maxIdx < 0)); i += width)
+                {
+                    const auto x = _mm512_loadu_ps (src + i);
+                    const auto minMask = static_cast<juce::uint32> (_mm512_cmp_ps_mask (x, minVector, _CMP_EQ_OQ));
+                    const auto maxMask = static_cast<juce::uint32> (_mm512_cmp_ps_mask (x, maxVector, _CMP_EQ_OQ));
+
+                    if ((minIdx < 0) && (minMask != 0))
+                        minIdx = i + findFirstSetBit (minMask);
+
+                    if ((maxIdx < 0) && (maxMask != 0))
+                        maxIdx = i + findFirstSetBit (maxMask);
+                }
+
+                for (; (i < numSamples) && ((minIdx < 0) || (maxIdx < 0)); ++i)
+                {
+                    if ((minIdx < 0) && (src[i] == minValue))
+                        minIdx = i;
+
+                    if ((maxIdx < 0) && (src[i] == maxValue))
+                        maxIdx = i;
+                }
+
+                return { minValue, maxValue, minIdx, maxIdx };
+            }
+
+            NTLAB_TARGET ("avx512f") static int findRisingZeroCrossing (const float* src, int numSamples)
+            {
+                const auto zero = _mm512_setzero_ps();
+                int i = 1;
+
+                for (; i <= numSamples - width; i += width)
+                {
+                    const auto notPositive = _mm512_cmp_ps_mask (_mm512_loadu_ps (src + i - 1), zero, _CMP_LE_OQ);
+                    const auto positive    = _mm512_cmp_ps_mask (_mm512_loadu_ps (src + i),     zero, _CMP_GT_OQ);
+                    const auto mask = static_cast<juce::uint32> (notPositive & positive);
+
+                    if (mask != 0)
+                        return i + findFirstSetBit (mask);
+                }
+
+                return scalar::findRisingZeroCrossing (src, numSamples, i);
+            }
+
+            NTLAB_TARGET ("avx512f") static void deinterleavePairs (float* firstDest, float* secondDest, const float* src, int numPairs)
+            {
+                const auto evenIdx = _mm512_setr_epi32 (0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+                const auto oddIdx  = _mm512_setr_epi32 (1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+                int i = 0;
+
+                for (; i <= numPairs - width; i += width)
+                {
+                    const auto a = _mm512_loadu_ps (src + 2 * i);
+                    const auto b = _mm512_loadu_ps (src + 2 * i + width);
+                    _mm512_storeu_ps (firstDest + i,  _mm512_permutex2var_ps (a, evenIdx, b));
+                    _mm512_storeu_ps (secondDest + i, _mm512_permutex2var_ps (a, oddIdx,  b));
+                }
+
+                avx2::deinterleavePairs (firstDest + i, secondDest + i, src + 2 * i, numPairs - i);
+            }
+        }
+
+       #if JUCE_GCC
+        #pragma GCC diagnostic pop
+       #endif
+#endif
+
+#if NTLAB_VECTOR_KERNELS_NEON
+        //==============================================================================================================
+        namespace neon
+        {
+            static const int width = 4;
+
+            static void addMagnitudes (float* dest, const std::complex<float>* src, int numValues)
+            {
+                auto* s = reinterpret_cast<const float*> (src);
+                int i = 0;
+
+                for (; i <= numValues - width; i += width)
+                {
+                    const auto reIm = vld2q_f32 (s + 2 * i);
+                    const auto squared = vmlaq_f32 (vmulq_f32 (reIm.val[0], reIm.val[0]), reIm.val[1], reIm.val[1]);
+                    vst1q_f32 (dest + i, vaddq_f32 (vld1q_f32 (dest + i), vsqrtq_f32 (squared)));
+                }
+
+                scalar::addMagnitudes (dest + i, src + i, numValues - i);
+            }
+
+            static VectorKernels::MinMax findMinMax (const float* src, int numSamples)
+            {
+                if (numSamples < width)
+                    return scalar::findMinMax (src, numSamples);
+
+                auto min = vld1q_f32 (src);
+                auto max = min;
+                int i = width;
+
+                for (; i <= numSamples - width; i += width)
+                {
+                    const auto x = vld1q_f32 (src + i);
+                    min = vminq_f32 (min, x);
+                    max = vmaxq_f32 (max, x);
+                }
+
+                float minValue = vminvq_f32 (min);
+                float maxValue = vmaxvq_f32 (max);
+
+                for (; i < numSamples; ++i)
+                {
+                    minValue = std::min (minValue, src[i]);
+                    maxValue = std::max (maxValue, src[i]);
+                }
+
+                return { minValue, maxValue, scalar::findFirst (src, numSamples, minValue, 0), scalar::findFirst (src, numSamples, maxValue, 0) };
+            }
+
+            static int findRisingZeroCrossing (const float* src, int numSamples)
+            {
+                const auto zero = vdupq_n_f32 (0.0f);
+                int i = 1;
+
+                for (; i <= numSamples - width; i += width)
+                {
+                    const auto notPositive = vcleq_f32 (vld1q_f32 (src + i - 1), zero);
+                    const auto positive    = vcgtq_f32 (vld1q_f32 (src + i),     zero);
+
+                    // NEON has no movemask, so the exact position is searched only if there is a crossing
+                    if (vmaxvq_u32 (vandq_u32 (notPositive, positive)) != 0)
+                        return scalar::findRisingZeroCrossing (src, i + width, i);
+                }
+
+                return scalar::findRisingZeroCrossing (src, numSamples, i);
+            }
+
+            static void deinterleavePairs (float* firstDest, float* secondDest, const float* src, int numPairs)
+            {
+                int i = 0;
+
+                for (; i <= numPairs - width; i += width)
+                {
+                    const auto pairs = vld2q_f32 (src + 2 * i);
+                    vst1q_f32 (firstDest + i,  pairs.val[0]);
+                    vst1q_f32 (secondDest + i, pairs.val[1]);
+                }
+
+                scalar::deinterleavePairs (firstDest + i, secondDest + i, src + 2 * i, numPairs - i);
+            }
+        }
+#endif
+    }
+
+    const VectorKernels::Kernels& VectorKernels::getKernels()
+    {
+        using namespace VectorKernelsImplementation;
+
+        // The two argument overload of findRisingZeroCrossing is the kernel, the other one is used for the remainders
+        using CrossingSearch = int (*) (const float*, int);
+
+        static const Kernels bestKernels = [] () -> Kernels
+        {
+           #if JUCE_INTEL
+            if (juce::SystemStats::hasAVX512F())
+                return { InstructionSet::avx512, avx512::addMagnitudes, avx512::findMinMax, avx512::findRisingZeroCrossing, avx512::deinterleavePairs };
+
+            if (juce::SystemStats::hasAVX2())
+                return { InstructionSet::avx2, avx2::addMagnitudes, avx2::findMinMax, avx2::findRisingZeroCrossing, avx2::deinterleavePairs };
+
+            if (juce::SystemStats::hasSSE2())
+                return { InstructionSet::sse2, sse2::addMagnitudes, sse2::findMinMax, sse2::findRisingZeroCrossing, sse2::deinterleavePairs };
+           #elif NTLAB_VECTOR_KERNELS_NEON
+            return { InstructionSet::neon, neon::addMagnitudes, neon::findMinMax, neon::findRisingZeroCrossing, neon::deinterleavePairs };
+           #endif
+
+            return { InstructionSet::scalar, scalar::addMagnitudes, scalar::findMinMax, static_cast<CrossingSearch> (scalar::findRisingZeroCrossing), scalar::deinterleavePairs };
+        }();
+
+        return bestKernels;
+    }
+
+    juce::String VectorKernels::getInstructionSetName (InstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+            case InstructionSet::sse2:   return "SSE2";
+            case InstructionSet::avx2:   return "AVX2";
+            case InstructionSet::avx512: return "AVX-512";
+            case InstructionSet::neon:   return "NEON";
+            case InstructionSet::scalar:
+            default:                     return "Scalar";
+        }
+    }
+
+#if JUCE_UNIT_TESTS
+    /**
+     * Checks the vectorized kernels of every instruction set supported by the machine running the tests against the
+     * scalar kernels, for all lengths up to and beyond the widest vector so that the remainder handling is covered.
+     * Afterwards the time per sample of each kernel is logged for the scalar kernels and every instruction set.
+     */
+    class VectorKernelsTests : public juce::UnitTest
+    {
+    public:
+        VectorKernelsTests() : juce::UnitTest ("VectorKernels", "ntlab") {}
+
+        void runTest() override
+        {
+            using namespace VectorKernelsImplementation;
+
+           #if JUCE_INTEL
+            if (juce::SystemStats::hasSSE2())
+                testKernels ("SSE2", sse2::addMagnitudes, sse2::findMinMax, sse2::findRisingZeroCrossing, sse2::deinterleavePairs);
+
+            if (juce::SystemStats::hasAVX2())
+                testKernels ("AVX2", avx2::addMagnitudes, avx2::findMinMax, avx2::findRisingZeroCrossing, avx2::deinterleavePairs);
+
+            if (juce::SystemStats::hasAVX512F())
+                testKernels ("AVX-512", avx512::addMagnitudes, avx512::findMinMax, avx512::findRisingZeroCrossing, avx512::deinterleavePairs);
+           #elif NTLAB_VECTOR_KERNELS_NEON
+            testKernels ("NEON", neon::addMagnitudes, neon::findMinMax, neon::findRisingZeroCrossing, neon::deinterleavePairs);
+           #endif
+
+            beginTest ("Time per sample");
+
+            benchmarkKernels ("Scalar", scalar::addMagnitudes, scalar::findMinMax, static_cast<CrossingSearch> (scalar::findRisingZeroCrossing), scalar::deinterleavePairs);
+
+           #if JUCE_INTEL
+            if (juce::SystemStats::hasSSE2())
+                benchmarkKernels ("SSE2", sse2::addMagnitudes, sse2::findMinMax, sse2::findRisingZeroCrossing, sse2::deinterleavePairs);
+
+            if (juce::SystemStats::hasAVX2())
+                benchmarkKernels ("AVX2", avx2::addMagnitudes, avx2::findMinMax, avx2::findRisingZeroCrossing, avx2::deinterleavePairs);
+
+            if (juce::SystemStats::hasAVX512F())
+                benchmarkKernels ("AVX-512", avx512::addMagnitudes, avx512::findMinMax, avx512::findRisingZeroCrossing, avx512::deinterleavePairs);
+           #elif NTLAB_VECTOR_KERNELS_NEON
+            benchmarkKernels ("NEON", neon::addMagnitudes, neon::findMinMax, neon::findRisingZeroCrossing, neon::deinterleavePairs);
+           #endif
+        }
+
+    private:
+        using AddMagnitudes     = void (*) (float*, const std::complex<float>*, int);
+        using FindMinMax        = VectorKernels::MinMax (*) (const float*, int);
+        using CrossingSearch    = int (*) (const float*, int);
+        using DeinterleavePairs = void (*) (float*, float*, const float*, int);
+
+        static constexpr int maxNumSamples = 99;
+        static constexpr int numBenchmarkSamples = 4096;
+        static constexpr int numBenchmarkRounds = 2000;
+
+        void testKernels (const juce::String& instructionSetName, AddMagnitudes addMagnitudes, FindMinMax findMinMax, CrossingSearch findRisingZeroCrossing, DeinterleavePairs deinterleavePairs)
+        {
+            using namespace VectorKernelsImplementation;
+
+            beginTest (instructionSetName + " matches scalar");
+
+            auto random = getRandom();
+            std::vector<float> src (2 * maxNumSamples), first (maxNumSamples), second (maxNumSamples), firstExpected (maxNumSamples), secondExpected (maxNumSamples);
+            std::vector<float> magnitudes (maxNumSamples), magnitudesExpected (maxNumSamples);
+            std::vector<std::complex<float>> complexValues (maxNumSamples);
+
+            for (int numSamples = 1; numSamples <= maxNumSamples; ++numSamples)
+            {
+                for (auto& s : src)
+                    s = random.nextFloat() * 2.0f - 1.0f;
+
+                // Repeat the extreme values, so that the index of their first occurrence is checked too
+                if (numSamples > 2)
+                {
+                    src[static_cast<size_t> (random.nextInt (numSamples))] = 2.0f;
+                    src[static_cast<size_t> (random.nextInt (numSamples))] = 2.0f;
+                    src[static_cast<size_t> (random.nextInt (numSamples))] = -2.0f;
+                    src[static_cast<size_t> (random.nextInt (numSamples))] = -2.0f;
+                }
+
+                const auto minMax = findMinMax (src.data(), numSamples);
+                const auto minMaxExpected = scalar::findMinMax (src.data(), numSamples);
+                expectEquals (minMax.min,    minMaxExpected.min);
+                expectEquals (minMax.max,    minMaxExpected.max);
+                expectEquals (minMax.minIdx, minMaxExpected.minIdx);
+                expectEquals (minMax.maxIdx, minMaxExpected.maxIdx);
+
+                // A single rising edge at a random position, as well as no edge at all
+                for (auto& s : src)
+                    s = -std::abs (s);
+
+                const int edgeIdx = random.nextInt (numSamples + 1);
+                if (edgeIdx < numSamples)
+                    src[static_cast<size_t> (edgeIdx)] = 1.0f;
+
+                const auto scalarCrossingSearch = static_cast<CrossingSearch> (scalar::findRisingZeroCrossing);
+                expectEquals (findRisingZeroCrossing (src.data(), numSamples), scalarCrossingSearch (src.data(), numSamples));
+
+                deinterleavePairs (first.data(), second.data(), src.data(), numSamples);
+                scalar::deinterleavePairs (firstExpected.data(), secondExpected.data(), src.data(), numSamples);
+                expect (std::equal (first.begin(), first.begin() + numSamples, firstExpected.begin()));
+                expect (std::equal (second.begin(), second.begin() + numSamples, secondExpected.begin()));
+
+                for (int i = 0; i < numSamples; ++i)
+                    complexValues[static_cast<size_t> (i)] = { src[static_cast<size_t> (2 * i)], src[static_cast<size_t> (2 * i + 1)] };
+
+                // The square root might be computed with a different precision
+                std::fill (magnitudes.begin(), magnitudes.end(), 1.0f);
+                std::fill (magnitudesExpected.begin(), magnitudesExpected.end(), 1.0f);
+                addMagnitudes (magnitudes.data(), complexValues.data(), numSamples);
+                scalar::addMagnitudes (magnitudesExpected.data(), complexValues.data(), numSamples);
+
+                for (int i = 0; i < numSamples; ++i)
+                    expectWithinAbsoluteError (magnitudes[static_cast<size_t> (i)], magnitudesExpected[static_cast<size_t> (i)], 1e-6f);
+            }
+        }
+
+        void benchmarkKernels (const juce::String& instructionSetName, AddMagnitudes addMagnitudes, FindMinMax findMinMax, CrossingSearch findRisingZeroCrossing, DeinterleavePairs deinterleavePairs)
+        {
+            auto random = getRandom();
+            std::vector<float> src (2 * numBenchmarkSamples), first (numBenchmarkSamples), second (numBenchmarkSamples), magnitudes (numBenchmarkSamples);
+            std::vector<std::complex<float>> complexValues (numBenchmarkSamples);
+
+            // Only negative samples, so that the zero crossing search has to scan the whole buffer
+            for (auto& s : src)
+                s = -random.nextFloat();
+
+            for (int i = 0; i < numBenchmarkSamples; ++i)
+                complexValues[static_cast<size_t> (i)] = { src[static_cast<size_t> (2 * i)], src[static_cast<size_t> (2 * i + 1)] };
+
+            // The results are summed up, so that the calls are not optimised away
+            double checksum = 0.0;
+
+            const double addMagnitudesTime = measureNsPerSample ([&] { addMagnitudes (magnitudes.data(), complexValues.data(), numBenchmarkSamples); });
+            const double findMinMaxTime    = measureNsPerSample ([&] { checksum += findMinMax (src.data(), numBenchmarkSamples).max; });
+            const double crossingTime      = measureNsPerSample ([&] { checksum += findRisingZeroCrossing (src.data(), numBenchmarkSamples); });
+            const double deinterleaveTime  = measureNsPerSample ([&] { deinterleavePairs (first.data(), second.data(), src.data(), numBenchmarkSamples); });
+
+            checksum += magnitudes[0] + first[0] + second[0];
+            expect (std::isfinite (checksum));
+
+            logMessage (instructionSetName + " ns per sample: addMagnitudes " + juce::String (addMagnitudesTime, 3)
+                                           + ", findMinMax "                   + juce::String (findMinMaxTime, 3)
+                                           + ", findRisingZeroCrossing "       + juce::String (crossingTime, 3)
+                                           + ", deinterleavePairs "            + juce::String (deinterleaveTime, 3));
+        }
+
+        template <typename Kernel>
+        static double measureNsPerSample (Kernel&& kernel)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int round = 0; round < numBenchmarkRounds; ++round)
+                kernel();
+
+            const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+            return seconds * 1.0e9 / (numBenchmarkRounds * static_cast<double> (numBenchmarkSamples));
+        }
+    };
+
+    static VectorKernelsTests vectorKernelsTests;
+#endif
+}
+
+#undef NTLAB_TARGET
@@ -0,0 +1,109 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <complex>
+
+namespace ntlab
+{
+    /**
+     * A collection of the vectorized kernels the collectors spend most of their time in. Each kernel is implemented
+     * for SSE2, AVX2 and AVX-512 on Intel and for NEON on ARM, next to a scalar fallback. The implementation used is
+     * chosen once at runtime based on the features of the CPU, so binaries built for a baseline instruction set still
+     * benefit from wider vector units if available. All kernels work on unaligned memory and any number of samples.
+     */
+    class VectorKernels
+    {
+    public:
+
+        enum class InstructionSet
+        {
+            scalar,
+            sse2,
+            avx2,
+            avx512,
+            neon
+        };
+
+        struct MinMax
+        {
+            float min, max;
+            int minIdx, maxIdx;
+        };
+
+        /** Adds the magnitudes of the complex values in src to the values in dest */
+        static void addMagnitudes (float* dest, const std::complex<float>* src, int numValues)
+        {
+            getKernels().addMagnitudes (dest, src, numValues);
+        }
+
+        /**
+         * Returns the minimum and the maximum value of src along with the index of their first occurrence. numSamples
+         * must be greater than zero.
+         */
+        static MinMax findMinMax (const float* src, int numSamples)
+        {
+            return getKernels().findMinMax (src, numSamples);
+        }
+
+        /**
+         * Returns the index of the first sample that is greater than zero while its predecessor is less than or equal
+         * to zero, or -1 if there is no such rising edge. The first sample is only used as predecessor.
+         */
+        static int findRisingZeroCrossing (const float* src, int numSamples)
+        {
+            return getKernels().findRisingZeroCrossing (src, numSamples);
+        }
+
+        /** Splits numPairs pairs of interleaved samples into the first and the second sample of each pair */
+        static void deinterleavePairs (float* firstDest, float* secondDest, const float* src, int numPairs)
+        {
+            getKernels().deinterleavePairs (firstDest, secondDest, src, numPairs);
+        }
+
+        /** Returns the instruction set the kernels use on this machine */
+        static InstructionSet getInstructionSet() { return getKernels().instructionSet; }
+
+        /** Returns the name of an instruction set, e.g. to log it for diagnostic purposes */
+        static juce::String getInstructionSetName (InstructionSet instructionSet);
+
+    private:
+
+        struct Kernels
+        {
+            InstructionSet instructionSet;
+            void   (*addMagnitudes)          (float*, const std::complex<float>*, int);
+            MinMax (*findMinMax)             (const float*, int);
+            int    (*findRisingZeroCrossing) (const float*, int);
+            void   (*deinterleavePairs)      (float*, float*, const float*, int);
+        };
+
+        /** Returns the kernels for the best instruction set supported. Chosen once on the first call */
+        static const Kernels& getKernels();
+    };
+}
@@ -0,0 +1,223 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "CrossCorrelationComponent.h"
+#include "../RealtimeDataTransfer/CrossCorrelationDataCollector.h"
+#include "../Utilities/SerializableRange.h"
+
+namespace ntlab
+{
+    const juce::Identifier CrossCorrelationComponent::parameterFFTOrder         ("fftOrder");
+    const juce::Identifier CrossCorrelationComponent::parameterMaxLag           ("maxLag");
+    const juce::Identifier CrossCorrelationComponent::parameterCorrelationRange ("correlationRange");
+
+    CrossCorrelationComponent::CrossCorrelationComponent (const juce::String identifierExtension, WindowOpenGLContext& windowOpenGlContext, juce::UndoManager* undoManager)
+    : VisualizationTarget ("CrossCorrelation" + identifierExtension, undoManager),
+      Plot2D (true, windowOpenGlContext)
+    {
+        valueTree.addListener (this);
+        valueTree.setProperty (parameterFFTOrder,         12,                                     undoManager);
+        valueTree.setProperty (parameterMaxLag,           64,                                     undoManager);
+        valueTree.setProperty (parameterCorrelationRange, SerializableRange<float> (-0.2f, 1.0f), undoManager);
+
+        setBackgroundColour (juce::Colours::darkturquoise, false);
+        setGridProperties (8, 6, juce::Colours::darkgrey);
+        enableXAxisTicks (true, "s");
+        enableYAxisTicks (true);
+        enableLegend (true, ntlab::Plot2D::topRight, false, 0.0f);
+        setLineWidthIfPossibleForGPU (1.5);
+    }
+
+    CrossCorrelationComponent::~CrossCorrelationComponent ()
+    {
+        valueTree.removeListener (this);
+    }
+
+    void CrossCorrelationComponent::setFFTOrder (int newFFTOrder)
+    {
+        valueTree.setProperty (parameterFFTOrder, newFFTOrder, undoManager);
+    }
+
+    void CrossCorrelationComponent::setMaxLag (int maxLagInSamples)
+    {
+        jassert (maxLagInSamples > 0);
+        valueTree.setProperty (parameterMaxLag, maxLagInSamples, undoManager);
+    }
+
+    void CrossCorrelationComponent::setCorrelationRange (juce::Range<float> correlationRange)
+    {
+        valueTree.setProperty (parameterCorrelationRange, SerializableRange<float> (correlationRange), undoManager);
+    }
+
+    float CrossCorrelationComponent::getPeakLag (int pairIdx)
+    {
+        std::lock_guard<std::mutex> scopedLock (peakLagLock);
+
+        if (juce::isPositiveAndBelow (pairIdx, static_cast<int> (peakLags.size())))
+            return peakLags[static_cast<size_t> (pairIdx)];
+
+        return 0.0f;
+    }
+
+    void CrossCorrelationComponent::applySettingFromCollector (const juce::String& setting, const juce::var& value)
+    {
+        if (setting == CrossCorrelationDataCollector::settingPairNames)
+        {
+            if (value.isArray())
+            {
+                auto newPairNames = value.getArray();
+                pairNames.clearQuick();
+
+                for (auto& pairName : *newPairNames)
+                    pairNames.add (pairName);
+
+                validChannelInformation.set (pairNamesValid);
+                updateChannelInformation();
+            }
+        }
+        else if (setting == CrossCorrelationDataCollector::settingNumPairs)
+        {
+            if (value.isInt())
+            {
+                numPairs = value;
+                validChannelInformation.set (numPairsValid);
+                updateChannelInformation();
+            }
+        }
+        else if (setting == CrossCorrelationDataCollector::settingMaxLag)
+        {
+            if (value.isInt())
+            {
+                validChannelInformation.set (maxLagValid);
+                valueTree.setProperty (parameterMaxLag, value, undoManager);
+                updateChannelInformation();
+            }
+        }
+        else if (setting == CrossCorrelationDataCollector::settingSampleRate)
+        {
+            if (value.isDouble())
+            {
+                sampleRate = value;
+                validChannelInformation.set (sampleRateValid);
+                updateChannelInformation();
+            }
+        }
+        else if (setting == CrossCorrelationDataCollector::settingFFTOrder)
+        {
+            if (value.isInt())
+                valueTree.setProperty (parameterFFTOrder, value, undoManager);
+        }
+    }
+
+    void CrossCorrelationComponent::beginFrame()
+    {
+        if (dataSource != nullptr)
+        {
+            lastBuffer = &dataSource->startReading (*this);
+
+            const int numValuesPerPair = getNumValuesPerPair();
+
+            ConstFrame<CrossCorrelationDataCollector::Layout> frame (*lastBuffer, numPairs, numValuesPerPair);
+
+            // if the buffer supplied doesn't seem to match just give it back directly
+            if (! frame.isValid())
+            {
+                lastBuffer = nullptr;
+                dataSource->finishedReading (*this);
+                return;
+            }
+
+            std::lock_guard<std::mutex> scopedLock (peakLagLock);
+            peakLags.resize (static_cast<size_t> (numPairs));
+
+            for (int p = 0; p < numPairs; ++p)
+                peakLags[static_cast<size_t> (p)] = frame.getChannel (p)[CrossCorrelationDataCollector::peakLag];
+        }
+    }
+
+    const float* CrossCorrelationComponent::getBufferForLine (int lineIdx)
+    {
+        if (lastBuffer != nullptr)
+            return ConstFrame<CrossCorrelationDataCollector::Layout> (*lastBuffer, numPairs, getNumValuesPerPair()).getChannel (lineIdx) + CrossCorrelationDataCollector::firstCurveValue;
+
+        return nullptr;
+    }
+
+    void CrossCorrelationComponent::endFrame()
+    {
+        if (lastBuffer != nullptr)
+            dataSource->finishedReading (*this);
+    }
+
+    void CrossCorrelationComponent::valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property)
+    {
+        if (treeWhosePropertyHasChanged == valueTree)
+        {
+            auto propertyValue = valueTree.getProperty (property);
+
+            if (property == parameterFFTOrder)
+            {
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, CrossCorrelationDataCollector::settingFFTOrder, propertyValue);
+            }
+            else if (property == parameterMaxLag)
+            {
+                maxLag = propertyValue;
+                updateChannelInformation();
+
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, CrossCorrelationDataCollector::settingMaxLag, propertyValue);
+            }
+            else if (property == parameterCorrelationRange)
+            {
+                setYRange (SerializableRange<float> (propertyValue));
+            }
+        }
+    }
+
+    void CrossCorrelationComponent::valueTreeChildAdded (juce::ValueTree&, juce::ValueTree&) {}
+    void CrossCorrelationComponent::valueTreeChildRemoved (juce::ValueTree&, juce::ValueTree&, int) {}
+    void CrossCorrelationComponent::valueTreeChildOrderChanged (juce::ValueTree&, int, int) {}
+    void CrossCorrelationComponent::valueTreeParentChanged (juce::ValueTree&) {}
+
+    void CrossCorrelationComponent::updateChannelInformation()
+    {
+        if (validChannelInformation.all())
+        {
+            const float maxLagInSeconds = static_cast<float> (maxLag / sampleRate);
+            const float lagStep = static_cast<float> (1.0 / sampleRate);
+
+            // The curve holds the lags -maxLag...maxLag including both ends, so the x values range one step further
+            setXValues ({-maxLagInSeconds, maxLagInSeconds + lagStep}, getNumValuesPerPair() - CrossCorrelationDataCollector::firstCurveValue, LogScaling::none);
+            setXRange ({-maxLagInSeconds, maxLagInSeconds});
+            setLines (numPairs, pairNames);
+        }
+    }
+
+    int CrossCorrelationComponent::getNumValuesPerPair() const
+    {
+        return CrossCorrelationDataCollector::firstCurveValue + 2 * maxLag + 1;
+    }
+}
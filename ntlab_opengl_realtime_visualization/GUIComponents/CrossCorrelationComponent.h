@@ -0,0 +1,119 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <bitset>
+#include "../RealtimeDataTransfer/VisualizationDataSource.h"
+#include "../2DPlot/Plot2D.h"
+
+namespace ntlab
+{
+    /**
+     * The Component designed to visualize the correlation curves computed by a CrossCorrelationDataCollector
+     * instance. Each channel pair is drawn as a line over the lag in seconds, the most recent peak lags can be queried
+     * with getPeakLag, e.g. to display them as text. It exports the parameters fftOrder, maxLag and correlationRange
+     * to the VisualizationTarget valueTree member. It inherits ntlab::Plot2D and therefore uses OpenGL for rendering.
+     */
+    class CrossCorrelationComponent : public ntlab::VisualizationTarget, public ntlab::Plot2D, private juce::ValueTree::Listener
+    {
+    public:
+
+        /** An integer value specifying the order of the FFT used by the collector. Default value: 12 */
+        static const juce::Identifier parameterFFTOrder;
+
+        /** A positive integer specifying the largest lag in samples displayed. Default value: 64 */
+        static const juce::Identifier parameterMaxLag;
+
+        /** A 2-Element float Array containing the minimal and maximal correlation value visualized. */
+        static const juce::Identifier parameterCorrelationRange;
+
+        /**
+         * Specifiy an identifier extension to map the CrossCorrelationComponent to the corresponding source.
+         * The Identifier will automatically be prepended by "CrossCorrelation". The optional undo manager can
+         * be passed to enable undo functionality for the parameters held by the ValueTree.
+         */
+        CrossCorrelationComponent (const juce::String identifierExtension, WindowOpenGLContext& windowOpenGlContext, juce::UndoManager* undoManager = nullptr);
+
+        ~CrossCorrelationComponent();
+
+        /** Sets the order of the FFT used by the collector */
+        void setFFTOrder (int newFFTOrder);
+
+        /** Sets the largest lag in samples displayed */
+        void setMaxLag (int maxLagInSamples);
+
+        /** Sets the range of correlation values displayed */
+        void setCorrelationRange (juce::Range<float> correlationRange);
+
+        /**
+         * Returns the delay in seconds between both channels of the pair requested, as measured by the last frame drawn.
+         * A positive value means that the first channel of the pair is delayed relative to the second channel.
+         */
+        float getPeakLag (int pairIdx);
+
+#ifndef DOXYGEN
+        void applySettingFromCollector (const juce::String& setting, const juce::var& value) override;
+#endif
+
+    private:
+
+        // bitfield index values for all settings that have been set
+        enum ValidSettings
+        {
+            numPairsValid   = 0,
+            pairNamesValid  = 1,
+            maxLagValid     = 2,
+            sampleRateValid = 3
+        };
+        std::bitset<4> validChannelInformation;
+
+        int numPairs = 0;
+        std::atomic<int> maxLag {0};
+        double sampleRate = 0.0;
+        juce::StringArray pairNames;
+
+        juce::MemoryBlock* lastBuffer = nullptr;
+
+        std::mutex peakLagLock;
+        std::vector<float> peakLags;
+
+        // Plot2D Member functions
+        void beginFrame() override;
+        const float* getBufferForLine (int lineIdx) override;
+        void endFrame() override;
+
+        // ValueTree::Listener functions
+        void valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property) override;
+        void valueTreeChildAdded (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenAdded) override;
+        void valueTreeChildRemoved (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override;
+        void valueTreeChildOrderChanged (juce::ValueTree &parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override;
+        void valueTreeParentChanged (juce::ValueTree &treeWhoseParentHasChanged) override;
+
+        void updateChannelInformation();
+
+        int getNumValuesPerPair() const;
+    };
+}
@@ -0,0 +1,296 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "EyeDiagramComponent.h"
+#include "../RealtimeDataTransfer/EyeDiagramDataCollector.h"
+#include "../Utilities/SerializableRange.h"
+#include "../Shader/ColourMapShader.h"
+
+namespace ntlab
+{
+    const juce::Identifier EyeDiagramComponent::parameterNumSymbolsViewed ("numSymbolsViewed");
+    const juce::Identifier EyeDiagramComponent::parameterPersistence      ("persistence");
+    const juce::Identifier EyeDiagramComponent::parameterAmplitudeRange   ("amplitudeRange");
+
+    EyeDiagramComponent::EyeDiagramComponent (const juce::String identifierExtension, WindowOpenGLContext& windowOpenGlContext, juce::UndoManager* undoManager)
+    : VisualizationTarget ("EyeDiagram" + identifierExtension, undoManager),
+      Plot2D (true, windowOpenGlContext),
+      eyeDiagramGLContext (windowOpenGlContext)
+    {
+        valueTree.addListener (this);
+        valueTree.setProperty (parameterNumSymbolsViewed, 2,                                       undoManager);
+        valueTree.setProperty (parameterPersistence,      0.0,                                     undoManager);
+        valueTree.setProperty (parameterAmplitudeRange,   SerializableRange<float> (-1.0f, 1.0f),  undoManager);
+
+        setBackgroundColour (juce::Colours::black, false);
+
+        juce::ColourGradient heatMap (juce::Colours::darkblue, 0.0f, 0.0f, juce::Colours::red, 1.0f, 0.0f, false);
+        heatMap.addColour (0.33, juce::Colours::cyan);
+        heatMap.addColour (0.66, juce::Colours::yellow);
+        setColourMap (heatMap);
+
+        setGridProperties (4, 8, juce::Colours::darkgrey);
+        enableXAxisTicks (true, "sec");
+        enableYAxisTicks (true);
+    }
+
+    EyeDiagramComponent::~EyeDiagramComponent ()
+    {
+        valueTree.removeListener (this);
+    }
+
+    void EyeDiagramComponent::setNumSymbolsViewed (int numSymbols)
+    {
+        jassert (numSymbols > 0);
+        valueTree.setProperty (parameterNumSymbolsViewed, numSymbols, undoManager);
+    }
+
+    void EyeDiagramComponent::setPersistence (double persistence)
+    {
+        valueTree.setProperty (parameterPersistence, persistence, undoManager);
+    }
+
+    void EyeDiagramComponent::setAmplitudeRange (juce::Range<float> amplitudeRange)
+    {
+        valueTree.setProperty (parameterAmplitudeRange, SerializableRange<float> (amplitudeRange), undoManager);
+    }
+
+    void EyeDiagramComponent::setColourMap (const juce::ColourGradient& newColourMap)
+    {
+        eyeDiagramGLContext.executeOnGLThread ([this, newColourMap] (juce::OpenGLContext&)
+        {
+            colourMap = newColourMap;
+            colourMapNeedsUpdate = true;
+        });
+    }
+
+    void EyeDiagramComponent::applySettingFromCollector (const juce::String& setting, const juce::var& value)
+    {
+        if (setting == EyeDiagramDataCollector::settingSymbolPeriod)
+        {
+            if (value.isDouble())
+            {
+                tSymbol = value;
+                updateTimeRange();
+            }
+        }
+        else if (setting == EyeDiagramDataCollector::settingNumColumnsPerSymbol)
+        {
+            if (value.isInt())
+                numColumnsPerSymbol = value;
+        }
+        else if (setting == EyeDiagramDataCollector::settingNumAmplitudeBins)
+        {
+            if (value.isInt())
+                numAmplitudeBins = value;
+        }
+        else if (setting == EyeDiagramDataCollector::settingAmplitudeRange)
+        {
+            if (value.isString())
+                valueTree.setProperty (parameterAmplitudeRange, value, undoManager);
+        }
+    }
+
+    void EyeDiagramComponent::openGLContextClosing()
+    {
+        if (densityTexture != 0)
+            glDeleteTextures (1, &densityTexture);
+
+        if (colourMapTexture != 0)
+            glDeleteTextures (1, &colourMapTexture);
+
+        if (quadGLBuffer != 0)
+            eyeDiagramGLContext.openGLContext.extensions.glDeleteBuffers (1, &quadGLBuffer);
+
+        densityTexture   = 0;
+        colourMapTexture = 0;
+        quadGLBuffer     = 0;
+        densityTextureWidth  = 0;
+        densityTextureHeight = 0;
+        quadNeedsUpdate      = true;
+        colourMapNeedsUpdate = true;
+
+        Plot2D::openGLContextClosing();
+    }
+
+    void EyeDiagramComponent::renderBeneathLines (juce::OpenGLContext& openGLContext, int, int)
+    {
+        if (dataSource == nullptr)
+            return;
+
+        auto* colourMapShader = eyeDiagramGLContext.getResourcePool().getShader<ColourMapShader2D> ("ColourMapShader2D", openGLContext);
+        if (colourMapShader == nullptr)
+            return;
+
+        // Fetch the most recent histogram, its size is independent of the number of symbols accumulated
+        const int histogramWidth  = numColumnsPerSymbol;
+        const int histogramHeight = numAmplitudeBins;
+        ConstFrame<EyeDiagramDataCollector::Layout> histogram (dataSource->startReading (*this), histogramHeight, histogramWidth);
+
+        if ((histogramWidth > 0) && histogram.isValid())
+            uploadDensityTexture (histogram.getValues(), histogramWidth, histogramHeight);
+
+        dataSource->finishedReading (*this);
+
+        if (densityTexture == 0)
+            return;
+
+        if (colourMapNeedsUpdate)
+            uploadColourMapTexture();
+
+        if (quadGLBuffer == 0)
+            openGLContext.extensions.glGenBuffers (1, &quadGLBuffer);
+
+        openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, quadGLBuffer);
+
+        // The quad covers the whole viewport, the horizontal texture coordinate wraps once per symbol period
+        if (quadNeedsUpdate.exchange (false))
+        {
+            const float u = static_cast<float> (numSymbolsViewed.load());
+            const ColourMapShader2D::Vertex quad[4] =
+            {
+                {-1.0f, -1.0f, 0.0f, 0.0f}, {1.0f, -1.0f, u, 0.0f}, {-1.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 1.0f, u, 1.0f}
+            };
+
+            openGLContext.extensions.glBufferData (GL_ARRAY_BUFFER, sizeof (quad), quad, GL_STATIC_DRAW);
+        }
+
+        colourMapShader->use();
+        colourMapShader->bindTextures (openGLContext, densityTexture, colourMapTexture);
+        colourMapShader->enableAttributes (openGLContext);
+        glDrawArrays (GL_TRIANGLE_STRIP, 0, 4);
+        colourMapShader->disableAttributes (openGLContext);
+        colourMapShader->unbindTextures (openGLContext);
+    }
+
+    void EyeDiagramComponent::uploadDensityTexture (const juce::uint8* densities, int width, int height)
+    {
+        if (densityTexture == 0)
+        {
+            glGenTextures (1, &densityTexture);
+            glBindTexture (GL_TEXTURE_2D, densityTexture);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+        else
+        {
+            glBindTexture (GL_TEXTURE_2D, densityTexture);
+        }
+
+        glPixelStorei (GL_UNPACK_ALIGNMENT, 1);
+
+        // Only re-allocate the texture storage if the histogram size changed
+        if ((width != densityTextureWidth) || (height != densityTextureHeight))
+        {
+            glTexImage2D (GL_TEXTURE_2D, 0, GL_ALPHA, width, height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, densities);
+            densityTextureWidth  = width;
+            densityTextureHeight = height;
+        }
+        else
+        {
+            glTexSubImage2D (GL_TEXTURE_2D, 0, 0, 0, width, height, GL_ALPHA, GL_UNSIGNED_BYTE, densities);
+        }
+
+        glBindTexture (GL_TEXTURE_2D, 0);
+    }
+
+    void EyeDiagramComponent::uploadColourMapTexture()
+    {
+        std::vector<juce::uint8> colours (colourMapSize * 4);
+
+        for (int i = 0; i < colourMapSize; ++i)
+        {
+            auto colour = colourMap.getColourAtPosition (i / static_cast<double> (colourMapSize - 1));
+            colours[4 * i]     = colour.getRed();
+            colours[4 * i + 1] = colour.getGreen();
+            colours[4 * i + 2] = colour.getBlue();
+            colours[4 * i + 3] = colour.getAlpha();
+        }
+
+        if (colourMapTexture == 0)
+        {
+            glGenTextures (1, &colourMapTexture);
+            glBindTexture (GL_TEXTURE_2D, colourMapTexture);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+        else
+        {
+            glBindTexture (GL_TEXTURE_2D, colourMapTexture);
+        }
+
+        glPixelStorei (GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA, colourMapSize, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, colours.data());
+        glBindTexture (GL_TEXTURE_2D, 0);
+
+        colourMapNeedsUpdate = false;
+    }
+
+    void EyeDiagramComponent::updateTimeRange()
+    {
+        if (tSymbol > 0.0)
+            setXRange (juce::Range<float> (0.0f, static_cast<float> (numSymbolsViewed * tSymbol)));
+    }
+
+    void EyeDiagramComponent::valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property)
+    {
+        if (treeWhosePropertyHasChanged == valueTree)
+        {
+            auto propertyValue = valueTree.getProperty (property);
+
+            if (property == parameterNumSymbolsViewed)
+            {
+                numSymbolsViewed = juce::jmax (1, static_cast<int> (propertyValue));
+                quadNeedsUpdate = true;
+
+                // one grid line at each symbol boundary and in the middle of each symbol
+                setGridProperties (2 * numSymbolsViewed, getNumYGridLines(), false);
+                updateTimeRange();
+            }
+            else if (property == parameterPersistence)
+            {
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, EyeDiagramDataCollector::settingPersistence, propertyValue);
+            }
+            else if (property == parameterAmplitudeRange)
+            {
+                SerializableRange<float> amplitudeRange (propertyValue);
+                setYRange (amplitudeRange);
+
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, EyeDiagramDataCollector::settingAmplitudeRange, propertyValue);
+            }
+        }
+    }
+
+    void EyeDiagramComponent::valueTreeChildAdded (juce::ValueTree&, juce::ValueTree&) {}
+    void EyeDiagramComponent::valueTreeChildRemoved (juce::ValueTree&, juce::ValueTree&, int) {}
+    void EyeDiagramComponent::valueTreeChildOrderChanged (juce::ValueTree&, int, int) {}
+    void EyeDiagramComponent::valueTreeParentChanged (juce::ValueTree&) {}
+}
@@ -0,0 +1,131 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "../RealtimeDataTransfer/VisualizationDataSource.h"
+#include "../2DPlot/Plot2D.h"
+
+namespace ntlab
+{
+    /**
+     * The Component designed to visualize eye diagrams collected by an EyeDiagramDataCollector instance. The hit
+     * histogram sent by the collector is uploaded as texture and drawn through a colour map beneath the grid of the
+     * plot, so the rendering cost doesn't depend on the number of symbols accumulated. It exports the parameters
+     * "numSymbolsViewed", "persistence" and "amplitudeRange" to the VisualizationTarget valueTree member. It inherits
+     * ntlab::Plot2D and therefore uses OpenGL for rendering.
+     */
+    class EyeDiagramComponent : public ntlab::VisualizationTarget, public ntlab::Plot2D, private juce::ValueTree::Listener
+    {
+    public:
+
+        /** A positive integer specifying the number of symbol periods displayed side by side. Default value: 2 */
+        static const juce::Identifier parameterNumSymbolsViewed;
+
+        /**
+         * A double value in the range 0...1 specifying the amount of the histogram kept after each update. 0 means
+         * no persistence, values close to 1 lead to a long persistence
+         */
+        static const juce::Identifier parameterPersistence;
+
+        /** A 2-Element float Array containing the minimal and maximal amplitude visualized. */
+        static const juce::Identifier parameterAmplitudeRange;
+
+        /**
+         * Specifiy an identifier extension to map the EyeDiagramComponent to the corresponding source.
+         * The Identifier will automatically be prepended by "EyeDiagram". The optional undo manager can
+         * be passed to enable undo functionality for the parameters held by the ValueTree.
+         */
+        EyeDiagramComponent (const juce::String identifierExtension, WindowOpenGLContext& windowOpenGlContext, juce::UndoManager* undoManager = nullptr);
+
+        ~EyeDiagramComponent();
+
+        /**
+         * Sets the number of symbol periods displayed side by side. Calling this is equal to updating the
+         * parameterNumSymbolsViewed property of the value tree.
+         */
+        void setNumSymbolsViewed (int numSymbols);
+
+        /**
+         * Sets the amount of the histogram kept after each update. Calling this is equal to updating the
+         * parameterPersistence property of the value tree.
+         */
+        void setPersistence (double persistence);
+
+        /**
+         * Sets the range of amplitudes mapped to the histogram. Calling this is equal to updating the
+         * parameterAmplitudeRange property of the value tree.
+         */
+        void setAmplitudeRange (juce::Range<float> amplitudeRange);
+
+        /**
+         * Sets the colours used to display the hit densities. The lowest density is mapped to the start of the
+         * gradient, the highest density is mapped to the end of the gradient. Bins without any hits stay transparent.
+         */
+        void setColourMap (const juce::ColourGradient& newColourMap);
+
+        void applySettingFromCollector (const juce::String& setting, const juce::var& value) override;
+
+        // OpenGLRenderer related member functions
+        void openGLContextClosing() override;
+
+    private:
+
+        WindowOpenGLContext& eyeDiagramGLContext;
+
+        // histogram information, set by the collector and read on the GL thread
+        std::atomic<int> numColumnsPerSymbol {0};
+        std::atomic<int> numAmplitudeBins {0};
+        double tSymbol = 0.0;
+
+        // OpenGL resources, only accessed on the GL thread
+        GLuint densityTexture = 0;
+        GLuint colourMapTexture = 0;
+        GLuint quadGLBuffer = 0;
+        int densityTextureWidth = 0;
+        int densityTextureHeight = 0;
+        std::atomic<bool> quadNeedsUpdate {true};
+        std::atomic<int>  numSymbolsViewed {2};
+
+        juce::ColourGradient colourMap; // only accessed on the GL thread
+        bool colourMapNeedsUpdate = true;
+
+        static const int colourMapSize = 256;
+
+        // Plot2D Member functions
+        void renderBeneathLines (juce::OpenGLContext& openGLContext, int width, int height) override;
+
+        // ValueTree::Listener functions
+        void valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property) override;
+        void valueTreeChildAdded (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenAdded) override;
+        void valueTreeChildRemoved (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override;
+        void valueTreeChildOrderChanged (juce::ValueTree &parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override;
+        void valueTreeParentChanged (juce::ValueTree &treeWhoseParentHasChanged) override;
+
+        void uploadDensityTexture (const juce::uint8* densities, int width, int height);
+        void uploadColourMapTexture();
+        void updateTimeRange();
+    };
+}
@@ -0,0 +1,326 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "GoniometerComponent.h"
+#include "../RealtimeDataTransfer/GoniometerDataCollector.h"
+
+namespace ntlab
+{
+    const juce::Identifier GoniometerComponent::parameterNumPoints        ("numPoints");
+    const juce::Identifier GoniometerComponent::parameterDecimationFactor ("decimationFactor");
+    const juce::Identifier GoniometerComponent::parameterCorrelationTime  ("correlationTime");
+    const juce::Identifier GoniometerComponent::parameterDecayTime        ("decayTime");
+
+    GoniometerComponent::GoniometerComponent (const juce::String identifierExtension, WindowOpenGLContext& windowOpenGlContext, juce::UndoManager* undoManager)
+    : VisualizationTarget ("Goniometer" + identifierExtension, undoManager),
+      Plot2D (false, windowOpenGlContext),
+      goniometerGLContext (windowOpenGlContext)
+    {
+        valueTree.addListener (this);
+        valueTree.setProperty (parameterNumPoints,        1024, undoManager);
+        valueTree.setProperty (parameterDecimationFactor, 2,    undoManager);
+        valueTree.setProperty (parameterCorrelationTime,  0.3,  undoManager);
+        valueTree.setProperty (parameterDecayTime,        0.15, undoManager);
+
+        setBackgroundColour (juce::Colours::black, false);
+        setGridProperties (1, 1, juce::Colours::darkgrey);
+    }
+
+    GoniometerComponent::~GoniometerComponent ()
+    {
+        valueTree.removeListener (this);
+    }
+
+    void GoniometerComponent::setPoints (int numPointsPerFrame, int decimationFactor)
+    {
+        jassert (numPointsPerFrame > 0);
+        jassert (decimationFactor > 0);
+        valueTree.setProperty (parameterNumPoints,        numPointsPerFrame, undoManager);
+        valueTree.setProperty (parameterDecimationFactor, decimationFactor,  undoManager);
+    }
+
+    void GoniometerComponent::setCorrelationTime (double correlationTimeInSeconds)
+    {
+        valueTree.setProperty (parameterCorrelationTime, correlationTimeInSeconds, undoManager);
+    }
+
+    void GoniometerComponent::setDecayTime (double decayTimeInSeconds)
+    {
+        valueTree.setProperty (parameterDecayTime, decayTimeInSeconds, undoManager);
+    }
+
+    void GoniometerComponent::setPointColour (juce::Colour newPointColour)
+    {
+        pointColour = newPointColour.getARGB();
+    }
+
+    void GoniometerComponent::applySettingFromCollector (const juce::String& setting, const juce::var& value)
+    {
+        if (setting == GoniometerDataCollector::settingNumPoints)
+        {
+            if (value.isInt())
+                valueTree.setProperty (parameterNumPoints, value, undoManager);
+        }
+        else if (setting == GoniometerDataCollector::settingDecimationFactor)
+        {
+            if (value.isInt())
+                valueTree.setProperty (parameterDecimationFactor, value, undoManager);
+        }
+        else if (setting == GoniometerDataCollector::settingCorrelationTime)
+        {
+            if (value.isDouble())
+                valueTree.setProperty (parameterCorrelationTime, value, undoManager);
+        }
+    }
+
+    void GoniometerComponent::openGLContextClosing()
+    {
+        auto& extensions = goniometerGLContext.openGLContext.extensions;
+
+        if (pointGLBuffer != 0)
+            extensions.glDeleteBuffers (1, &pointGLBuffer);
+
+        if (densityLayerQuadGLBuffer != 0)
+            extensions.glDeleteBuffers (1, &densityLayerQuadGLBuffer);
+
+        if (correlationBarGLBuffer != 0)
+            extensions.glDeleteBuffers (1, &correlationBarGLBuffer);
+
+        pointGLBuffer            = 0;
+        densityLayerQuadGLBuffer = 0;
+        correlationBarGLBuffer   = 0;
+        numPointsInBuffer        = 0;
+        densityLayer.release();
+
+        Plot2D::openGLContextClosing();
+    }
+
+    void GoniometerComponent::renderBeneathLines (juce::OpenGLContext& openGLContext, int width, int height)
+    {
+        auto& resourcePool = goniometerGLContext.getResourcePool();
+        auto* lineShader    = resourcePool.getShader<LineShader2D>    ("LineShader2D",    openGLContext);
+        auto* textureShader = resourcePool.getShader<TextureShader2D> ("TextureShader2D", openGLContext);
+
+        if ((lineShader == nullptr) || (textureShader == nullptr) || (width <= 0) || (height <= 0))
+            return;
+
+        const bool drawNewPoints = uploadNewPoints (openGLContext);
+
+        updateDensityLayer (openGLContext, *lineShader, drawNewPoints, width, height);
+
+        // The density layer changed the viewport, so it has to be restored before drawing to the plot area
+        auto clip = goniometerGLContext.getComponentClippingBoundsRelativeToGLRenderingTarget (this);
+        glViewport (clip.getX(), clip.getY(), clip.getWidth(), clip.getHeight());
+
+        drawDensityLayer (openGLContext, *textureShader);
+        drawCorrelationBar (openGLContext, *lineShader);
+    }
+
+    bool GoniometerComponent::uploadNewPoints (juce::OpenGLContext& openGLContext)
+    {
+        // The first four vertices are a quad covering the whole layer, used to fade out the points drawn before
+        static const juce::Point<float> fadeQuad[4] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {-1.0f, 1.0f}, {1.0f, 1.0f}};
+
+        if (pointGLBuffer == 0)
+        {
+            openGLContext.extensions.glGenBuffers (1, &pointGLBuffer);
+            openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, pointGLBuffer);
+            openGLContext.extensions.glBufferData (GL_ARRAY_BUFFER, sizeof (fadeQuad) + sizeof (juce::Point<float>), nullptr, GL_STREAM_DRAW);
+            openGLContext.extensions.glBufferSubData (GL_ARRAY_BUFFER, 0, sizeof (fadeQuad), fadeQuad);
+            numPointsInBuffer = 0;
+        }
+
+        if (dataSource == nullptr)
+            return false;
+
+        bool newPointsUploaded = false;
+        ConstFrame<GoniometerDataCollector::Layout> frame (dataSource->startReading (*this), 1);
+
+        if (frame.isValid() && (frame.getNumValues() > 0))
+        {
+            const auto& header = frame.getHeader();
+
+            // The same frame is returned until the collector sent a new one, it must not be accumulated twice
+            if (header.frameIndex != lastFrameIndex)
+            {
+                lastFrameIndex = header.frameIndex;
+                correlation = header.correlation;
+
+                const size_t pointBytes = static_cast<size_t> (frame.getNumValues()) * sizeof (float);
+                const auto* points = frame.getValues();
+
+                // The line shader attribute reads one float beyond the last vertex, therefore one padding vertex is
+                // allocated at the end of the buffer
+                openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, pointGLBuffer);
+                openGLContext.extensions.glBufferData (GL_ARRAY_BUFFER, static_cast<GLsizeiptr> (sizeof (fadeQuad) + pointBytes + sizeof (juce::Point<float>)), nullptr, GL_STREAM_DRAW);
+                openGLContext.extensions.glBufferSubData (GL_ARRAY_BUFFER, 0, sizeof (fadeQuad), fadeQuad);
+                openGLContext.extensions.glBufferSubData (GL_ARRAY_BUFFER, sizeof (fadeQuad), static_cast<GLsizeiptr> (pointBytes), points);
+
+                numPointsInBuffer = static_cast<int> (pointBytes / sizeof (juce::Point<float>));
+                newPointsUploaded = true;
+            }
+        }
+
+        dataSource->finishedReading (*this);
+        return newPointsUploaded;
+    }
+
+    void GoniometerComponent::updateDensityLayer (juce::OpenGLContext& openGLContext, LineShader2D& lineShader, bool drawNewPoints, int width, int height)
+    {
+        if ((densityLayer.getWidth() != width) || (densityLayer.getHeight() != height))
+        {
+            if (!densityLayer.initialise (openGLContext, width, height))
+                return;
+
+            densityLayer.makeCurrentRenderingTarget();
+            juce::OpenGLHelpers::clear (juce::Colours::transparentBlack);
+            densityLayer.releaseAsRenderingTarget();
+        }
+
+        // The fading depends on the time passed since the last frame, so that it is independent of the frame rate
+        const double now = juce::Time::getMillisecondCounterHiRes();
+        const double secondsSinceLastFrame = juce::jlimit (0.0, 1.0, (now - lastRenderTime) * 0.001);
+        const float persistence = static_cast<float> (std::exp (-secondsSinceLastFrame / decayTime.load()));
+        lastRenderTime = now;
+
+        densityLayer.makeCurrentRenderingTarget();
+        glViewport (0, 0, width, height);
+
+        lineShader.use();
+        lineShader.setCoordinateSystemFittingRange ({-1.0f, 1.0f}, {-1.0f, 1.0f});
+        openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, pointGLBuffer);
+        lineShader.enableAttributes (openGLContext);
+
+        // Scales down all channels of the layer, which holds premultiplied colours, by the persistence factor
+        glBlendFunc (GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+        lineShader.setLineColour (juce::Colours::black.withAlpha (1.0f - persistence));
+        glDrawArrays (GL_TRIANGLE_STRIP, 0, 4);
+
+        // The points are added up, so that regions hit by many points saturate
+        if (drawNewPoints && (numPointsInBuffer > 0))
+        {
+            const juce::Colour colour (pointColour.load());
+            const float alpha = colour.getFloatAlpha();
+
+            glBlendFunc (GL_ONE, GL_ONE);
+            lineShader.setLineColour (juce::Colour::fromFloatRGBA (colour.getFloatRed()   * alpha,
+                                                                    colour.getFloatGreen() * alpha,
+                                                                    colour.getFloatBlue()  * alpha,
+                                                                    alpha));
+            glDrawArrays (GL_POINTS, 4, numPointsInBuffer);
+        }
+
+        lineShader.disableAttributes (openGLContext);
+        densityLayer.releaseAsRenderingTarget();
+
+        glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+    void GoniometerComponent::drawDensityLayer (juce::OpenGLContext& openGLContext, TextureShader2D& textureShader)
+    {
+        if (!densityLayer.isValid())
+            return;
+
+        if (densityLayerQuadGLBuffer == 0)
+        {
+            const TextureShader2D::Vertex quad[4] =
+            {
+                {-1.0f, -1.0f, 0.0f, 0.0f}, {1.0f, -1.0f, 1.0f, 0.0f}, {-1.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 1.0f, 1.0f, 1.0f}
+            };
+
+            openGLContext.extensions.glGenBuffers (1, &densityLayerQuadGLBuffer);
+            openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, densityLayerQuadGLBuffer);
+            openGLContext.extensions.glBufferData (GL_ARRAY_BUFFER, sizeof (quad), quad, GL_STATIC_DRAW);
+        }
+
+        // The layer holds premultiplied colours
+        glBlendFunc (GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+        textureShader.use();
+        textureShader.bindTexture (openGLContext, densityLayer.getTextureID());
+        openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, densityLayerQuadGLBuffer);
+        textureShader.enableAttributes (openGLContext);
+        glDrawArrays (GL_TRIANGLE_STRIP, 0, 4);
+        textureShader.disableAttributes (openGLContext);
+        textureShader.unbindTexture();
+
+        glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+    void GoniometerComponent::drawCorrelationBar (juce::OpenGLContext& openGLContext, LineShader2D& lineShader)
+    {
+        // The bar grows from the center of a small strip at the bottom, the last vertex pads the buffer
+        const juce::Point<float> bar[5] =
+        {
+            {0.0f, -1.0f}, {correlation, -1.0f}, {0.0f, -0.95f}, {correlation, -0.95f}, {0.0f, 0.0f}
+        };
+
+        if (correlationBarGLBuffer == 0)
+            openGLContext.extensions.glGenBuffers (1, &correlationBarGLBuffer);
+
+        openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, correlationBarGLBuffer);
+        openGLContext.extensions.glBufferData (GL_ARRAY_BUFFER, sizeof (bar), bar, GL_DYNAMIC_DRAW);
+
+        lineShader.use();
+        lineShader.setCoordinateSystemFittingRange ({-1.0f, 1.0f}, {-1.0f, 1.0f});
+        lineShader.setLineColour ((correlation >= 0.0f) ? juce::Colours::green : juce::Colours::red);
+        lineShader.enableAttributes (openGLContext);
+        glDrawArrays (GL_TRIANGLE_STRIP, 0, 4);
+        lineShader.disableAttributes (openGLContext);
+    }
+
+    void GoniometerComponent::valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property)
+    {
+        if (treeWhosePropertyHasChanged == valueTree)
+        {
+            auto propertyValue = valueTree.getProperty (property);
+
+            if (property == parameterNumPoints)
+            {
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, GoniometerDataCollector::settingNumPoints, propertyValue);
+            }
+            else if (property == parameterDecimationFactor)
+            {
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, GoniometerDataCollector::settingDecimationFactor, propertyValue);
+            }
+            else if (property == parameterCorrelationTime)
+            {
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, GoniometerDataCollector::settingCorrelationTime, propertyValue);
+            }
+            else if (property == parameterDecayTime)
+            {
+                decayTime = juce::jmax (0.001, static_cast<double> (propertyValue));
+            }
+        }
+    }
+
+    void GoniometerComponent::valueTreeChildAdded (juce::ValueTree&, juce::ValueTree&) {}
+    void GoniometerComponent::valueTreeChildRemoved (juce::ValueTree&, juce::ValueTree&, int) {}
+    void GoniometerComponent::valueTreeChildOrderChanged (juce::ValueTree&, int, int) {}
+    void GoniometerComponent::valueTreeParentChanged (juce::ValueTree&) {}
+}
@@ -0,0 +1,118 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "../RealtimeDataTransfer/VisualizationDataSource.h"
+#include "../2DPlot/Plot2D.h"
+
+namespace ntlab
+{
+    /**
+     * The Component designed to visualize the stereo image collected by a GoniometerDataCollector instance. The
+     * mid/side points are accumulated into an offscreen layer, which fades out over time, so that often hit regions
+     * appear brighter than regions only hit by a few points. The phase correlation is drawn as a bar at the bottom,
+     * growing from the center to the right for positive and to the left for negative correlation values. It exports
+     * the parameters numPoints, decimationFactor, correlationTime and decayTime to the VisualizationTarget valueTree
+     * member. It inherits ntlab::Plot2D and therefore uses OpenGL for rendering.
+     */
+    class GoniometerComponent : public ntlab::VisualizationTarget, public ntlab::Plot2D, private juce::ValueTree::Listener
+    {
+    public:
+
+        /** A positive integer specifying the number of points sent by the collector per frame. Default value: 1024 */
+        static const juce::Identifier parameterNumPoints;
+
+        /** A positive integer specifying that only every nth sample pair is used as a point. Default value: 2 */
+        static const juce::Identifier parameterDecimationFactor;
+
+        /** A double value specifying the time constant of the correlation measurement in seconds. Default value: 0.3 */
+        static const juce::Identifier parameterCorrelationTime;
+
+        /** A double value specifying the time in seconds after which points faded to 1/e. Default value: 0.15 */
+        static const juce::Identifier parameterDecayTime;
+
+        /**
+         * Specifiy an identifier extension to map the GoniometerComponent to the corresponding source.
+         * The Identifier will automatically be prepended by "Goniometer". The optional undo manager can
+         * be passed to enable undo functionality for the parameters held by the ValueTree.
+         */
+        GoniometerComponent (const juce::String identifierExtension, WindowOpenGLContext& windowOpenGlContext, juce::UndoManager* undoManager = nullptr);
+
+        ~GoniometerComponent();
+
+        /** Sets the number of points per frame and the decimation factor applied by the collector */
+        void setPoints (int numPointsPerFrame, int decimationFactor);
+
+        /** Sets the time constant of the correlation measurement */
+        void setCorrelationTime (double correlationTimeInSeconds);
+
+        /** Sets the time after which the points faded to 1/e of their intensity */
+        void setDecayTime (double decayTimeInSeconds);
+
+        /**
+         * Sets the colour of the points. The alpha value of the colour is the intensity a single point adds to the
+         * accumulated density, so lower values reveal more details for dense signals.
+         */
+        void setPointColour (juce::Colour newPointColour);
+
+#ifndef DOXYGEN
+        void applySettingFromCollector (const juce::String& setting, const juce::var& value) override;
+
+        void openGLContextClosing() override;
+#endif
+
+    private:
+
+        WindowOpenGLContext& goniometerGLContext;
+
+        std::atomic<double>       decayTime {0.15};
+        std::atomic<juce::uint32> pointColour {juce::Colours::lightgreen.withAlpha (0.3f).getARGB()};
+
+        // Only accessed on the GL thread
+        juce::OpenGLFrameBuffer densityLayer;
+        GLuint pointGLBuffer = 0;
+        GLuint densityLayerQuadGLBuffer = 0;
+        GLuint correlationBarGLBuffer = 0;
+        int    numPointsInBuffer = 0;
+        juce::uint32 lastFrameIndex = 0;
+        float  correlation = 0.0f;
+        double lastRenderTime = 0.0;
+
+        void renderBeneathLines (juce::OpenGLContext& openGLContext, int width, int height) override;
+
+        bool uploadNewPoints (juce::OpenGLContext& openGLContext);
+        void updateDensityLayer (juce::OpenGLContext& openGLContext, LineShader2D& lineShader, bool drawNewPoints, int width, int height);
+        void drawDensityLayer (juce::OpenGLContext& openGLContext, TextureShader2D& textureShader);
+        void drawCorrelationBar (juce::OpenGLContext& openGLContext, LineShader2D& lineShader);
+
+        // ValueTree::Listener functions
+        void valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property) override;
+        void valueTreeChildAdded (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenAdded) override;
+        void valueTreeChildRemoved (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override;
+        void valueTreeChildOrderChanged (juce::ValueTree &parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override;
+        void valueTreeParentChanged (juce::ValueTree &treeWhoseParentHasChanged) override;
+    };
+}
@@ -0,0 +1,246 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "HistogramComponent.h"
+#include "../RealtimeDataTransfer/HistogramDataCollector.h"
+#include "../Utilities/SerializableRange.h"
+
+namespace ntlab
+{
+    const juce::Identifier HistogramComponent::parameterNumBins             ("numBins");
+    const juce::Identifier HistogramComponent::parameterAmplitudeRange      ("amplitudeRange");
+    const juce::Identifier HistogramComponent::parameterAccumulationMode    ("accumulationMode");
+    const juce::Identifier HistogramComponent::parameterAccumulationTime    ("accumulationTime");
+    const juce::Identifier HistogramComponent::parameterProbabilityRange    ("probabilityRange");
+    const juce::Identifier HistogramComponent::parameterProbabilityLinearDB ("probabilityLinearDB");
+
+    HistogramComponent::HistogramComponent (const juce::String identifierExtension, WindowOpenGLContext& windowOpenGlContext, juce::UndoManager* undoManager)
+    : VisualizationTarget ("Histogram" + identifierExtension, undoManager),
+      Plot2D (true, windowOpenGlContext)
+    {
+        valueTree.addListener (this);
+        valueTree.setProperty (parameterNumBins,             128,                                     undoManager);
+        valueTree.setProperty (parameterAmplitudeRange,      SerializableRange<float> (-1.0f, 1.0f),  undoManager);
+        valueTree.setProperty (parameterAccumulationMode,    static_cast<int> (HistogramDataCollector::decayed), undoManager);
+        valueTree.setProperty (parameterAccumulationTime,    1.0,                                     undoManager);
+        valueTree.setProperty (parameterProbabilityRange,    SerializableRange<float> (-60.0f, 0.0f), undoManager);
+        valueTree.setProperty (parameterProbabilityLinearDB, true,                                    undoManager);
+
+        setBackgroundColour (juce::Colours::darkturquoise, false);
+
+        automaticLineColours = [] (int numChannels)
+        {
+            juce::Array<juce::Colour> onlyGreen;
+            for (int i = 0; i < numChannels; ++i)
+                onlyGreen.add (juce::Colours::azure);
+
+            return onlyGreen;
+        };
+
+        setGridProperties (8, 6, juce::Colours::darkgrey);
+        enableXAxisTicks (true);
+        enableLegend (true, ntlab::Plot2D::topRight, false, 0.0f);
+        setLineWidthIfPossibleForGPU (1.5);
+    }
+
+    HistogramComponent::~HistogramComponent ()
+    {
+        valueTree.removeListener (this);
+    }
+
+    void HistogramComponent::setBins (int numBins, juce::Range<float> amplitudeRange)
+    {
+        jassert (numBins > 1);
+        valueTree.setProperty (parameterNumBins,        numBins,                                  undoManager);
+        valueTree.setProperty (parameterAmplitudeRange, SerializableRange<float> (amplitudeRange), undoManager);
+    }
+
+    void HistogramComponent::setAccumulation (bool shouldBeWindowed, double accumulationTimeInSeconds)
+    {
+        const int mode = shouldBeWindowed ? HistogramDataCollector::windowed : HistogramDataCollector::decayed;
+        valueTree.setProperty (parameterAccumulationMode, mode,                      undoManager);
+        valueTree.setProperty (parameterAccumulationTime, accumulationTimeInSeconds, undoManager);
+    }
+
+    void HistogramComponent::setProbabilityScaling (bool shouldBeLog)
+    {
+        valueTree.setProperty (parameterProbabilityLinearDB, shouldBeLog, undoManager);
+    }
+
+    void HistogramComponent::applySettingFromCollector (const juce::String& setting, const juce::var& value)
+    {
+        if (setting == HistogramDataCollector::settingChannelNames)
+        {
+            if (value.isArray())
+            {
+                auto newChannelNames = value.getArray();
+                channelNames.clearQuick();
+
+                for (auto& channelName : *newChannelNames)
+                    channelNames.add (channelName);
+
+                validChannelInformation.set (channelNamesValid);
+                updateChannelInformation();
+            }
+        }
+        else if (setting == HistogramDataCollector::settingNumChannels)
+        {
+            if (value.isInt())
+            {
+                numChannels = value;
+                validChannelInformation.set (numChannelsValid);
+                updateChannelInformation();
+            }
+        }
+        else if (setting == HistogramDataCollector::settingNumBins)
+        {
+            if (value.isInt())
+            {
+                validChannelInformation.set (numBinsValid);
+                valueTree.setProperty (parameterNumBins, value, undoManager);
+                updateChannelInformation();
+            }
+        }
+        else if (setting == HistogramDataCollector::settingAmplitudeRange)
+        {
+            if (value.isString())
+            {
+                validChannelInformation.set (amplitudeRangeValid);
+                valueTree.setProperty (parameterAmplitudeRange, value, undoManager);
+                updateChannelInformation();
+            }
+        }
+        else if (setting == HistogramDataCollector::settingAccumulationMode)
+        {
+            if (value.isInt())
+                valueTree.setProperty (parameterAccumulationMode, value, undoManager);
+        }
+        else if (setting == HistogramDataCollector::settingAccumulationTime)
+        {
+            if (value.isDouble())
+                valueTree.setProperty (parameterAccumulationTime, value, undoManager);
+        }
+    }
+
+    void HistogramComponent::beginFrame()
+    {
+        if (dataSource != nullptr)
+        {
+            lastBuffer = &dataSource->startReading (*this);
+
+            // if the buffer supplied doesn't seem to match just give it back directly
+            if (! ConstFrame<HistogramDataCollector::Layout> (*lastBuffer, numChannels, numBins).isValid())
+            {
+                lastBuffer = nullptr;
+                dataSource->finishedReading (*this);
+            }
+        }
+    }
+
+    const float* HistogramComponent::getBufferForLine (int lineIdx)
+    {
+        if (lastBuffer != nullptr)
+            return ConstFrame<HistogramDataCollector::Layout> (*lastBuffer, numChannels, numBins).getChannel (lineIdx);
+
+        return nullptr;
+    }
+
+    void HistogramComponent::endFrame()
+    {
+        if (lastBuffer != nullptr)
+            dataSource->finishedReading (*this);
+    }
+
+    void HistogramComponent::valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property)
+    {
+        if (treeWhosePropertyHasChanged == valueTree)
+        {
+            auto propertyValue = valueTree.getProperty (property);
+
+            if (property == parameterNumBins)
+            {
+                numBins = propertyValue;
+                updateChannelInformation();
+
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, HistogramDataCollector::settingNumBins, propertyValue);
+            }
+            else if (property == parameterAmplitudeRange)
+            {
+                updateChannelInformation();
+
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, HistogramDataCollector::settingAmplitudeRange, propertyValue);
+            }
+            else if (property == parameterAccumulationMode)
+            {
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, HistogramDataCollector::settingAccumulationMode, propertyValue);
+            }
+            else if (property == parameterAccumulationTime)
+            {
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, HistogramDataCollector::settingAccumulationTime, propertyValue);
+            }
+            else if ((property == parameterProbabilityRange) || (property == parameterProbabilityLinearDB))
+            {
+                updateProbabilityRange();
+            }
+        }
+    }
+
+    void HistogramComponent::valueTreeChildAdded (juce::ValueTree&, juce::ValueTree&) {}
+    void HistogramComponent::valueTreeChildRemoved (juce::ValueTree&, juce::ValueTree&, int) {}
+    void HistogramComponent::valueTreeChildOrderChanged (juce::ValueTree&, int, int) {}
+    void HistogramComponent::valueTreeParentChanged (juce::ValueTree&) {}
+
+    void HistogramComponent::updateChannelInformation()
+    {
+        if (validChannelInformation.all())
+        {
+            SerializableRange<float> amplitudeRange (valueTree.getProperty (parameterAmplitudeRange));
+
+            setXValues (amplitudeRange, numBins.load(), LogScaling::none);
+            setLines (numChannels, channelNames);
+        }
+    }
+
+    void HistogramComponent::updateProbabilityRange()
+    {
+        bool probabilityShouldBeLog = valueTree.getProperty (parameterProbabilityLinearDB);
+        SerializableRange<float> probabilityRange (valueTree.getProperty (parameterProbabilityRange));
+
+        if (probabilityShouldBeLog)
+        {
+            setYRange (probabilityRange, Plot2D::LogScaling::dBPower);
+            enableYAxisTicks (true, "dB", true);
+        }
+        else
+        {
+            setYRange (probabilityRange, Plot2D::LogScaling::none);
+            enableYAxisTicks (true, "", true);
+        }
+    }
+}
@@ -0,0 +1,124 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <bitset>
+#include "../RealtimeDataTransfer/VisualizationDataSource.h"
+#include "../2DPlot/Plot2D.h"
+
+namespace ntlab
+{
+    /**
+     * The Component designed to visualize amplitude histograms collected by a HistogramDataCollector instance. Each
+     * channel is drawn as a line showing the probability of the amplitudes falling into each bin. It exports the
+     * parameters numBins, amplitudeRange, accumulationMode, accumulationTime, probabilityRange and
+     * probabilityLinearDB to the VisualizationTarget valueTree member. It inherits ntlab::Plot2D and therefore uses
+     * OpenGL for rendering.
+     */
+    class HistogramComponent : public ntlab::VisualizationTarget, public ntlab::Plot2D, private juce::ValueTree::Listener
+    {
+    public:
+
+        /** A positive integer specifying the number of histogram bins. Default value: 128 */
+        static const juce::Identifier parameterNumBins;
+
+        /** A 2-Element float Array containing the minimal and maximal amplitude covered by the histogram. */
+        static const juce::Identifier parameterAmplitudeRange;
+
+        /** An integer selecting windowed (0) or exponentially decayed (1) accumulation. Default value: 1 */
+        static const juce::Identifier parameterAccumulationMode;
+
+        /** A double value specifying the window length or the decay time constant in seconds. Default value: 1.0 */
+        static const juce::Identifier parameterAccumulationTime;
+
+        /**
+         * A 2-Element float Array containing the minimal and maximal probability visualized. If the probability is
+         * displayed in dB, the range is expected in dB too.
+         */
+        static const juce::Identifier parameterProbabilityRange;
+
+        /** A boolean to select if the probability should be displayed linear (=false) or in dB (=true) */
+        static const juce::Identifier parameterProbabilityLinearDB;
+
+        /**
+         * Specifiy an identifier extension to map the HistogramComponent to the corresponding source.
+         * The Identifier will automatically be prepended by "Histogram". The optional undo manager can
+         * be passed to enable undo functionality for the parameters held by the ValueTree.
+         */
+        HistogramComponent (const juce::String identifierExtension, WindowOpenGLContext& windowOpenGlContext, juce::UndoManager* undoManager = nullptr);
+
+        ~HistogramComponent();
+
+        /** Sets the number of bins and the amplitude range covered by the histogram */
+        void setBins (int numBins, juce::Range<float> amplitudeRange);
+
+        /**
+         * Selects windowed or exponentially decayed accumulation. Depending on the mode, the accumulation time is the
+         * window length or the decay time constant.
+         */
+        void setAccumulation (bool shouldBeWindowed, double accumulationTimeInSeconds);
+
+        /** If enabled, the probability axis is scaled in dB values, revealing rare amplitudes like clipped samples */
+        void setProbabilityScaling (bool shouldBeLog);
+
+#ifndef DOXYGEN
+        void applySettingFromCollector (const juce::String& setting, const juce::var& value) override;
+#endif
+
+    private:
+
+        // bitfield index values for all settings that have been set
+        enum ValidSettings
+        {
+            numChannelsValid    = 0,
+            channelNamesValid   = 1,
+            numBinsValid        = 2,
+            amplitudeRangeValid = 3
+        };
+        std::bitset<4> validChannelInformation;
+
+        int numChannels = 0;
+        std::atomic<int> numBins {0};
+        juce::StringArray channelNames;
+
+        juce::MemoryBlock* lastBuffer = nullptr;
+
+        // Plot2D Member functions
+        void beginFrame() override;
+        const float* getBufferForLine (int lineIdx) override;
+        void endFrame() override;
+
+        // ValueTree::Listener functions
+        void valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property) override;
+        void valueTreeChildAdded (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenAdded) override;
+        void valueTreeChildRemoved (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override;
+        void valueTreeChildOrderChanged (juce::ValueTree &parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override;
+        void valueTreeParentChanged (juce::ValueTree &treeWhoseParentHasChanged) override;
+
+        void updateChannelInformation();
+        void updateProbabilityRange();
+    };
+}
@@ -0,0 +1,238 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "LoudnessMeterComponent.h"
+#include "../RealtimeDataTransfer/LoudnessDataCollector.h"
+#include "../Utilities/SerializableRange.h"
+
+namespace ntlab
+{
+    const juce::Identifier LoudnessMeterComponent::parameterLevelRange ("levelRange");
+
+    const juce::Colour LoudnessMeterComponent::loudnessBarColours[3] = {juce::Colours::lightgreen, juce::Colours::green, juce::Colours::darkturquoise};
+    const juce::Colour LoudnessMeterComponent::truePeakBarColour = juce::Colours::azure;
+    const juce::Colour LoudnessMeterComponent::truePeakMaxColour = juce::Colours::red;
+
+    LoudnessMeterComponent::LoudnessMeterComponent (const juce::String identifierExtension, WindowOpenGLContext& windowOpenGlContext, juce::UndoManager* undoManager)
+    : VisualizationTarget ("Loudness" + identifierExtension, undoManager),
+      Plot2D (false, windowOpenGlContext),
+      meterGLContext (windowOpenGlContext)
+    {
+        valueTree.addListener (this);
+        valueTree.setProperty (parameterLevelRange, SerializableRange<float> (-60.0f, 3.0f), undoManager);
+
+        setBackgroundColour (juce::Colours::black, false);
+        setGridProperties (1, 7, juce::Colours::darkgrey);
+        enableYAxisTicks (true, "dB");
+        enableLegend (true, ntlab::Plot2D::topRight, false, 0.0f);
+    }
+
+    LoudnessMeterComponent::~LoudnessMeterComponent ()
+    {
+        valueTree.removeListener (this);
+    }
+
+    void LoudnessMeterComponent::setLevelRange (juce::Range<float> levelRange)
+    {
+        valueTree.setProperty (parameterLevelRange, SerializableRange<float> (levelRange), undoManager);
+    }
+
+    void LoudnessMeterComponent::resetIntegratedLoudness()
+    {
+        if (dataSource != nullptr)
+        {
+            juce::var reset (true);
+            dataSource->applySettingToCollector (*this, LoudnessDataCollector::settingResetIntegratedLoudness, reset);
+        }
+    }
+
+    void LoudnessMeterComponent::applySettingFromCollector (const juce::String& setting, const juce::var& value)
+    {
+        if (setting == LoudnessDataCollector::settingChannelNames)
+        {
+            if (value.isArray())
+            {
+                auto newChannelNames = value.getArray();
+                channelNames.clearQuick();
+
+                for (auto& channelName : *newChannelNames)
+                    channelNames.add (channelName);
+
+                validChannelInformation.set (channelNamesValid);
+                updateChannelInformation();
+            }
+        }
+        else if (setting == LoudnessDataCollector::settingNumChannels)
+        {
+            if (value.isInt())
+            {
+                numChannels = value;
+                validChannelInformation.set (numChannelsValid);
+                updateChannelInformation();
+            }
+        }
+    }
+
+    void LoudnessMeterComponent::openGLContextClosing()
+    {
+        if (barGLBuffer != 0)
+            meterGLContext.openGLContext.extensions.glDeleteBuffers (1, &barGLBuffer);
+
+        barGLBuffer = 0;
+
+        Plot2D::openGLContextClosing();
+    }
+
+    void LoudnessMeterComponent::renderBeneathLines (juce::OpenGLContext& openGLContext, int, int)
+    {
+        if (dataSource == nullptr)
+            return;
+
+        auto* lineShader = meterGLContext.getResourcePool().getShader<LineShader2D> ("LineShader2D", openGLContext);
+        if (lineShader == nullptr)
+            return;
+
+        // The number of channels is derived from the frame itself, so that no state is shared with the message thread
+        auto& frame = dataSource->startReading (*this);
+        const int numValues = static_cast<int> (frame.getSize() / sizeof (float));
+        const int numFrameChannels = (numValues - LoudnessDataCollector::firstTruePeak) / LoudnessDataCollector::numValuesPerChannel;
+
+        if ((numFrameChannels < 0) || (numValues != LoudnessDataCollector::firstTruePeak + numFrameChannels * LoudnessDataCollector::numValuesPerChannel))
+        {
+            dataSource->finishedReading (*this);
+            return;
+        }
+
+        juce::Range<float> levelRangeToDraw;
+        {
+            std::lock_guard<std::mutex> scopedLock (levelRangeLock);
+            levelRangeToDraw = levelRange;
+        }
+
+        const auto* values = static_cast<const float*> (frame.getData());
+        const float barFloor = levelRangeToDraw.getStart();
+        const int numBars = LoudnessDataCollector::firstTruePeak + numFrameChannels;
+        const float barWidth = 1.0f / numBars;
+
+        // Each bar is a triangle strip of 4 vertices, each max marker a line of 2 vertices. The shader attribute
+        // reads one float beyond the last vertex, therefore one padding vertex is appended
+        barVertices.resize (static_cast<size_t> (4 * numBars + 2 * numFrameChannels + 1));
+        auto* vertex = barVertices.data();
+
+        auto addBar = [&] (int barIdx, float level)
+        {
+            const float left  = (barIdx + 0.15f) * barWidth;
+            const float right = (barIdx + 0.85f) * barWidth;
+            const float top   = std::max (barFloor, level);
+
+            *vertex++ = {left,  barFloor};
+            *vertex++ = {right, barFloor};
+            *vertex++ = {left,  top};
+            *vertex++ = {right, top};
+        };
+
+        for (int b = 0; b < LoudnessDataCollector::firstTruePeak; ++b)
+            addBar (b, values[b]);
+
+        for (int n = 0; n < numFrameChannels; ++n)
+            addBar (LoudnessDataCollector::firstTruePeak + n, values[LoudnessDataCollector::firstTruePeak + LoudnessDataCollector::numValuesPerChannel * n]);
+
+        for (int n = 0; n < numFrameChannels; ++n)
+        {
+            const int barIdx = LoudnessDataCollector::firstTruePeak + n;
+            const float maxLevel = values[LoudnessDataCollector::firstTruePeak + LoudnessDataCollector::numValuesPerChannel * n + 1];
+
+            *vertex++ = {(barIdx + 0.15f) * barWidth, maxLevel};
+            *vertex++ = {(barIdx + 0.85f) * barWidth, maxLevel};
+        }
+
+        *vertex = {0.0f, 0.0f};
+
+        dataSource->finishedReading (*this);
+
+        if (barGLBuffer == 0)
+            openGLContext.extensions.glGenBuffers (1, &barGLBuffer);
+
+        openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, barGLBuffer);
+        openGLContext.extensions.glBufferData (GL_ARRAY_BUFFER,
+                                               static_cast<GLsizeiptr> (barVertices.size() * sizeof (juce::Point<float>)),
+                                               barVertices.data(),
+                                               GL_STREAM_DRAW);
+
+        lineShader->setCoordinateSystemFittingRange ({0.0f, 1.0f}, levelRangeToDraw);
+        lineShader->enableAttributes (openGLContext);
+
+        for (int b = 0; b < numBars; ++b)
+        {
+            lineShader->setLineColour ((b < LoudnessDataCollector::firstTruePeak) ? loudnessBarColours[b] : truePeakBarColour);
+            glDrawArrays (GL_TRIANGLE_STRIP, 4 * b, 4);
+        }
+
+        lineShader->setLineColour (truePeakMaxColour);
+        glDrawArrays (GL_LINES, 4 * numBars, 2 * numFrameChannels);
+
+        lineShader->disableAttributes (openGLContext);
+    }
+
+    void LoudnessMeterComponent::valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property)
+    {
+        if (treeWhosePropertyHasChanged == valueTree)
+        {
+            if (property == parameterLevelRange)
+            {
+                SerializableRange<float> newLevelRange (valueTree.getProperty (parameterLevelRange));
+
+                {
+                    std::lock_guard<std::mutex> scopedLock (levelRangeLock);
+                    levelRange = newLevelRange;
+                }
+
+                setYRange (newLevelRange);
+            }
+        }
+    }
+
+    void LoudnessMeterComponent::valueTreeChildAdded (juce::ValueTree&, juce::ValueTree&) {}
+    void LoudnessMeterComponent::valueTreeChildRemoved (juce::ValueTree&, juce::ValueTree&, int) {}
+    void LoudnessMeterComponent::valueTreeChildOrderChanged (juce::ValueTree&, int, int) {}
+    void LoudnessMeterComponent::valueTreeParentChanged (juce::ValueTree&) {}
+
+    void LoudnessMeterComponent::updateChannelInformation()
+    {
+        if (validChannelInformation.all())
+        {
+            juce::StringArray barNames ({"Momentary", "Short-term", "Integrated"});
+            juce::Array<juce::Colour> barColours (loudnessBarColours, 3);
+
+            for (int n = 0; n < numChannels; ++n)
+            {
+                barNames.add ("True peak " + channelNames[n]);
+                barColours.add (truePeakBarColour);
+            }
+
+            setLines (barNames.size(), barNames, barColours);
+        }
+    }
+}
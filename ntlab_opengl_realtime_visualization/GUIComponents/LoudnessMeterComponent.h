@@ -0,0 +1,112 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <bitset>
+#include "../RealtimeDataTransfer/VisualizationDataSource.h"
+#include "../2DPlot/Plot2D.h"
+
+namespace ntlab
+{
+    /**
+     * The Component designed to visualize the loudness and true peak values measured by a LoudnessDataCollector
+     * instance. It draws a bar for the momentary, short-term and integrated loudness followed by a true peak bar for
+     * each channel, which is topped by a marker holding the maximum true peak. It exports the parameter levelRange to
+     * the VisualizationTarget valueTree member. It inherits ntlab::Plot2D for the grid, the axis labels and the
+     * legend, while the bars are drawn directly with the line shader shared through the WindowOpenGLContext, so no
+     * line buffers are allocated.
+     */
+    class LoudnessMeterComponent : public ntlab::VisualizationTarget, public ntlab::Plot2D, private juce::ValueTree::Listener
+    {
+    public:
+
+        /**
+         * A 2-Element float Array containing the minimal and maximal level in LUFS and dBTP displayed.
+         * Default value: -60|3
+         */
+        static const juce::Identifier parameterLevelRange;
+
+        /**
+         * Specifiy an identifier extension to map the LoudnessMeterComponent to the corresponding source.
+         * The Identifier will automatically be prepended by "Loudness". The optional undo manager can
+         * be passed to enable undo functionality for the parameters held by the ValueTree.
+         */
+        LoudnessMeterComponent (const juce::String identifierExtension, WindowOpenGLContext& windowOpenGlContext, juce::UndoManager* undoManager = nullptr);
+
+        ~LoudnessMeterComponent();
+
+        /** Sets the range of levels displayed */
+        void setLevelRange (juce::Range<float> levelRange);
+
+        /** Restarts the measurement of the integrated loudness and the maximum true peak on the collector side */
+        void resetIntegratedLoudness();
+
+#ifndef DOXYGEN
+        void applySettingFromCollector (const juce::String& setting, const juce::var& value) override;
+
+        void openGLContextClosing() override;
+#endif
+
+    private:
+
+        WindowOpenGLContext& meterGLContext;
+
+        // bitfield index values for all settings that have been set
+        enum ValidSettings
+        {
+            numChannelsValid  = 0,
+            channelNamesValid = 1
+        };
+        std::bitset<2> validChannelInformation;
+
+        int numChannels = 0;
+        juce::StringArray channelNames;
+
+        // The level range parsed from the valueTree on the message thread, read by renderBeneathLines on the GL thread
+        juce::Range<float> levelRange {-60.0f, 3.0f};
+        std::mutex levelRangeLock;
+
+        // The bar vertices are rebuilt from each frame received, only accessed on the GL thread
+        GLuint barGLBuffer = 0;
+        std::vector<juce::Point<float>> barVertices;
+
+        static const juce::Colour loudnessBarColours[3];
+        static const juce::Colour truePeakBarColour;
+        static const juce::Colour truePeakMaxColour;
+
+        // Plot2D Member functions
+        void renderBeneathLines (juce::OpenGLContext& openGLContext, int width, int height) override;
+
+        // ValueTree::Listener functions
+        void valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property) override;
+        void valueTreeChildAdded (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenAdded) override;
+        void valueTreeChildRemoved (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override;
+        void valueTreeChildOrderChanged (juce::ValueTree &parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override;
+        void valueTreeParentChanged (juce::ValueTree &treeWhoseParentHasChanged) override;
+
+        void updateChannelInformation();
+    };
+}
@@ -31,6 +31,7 @@ namespace ntlab
     const juce::Identifier OscilloscopeComponent::parameterGainLinear       ("gainLinear");
     const juce::Identifier OscilloscopeComponent::parameterTimeViewed       ("timeViewed");
     const juce::Identifier OscilloscopeComponent::parameterEnableTriggering ("enableTriggering");
+    const juce::Identifier OscilloscopeComponent::parameterPreFilterCoefficients ("preFilterCoefficients");
 
     OscilloscopeComponent::OscilloscopeComponent (const juce::String identifierExtension, WindowOpenGLContext& windowOpenGlContext, juce::UndoManager* undoManager)
     : VisualizationTarget ("Oscilloscope" + identifierExtension, undoManager),
@@ -40,6 +41,7 @@ namespace ntlab
         valueTree.setProperty (parameterGainLinear,       1.0,   undoManager);
         valueTree.setProperty (parameterTimeViewed,       0.01,  undoManager);
         valueTree.setProperty (parameterEnableTriggering, false, undoManager);
+        valueTree.setProperty (parameterPreFilterCoefficients, juce::String(), undoManager);
 
         setBackgroundColour (juce::Colours::darkturquoise, false);
 
@@ -93,6 +95,11 @@ namespace ntlab
         return valueTree.getProperty (parameterEnableTriggering);
     }
 
+    void OscilloscopeComponent::setPreFilter (const std::vector<Biquad::Coefficients>& coefficients)
+    {
+        valueTree.setProperty (parameterPreFilterCoefficients, BiquadFilterChain::coefficientsToString (coefficients), undoManager);
+    }
+
     void OscilloscopeComponent::displaySettingsBar (bool shouldBeDisplayed)
     {
         if ((settingsComponent == nullptr) != shouldBeDisplayed)
@@ -149,9 +156,20 @@ namespace ntlab
                 numSamples = value;
                 validChannelInformation.set (numSamplesValid);
                 updateChannelInformation();
+
+                // the collector might have been registered after the last resize, so make sure it knows the limit
+                sendMaxNumPointsPerLineToCollector();
             }
 
         }
+        else if (setting == OscilloscopeDataCollector::settingNumPointsPerChunk)
+        {
+            if (value.isInt())
+            {
+                numPointsPerChunk = value;
+                shouldClearAssembledLines = true;
+            }
+        }
         else if (setting == OscilloscopeDataCollector::settingTSample)
         {
             if (value.isDouble())
@@ -181,16 +199,23 @@ namespace ntlab
     {
         if (settingsComponent.get() != nullptr)
             settingsComponent->setBounds (0, 0, getWidth (), 100);
+
+        maxNumPointsPerLine = 2 * getPhysicalWidth();
+        sendMaxNumPointsPerLineToCollector();
     }
 
     void OscilloscopeComponent::beginFrame()
     {
-        if (dataSource != nullptr)
+        if ((dataSource != nullptr) && (numPointsPerChunk > 0))
+        {
+            assembleChunk();
+        }
+        else if (dataSource != nullptr)
         {
             lastBuffer = &dataSource->startReading (*this);
 
             // if the buffer supplied doesn't seem to match just give it back directly
-            if (lastBuffer->getSize() != numSamples * numChannels * sizeof (float))
+            if (! ConstFrame<OscilloscopeDataCollector::Layout> (*lastBuffer, numChannels, numSamples).isValid())
             {
                 lastBuffer = nullptr;
                 dataSource->finishedReading (*this);
@@ -201,7 +226,10 @@ namespace ntlab
     const float* OscilloscopeComponent::getBufferForLine (int lineIdx)
     {
         if (lastBuffer != nullptr)
-            return static_cast<float*> (lastBuffer->getData()) + (numSamples * lineIdx);
+            return ConstFrame<OscilloscopeDataCollector::Layout> (*lastBuffer, numChannels, numSamples).getChannel (lineIdx);
+
+        if ((numPointsPerChunk > 0) && (assembledLines.size() == static_cast<size_t> (numChannels * numSamples)) && (numSamples > 0))
+            return assembledLines.data() + lineIdx * numSamples;
 
         return nullptr;
     }
@@ -212,6 +240,40 @@ namespace ntlab
             dataSource->finishedReading (*this);
     }
 
+    void OscilloscopeComponent::assembleChunk()
+    {
+        lastBuffer = nullptr;
+
+        // Only reallocates if the settings have changed, the lines start flat until the first chunks arrive
+        const auto numValues = static_cast<size_t> (numChannels * numSamples);
+        if ((assembledLines.size() != numValues) || shouldClearAssembledLines.exchange (false))
+            assembledLines.assign (numValues, 0.0f);
+
+        ConstFrame<OscilloscopeDataCollector::ChunkLayout> chunk (dataSource->startReading (*this), numChannels);
+
+        if (chunk.isValid() && (numSamples > 0))
+        {
+            const auto& header = chunk.getHeader();
+            const int firstPoint = header.firstPoint;
+            const int numPoints  = header.numPoints;
+
+            // The data source returns the same chunk until the collector sent a new one
+            const bool isNewChunk = header.chunkIndex != lastChunkIndex;
+            const bool fitsIntoLines = (firstPoint >= 0) && (numPoints > 0) && (numPoints <= chunk.getNumValuesPerChannel()) && (firstPoint + numPoints <= numSamples);
+
+            if (isNewChunk && fitsIntoLines)
+            {
+                lastChunkIndex = header.chunkIndex;
+
+                for (int c = 0; c < numChannels; ++c)
+                    std::copy (chunk.getChannel (c), chunk.getChannel (c) + numPoints, assembledLines.data() + c * numSamples + firstPoint);
+            }
+        }
+
+        // The chunk has been copied, so the block can be given back before the lines are drawn
+        dataSource->finishedReading (*this);
+    }
+
     void OscilloscopeComponent::valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property)
     {
         if (treeWhosePropertyHasChanged == valueTree)
@@ -234,6 +296,11 @@ namespace ntlab
                 if (dataSource != nullptr)
                     dataSource->applySettingToCollector (*this, OscilloscopeDataCollector::settingIsTriggered, propertyValue);
             }
+            else if (property == parameterPreFilterCoefficients)
+            {
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, OscilloscopeDataCollector::settingPreFilterCoefficients, propertyValue);
+            }
         }
     }
 
@@ -259,6 +326,12 @@ namespace ntlab
         }
     }
 
+    void OscilloscopeComponent::sendMaxNumPointsPerLineToCollector ()
+    {
+        if (dataSource != nullptr)
+            dataSource->applySettingToCollector (*this, OscilloscopeDataCollector::settingMaxNumPointsPerLine, maxNumPointsPerLine.load());
+    }
+
     OscilloscopeComponent::SettingsComponent::SettingsComponent (juce::ValueTree& valueTree, juce::UndoManager* um) : oscilloscopeValueTree (valueTree), undoManager (um)
     {
         addAndMakeVisible (timebaseSlider);
@@ -27,15 +27,19 @@ SOFTWARE.
 #include <bitset>
 
 #include "../RealtimeDataTransfer/VisualizationDataSource.h"
+#include "../DSP/Biquad.h"
 #include "../2DPlot/Plot2D.h"
 
 namespace ntlab
 {
     /**
      * The Component designed to visualize time-domain data collected by an OscilloscopeDataCollector instance.
-     * It exports the parameters "gainLinear", "timeViewed" and "enableTriggering" to the VisualizationTarget
+     * It exports the parameters "gainLinear", "timeViewed", "enableTriggering" and "preFilterCoefficients" to the VisualizationTarget
      * valueTree member as an alternative way to set these parameters by using the setter member functions and
      * save/restore its state. It inherits ntlab::Plot2D and therefore uses OpenGL for rendering.
+     *
+     * If the collector sends chunks instead of complete frames, the component assembles them into the lines drawn,
+     * so that the current frame sweeps over the previous one, @see OscilloscopeDataCollector::setChunkSize
      */
     class OscilloscopeComponent : public ntlab::VisualizationTarget, public ntlab::Plot2D, private juce::ValueTree::Listener
     {
@@ -50,6 +54,12 @@ namespace ntlab
         /** A boolean value specifying if the oscilloscope should be triggered to the rising edge of the first channel */
         static const juce::Identifier parameterEnableTriggering;
 
+        /**
+         * A string containing the serialized coefficients of the biquad sections the collector applies to the signal
+         * before sending it, as created by BiquadFilterChain::coefficientsToString. An empty string disables filtering.
+         */
+        static const juce::Identifier parameterPreFilterCoefficients;
+
         /**
          * Specifiy an identifier extension to map the OscilloscopeComponent to the corresponding source.
          * The Identifier will automatically be prepended by "Oscilloscope". The optional undo manager can
@@ -95,6 +105,14 @@ namespace ntlab
          */
         bool getTriggeringState();
 
+        /**
+         * Sets the biquad sections the collector applies to all channels before sending them, e.g. to view a DC-blocked
+         * or band-limited version of the signal. The coefficients have to be designed for the sample period of the
+         * samples displayed. Pass an empty vector to disable filtering. Calling this is equal to updating the
+         * parameterPreFilterCoefficients property of the value tree.
+         */
+        void setPreFilter (const std::vector<Biquad::Coefficients>& coefficients);
+
         /**
          * This overlays a simple semi-transparent settings bar above the scope, allowing to adjust time viewed, gain
          * and triggering. You might however want to implement controls that suit your GUI design better. Use the
@@ -153,6 +171,15 @@ namespace ntlab
 
         juce::MemoryBlock* lastBuffer = nullptr;
 
+        // If the collector sends chunks, they are assembled into the lines drawn, one after another per channel
+        std::atomic<int>   numPointsPerChunk {0};
+        std::atomic<bool>  shouldClearAssembledLines {false};
+        std::vector<float> assembledLines;
+        juce::uint32       lastChunkIndex = 0;
+
+        // A minimum and a maximum value for each pixel column, updated when resized
+        std::atomic<int> maxNumPointsPerLine {0};
+
         std::unique_ptr<SettingsComponent> settingsComponent;
 
         // Plot2D Member functions
@@ -160,6 +187,12 @@ namespace ntlab
         const float* getBufferForLine (int lineIdx) override;
         void endFrame() override;
 
+        // The collector limits the lines to a minimum and a maximum per pixel column, which must be drawn in pairs
+        bool linesHoldMinMaxPairs() const override { return true; }
+
+        /** Copies the chunk currently held by the data source to the assembled lines, called from beginFrame */
+        void assembleChunk();
+
         // ValueTree::Listener functions
         void valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property) override;
         void valueTreeChildAdded (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenAdded) override;
@@ -169,6 +202,7 @@ namespace ntlab
 
         void updateChannelInformation();
         void updateTimebaseInformation();
+        void sendMaxNumPointsPerLineToCollector();
     };
 }
 
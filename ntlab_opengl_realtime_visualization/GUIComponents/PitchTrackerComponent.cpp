@@ -0,0 +1,181 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "PitchTrackerComponent.h"
+#include "../RealtimeDataTransfer/PitchTrackerDataCollector.h"
+#include "../Utilities/SerializableRange.h"
+
+namespace ntlab
+{
+    const juce::Identifier PitchTrackerComponent::parameterHistoryLength ("historyLength");
+    const juce::Identifier PitchTrackerComponent::parameterThreshold     ("threshold");
+    const juce::Identifier PitchTrackerComponent::parameterNoteRange     ("noteRange");
+
+    PitchTrackerComponent::PitchTrackerComponent (const juce::String identifierExtension, WindowOpenGLContext& windowOpenGlContext, juce::UndoManager* undoManager)
+    : VisualizationTarget ("PitchTracker" + identifierExtension, undoManager),
+      Plot2D (true, windowOpenGlContext)
+    {
+        valueTree.addListener (this);
+        valueTree.setProperty (parameterHistoryLength, 5.0,                                      undoManager);
+        valueTree.setProperty (parameterThreshold,     0.15,                                     undoManager);
+        valueTree.setProperty (parameterNoteRange,     SerializableRange<float> (36.0f, 96.0f),  undoManager);
+
+        setBackgroundColour (juce::Colours::darkturquoise, false);
+
+        automaticLineColours = [] (int numLines)
+        {
+            juce::Array<juce::Colour> onlyYellow;
+            for (int i = 0; i < numLines; ++i)
+                onlyYellow.add (juce::Colours::yellow);
+
+            return onlyYellow;
+        };
+
+        // One grid line per octave in the default note range
+        setGridProperties (9, 4, juce::Colours::darkgrey);
+        enableXAxisTicks (true, "s");
+        enableYAxisTicks (true);
+        setLineWidthIfPossibleForGPU (2.0);
+    }
+
+    PitchTrackerComponent::~PitchTrackerComponent ()
+    {
+        valueTree.removeListener (this);
+    }
+
+    void PitchTrackerComponent::setHistoryLength (double historyLengthInSeconds)
+    {
+        jassert (historyLengthInSeconds > 0.0);
+        valueTree.setProperty (parameterHistoryLength, historyLengthInSeconds, undoManager);
+    }
+
+    void PitchTrackerComponent::setThreshold (double newThreshold)
+    {
+        valueTree.setProperty (parameterThreshold, newThreshold, undoManager);
+    }
+
+    void PitchTrackerComponent::setNoteRange (juce::Range<float> noteRange)
+    {
+        valueTree.setProperty (parameterNoteRange, SerializableRange<float> (noteRange), undoManager);
+    }
+
+    void PitchTrackerComponent::applySettingFromCollector (const juce::String& setting, const juce::var& value)
+    {
+        if (setting == PitchTrackerDataCollector::settingNumValues)
+        {
+            if (value.isInt())
+            {
+                numValues = value;
+                validChannelInformation.set (numValuesValid);
+                updateChannelInformation();
+            }
+        }
+        else if (setting == PitchTrackerDataCollector::settingHistoryLength)
+        {
+            if (value.isDouble())
+            {
+                validChannelInformation.set (historyLengthValid);
+                valueTree.setProperty (parameterHistoryLength, value, undoManager);
+                updateChannelInformation();
+            }
+        }
+        else if (setting == PitchTrackerDataCollector::settingThreshold)
+        {
+            if (value.isDouble())
+                valueTree.setProperty (parameterThreshold, value, undoManager);
+        }
+    }
+
+    void PitchTrackerComponent::beginFrame()
+    {
+        if (dataSource != nullptr)
+        {
+            lastBuffer = &dataSource->startReading (*this);
+
+            // if the buffer supplied doesn't seem to match just give it back directly
+            if (! ConstFrame<PitchTrackerDataCollector::Layout> (*lastBuffer, 1, numValues).isValid())
+            {
+                lastBuffer = nullptr;
+                dataSource->finishedReading (*this);
+            }
+        }
+    }
+
+    const float* PitchTrackerComponent::getBufferForLine (int)
+    {
+        if (lastBuffer != nullptr)
+            return ConstFrame<PitchTrackerDataCollector::Layout> (*lastBuffer, 1, numValues).getValues();
+
+        return nullptr;
+    }
+
+    void PitchTrackerComponent::endFrame()
+    {
+        if (lastBuffer != nullptr)
+            dataSource->finishedReading (*this);
+    }
+
+    void PitchTrackerComponent::valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property)
+    {
+        if (treeWhosePropertyHasChanged == valueTree)
+        {
+            auto propertyValue = valueTree.getProperty (property);
+
+            if (property == parameterHistoryLength)
+            {
+                updateChannelInformation();
+
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, PitchTrackerDataCollector::settingHistoryLength, propertyValue);
+            }
+            else if (property == parameterThreshold)
+            {
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, PitchTrackerDataCollector::settingThreshold, propertyValue);
+            }
+            else if (property == parameterNoteRange)
+            {
+                setYRange (SerializableRange<float> (propertyValue));
+            }
+        }
+    }
+
+    void PitchTrackerComponent::valueTreeChildAdded (juce::ValueTree&, juce::ValueTree&) {}
+    void PitchTrackerComponent::valueTreeChildRemoved (juce::ValueTree&, juce::ValueTree&, int) {}
+    void PitchTrackerComponent::valueTreeChildOrderChanged (juce::ValueTree&, int, int) {}
+    void PitchTrackerComponent::valueTreeParentChanged (juce::ValueTree&) {}
+
+    void PitchTrackerComponent::updateChannelInformation()
+    {
+        if (validChannelInformation.all() && (numValues > 1))
+        {
+            const float historyLength = valueTree.getProperty (parameterHistoryLength);
+            juce::StringArray lineNames ("Pitch");
+
+            setXValues ({-historyLength, 0.0f}, numValues.load(), LogScaling::none);
+            setLines (1, lineNames);
+        }
+    }
+}
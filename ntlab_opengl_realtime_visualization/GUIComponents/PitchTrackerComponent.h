@@ -0,0 +1,103 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <bitset>
+#include "../RealtimeDataTransfer/VisualizationDataSource.h"
+#include "../2DPlot/Plot2D.h"
+
+namespace ntlab
+{
+    /**
+     * The Component designed to visualize the pitch history collected by a PitchTrackerDataCollector instance. The
+     * pitch is drawn as a roll-mode line with the most recent value at the right edge, the y axis shows MIDI note
+     * numbers. It exports the parameters historyLength, threshold and noteRange to the VisualizationTarget valueTree
+     * member. It inherits ntlab::Plot2D and therefore uses OpenGL for rendering.
+     */
+    class PitchTrackerComponent : public ntlab::VisualizationTarget, public ntlab::Plot2D, private juce::ValueTree::Listener
+    {
+    public:
+
+        /** A double value specifying the time span in seconds displayed. Default value: 5.0 */
+        static const juce::Identifier parameterHistoryLength;
+
+        /** A double value specifying the voicing threshold used by the collector. Default value: 0.15 */
+        static const juce::Identifier parameterThreshold;
+
+        /** A 2-Element float Array containing the lowest and highest MIDI note number displayed. Default value: 36|96 */
+        static const juce::Identifier parameterNoteRange;
+
+        /**
+         * Specifiy an identifier extension to map the PitchTrackerComponent to the corresponding source.
+         * The Identifier will automatically be prepended by "PitchTracker". The optional undo manager can
+         * be passed to enable undo functionality for the parameters held by the ValueTree.
+         */
+        PitchTrackerComponent (const juce::String identifierExtension, WindowOpenGLContext& windowOpenGlContext, juce::UndoManager* undoManager = nullptr);
+
+        ~PitchTrackerComponent();
+
+        /** Sets the time span displayed */
+        void setHistoryLength (double historyLengthInSeconds);
+
+        /** Sets the voicing threshold used by the collector */
+        void setThreshold (double newThreshold);
+
+        /** Sets the range of MIDI note numbers displayed */
+        void setNoteRange (juce::Range<float> noteRange);
+
+#ifndef DOXYGEN
+        void applySettingFromCollector (const juce::String& setting, const juce::var& value) override;
+#endif
+
+    private:
+
+        // bitfield index values for all settings that have been set
+        enum ValidSettings
+        {
+            numValuesValid     = 0,
+            historyLengthValid = 1
+        };
+        std::bitset<2> validChannelInformation;
+
+        std::atomic<int> numValues {0};
+
+        juce::MemoryBlock* lastBuffer = nullptr;
+
+        // Plot2D Member functions
+        void beginFrame() override;
+        const float* getBufferForLine (int lineIdx) override;
+        void endFrame() override;
+
+        // ValueTree::Listener functions
+        void valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property) override;
+        void valueTreeChildAdded (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenAdded) override;
+        void valueTreeChildRemoved (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override;
+        void valueTreeChildOrderChanged (juce::ValueTree &parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override;
+        void valueTreeParentChanged (juce::ValueTree &treeWhoseParentHasChanged) override;
+
+        void updateChannelInformation();
+    };
+}
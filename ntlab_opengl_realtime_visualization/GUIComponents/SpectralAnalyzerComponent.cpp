@@ -35,6 +35,7 @@ namespace ntlab
     const juce::Identifier SpectralAnalyzerComponent::parameterHideDC                  ("hideDC");
     const juce::Identifier SpectralAnalyzerComponent::parameterMagnitudeLinearDB       ("magnitudeLinearDB");
     const juce::Identifier SpectralAnalyzerComponent::parameterFrequencyLinearLog      ("frequencyLinearLog");
+    const juce::Identifier SpectralAnalyzerComponent::parameterPreFilterCoefficients   ("preFilterCoefficients");
 
     SpectralAnalyzerComponent::SpectralAnalyzerComponent (const juce::String identifierExtension, WindowOpenGLContext& windowOpenGlContext, juce::UndoManager *undoManager)
     : VisualizationTarget ("SpectralAnalyzer" + identifierExtension, undoManager),
@@ -47,6 +48,7 @@ namespace ntlab
         valueTree.setProperty (parameterHideNegativeFrequencies, true,                            undoManager);
         valueTree.setProperty (parameterMagnitudeLinearDB,       true,                            undoManager);
         valueTree.setProperty (parameterFrequencyLinearLog,      true,                            undoManager);
+        valueTree.setProperty (parameterPreFilterCoefficients,   juce::String(),                  undoManager);
 
         setBackgroundColour (juce::Colours::darkturquoise, false);
 
@@ -93,6 +95,11 @@ namespace ntlab
         valueTree.setProperty (parameterFrequencyLinearLog, shouldBeLog, undoManager);
     }
 
+    void SpectralAnalyzerComponent::setPreFilter (const std::vector<Biquad::Coefficients>& coefficients)
+    {
+        valueTree.setProperty (parameterPreFilterCoefficients, BiquadFilterChain::coefficientsToString (coefficients), undoManager);
+    }
+
     void SpectralAnalyzerComponent::applySettingFromCollector (const juce::String &setting, const juce::var &value)
     {
         if (setting == SpectralDataCollector::settingChannelNames)
@@ -124,9 +131,20 @@ namespace ntlab
             if (value.isInt())
             {
                 valueTree.setProperty (parameterFFTOrder, value, undoManager);
+
+                // the collector might have been registered after the last resize, so make sure it knows the limit
+                sendMaxNumPointsPerLineToCollector();
             }
 
         }
+        else if (setting == SpectralDataCollector::settingNumBinsPerLine)
+        {
+            if (value.isInt())
+            {
+                numBinsPerLine = value;
+                updateFrequencyRangeInformation();
+            }
+        }
         else if (setting == SpectralDataCollector::settingStartFrequency)
         {
             if (value.isDouble())
@@ -145,29 +163,59 @@ namespace ntlab
         }
     }
 
-    void SpectralAnalyzerComponent::resized () {}
+    void SpectralAnalyzerComponent::resized ()
+    {
+        updateMaxNumPointsPerLine();
+    }
 
     void SpectralAnalyzerComponent::beginFrame ()
     {
         if (dataSource != nullptr)
         {
             lastBuffer = &dataSource->startReading (*this);
+            ConstFrame<SpectralDataCollector::Layout> frame (*lastBuffer, numChannels, numBinsPerLine);
 
             // if the buffer supplied doesn't seem to match just give it back directly
-            if (lastBuffer->getSize() != numFFTBins * numChannels * sizeof (float))
+            if (! frame.isValid() || (numBinsPerLine < 2))
             {
                 lastBuffer = nullptr;
                 dataSource->finishedReading (*this);
+                return;
+            }
+
+            mirrorLinesInFrame = showNegativeFrequencies;
+            skipDCInFrame = ! mirrorLinesInFrame && skipDC;
+
+            if (mirrorLinesInFrame)
+            {
+                // The bins above half the sample rate have the magnitudes of the bins below in reverse order, the DC
+                // bin and the bin at half the sample rate have no counterpart
+                const int numBinsBelowHalfSampleRate = numBinsPerLine - 1;
+                const int numValuesPerMirroredLine = 2 * numBinsBelowHalfSampleRate;
+                mirroredLines.resize (static_cast<size_t> (numChannels * numValuesPerMirroredLine));
+
+                for (int c = 0; c < numChannels; ++c)
+                {
+                    const float* bins = frame.getChannel (c);
+                    float* mirroredLine = mirroredLines.data() + c * numValuesPerMirroredLine;
+
+                    std::copy (bins, bins + numBinsPerLine, mirroredLine);
+                    for (int k = numBinsPerLine; k < numValuesPerMirroredLine; ++k)
+                        mirroredLine[k] = bins[numValuesPerMirroredLine - k];
+                }
             }
         }
     }
 
     const float* SpectralAnalyzerComponent::getBufferForLine (int lineIdx)
     {
-        if (lastBuffer != nullptr)
-            return static_cast<float*> (lastBuffer->getData()) + (numFFTBins * lineIdx);
+        if (lastBuffer == nullptr)
+            return nullptr;
+
+        if (mirrorLinesInFrame)
+            return mirroredLines.data() + lineIdx * 2 * (numBinsPerLine - 1);
 
-        return nullptr;
+        return ConstFrame<SpectralDataCollector::Layout> (*lastBuffer, numChannels, numBinsPerLine).getChannel (lineIdx) + (skipDCInFrame ? 1 : 0);
     }
 
     void SpectralAnalyzerComponent::endFrame ()
@@ -185,9 +233,17 @@ namespace ntlab
                 int fftOrder = valueTree.getProperty (property);
                 numFFTBins = 1 << fftOrder;
 
+                // until the collector reports that it combines bins
+                numBinsPerLine = numFFTBins / 2 + 1;
+
                 validChannelInformation.set (numFFTBinsValid);
                 updateChannelInformation();
             }
+            else if (property == parameterPreFilterCoefficients)
+            {
+                if (dataSource != nullptr)
+                    dataSource->applySettingToCollector (*this, SpectralDataCollector::settingPreFilterCoefficients, valueTree.getProperty (property));
+            }
             else if ((property == parameterMagnitudeLinearDB) || (property == parameterMagnitudeRange))
             {
                 bool magnitudeShouldBeLog = valueTree.getProperty (parameterMagnitudeLinearDB);
@@ -207,6 +263,7 @@ namespace ntlab
             else if ((property == parameterFrequencyLinearLog) || (property == parameterHideNegativeFrequencies) || (property == parameterHideDC))
             {
                 updateFrequencyRangeInformation();
+                updateMaxNumPointsPerLine();
             }
         }
     }
@@ -224,26 +281,50 @@ namespace ntlab
 
     void SpectralAnalyzerComponent::updateFrequencyRangeInformation ()
     {
-        if (!frequencyRange.isEmpty())
+        if (!frequencyRange.isEmpty() && (numBinsPerLine > 1))
         {
-            float frequencySpacing = frequencyRange.getLength() / numFFTBins;
-
-            auto frequencyRangeToUse = frequencyRange;
+            // The lines sent hold numBinsPerLine values from the start frequency up to and including half the span
+            const int numBinsBelowHalfSampleRate = numBinsPerLine - 1;
+            const float halfSpan = frequencyRange.getLength() / 2;
+            const float frequencySpacing = halfSpan / numBinsBelowHalfSampleRate;
 
-            if (valueTree.getProperty (parameterHideNegativeFrequencies))
-            {
-                if (valueTree.getProperty (parameterHideDC))
-                    frequencyRangeToUse = juce::Range<float> (frequencySpacing, frequencyRange.getEnd() / 2);
-                else
-                    frequencyRangeToUse = frequencyRange.withEnd (frequencyRange.getEnd() / 2);
-            }
+            const bool hideNegative = valueTree.getProperty (parameterHideNegativeFrequencies);
+            const bool hideDC = hideNegative && static_cast<bool> (valueTree.getProperty (parameterHideDC));
+            showNegativeFrequencies = ! hideNegative;
+            skipDC = hideDC;
 
             LogScaling scalingToUse = none;
 
             if (valueTree.getProperty (parameterFrequencyLinearLog))
                 scalingToUse = baseE;
 
-            setXValues (frequencyRangeToUse, frequencySpacing, scalingToUse);
+            // The range passed to setXValues excludes its end, so it is extended by one bin to include half the span
+            const float firstFrequency = frequencyRange.getStart() + (hideDC ? frequencySpacing : 0.0f);
+            const float lastFrequency  = frequencyRange.getStart() + halfSpan;
+
+            if (hideNegative)
+                setXValues ({ firstFrequency, lastFrequency + frequencySpacing }, numBinsPerLine - (hideDC ? 1 : 0), scalingToUse);
+            else
+                setXValues (frequencyRange, 2 * numBinsBelowHalfSampleRate, scalingToUse);
         }
     }
+
+    void SpectralAnalyzerComponent::updateMaxNumPointsPerLine ()
+    {
+        // Combining bins equally spaced in frequency would remove details at low frequencies on a logarithmic axis
+        if (valueTree.getProperty (parameterFrequencyLinearLog))
+            maxNumPointsPerLine = 0;
+        else if (valueTree.getProperty (parameterHideNegativeFrequencies))
+            maxNumPointsPerLine = getPhysicalWidth();
+        else
+            maxNumPointsPerLine = getPhysicalWidth() / 2;
+
+        sendMaxNumPointsPerLineToCollector();
+    }
+
+    void SpectralAnalyzerComponent::sendMaxNumPointsPerLineToCollector ()
+    {
+        if (dataSource != nullptr)
+            dataSource->applySettingToCollector (*this, SpectralDataCollector::settingMaxNumPointsPerLine, maxNumPointsPerLine.load());
+    }
 }
\ No newline at end of file
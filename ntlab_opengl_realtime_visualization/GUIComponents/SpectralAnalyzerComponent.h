@@ -27,14 +27,15 @@ SOFTWARE.
 
 #include <bitset>
 #include "../RealtimeDataTransfer/VisualizationDataSource.h"
+#include "../DSP/Biquad.h"
 #include "../2DPlot/Plot2D.h"
 
 namespace ntlab
 {
     /**
      * The Component designed to visualize frequency-domain data collected by a SpectralDataCollector instance.
-     * It exports the parameters fFTOrder, hideNegativeFrequencies, hideDC, magnitudeLinearDB, frequencyLinearLog
-     * to the VisualizationTarget valueTree member. It inherits ntlab::Plot2D and therefore uses OpenGL for rendering.
+     * It exports the parameters fFTOrder, hideNegativeFrequencies, hideDC, magnitudeLinearDB, frequencyLinearLog and
+     * preFilterCoefficients to the VisualizationTarget valueTree member. It inherits ntlab::Plot2D and therefore uses OpenGL for rendering.
      */
     class SpectralAnalyzerComponent : public ntlab::VisualizationTarget, public ntlab::Plot2D, private juce::ValueTree::Listener
     {
@@ -61,6 +62,13 @@ namespace ntlab
          */
         static const juce::Identifier parameterFrequencyLinearLog;
 
+        /**
+         * A string containing the serialized coefficients of the biquad sections the collector applies to the signal
+         * before transforming it, as created by BiquadFilterChain::coefficientsToString. An empty string disables
+         * filtering.
+         */
+        static const juce::Identifier parameterPreFilterCoefficients;
+
         /**
          * Specifiy an identifier extension to map the SpectralAnalyzerComponent to the corresponding source.
          * The Identifier will automatically be prepended by "SpectralAnalyzer". The optional undo manager can
@@ -90,6 +98,13 @@ namespace ntlab
          */
         void setFrequencyAxisScaling (bool shouldBeLog);
 
+        /**
+         * Sets the biquad sections the collector applies to all channels before transforming them. Pass an empty
+         * vector to disable filtering. Calling this is equal to updating the parameterPreFilterCoefficients property
+         * of the value tree.
+         */
+        void setPreFilter (const std::vector<Biquad::Coefficients>& coefficients);
+
 #ifndef DOXYGEN
         void applySettingFromCollector (const juce::String& setting, const juce::var& value) override;
         void resized() override;
@@ -108,6 +123,20 @@ namespace ntlab
 
         int numChannels = 0;
         int numFFTBins = 0;
+
+        // The collector only sends the bins from DC up to half the sample rate and might combine neighbouring bins if
+        // there are more bins than pixels
+        int numBinsPerLine = 0;
+        std::atomic<int> maxNumPointsPerLine {0};
+
+        // Set on the message thread, read once per frame on the OpenGL thread
+        std::atomic<bool> showNegativeFrequencies {false};
+        std::atomic<bool> skipDC {false};
+
+        // If the negative frequencies are shown, the lines are mirrored into this buffer on the OpenGL thread
+        bool mirrorLinesInFrame = false;
+        bool skipDCInFrame = false;
+        std::vector<float> mirroredLines;
         juce::StringArray channelNames;
         juce::Range<float> frequencyRange;
 
@@ -127,5 +156,7 @@ namespace ntlab
 
         void updateChannelInformation();
         void updateFrequencyRangeInformation();
+        void updateMaxNumPointsPerLine();
+        void sendMaxNumPointsPerLineToCollector();
     };
 }
@@ -0,0 +1,330 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "CrossCorrelationDataCollector.h"
+
+namespace ntlab
+{
+    CrossCorrelationDataCollector::PairWorker::PairWorker (CrossCorrelationDataCollector& ownerToUse, int fftOrder)
+    : juce::Thread ("Cross Correlation Worker"),
+      owner (ownerToUse)
+    {
+        inverseFFT.prepare (fftOrder);
+        correlation.allocate (inverseFFT.getNumFloatsForBuffer(), true);
+    }
+
+    void CrossCorrelationDataCollector::PairWorker::run()
+    {
+        while (!threadShouldExit())
+        {
+            if (spectraAvailable.wait (100))
+                owner.processPairs (*this);
+        }
+    }
+
+    CrossCorrelationDataCollector::CrossCorrelationDataCollector (const juce::String identifierExtension)
+    : FFTDataCollector ("CrossCorrelation" + identifierExtension)
+    {
+        prepareFFT (12, juce::dsp::WindowingFunction<float>::hann);
+    }
+
+    CrossCorrelationDataCollector::~CrossCorrelationDataCollector()
+    {
+        waitForWorkers();
+
+        for (auto& worker : workers)
+        {
+            worker->signalThreadShouldExit();
+            worker->spectraAvailable.signal();
+            worker->stopThread (1000);
+        }
+    }
+
+    void CrossCorrelationDataCollector::setChannelPairs (int numChannels, const juce::Array<std::pair<int, int>>& channelPairs, juce::StringArray channelNames)
+    {
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        waitForWorkers();
+
+        if (channelNames.size() != numChannels)
+        {
+            channelNames.clear();
+            for (int n = 0; n < numChannels; ++n)
+                channelNames.add (juce::String (n + 1));
+        }
+
+        this->channelNames = channelNames;
+        this->channelPairs.clearQuick();
+        pairNames.clearQuick();
+
+        for (auto& pair : channelPairs)
+        {
+            // A channel index of this pair is out of range
+            jassert (juce::isPositiveAndBelow (pair.first, numChannels) && juce::isPositiveAndBelow (pair.second, numChannels));
+
+            if (juce::isPositiveAndBelow (pair.first, numChannels) && juce::isPositiveAndBelow (pair.second, numChannels))
+            {
+                this->channelPairs.add (pair);
+                pairNames.add (channelNames[pair.first] + " / " + channelNames[pair.second]);
+            }
+        }
+
+        prepareChannels (numChannels);
+        recalculateMemory();
+        updateGUIPairs();
+    }
+
+    void CrossCorrelationDataCollector::setFFTOrder (int newFFTOrder)
+    {
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        waitForWorkers();
+
+        prepareFFT (newFFTOrder, juce::dsp::WindowingFunction<float>::hann);
+        recalculateMemory();
+        updateGUIFFTOrder();
+    }
+
+    void CrossCorrelationDataCollector::setMaxLag (int maxLagInSamples)
+    {
+        jassert (maxLagInSamples > 0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        waitForWorkers();
+
+        maxLag = maxLagInSamples;
+        recalculateMemory();
+        updateGUIPairs();
+    }
+
+    void CrossCorrelationDataCollector::setSampleRate (double newSampleRate)
+    {
+        jassert (newSampleRate > 0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        sampleRate = newSampleRate;
+        updateGUISampleRate();
+    }
+
+    void CrossCorrelationDataCollector::setMaxNumWorkerThreads (int maxNumThreads)
+    {
+        jassert (maxNumThreads > 0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        waitForWorkers();
+
+        maxNumWorkers = juce::jmax (1, maxNumThreads);
+        recalculateMemory();
+    }
+
+    void CrossCorrelationDataCollector::applySettingFromTarget (const juce::String& setting, const juce::var& value)
+    {
+        if (setting == settingFFTOrder)
+        {
+            if (value.isInt())
+                setFFTOrder (value);
+        }
+        else if (setting == settingMaxLag)
+        {
+            if (value.isInt())
+                setMaxLag (value);
+        }
+    }
+
+    void CrossCorrelationDataCollector::processSpectra()
+    {
+        if ((sampleRate <= 0.0) || workers.empty())
+            return;
+
+        // The workers are still busy with the last block
+        if (pairsInProgress.exchange (true))
+            return;
+
+        std::copy (getSpectrum (0), getSpectrum (numFFTChannels), spectraSnapshot.get());
+
+        // The pair counter is reset last, as workers still leaving the last round might already grab a new pair
+        numPairsRemaining = channelPairs.size();
+        nextPairIdx = 0;
+
+        for (auto& worker : workers)
+            worker->spectraAvailable.signal();
+    }
+
+    void CrossCorrelationDataCollector::processPairs (PairWorker& worker)
+    {
+        const int numPairs = channelPairs.size();
+
+        for (int pairIdx = nextPairIdx++; pairIdx < numPairs; pairIdx = nextPairIdx++)
+        {
+            processPair (pairIdx, worker);
+
+            // The worker finishing the last pair sends the results
+            if (--numPairsRemaining == 0)
+            {
+                publishResults();
+                pairsInProgress = false;
+            }
+        }
+    }
+
+    void CrossCorrelationDataCollector::processPair (int pairIdx, PairWorker& worker)
+    {
+        const auto& pair = channelPairs.getReference (pairIdx);
+        const int numSpectrumBins = getNumSpectrumBins();
+        const std::complex<float>* spectrumA = spectraSnapshot.get() + pair.first  * numSpectrumBins;
+        const std::complex<float>* spectrumB = spectraSnapshot.get() + pair.second * numSpectrumBins;
+        float* correlation = worker.correlation.get();
+        std::complex<float>* crossSpectrum = RealFFT::getBins (correlation);
+
+        // The phase transform normalizes each bin of the cross spectrum to a magnitude of one, which sharpens the
+        // correlation peak and makes its height independent of the signal spectrum. As the correlation is real, the
+        // bins of the non-negative frequencies are sufficient
+        for (int k = 0; k < numSpectrumBins; ++k)
+        {
+            const std::complex<float> product = spectrumA[k] * std::conj (spectrumB[k]);
+            const float magnitude = std::abs (product);
+            crossSpectrum[k] = (magnitude > 1e-12f) ? product / magnitude : std::complex<float> (0.0f, 0.0f);
+        }
+
+        worker.inverseFFT.performInverse (correlation);
+
+        // Negative lags are found at the end of the circular correlation
+        float* pairResults = results.data() + pairIdx * numValuesPerPair;
+        float* curve = pairResults + firstCurveValue;
+        const int numCurveValues = 2 * maxLag + 1;
+
+        for (int i = 0; i < numCurveValues; ++i)
+            curve[i] = correlation[(i - maxLag + numSamplesExpected) % numSamplesExpected];
+
+        const int peakIdx = static_cast<int> (std::max_element (curve, curve + numCurveValues) - curve);
+        float delta = 0.0f;
+        float peakHeight = curve[peakIdx];
+
+        // A parabola through the peak and its neighbours estimates the sub-sample position of the peak
+        if ((peakIdx > 0) && (peakIdx < numCurveValues - 1))
+        {
+            const float left   = curve[peakIdx - 1];
+            const float right  = curve[peakIdx + 1];
+            const float curvature = left - 2.0f * peakHeight + right;
+
+            if (curvature < 0.0f)
+            {
+                delta = 0.5f * (left - right) / curvature;
+                peakHeight -= 0.25f * (left - right) * delta;
+            }
+        }
+
+        pairResults[peakLag]   = static_cast<float> ((peakIdx - maxLag + delta) / sampleRate);
+        pairResults[peakValue] = peakHeight;
+    }
+
+    void CrossCorrelationDataCollector::publishResults()
+    {
+        auto* block = startWriting();
+
+        // If the results could not be sent, this block is skipped
+        if (block == nullptr)
+            return;
+
+        Frame<Layout> frame (*block, channelPairs.size(), numValuesPerPair);
+
+        if (frame.isValid())
+            std::copy (results.begin(), results.end(), frame.getValues());
+        else
+            block->fillWith (0);
+
+        finishedWriting();
+    }
+
+    void CrossCorrelationDataCollector::waitForWorkers()
+    {
+        while (pairsInProgress)
+            juce::Thread::sleep (1);
+    }
+
+    void CrossCorrelationDataCollector::recalculateMemory()
+    {
+        for (auto& worker : workers)
+        {
+            worker->signalThreadShouldExit();
+            worker->spectraAvailable.signal();
+            worker->stopThread (1000);
+        }
+
+        workers.clear();
+
+        const int numWorkers = std::min (maxNumWorkers, channelPairs.size());
+        for (int w = 0; w < numWorkers; ++w)
+        {
+            workers.emplace_back (new PairWorker (*this, fftOrder));
+            workers.back()->startThread();
+        }
+
+        // The circular correlation can only hold lags up to half the FFT length
+        maxLag = juce::jlimit (1, numSamplesExpected / 2 - 1, maxLag);
+        numValuesPerPair = firstCurveValue + 2 * maxLag + 1;
+
+        spectraSnapshot.allocate (numFFTChannels * getNumSpectrumBins(), true);
+        results.assign (static_cast<size_t> (channelPairs.size() * numValuesPerPair), 0.0f);
+        resizeMemoryBlock (results.size() * sizeof (float));
+    }
+
+    void CrossCorrelationDataCollector::updateAllGUIParameters()
+    {
+        updateGUIPairs();
+        updateGUIFFTOrder();
+        updateGUISampleRate();
+    }
+
+    void CrossCorrelationDataCollector::updateGUIPairs()
+    {
+        juce::var np (channelPairs.size());
+        juce::var pn (pairNames);
+        juce::var ml (maxLag);
+        sink->applySettingToTarget (*this, settingNumPairs, np);
+        sink->applySettingToTarget (*this, settingPairNames, pn);
+        sink->applySettingToTarget (*this, settingMaxLag, ml);
+    }
+
+    void CrossCorrelationDataCollector::updateGUIFFTOrder()
+    {
+        juce::var fo (fftOrder);
+        sink->applySettingToTarget (*this, settingFFTOrder, fo);
+
+        // The maximum lag might have been limited by the new FFT length
+        juce::var ml (maxLag);
+        sink->applySettingToTarget (*this, settingMaxLag, ml);
+    }
+
+    void CrossCorrelationDataCollector::updateGUISampleRate()
+    {
+        juce::var sr (sampleRate);
+        sink->applySettingToTarget (*this, settingSampleRate, sr);
+    }
+
+    const juce::String CrossCorrelationDataCollector::settingNumPairs   ("numPairs");
+    const juce::String CrossCorrelationDataCollector::settingPairNames  ("pairNames");
+    const juce::String CrossCorrelationDataCollector::settingMaxLag     ("maxLag");
+    const juce::String CrossCorrelationDataCollector::settingFFTOrder   ("fftOrder");
+    const juce::String CrossCorrelationDataCollector::settingSampleRate ("sampleRate");
+}
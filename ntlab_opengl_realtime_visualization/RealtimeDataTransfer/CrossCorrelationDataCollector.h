@@ -0,0 +1,175 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+#include "RealtimeDataSink.h"
+#include "FFTDataCollector.h"
+#include "Frame.h"
+
+namespace ntlab
+{
+    /**
+     * An object that estimates the time delay between pairs of channels of a realtime stream by computing their
+     * generalized cross-correlation with phase transform (GCC-PHAT) and periodically sends the results to a
+     * corresponding VisualizationTarget, normally a CrossCorrelationComponent.
+     *
+     * The samples are collected and transformed by the FFTDataCollector base class. For each pair, the cross spectrum
+     * is whitened, so that only its phase remains, and transformed back into a correlation curve. The peak of the
+     * curve marks the delay, it is refined with a parabolic interpolation to sub-sample resolution. A positive lag
+     * means that the first channel of a pair is delayed relative to the second channel.
+     *
+     * The pairs are processed by a set of worker threads, so the realtime thread only needs to compute one FFT per
+     * channel. If the workers are still busy with the last block when the next block is ready, that block is skipped.
+     *
+     * For each pair a frame contains the peak lag in seconds, the peak value and the correlation curve from -maxLag to
+     * maxLag samples.
+     *
+     * @see RealtimeDataSink, @see VisualisationDataSource, @see VisualizationTarget, @see CrossCorrelationComponent
+     */
+    class CrossCorrelationDataCollector : public FFTDataCollector
+    {
+    public:
+        static const juce::String settingNumPairs;
+        static const juce::String settingPairNames;
+        static const juce::String settingMaxLag;
+        static const juce::String settingFFTOrder;
+        static const juce::String settingSampleRate;
+
+        /** The indices of the values for each pair in a frame */
+        enum PairLayout
+        {
+            peakLag        = 0,
+            peakValue      = 1,
+            firstCurveValue = 2
+        };
+
+        /** Each frame holds the values of all pairs, each one laid out as described by PairLayout */
+        using Layout = FrameLayout<float>;
+
+        /**
+         * Specify an identifier extension to map the DataCollector to the corresponding target.
+         * The Identifier will automatically be prepended by "CrossCorrelation"
+         */
+        CrossCorrelationDataCollector (const juce::String identifierExtension = "1");
+
+        ~CrossCorrelationDataCollector();
+
+        /**
+         * Sets the number of channels pushed and the pairs of channels analyzed. Keep in mind that the next call to
+         * pushChannelSamples will expect a matching new number of channels so better don't call this while realtime
+         * sample processing is running.
+         * @param numChannels    The number of channels pushed
+         * @param channelPairs   The indices of the two channels of each pair
+         * @param channelNames   An Array of size numChannels containing the names of the channels
+         */
+        void setChannelPairs (int numChannels, const juce::Array<std::pair<int, int>>& channelPairs, juce::StringArray channelNames = juce::StringArray());
+
+        /**
+         * Sets the order of the FFT used. The FFT length limits the maximum delay that can be measured, it should be at
+         * least four times the maximum lag. The default value is an order of 12 resulting in an FFT length of 4096.
+         */
+        void setFFTOrder (int newFFTOrder);
+
+        /** Sets the largest lag in samples contained in the correlation curves sent */
+        void setMaxLag (int maxLagInSamples);
+
+        /** Sets the sample rate used. No data will be sent until the sample rate was set. */
+        void setSampleRate (double newSampleRate);
+
+        /**
+         * Sets the maximum number of worker threads used to process the pairs. By default, one thread less than the
+         * number of CPUs is used. There are never more threads than pairs.
+         */
+        void setMaxNumWorkerThreads (int maxNumThreads);
+
+        /**
+         * Updates all parameters relevant for the Visualization. Call this after (re-)connecting if your collector
+         * to sink connection is network based to keep both ends in sync.
+         */
+        void updateAllGUIParameters();
+
+        void applySettingFromTarget (const juce::String& setting, const juce::var& value) override;
+
+    private:
+
+        /** Waits for new spectra and processes pairs until no pair is left */
+        class PairWorker : public juce::Thread
+        {
+        public:
+            PairWorker (CrossCorrelationDataCollector& owner, int fftOrder);
+
+            void run() override;
+
+            juce::WaitableEvent spectraAvailable;
+
+        private:
+            CrossCorrelationDataCollector& owner;
+
+            // Each worker needs its own FFT instance for the inverse FFT, as it holds the scratch buffer of the
+            // transform. The cross spectrum is transformed in place into the correlation
+            RealFFT inverseFFT;
+            juce::HeapBlock<float> correlation;
+
+            friend class CrossCorrelationDataCollector;
+        };
+
+        // Pairs
+        juce::Array<std::pair<int, int>> channelPairs;
+        juce::StringArray channelNames;
+        juce::StringArray pairNames;
+        int maxLag = 64;
+        double sampleRate = 0.0;
+
+        // The spectra of all channels are copied here before the workers are started, so that the realtime thread can
+        // already collect the next block
+        juce::HeapBlock<std::complex<float>> spectraSnapshot;
+        std::vector<float> results;
+        int numValuesPerPair = 0;
+
+        // Workers
+        std::vector<std::unique_ptr<PairWorker>> workers;
+        int maxNumWorkers = juce::jmax (1, juce::SystemStats::getNumCpus() - 1);
+        std::atomic<bool> pairsInProgress {false};
+        std::atomic<int>  nextPairIdx {0};
+        std::atomic<int>  numPairsRemaining {0};
+
+        void processSpectra() override;
+
+        void processPairs (PairWorker& worker);
+        void processPair (int pairIdx, PairWorker& worker);
+        void publishResults();
+
+        void waitForWorkers();
+        void recalculateMemory();
+
+        void updateGUIPairs();
+        void updateGUIFFTOrder();
+        void updateGUISampleRate();
+    };
+}
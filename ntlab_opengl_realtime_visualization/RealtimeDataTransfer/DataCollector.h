@@ -77,6 +77,7 @@ namespace ntlab
             if (readBufferLock.try_lock())
             {
                 writeBlock.swapWith (readBlock);
+                lastBlockRead = false;
                 writeBufferLock.unlock();
                 readBufferLock.unlock();
                 dataBlockReady (sinkIdx);
@@ -109,9 +110,13 @@ namespace ntlab
         {
             if (readBlock.getSize() != expectedBlockSize)
                 readBlock.setSize (expectedBlockSize, true);
+
+            lastBlockRead = true;
+
             if (readerShouldSwapBlocks)
             {
                 writeBlock.swapWith (readBlock);
+                lastBlockRead = false;
                 writeBufferLock.unlock();
                 readerShouldSwapBlocks = false;
                 dataBlockReady (sinkIdx);
@@ -120,6 +125,12 @@ namespace ntlab
             readBufferLock.unlock();
         };
 
+        /**
+         * Returns true if the sink has read the block sent last. Collectors sending incremental data can use this to
+         * keep adding data to their current block instead of replacing a block that has not been read yet.
+         */
+        bool lastBlockWasRead() const { return lastBlockRead; }
+
         /** For internal use only, don't change */
         int sinkIdx = -1;
 
@@ -134,6 +145,7 @@ namespace ntlab
         juce::MemoryBlock writeBlock;
 
         bool readerShouldSwapBlocks = false;
+        std::atomic<bool> lastBlockRead {true};
 
         std::mutex readBufferLock, writeBufferLock;
 
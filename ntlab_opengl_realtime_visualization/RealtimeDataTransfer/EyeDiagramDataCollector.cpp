@@ -0,0 +1,297 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "EyeDiagramDataCollector.h"
+#include "../Utilities/SerializableRange.h"
+
+namespace ntlab
+{
+    void EyeDiagramDataCollector::setSampleRate (double newSampleRate)
+    {
+        jassert (newSampleRate > 0);
+        tSample = 1.0 / newSampleRate;
+        recalculateTimebase();
+    }
+
+    void EyeDiagramDataCollector::setSymbolRate (double newSymbolRate)
+    {
+        jassert (newSymbolRate > 0);
+        tSymbol = 1.0 / newSymbolRate;
+        recalculateTimebase();
+    }
+
+    void EyeDiagramDataCollector::setSymbolPhase (double phaseInSymbolPeriods)
+    {
+        jassert (juce::isPositiveAndNotGreaterThan (phaseInSymbolPeriods, 1.0));
+        symbolPhase = phaseInSymbolPeriods;
+    }
+
+    void EyeDiagramDataCollector::setHistogramSize (int numColumnsPerSymbol, int numAmplitudeBins)
+    {
+        jassert (numColumnsPerSymbol > 1);
+        jassert (numAmplitudeBins > 1);
+
+        this->numColumnsPerSymbol = numColumnsPerSymbol;
+        this->numAmplitudeBins = numAmplitudeBins;
+
+        recalculateTimebase();
+        recalculateMemory();
+    }
+
+    void EyeDiagramDataCollector::setAmplitudeRange (juce::Range<float> newAmplitudeRange)
+    {
+        jassert (!newAmplitudeRange.isEmpty());
+        amplitudeRange = newAmplitudeRange;
+        recalculateMemory();
+    }
+
+    void EyeDiagramDataCollector::setNumSymbolsPerUpdate (int numSymbols)
+    {
+        jassert (numSymbols > 0);
+        numSymbolsPerUpdate = numSymbols;
+    }
+
+    void EyeDiagramDataCollector::setPersistence (float newPersistence)
+    {
+        jassert (juce::isPositiveAndBelow (newPersistence, 1.0f));
+        persistence = newPersistence;
+    }
+
+    void EyeDiagramDataCollector::setChannelToAnalyze (int channel)
+    {
+        jassert (channel >= 0);
+        channelToAnalyze = channel;
+    }
+
+    void EyeDiagramDataCollector::pushChannelsSamples (juce::AudioBuffer<float>& bufferToPush)
+    {
+        const int numSamples = bufferToPush.getNumSamples();
+
+        if ((resamplingStep <= 0.0) || histogram.empty() || (numSamples == 0))
+            return;
+
+        // Make sure to push a buffer containing the channel to analyze
+        jassert (channelToAnalyze < bufferToPush.getNumChannels());
+        if (channelToAnalyze >= bufferToPush.getNumChannels())
+            return;
+
+        const float* samples = bufferToPush.getReadPointer (channelToAnalyze);
+        const double lastInterpolationPosition = numSamples - 1;
+        const int columnOffset = juce::roundToInt (symbolPhase * numColumnsPerSymbol) % numColumnsPerSymbol;
+
+        double position = nextPointPosition;
+
+        // Resample the signal in chunks of points, a position between -1 and 0 is interpolated with the last sample
+        // of the previous buffer
+        while (position < lastInterpolationPosition)
+        {
+            int numPoints = 0;
+
+            while ((numPoints < resamplingChunkSize) && (position < lastInterpolationPosition))
+            {
+                const int idx = static_cast<int> (std::floor (position));
+                const float frac = static_cast<float> (position - idx);
+                const float a = (idx < 0) ? lastSample : samples[idx];
+                const float b = samples[idx + 1];
+
+                resampledValues[numPoints]  = a + frac * (b - a);
+                resampledColumns[numPoints] = (currentColumn + columnOffset) % numColumnsPerSymbol;
+
+                if (++currentColumn == numColumnsPerSymbol)
+                {
+                    currentColumn = 0;
+                    ++numSymbolsAccumulated;
+                }
+
+                position += resamplingStep;
+                ++numPoints;
+            }
+
+            accumulateChunk (numPoints);
+        }
+
+        nextPointPosition = position - numSamples;
+        lastSample = samples[numSamples - 1];
+
+        if (numSymbolsAccumulated >= numSymbolsPerUpdate)
+            publishHistogram();
+    }
+
+    void EyeDiagramDataCollector::applySettingFromTarget (const juce::String& setting, const juce::var& value)
+    {
+        if (setting == settingPersistence)
+        {
+            if (value.isDouble())
+                setPersistence (static_cast<float> (static_cast<double> (value)));
+        }
+        else if (setting == settingAmplitudeRange)
+        {
+            if (value.isString())
+                setAmplitudeRange (SerializableRange<float> (value));
+        }
+    }
+
+    void EyeDiagramDataCollector::accumulateChunk (int numPoints)
+    {
+        // Compute the amplitude bins of the whole chunk with vector operations
+        const float binsPerAmplitude = numAmplitudeBins / amplitudeRange.getLength();
+        juce::FloatVectorOperations::add      (resampledValues, -amplitudeRange.getStart(), numPoints);
+        juce::FloatVectorOperations::multiply (resampledValues, binsPerAmplitude, numPoints);
+        juce::FloatVectorOperations::clip     (resampledValues, resampledValues, 0.0f, numAmplitudeBins - 1.0f, numPoints);
+
+        // NaN is not clipped, so it is mapped to the lowest bin instead of converting it to an int
+        int* bins = amplitudeBins + 1;
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const float value = resampledValues[i];
+            bins[i] = juce::jlimit (0, numAmplitudeBins - 1, static_cast<int> ((value == value) ? value : 0.0f));
+        }
+
+        amplitudeBins[0] = (lastAmplitudeBin < 0) ? bins[0] : lastAmplitudeBin;
+        lastAmplitudeBin = bins[numPoints - 1];
+
+        // All bins between the previous and the current point are hit, so that steep edges stay connected. Instead of
+        // incrementing each of them, the start and the end of the span are marked, which is independent of its length
+        float* edges = hitEdges.data();
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const int lowestBin  = std::min (bins[i], amplitudeBins[i] + 1);
+            const int highestBin = std::max (bins[i], amplitudeBins[i] - 1);
+            const int column = resampledColumns[i];
+
+            edges[lowestBin        * numColumnsPerSymbol + column] += 1.0f;
+            edges[(highestBin + 1) * numColumnsPerSymbol + column] -= 1.0f;
+        }
+    }
+
+    void EyeDiagramDataCollector::integrateHitEdges()
+    {
+        // Each row of edges holds the change of the hit count compared to the row below, so summing them up row by
+        // row gives the hits of each bin. This works on whole rows, so it is done with vector operations
+        float* hits  = histogram.data();
+        float* edges = hitEdges.data();
+
+        for (int b = 1; b < numAmplitudeBins; ++b)
+            juce::FloatVectorOperations::add (edges + b * numColumnsPerSymbol, edges + (b - 1) * numColumnsPerSymbol, numColumnsPerSymbol);
+
+        juce::FloatVectorOperations::add (hits, edges, numColumnsPerSymbol * numAmplitudeBins);
+        std::fill (hitEdges.begin(), hitEdges.end(), 0.0f);
+    }
+
+    void EyeDiagramDataCollector::publishHistogram()
+    {
+        // If the target is still reading the last histogram, keep accumulating and try again with the next buffer
+        auto* block = startWriting();
+        if (block == nullptr)
+            return;
+
+        integrateHitEdges();
+
+        const size_t numBins = histogram.size();
+        Frame<Layout> frame (*block, numAmplitudeBins, numColumnsPerSymbol);
+
+        if (frame.isValid())
+        {
+            // Map the hit counts to 8 bit densities on a log scale, as the counts span multiple orders of magnitude
+            auto* densities = frame.getValues();
+            const float maxNumHits = *std::max_element (histogram.begin(), histogram.end());
+            const float normalization = (maxNumHits > 0.0f) ? 255.0f / std::log1p (maxNumHits) : 0.0f;
+
+            for (size_t i = 0; i < numBins; ++i)
+                densities[i] = static_cast<juce::uint8> (juce::roundToInt (std::log1p (histogram[i]) * normalization));
+        }
+        else
+        {
+            block->fillWith (0);
+        }
+
+        finishedWriting();
+
+        numSymbolsAccumulated = 0;
+
+        if (persistence > 0.0f)
+            juce::FloatVectorOperations::multiply (histogram.data(), persistence, static_cast<int> (numBins));
+        else
+            std::fill (histogram.begin(), histogram.end(), 0.0f);
+    }
+
+    void EyeDiagramDataCollector::recalculateTimebase()
+    {
+        // Both the sample rate and the symbol rate are needed
+        if ((tSample <= 0.0) || (tSymbol <= 0.0))
+            return;
+
+        resamplingStep = (tSymbol / tSample) / numColumnsPerSymbol;
+        nextPointPosition = 0.0;
+        currentColumn = 0;
+
+        if (histogram.empty())
+            recalculateMemory();
+
+        updateGUITimebase();
+    }
+
+    void EyeDiagramDataCollector::recalculateMemory()
+    {
+        const size_t numBins = static_cast<size_t> (numColumnsPerSymbol * numAmplitudeBins);
+
+        histogram.assign (numBins, 0.0f);
+        hitEdges.assign (numBins + static_cast<size_t> (numColumnsPerSymbol), 0.0f);
+        resizeMemoryBlock (Layout::getNumBytes (numAmplitudeBins, numColumnsPerSymbol));
+
+        numSymbolsAccumulated = 0;
+        lastAmplitudeBin = -1;
+
+        updateGUIHistogram();
+    }
+
+    void EyeDiagramDataCollector::updateAllGUIParameters()
+    {
+        updateGUITimebase();
+        updateGUIHistogram();
+    }
+
+    void EyeDiagramDataCollector::updateGUITimebase()
+    {
+        juce::var ts (tSymbol);
+        sink->applySettingToTarget (*this, settingSymbolPeriod, ts);
+    }
+
+    void EyeDiagramDataCollector::updateGUIHistogram()
+    {
+        juce::var nc (numColumnsPerSymbol);
+        juce::var nb (numAmplitudeBins);
+        juce::var ar (SerializableRange<float> (amplitudeRange).toString());
+        sink->applySettingToTarget (*this, settingNumColumnsPerSymbol, nc);
+        sink->applySettingToTarget (*this, settingNumAmplitudeBins, nb);
+        sink->applySettingToTarget (*this, settingAmplitudeRange, ar);
+    }
+
+    const juce::String EyeDiagramDataCollector::settingSymbolPeriod        ("symbolPeriod");
+    const juce::String EyeDiagramDataCollector::settingNumColumnsPerSymbol ("numColumnsPerSymbol");
+    const juce::String EyeDiagramDataCollector::settingNumAmplitudeBins    ("numAmplitudeBins");
+    const juce::String EyeDiagramDataCollector::settingAmplitudeRange      ("amplitudeRange");
+    const juce::String EyeDiagramDataCollector::settingPersistence         ("persistence");
+}
@@ -0,0 +1,173 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "RealtimeDataSink.h"
+#include "DataCollector.h"
+#include "Frame.h"
+
+namespace ntlab
+{
+    /**
+     * An object that collects samples of a serial data signal from a realtime stream and accumulates them into a 2D
+     * hit histogram, forming an eye diagram. The signal is resampled at a configurable number of points per symbol
+     * period through linear interpolation, so the symbol rate does not need to be an integer fraction of the sample
+     * rate. Each point increments the histogram bin matching its phase within the symbol period and its amplitude.
+     * Transitions spanning multiple amplitude bins between two points are filled, so steep edges stay connected.
+     *
+     * As the eye diagram is built from overlapping segments starting at every symbol, it is periodic with the symbol
+     * period. Therefore only the histogram of one symbol period is collected and sent, the EyeDiagramComponent tiles
+     * it to display multiple symbol periods. Only the compact histogram is sent to the target, normalized to 8 bit
+     * densities on a logarithmic scale, so the cost of the visualization doesn't depend on the number of symbols
+     * accumulated.
+     *
+     * There is no clock recovery, the symbols are assumed to be aligned to the sample stream with a constant phase
+     * offset that can be adjusted through setSymbolPhase.
+     *
+     * @see RealtimeDataSink, @see VisualisationDataSource, @see VisualizationTarget, @see EyeDiagramComponent
+     */
+    class EyeDiagramDataCollector : public DataCollector
+    {
+    public:
+        static const juce::String settingSymbolPeriod;
+        static const juce::String settingNumColumnsPerSymbol;
+        static const juce::String settingNumAmplitudeBins;
+        static const juce::String settingAmplitudeRange;
+        static const juce::String settingPersistence;
+
+        /**
+         * Each frame holds the 8 bit densities of the histogram, with one channel per amplitude bin from the lowest
+         * amplitude upwards and one value per column
+         */
+        using Layout = FrameLayout<juce::uint8>;
+
+        /**
+         * Specify an identifier extension to map the DataCollector to the corresponding target.
+         * The Identifier will automatically be prepended by "EyeDiagram"
+         */
+        EyeDiagramDataCollector (const juce::String identifierExtension = "1") : DataCollector ("EyeDiagram" + identifierExtension) {};
+
+        virtual ~EyeDiagramDataCollector () {};
+
+        /** Sets the sample rate used. The eye diagram won't display any data until both sample and symbol rate are set */
+        void setSampleRate (double newSampleRate);
+
+        /** Sets the symbol rate of the signal analyzed */
+        void setSymbolRate (double newSymbolRate);
+
+        /**
+         * Shifts the sampling of the symbol periods by a fraction of a symbol period to align the eye diagram to the
+         * symbol transitions of the signal. Valid values are in the range 0...1
+         */
+        void setSymbolPhase (double phaseInSymbolPeriods);
+
+        /**
+         * Sets the resolution of the histogram. The number of columns is the number of points the signal is resampled
+         * to per symbol period, the number of amplitude bins is the vertical resolution.
+         */
+        void setHistogramSize (int numColumnsPerSymbol, int numAmplitudeBins);
+
+        /** Sets the range of amplitudes mapped to the histogram. Values outside of this range are clipped */
+        void setAmplitudeRange (juce::Range<float> newAmplitudeRange);
+
+        /**
+         * Sets the number of symbols accumulated before the histogram is sent to the target. Larger values lead to
+         * less frequent updates but a more detailed picture.
+         */
+        void setNumSymbolsPerUpdate (int numSymbols);
+
+        /**
+         * Sets the amount of the histogram kept after it has been sent to the target. 0 clears the histogram after
+         * every update, values close to 1 lead to a long persistence.
+         */
+        void setPersistence (float persistence);
+
+        /** Selects the channel of the buffers pushed that is analyzed */
+        void setChannelToAnalyze (int channel);
+
+        /** Pushes an audio buffer holding the channel to analyze to the sample queue */
+        void pushChannelsSamples (juce::AudioBuffer<float>& bufferToPush);
+
+        /**
+         * Updates all parameters relevant for the Visualization. Call this after (re-)connecting if your collector
+         * to sink connection is network based to keep both ends in sync.
+         */
+        void updateAllGUIParameters();
+
+        void applySettingFromTarget (const juce::String& setting, const juce::var& value) override;
+
+    private:
+
+        // Timebase
+        double tSample = 0.0;
+        double tSymbol = 0.0;
+        double symbolPhase = 0.0;
+        double resamplingStep = 0.0;
+        double nextPointPosition = 0.0; // relative to the first sample of the next buffer, might be negative
+        float  lastSample = 0.0f;
+        int    currentColumn = 0;
+        int    channelToAnalyze = 0;
+
+        // Histogram
+        int   numColumnsPerSymbol = 64;
+        int   numAmplitudeBins = 128;
+        int   numSymbolsPerUpdate = 1000;
+        int   numSymbolsAccumulated = 0;
+        int   lastAmplitudeBin = -1;
+        float persistence = 0.0f;
+        juce::Range<float> amplitudeRange {-1.0f, 1.0f};
+        std::vector<float> histogram; // numAmplitudeBins rows of numColumnsPerSymbol columns each
+
+        // The hits since the last update as the difference of each bin to the bin below, numAmplitudeBins + 1 rows.
+        // A point spanning multiple bins only changes two values, the rows are summed up when publishing
+        std::vector<float> hitEdges;
+
+        // Scratch buffers for a chunk of resampled points, so that no allocation takes place on the realtime thread
+        static const int resamplingChunkSize = 256;
+        float resampledValues[resamplingChunkSize];
+        int   resampledColumns[resamplingChunkSize];
+        int   amplitudeBins[resamplingChunkSize + 1]; // starts with the bin of the last point of the previous chunk
+
+        /** Accumulates a chunk of resampled values into the hit edges */
+        void accumulateChunk (int numPoints);
+
+        /** Sums up the hit edges row by row and adds the result to the histogram */
+        void integrateHitEdges();
+
+        /** Sends the histogram to the target if a memory block is available and applies the persistence */
+        void publishHistogram();
+
+        void recalculateTimebase();
+
+        void recalculateMemory();
+
+        void updateGUITimebase();
+
+        void updateGUIHistogram();
+    };
+}
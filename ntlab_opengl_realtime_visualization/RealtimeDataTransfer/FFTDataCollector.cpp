@@ -0,0 +1,116 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "FFTDataCollector.h"
+
+namespace ntlab
+{
+    void FFTDataCollector::pushChannelsSamples (juce::AudioBuffer<float> &bufferToPush)
+    {
+        if ((bufferToPush.getNumChannels() != numFFTChannels) || (numSamplesExpected == 0))
+            return;
+
+        if (processingLock.try_lock ())
+        {
+            preProcessing.process (bufferToPush, [this] (juce::AudioBuffer<float>& processedSamples) { collectSamples (processedSamples); });
+
+            processingLock.unlock();
+        }
+    }
+
+    void FFTDataCollector::setPreFilterCoefficients (const std::vector<Biquad::Coefficients>& coefficients)
+    {
+        preProcessing.setFilterCoefficients (coefficients);
+    }
+
+    void FFTDataCollector::collectSamples (juce::AudioBuffer<float>& buffer)
+    {
+        int numSamplesInPassedBuffer = buffer.getNumSamples();
+        int numSamplesToCopy = std::min (numSamplesInPassedBuffer, (numSamplesExpected - numSamplesInSampleBuffer));
+
+        for (int n = 0; n < numFFTChannels; ++n)
+        {
+            auto writePtr = channelBuffers.get() + n * numFloatsPerChannel + numSamplesInSampleBuffer;
+            auto readPtr = buffer.getReadPointer (n);
+
+            // The window is applied while copying the samples, so that no additional pass is needed
+            if (shouldApplyWindow)
+                juce::FloatVectorOperations::multiply (writePtr, readPtr, windowTable.data() + numSamplesInSampleBuffer, numSamplesToCopy);
+            else
+                juce::FloatVectorOperations::copy (writePtr, readPtr, numSamplesToCopy);
+        }
+        numSamplesInSampleBuffer += numSamplesToCopy;
+
+        if (numSamplesInSampleBuffer >= numSamplesExpected)
+            performFFTs();
+    }
+
+    void FFTDataCollector::prepareFFT (int newFFTOrder, juce::dsp::WindowingFunction<float>::WindowingMethod windowingMethod)
+    {
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+
+        fftOrder = newFFTOrder;
+        numSamplesExpected = 1 << fftOrder;
+        realFFT.prepare (fftOrder);
+
+        shouldApplyWindow = (windowingMethod != juce::dsp::WindowingFunction<float>::rectangular);
+        windowTable.resize (static_cast<size_t> (numSamplesExpected));
+        juce::dsp::WindowingFunction<float>::fillWindowingTables (windowTable.data(), windowTable.size(), windowingMethod, false);
+
+        prepareChannels (numFFTChannels);
+    }
+
+    void FFTDataCollector::prepareChannels (int newNumChannels)
+    {
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+
+        numFFTChannels = newNumChannels;
+        numFloatsPerChannel = realFFT.getNumFloatsForBuffer();
+        channelBuffers.allocate (numFFTChannels * numFloatsPerChannel, true);
+        numSamplesInSampleBuffer = 0;
+
+        preProcessing.prepare (numFFTChannels);
+    }
+
+    void FFTDataCollector::prepareDecimation (int numStages)
+    {
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+
+        preProcessing.prepareDecimation (numStages);
+
+        numSamplesInSampleBuffer = 0;
+    }
+
+    void FFTDataCollector::performFFTs()
+    {
+        // The samples of each channel are replaced by their spectrum
+        for (int c = 0; c < numFFTChannels; ++c)
+            realFFT.performForward (channelBuffers.get() + c * numFloatsPerChannel);
+
+        processSpectra();
+
+        numSamplesInSampleBuffer = 0;
+    }
+}
@@ -0,0 +1,144 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+#include "RealtimeDataSink.h"
+#include "DataCollector.h"
+#include "../DSP/DecimatingFilterChain.h"
+#include "../DSP/RealFFT.h"
+#include "../DSP/VectorKernels.h"
+
+namespace ntlab
+{
+    /**
+     * A base class for all collectors that analyze the spectra of their channels. It collects blocks of samples of
+     * the FFT length for all channels, optionally applies a window while collecting them, transforms them and calls
+     * processSpectra on the realtime thread as soon as the spectra of all channels are available.
+     *
+     * Subclasses need to call prepareFFT and prepareChannels before pushing samples and whenever the FFT order or the
+     * channel count changes. Both functions allocate memory and must not be called while realtime processing runs.
+     *
+     * Optionally the samples can be decimated by a power of two before being collected, so that the FFT covers a
+     * smaller bandwidth of a signal sampled at a high rate. Subclasses enable this through prepareDecimation.
+     * Furthermore a chain of biquad filters can be applied to the samples after the optional decimation.
+     *
+     * As the samples are real, only the getNumSpectrumBins bins of the non-negative frequencies are computed, the
+     * others are their complex conjugates. Each channel has a single buffer of N + 2 floats for an FFT length of N,
+     * which first collects the samples and then holds the bins after the samples were transformed in place. The
+     * transform needs a scratch buffer of N / 2 complex values and twiddle factors of the same size, shared by all
+     * channels. Together with the window table, a collector with C channels therefore needs
+     * 4 * (C * (N + 2) + 3 * N) bytes for its sample and spectral data, plus the tables of a juce::dsp::FFT of
+     * length N / 2. For 64 channels at an FFT order of 16 this is 17.6 MB, storing samples and spectra as complex
+     * values took 67 MB.
+     *
+     * @see SpectralDataCollector, @see CrossCorrelationDataCollector
+     */
+    class FFTDataCollector : public DataCollector
+    {
+    public:
+
+        FFTDataCollector (const juce::String& identifier) : DataCollector (identifier) {};
+
+        virtual ~FFTDataCollector() {};
+
+        /**
+         * Pushes an audio buffer to the sample queue holding as much channels as set up by prepareChannels. Samples
+         * that don't fit into the current FFT block anymore are dropped. If an unmatching channel count is passed, the
+         * buffer is ignored.
+         */
+        void pushChannelsSamples (juce::AudioBuffer<float> &bufferToPush);
+
+        /**
+         * Sets the coefficients of the biquad sections applied to all channels before they are transformed. Pass an
+         * empty vector to disable filtering, which is the default. This can safely be called while realtime sample
+         * processing is running, the new coefficients are applied with the next buffer pushed without resetting the
+         * filter state.
+         */
+        void setPreFilterCoefficients (const std::vector<Biquad::Coefficients>& coefficients);
+
+    protected:
+
+        /**
+         * Called on the realtime thread when the spectra of all channels are available. The spectra can be accessed
+         * through getSpectrum until this function returns.
+         */
+        virtual void processSpectra() = 0;
+
+        /**
+         * Sets the FFT order and the window applied to the samples before transforming them. Pass
+         * juce::dsp::WindowingFunction<float>::rectangular to transform the samples as they are.
+         */
+        void prepareFFT (int newFFTOrder, juce::dsp::WindowingFunction<float>::WindowingMethod windowingMethod);
+
+        /** Allocates the sample and spectral buffers for the number of channels passed and the current FFT order */
+        void prepareChannels (int newNumChannels);
+
+        /**
+         * Sets the number of half-band stages the samples pass before being collected, resulting in a decimation
+         * factor of 2^numStages. Pass 0 to disable decimation.
+         */
+        void prepareDecimation (int numStages);
+
+        /** Returns the factor by which the samples are currently decimated before being collected */
+        int getDecimationFactor() const { return preProcessing.getDecimationFactor(); }
+
+        /**
+         * Returns the getNumSpectrumBins bins of the non-negative frequencies of the channel requested. The spectra
+         * of all channels are stored one after another, so all values of all channels can be accessed from the pointer
+         * to the first channel too.
+         */
+        const std::complex<float>* getSpectrum (int channel) const { return RealFFT::getBins (channelBuffers.get() + channel * numFloatsPerChannel); };
+
+        /** Returns the number of bins per channel returned by getSpectrum, which is half the FFT length plus one */
+        int getNumSpectrumBins() const { return numSamplesExpected / 2 + 1; }
+
+        int fftOrder = 0;
+        int numSamplesExpected = 0;
+        int numFFTChannels = 0;
+
+        std::recursive_mutex processingLock;
+
+    private:
+
+        // The samples and, after the transform, the spectra of all channels, numFloatsPerChannel floats each
+        RealFFT realFFT;
+        juce::HeapBlock<float> channelBuffers;
+        int numFloatsPerChannel = 0;
+        std::vector<float> windowTable;
+        bool shouldApplyWindow = false;
+        int numSamplesInSampleBuffer = 0;
+
+        // Decimation and filtering, applied in chunks before the samples are collected
+        DecimatingFilterChain preProcessing;
+
+        void collectSamples (juce::AudioBuffer<float>& buffer);
+
+        void performFFTs();
+    };
+}
@@ -0,0 +1,162 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <type_traits>
+
+namespace ntlab
+{
+    /** The header type of a FrameLayout without any side payload */
+    struct NoFrameHeader {};
+
+    /**
+     * Describes the memory layout of the frames a DataCollector sends to its VisualizationTarget at compile time. A
+     * frame optionally starts with a header struct holding side payload like a frame counter, followed by the values
+     * of all channels stored one after another. The number of channels and values per channel are runtime
+     * properties, as they depend on the settings of the collector.
+     *
+     * Each collector exposes its layout as a public Layout type. Collectors and targets access their frames through a
+     * Frame or ConstFrame referring to this type, so that both ends agree on the sample and header type by
+     * construction. Both types must be trivially copyable, as frames might be sent over a network connection.
+     */
+    template <typename SampleType, typename HeaderType = NoFrameHeader>
+    struct FrameLayout
+    {
+        using Sample = SampleType;
+        using Header = HeaderType;
+
+        static_assert (std::is_trivially_copyable<Sample>::value, "The sample type of a frame must be trivially copyable");
+        static_assert (std::is_trivially_copyable<Header>::value, "The header type of a frame must be trivially copyable");
+
+        static constexpr bool   hasHeader  = ! std::is_empty<Header>::value;
+        static constexpr size_t headerSize = hasHeader ? sizeof (Header) : 0;
+
+        static_assert (headerSize % alignof (Sample) == 0, "The header size must keep the samples following it aligned");
+
+        /** Returns the size of a frame in bytes */
+        static constexpr size_t getNumBytes (int numChannels, int numValuesPerChannel)
+        {
+            return headerSize + static_cast<size_t> (numChannels) * static_cast<size_t> (numValuesPerChannel) * sizeof (Sample);
+        }
+
+        /** Returns the index of the first value of a channel among the values following the header */
+        static constexpr size_t getChannelOffset (int channel, int numValuesPerChannel)
+        {
+            return static_cast<size_t> (channel) * static_cast<size_t> (numValuesPerChannel);
+        }
+    };
+
+    /**
+     * A typed view on a memory block holding a frame of the FrameLayout passed. The view checks whether the size of the
+     * block matches the layout and the dimensions passed, so only call the accessors of a view that isValid. Use the
+     * Frame alias to write and the ConstFrame alias to read a frame.
+     */
+    template <typename Layout, bool isReadOnly>
+    class FrameView
+    {
+    public:
+        using Sample = typename Layout::Sample;
+        using Header = typename Layout::Header;
+
+        using BlockType   = typename std::conditional<isReadOnly, const juce::MemoryBlock, juce::MemoryBlock>::type;
+        using SampleType  = typename std::conditional<isReadOnly, const Sample, Sample>::type;
+        using HeaderType  = typename std::conditional<isReadOnly, const Header, Header>::type;
+        using BytePointer = typename std::conditional<isReadOnly, const char*, char*>::type;
+
+        /** Creates a view on a frame with a known number of channels and values per channel */
+        FrameView (BlockType& block, int numChannelsInFrame, int numValuesPerChannelInFrame)
+          : data (static_cast<BytePointer> (block.getData())),
+            numChannels (numChannelsInFrame),
+            numValuesPerChannel (numValuesPerChannelInFrame),
+            valid ((numChannels > 0) && (block.getSize() == Layout::getNumBytes (numChannels, numValuesPerChannel)))
+        {}
+
+        /**
+         * Creates a view on a frame with a known number of channels and a number of values per channel derived from
+         * the size of the block.
+         */
+        FrameView (BlockType& block, int numChannelsInFrame)
+          : data (static_cast<BytePointer> (block.getData())),
+            numChannels (numChannelsInFrame),
+            numValuesPerChannel (deriveNumValuesPerChannel (block.getSize(), numChannelsInFrame)),
+            valid (numValuesPerChannel >= 0)
+        {}
+
+        /** Returns true if the size of the memory block matches the layout */
+        bool isValid() const { return valid; }
+
+        int getNumChannels()         const { return numChannels; }
+        int getNumValuesPerChannel() const { return numValuesPerChannel; }
+        int getNumValues()           const { return numChannels * numValuesPerChannel; }
+
+        /** Returns the header of the frame. Only available for layouts with a header */
+        HeaderType& getHeader() const
+        {
+            static_assert (Layout::hasHeader, "This frame layout has no header");
+            return *reinterpret_cast<HeaderType*> (data);
+        }
+
+        /** Returns the values of all channels, stored one channel after another */
+        SampleType* getValues() const { return reinterpret_cast<SampleType*> (data + Layout::headerSize); }
+
+        /** Returns the values of a single channel */
+        SampleType* getChannel (int channel) const
+        {
+            jassert (juce::isPositiveAndBelow (channel, numChannels));
+            return getValues() + Layout::getChannelOffset (channel, numValuesPerChannel);
+        }
+
+    private:
+        BytePointer data;
+        int numChannels;
+        int numValuesPerChannel;
+        bool valid;
+
+        static int deriveNumValuesPerChannel (size_t numBytes, int numChannels)
+        {
+            if ((numChannels <= 0) || (numBytes < Layout::headerSize))
+                return -1;
+
+            const size_t bytesPerChannel = static_cast<size_t> (numChannels) * sizeof (Sample);
+            const size_t numValueBytes = numBytes - Layout::headerSize;
+
+            if (numValueBytes % bytesPerChannel != 0)
+                return -1;
+
+            return static_cast<int> (numValueBytes / bytesPerChannel);
+        }
+    };
+
+    /** A view to write a frame of the layout passed */
+    template <typename Layout>
+    using Frame = FrameView<Layout, false>;
+
+    /** A view to read a frame of the layout passed */
+    template <typename Layout>
+    using ConstFrame = FrameView<Layout, true>;
+}
@@ -0,0 +1,238 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "GoniometerDataCollector.h"
+
+namespace ntlab
+{
+    GoniometerDataCollector::GoniometerDataCollector (const juce::String identifierExtension)
+    : DataCollector ("Goniometer" + identifierExtension)
+    {
+        recalculateMemory();
+    }
+
+    void GoniometerDataCollector::setPoints (int numPointsPerFrame, int decimationFactor)
+    {
+        jassert (numPointsPerFrame > 0);
+        jassert (decimationFactor > 0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        numPoints = numPointsPerFrame;
+        this->decimationFactor = decimationFactor;
+
+        updateGUIPoints();
+        recalculateMemory();
+    }
+
+    void GoniometerDataCollector::setCorrelationTime (double correlationTimeInSeconds)
+    {
+        jassert (correlationTimeInSeconds > 0.0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        correlationTime = correlationTimeInSeconds;
+
+        if (sampleRate > 0.0)
+            correlationDecayPerChunk = static_cast<float> (std::exp (-chunkSize / (correlationTime * sampleRate)));
+
+        updateGUICorrelationTime();
+    }
+
+    void GoniometerDataCollector::setSampleRate (double newSampleRate)
+    {
+        jassert (newSampleRate > 0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        sampleRate = newSampleRate;
+        correlationDecayPerChunk = static_cast<float> (std::exp (-chunkSize / (correlationTime * sampleRate)));
+    }
+
+    void GoniometerDataCollector::pushChannelsSamples (juce::AudioBuffer<float>& bufferToPush)
+    {
+        if ((bufferToPush.getNumChannels() < 2) || (sampleRate <= 0.0))
+            return;
+
+        if (processingLock.try_lock())
+        {
+            const int numSamples = bufferToPush.getNumSamples();
+            const float* left  = bufferToPush.getReadPointer (0);
+            const float* right = bufferToPush.getReadPointer (1);
+
+            updateCorrelationSums (left, right, numSamples);
+            collectPoints (left, right, numSamples);
+
+            processingLock.unlock();
+        }
+    }
+
+    void GoniometerDataCollector::applySettingFromTarget (const juce::String& setting, const juce::var& value)
+    {
+        if (setting == settingNumPoints)
+        {
+            if (value.isInt())
+                setPoints (value, decimationFactor);
+        }
+        else if (setting == settingDecimationFactor)
+        {
+            if (value.isInt())
+                setPoints (numPoints, value);
+        }
+        else if (setting == settingCorrelationTime)
+        {
+            if (value.isDouble())
+                setCorrelationTime (value);
+        }
+    }
+
+    void GoniometerDataCollector::collectPoints (const float* left, const float* right, int numSamples)
+    {
+        // Rotates the left/right pairs by 45 degrees, so that the mid signal is on the vertical axis
+        const float scaling = juce::MathConstants<float>::sqrt2 * 0.5f;
+
+        int i = numSamplesUntilNextPoint;
+
+        for (; i < numSamples; i += decimationFactor)
+        {
+            points[2 * numPointsCollected]     = (left[i] - right[i]) * scaling;
+            points[2 * numPointsCollected + 1] = (left[i] + right[i]) * scaling;
+
+            if (++numPointsCollected == numPoints)
+            {
+                publishFrame();
+                numPointsCollected = 0;
+            }
+        }
+
+        numSamplesUntilNextPoint = i - numSamples;
+    }
+
+    void GoniometerDataCollector::updateCorrelationSums (const float* left, const float* right, int numSamples)
+    {
+        for (int chunkStart = 0; chunkStart < numSamples; chunkStart += chunkSize)
+        {
+            const int numSamplesInChunk = std::min (chunkSize, numSamples - chunkStart);
+            const float* l = left  + chunkStart;
+            const float* r = right + chunkStart;
+
+            // Four independent accumulators per product break the dependency chain of the multiply-accumulate
+            // operations, which allows the compiler to map the loop to vector instructions
+            float lr[4] = {}, ll[4] = {}, rr[4] = {};
+
+            int i = 0;
+            for (; i + 3 < numSamplesInChunk; i += 4)
+            {
+                for (int k = 0; k < 4; ++k)
+                {
+                    lr[k] += l[i + k] * r[i + k];
+                    ll[k] += l[i + k] * l[i + k];
+                    rr[k] += r[i + k] * r[i + k];
+                }
+            }
+
+            for (; i < numSamplesInChunk; ++i)
+            {
+                lr[0] += l[i] * r[i];
+                ll[0] += l[i] * l[i];
+                rr[0] += r[i] * r[i];
+            }
+
+            const double decay = (numSamplesInChunk == chunkSize) ? correlationDecayPerChunk
+                                                                  : std::pow (correlationDecayPerChunk, numSamplesInChunk / static_cast<double> (chunkSize));
+
+            sumLR = sumLR * decay + ((lr[0] + lr[1]) + (lr[2] + lr[3]));
+            sumLL = sumLL * decay + ((ll[0] + ll[1]) + (ll[2] + ll[3]));
+            sumRR = sumRR * decay + ((rr[0] + rr[1]) + (rr[2] + rr[3]));
+        }
+    }
+
+    float GoniometerDataCollector::computeCorrelation() const
+    {
+        const double energyProduct = sumLL * sumRR;
+
+        // Silence or a signal on only one channel has no defined correlation, it is reported as 0
+        if (energyProduct < 1e-20)
+            return 0.0f;
+
+        return juce::jlimit (-1.0f, 1.0f, static_cast<float> (sumLR / std::sqrt (energyProduct)));
+    }
+
+    void GoniometerDataCollector::publishFrame()
+    {
+        auto* block = startWriting();
+
+        // If the frame could not be sent, the points are dropped and the next frame is collected
+        if (block == nullptr)
+            return;
+
+        Frame<Layout> frame (*block, 1, static_cast<int> (points.size()));
+
+        if (frame.isValid())
+        {
+            auto& header = frame.getHeader();
+            header.frameIndex = ++frameIndex;
+            header.correlation = computeCorrelation();
+
+            std::copy (points.begin(), points.end(), frame.getValues());
+        }
+        else
+        {
+            block->fillWith (0);
+        }
+
+        finishedWriting();
+    }
+
+    void GoniometerDataCollector::recalculateMemory()
+    {
+        points.assign (static_cast<size_t> (2 * numPoints), 0.0f);
+        numPointsCollected = 0;
+        numSamplesUntilNextPoint = 0;
+
+        resizeMemoryBlock (Layout::getNumBytes (1, static_cast<int> (points.size())));
+    }
+
+    void GoniometerDataCollector::updateAllGUIParameters()
+    {
+        updateGUIPoints();
+        updateGUICorrelationTime();
+    }
+
+    void GoniometerDataCollector::updateGUIPoints()
+    {
+        juce::var np (numPoints);
+        juce::var df (decimationFactor);
+        sink->applySettingToTarget (*this, settingNumPoints, np);
+        sink->applySettingToTarget (*this, settingDecimationFactor, df);
+    }
+
+    void GoniometerDataCollector::updateGUICorrelationTime()
+    {
+        juce::var ct (correlationTime);
+        sink->applySettingToTarget (*this, settingCorrelationTime, ct);
+    }
+
+    const juce::String GoniometerDataCollector::settingNumPoints        ("numPoints");
+    const juce::String GoniometerDataCollector::settingDecimationFactor ("decimationFactor");
+    const juce::String GoniometerDataCollector::settingCorrelationTime  ("correlationTime");
+}
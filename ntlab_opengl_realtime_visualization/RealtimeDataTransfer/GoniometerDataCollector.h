@@ -0,0 +1,132 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "RealtimeDataSink.h"
+#include "DataCollector.h"
+#include "Frame.h"
+
+namespace ntlab
+{
+    /**
+     * An object that collects the samples of a stereo stream for a goniometer and measures the phase correlation
+     * between both channels. Its data is sent to a corresponding VisualizationTarget, normally a GoniometerComponent.
+     *
+     * Every nth sample pair is rotated into a mid/side point, with the side signal as x and the mid signal as y value,
+     * so that a mono signal shows up as a vertical line. As soon as enough points for a frame have been collected, a
+     * frame is sent, consisting of a FrameHeader followed by the points as interleaved side/mid float pairs. The
+     * correlation is computed from exponentially weighted running sums over all samples, not only the decimated ones.
+     *
+     * @see RealtimeDataSink, @see VisualisationDataSource, @see VisualizationTarget, @see GoniometerComponent
+     */
+    class GoniometerDataCollector : public DataCollector
+    {
+    public:
+        static const juce::String settingNumPoints;
+        static const juce::String settingDecimationFactor;
+        static const juce::String settingCorrelationTime;
+
+        /** The header at the beginning of each frame */
+        struct FrameHeader
+        {
+            /** Incremented with every frame sent, so that a target can tell new frames from frames already seen */
+            juce::uint32 frameIndex;
+
+            /** The phase correlation in the range of -1 to 1 */
+            float correlation;
+        };
+
+        /** A single channel of interleaved side/mid float pairs, preceded by the FrameHeader */
+        using Layout = FrameLayout<float, FrameHeader>;
+
+        /**
+         * Specify an identifier extension to map the DataCollector to the corresponding target.
+         * The Identifier will automatically be prepended by "Goniometer"
+         */
+        GoniometerDataCollector (const juce::String identifierExtension = "1");
+
+        virtual ~GoniometerDataCollector () {};
+
+        /**
+         * Sets the number of points sent per frame and the decimation factor, so that a point is created from every
+         * decimationFactor-th sample pair.
+         */
+        void setPoints (int numPointsPerFrame, int decimationFactor);
+
+        /** Sets the time constant of the running correlation in seconds */
+        void setCorrelationTime (double correlationTimeInSeconds);
+
+        /** Sets the sample rate used. The correlation time constant depends on the sample rate */
+        void setSampleRate (double newSampleRate);
+
+        /**
+         * Pushes an audio buffer to the collector. The first channel is treated as the left, the second channel as
+         * the right channel, all other channels are ignored.
+         */
+        void pushChannelsSamples (juce::AudioBuffer<float>& bufferToPush);
+
+        /**
+         * Updates all parameters relevant for the Visualization. Call this after (re-)connecting if your collector
+         * to sink connection is network based to keep both ends in sync.
+         */
+        void updateAllGUIParameters();
+
+        void applySettingFromTarget (const juce::String& setting, const juce::var& value) override;
+
+    private:
+
+        // Points
+        int numPoints = 1024;
+        int decimationFactor = 2;
+        int numPointsCollected = 0;
+        int numSamplesUntilNextPoint = 0;
+        std::vector<float> points;
+        juce::uint32 frameIndex = 0;
+
+        // Correlation
+        double sampleRate = 0.0;
+        double correlationTime = 0.3;
+        float  correlationDecayPerChunk = 0.0f;
+        double sumLR = 0.0, sumLL = 0.0, sumRR = 0.0;
+
+        // The running sums are decayed once per chunk
+        static constexpr int chunkSize = 64;
+
+        std::recursive_mutex processingLock;
+
+        void collectPoints (const float* left, const float* right, int numSamples);
+        void updateCorrelationSums (const float* left, const float* right, int numSamples);
+        float computeCorrelation() const;
+        void publishFrame();
+
+        void recalculateMemory();
+
+        void updateGUIPoints();
+        void updateGUICorrelationTime();
+    };
+}
@@ -0,0 +1,281 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "HistogramDataCollector.h"
+#include "../Utilities/SerializableRange.h"
+#include <numeric>
+
+namespace ntlab
+{
+    void HistogramDataCollector::setChannels (int numChannels, juce::StringArray channelNames)
+    {
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+
+        this->numChannels = numChannels;
+        this->channelNames = channelNames;
+
+        updateGUIChannels();
+        recalculateMemory();
+    }
+
+    void HistogramDataCollector::setSampleRate (double newSampleRate)
+    {
+        jassert (newSampleRate > 0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        sampleRate = newSampleRate;
+        recalculateTimebase();
+    }
+
+    void HistogramDataCollector::setBins (int numBins, juce::Range<float> amplitudeRange)
+    {
+        jassert (numBins > 1);
+        jassert (!amplitudeRange.isEmpty());
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        this->numBins = numBins;
+        this->amplitudeRange = amplitudeRange;
+
+        updateGUIBins();
+        recalculateMemory();
+    }
+
+    void HistogramDataCollector::setAccumulation (AccumulationMode mode, double accumulationTimeInSeconds)
+    {
+        jassert (accumulationTimeInSeconds > 0.0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        accumulationMode = mode;
+        accumulationTime = accumulationTimeInSeconds;
+
+        std::fill (counts.begin(), counts.end(), 0.0f);
+        recalculateTimebase();
+        updateGUIAccumulation();
+    }
+
+    void HistogramDataCollector::setUpdateRate (double updatesPerSecond)
+    {
+        jassert (updatesPerSecond > 0.0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        updateRate = updatesPerSecond;
+        recalculateTimebase();
+    }
+
+    void HistogramDataCollector::pushChannelsSamples (juce::AudioBuffer<float>& bufferToPush)
+    {
+        if ((bufferToPush.getNumChannels() != numChannels) || (numSamplesPerUpdate == 0))
+            return;
+
+        if (processingLock.try_lock())
+        {
+            const int numSamples = bufferToPush.getNumSamples();
+            const int numCountsPerChannel = numPartialHistograms * numBins;
+
+            // A buffer might span the end of an update interval, so it is processed in segments
+            for (int start = 0; start < numSamples;)
+            {
+                const int numSamplesInSegment = std::min (numSamples - start, numSamplesPerUpdate - numSamplesSinceUpdate);
+
+                if (accumulationMode == decayed)
+                {
+                    const float decay = static_cast<float> (std::exp (-numSamplesInSegment / decayTimeConstantInSamples));
+                    juce::FloatVectorOperations::multiply (counts.data(), decay, static_cast<int> (counts.size()));
+                }
+
+                for (int n = 0; n < numChannels; ++n)
+                    countSamples (bufferToPush.getReadPointer (n, start), numSamplesInSegment, counts.data() + n * numCountsPerChannel);
+
+                start                 += numSamplesInSegment;
+                numSamplesSinceUpdate += numSamplesInSegment;
+
+                if (numSamplesSinceUpdate >= numSamplesPerUpdate)
+                {
+                    numSamplesSinceUpdate = 0;
+
+                    // If the histogram could not be sent, the window is extended to the next update
+                    if (publishHistograms() && (accumulationMode == windowed))
+                        std::fill (counts.begin(), counts.end(), 0.0f);
+                }
+            }
+
+            processingLock.unlock();
+        }
+    }
+
+    void HistogramDataCollector::applySettingFromTarget (const juce::String& setting, const juce::var& value)
+    {
+        if (setting == settingNumBins)
+        {
+            if (value.isInt())
+                setBins (value, amplitudeRange);
+        }
+        else if (setting == settingAmplitudeRange)
+        {
+            if (value.isString())
+                setBins (numBins, SerializableRange<float> (value));
+        }
+        else if (setting == settingAccumulationMode)
+        {
+            if (value.isInt())
+                setAccumulation (static_cast<int> (value) == windowed ? windowed : decayed, accumulationTime);
+        }
+        else if (setting == settingAccumulationTime)
+        {
+            if (value.isDouble())
+                setAccumulation (accumulationMode, value);
+        }
+    }
+
+    void HistogramDataCollector::countSamples (const float* samples, int numSamples, float* channelCounts)
+    {
+        const float binsPerAmplitude = numBins / amplitudeRange.getLength();
+        const float binOffset = -amplitudeRange.getStart() * binsPerAmplitude;
+
+        float* partialCounts0 = channelCounts;
+        float* partialCounts1 = channelCounts + numBins;
+        float* partialCounts2 = channelCounts + 2 * numBins;
+        float* partialCounts3 = channelCounts + 3 * numBins;
+
+        // NaN is not clipped, so it is mapped to the first bin instead of converting it to an int
+        const int lastBin = numBins - 1;
+        auto toBin = [lastBin] (float binIndex) { return juce::jlimit (0, lastBin, static_cast<int> ((binIndex == binIndex) ? binIndex : 0.0f)); };
+
+        for (int chunkStart = 0; chunkStart < numSamples; chunkStart += chunkSize)
+        {
+            const int numSamplesInChunk = std::min (chunkSize, numSamples - chunkStart);
+
+            // Compute the bin indices of the whole chunk with vector operations
+            juce::FloatVectorOperations::copyWithMultiply (binIndices, samples + chunkStart, binsPerAmplitude, numSamplesInChunk);
+            juce::FloatVectorOperations::add              (binIndices, binOffset, numSamplesInChunk);
+            juce::FloatVectorOperations::clip             (binIndices, binIndices, 0.0f, numBins - 1.0f, numSamplesInChunk);
+
+            // Scatter the increments to the partial histograms
+            int i = 0;
+            for (; i + 3 < numSamplesInChunk; i += 4)
+            {
+                partialCounts0[toBin (binIndices[i])]     += 1.0f;
+                partialCounts1[toBin (binIndices[i + 1])] += 1.0f;
+                partialCounts2[toBin (binIndices[i + 2])] += 1.0f;
+                partialCounts3[toBin (binIndices[i + 3])] += 1.0f;
+            }
+
+            for (; i < numSamplesInChunk; ++i)
+                partialCounts0[toBin (binIndices[i])] += 1.0f;
+        }
+    }
+
+    bool HistogramDataCollector::publishHistograms()
+    {
+        auto* block = startWriting();
+        if (block == nullptr)
+            return false;
+
+        Frame<Layout> frame (*block, numChannels, numBins);
+
+        if (frame.isValid())
+        {
+            for (int n = 0; n < numChannels; ++n)
+            {
+                float* channelProbabilities = frame.getChannel (n);
+                const float* channelCounts = counts.data() + n * numPartialHistograms * numBins;
+
+                juce::FloatVectorOperations::copy (channelProbabilities, channelCounts, numBins);
+                for (int p = 1; p < numPartialHistograms; ++p)
+                    juce::FloatVectorOperations::add (channelProbabilities, channelCounts + p * numBins, numBins);
+
+                const float totalCount = std::accumulate (channelProbabilities, channelProbabilities + numBins, 0.0f);
+                if (totalCount > 0.0f)
+                    juce::FloatVectorOperations::multiply (channelProbabilities, 1.0f / totalCount, numBins);
+            }
+        }
+        else
+        {
+            block->fillWith (0);
+        }
+
+        finishedWriting();
+        return true;
+    }
+
+    void HistogramDataCollector::recalculateTimebase()
+    {
+        if (sampleRate <= 0.0)
+            return;
+
+        if (accumulationMode == windowed)
+            numSamplesPerUpdate = std::max (1, juce::roundToInt (accumulationTime * sampleRate));
+        else
+            numSamplesPerUpdate = std::max (1, juce::roundToInt (sampleRate / updateRate));
+
+        decayTimeConstantInSamples = accumulationTime * sampleRate;
+        numSamplesSinceUpdate = 0;
+    }
+
+    void HistogramDataCollector::recalculateMemory()
+    {
+        counts.assign (static_cast<size_t> (numChannels * numPartialHistograms * numBins), 0.0f);
+        resizeMemoryBlock (numChannels * numBins * sizeof (float));
+        numSamplesSinceUpdate = 0;
+    }
+
+    void HistogramDataCollector::updateAllGUIParameters()
+    {
+        updateGUIChannels();
+        updateGUIBins();
+        updateGUIAccumulation();
+    }
+
+    void HistogramDataCollector::updateGUIChannels()
+    {
+        juce::var ns (numChannels);
+        juce::var cn (channelNames);
+        sink->applySettingToTarget (*this, settingNumChannels, ns);
+        sink->applySettingToTarget (*this, settingChannelNames, cn);
+    }
+
+    void HistogramDataCollector::updateGUIBins()
+    {
+        juce::var nb (numBins);
+        juce::var ar (SerializableRange<float> (amplitudeRange).toString());
+        sink->applySettingToTarget (*this, settingNumBins, nb);
+        sink->applySettingToTarget (*this, settingAmplitudeRange, ar);
+    }
+
+    void HistogramDataCollector::updateGUIAccumulation()
+    {
+        juce::var am (static_cast<int> (accumulationMode));
+        juce::var at (accumulationTime);
+        sink->applySettingToTarget (*this, settingAccumulationMode, am);
+        sink->applySettingToTarget (*this, settingAccumulationTime, at);
+    }
+
+    const juce::String HistogramDataCollector::settingNumChannels      ("numChannels");
+    const juce::String HistogramDataCollector::settingChannelNames     ("channelNames");
+    const juce::String HistogramDataCollector::settingNumBins          ("numBins");
+    const juce::String HistogramDataCollector::settingAmplitudeRange   ("amplitudeRange");
+    const juce::String HistogramDataCollector::settingAccumulationMode ("accumulationMode");
+    const juce::String HistogramDataCollector::settingAccumulationTime ("accumulationTime");
+}
@@ -0,0 +1,160 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "RealtimeDataSink.h"
+#include "DataCollector.h"
+#include "Frame.h"
+
+namespace ntlab
+{
+    /**
+     * An object that collects samples from a realtime stream and accumulates a histogram of the sample amplitudes for
+     * each channel, which estimates the probability density of the amplitudes. This is useful to characterize e.g.
+     * clipping or noise distributions. Samples outside of the amplitude range are counted in the outermost bins, so
+     * clipping shows up as a peak at the borders of the histogram.
+     *
+     * The histogram is either accumulated over a window of a fixed duration and then restarted, or continuously with
+     * an exponential decay. It is periodically sent to the target, normalized so that the bins of each channel sum up
+     * to one. As only the bins are sent, the cost of the visualization doesn't depend on the sample rate. Normally the
+     * target will be a HistogramComponent.
+     *
+     * @see RealtimeDataSink, @see VisualisationDataSource, @see VisualizationTarget, @see HistogramComponent
+     */
+    class HistogramDataCollector : public DataCollector
+    {
+    public:
+        static const juce::String settingNumChannels;
+        static const juce::String settingChannelNames;
+        static const juce::String settingNumBins;
+        static const juce::String settingAmplitudeRange;
+        static const juce::String settingAccumulationMode;
+        static const juce::String settingAccumulationTime;
+
+        /** Each frame holds the probabilities of numBins bins per channel */
+        using Layout = FrameLayout<float>;
+
+        enum AccumulationMode
+        {
+            /** The histogram is cleared after each window of accumulationTime seconds */
+            windowed = 0,
+
+            /** The histogram decays exponentially with a time constant of accumulationTime seconds */
+            decayed = 1
+        };
+
+        /**
+         * Specify an identifier extension to map the DataCollector to the corresponding target.
+         * The Identifier will automatically be prepended by "Histogram"
+         */
+        HistogramDataCollector (const juce::String identifierExtension = "1") : DataCollector ("Histogram" + identifierExtension) {};
+
+        virtual ~HistogramDataCollector () {};
+
+        /**
+         * Sets the number of channels analyzed. Keep in mind that the next call to pushChannelSamples will expect a
+         * matching new number of channels so better don't call this while realtime sample processing is running.
+         * @param numChannels    The new number of channels analyzed
+         * @param channelNames   An Array of size numChannels containing the names to be displayed for each channel
+         */
+        void setChannels (int numChannels, juce::StringArray channelNames = juce::StringArray());
+
+        /** Sets the sample rate used. No data will be sent until the sample rate was set. */
+        void setSampleRate (double newSampleRate);
+
+        /** Sets the number of bins and the range of amplitudes covered by the histogram */
+        void setBins (int numBins, juce::Range<float> amplitudeRange);
+
+        /**
+         * Sets the way the histogram is accumulated. Depending on the mode, accumulationTime is either the duration
+         * of a window or the time constant of the decay.
+         */
+        void setAccumulation (AccumulationMode mode, double accumulationTimeInSeconds);
+
+        /** Sets the rate at which the histogram is sent to the target in the decayed accumulation mode */
+        void setUpdateRate (double updatesPerSecond);
+
+        /** Pushes an audio buffer holding as much channels as set by setChannels to the sample queue */
+        void pushChannelsSamples (juce::AudioBuffer<float>& bufferToPush);
+
+        /**
+         * Updates all parameters relevant for the Visualization. Call this after (re-)connecting if your collector
+         * to sink connection is network based to keep both ends in sync.
+         */
+        void updateAllGUIParameters();
+
+        void applySettingFromTarget (const juce::String& setting, const juce::var& value) override;
+
+    private:
+
+        // Channels
+        int               numChannels = 0;
+        juce::StringArray channelNames;
+
+        // Bins
+        int                numBins = 128;
+        juce::Range<float> amplitudeRange {-1.0f, 1.0f};
+
+        // Accumulation
+        double           sampleRate = 0.0;
+        AccumulationMode accumulationMode = decayed;
+        double           accumulationTime = 1.0;
+        double           updateRate = 30.0;
+        int              numSamplesPerUpdate = 0;
+        int              numSamplesSinceUpdate = 0;
+        double           decayTimeConstantInSamples = 0.0;
+
+        // Successive samples are counted in interleaved partial histograms, as consecutive increments of the same bin
+        // would otherwise stall on the store of the previous increment. They are summed up when sending.
+        static const int numPartialHistograms = 4;
+        std::vector<float> counts; // numPartialHistograms partial histograms of numBins for each channel
+
+        // Scratch buffer for the bin indices of a chunk of samples, so that no allocation takes place on the
+        // realtime thread
+        static constexpr int chunkSize = 256;
+        float binIndices[chunkSize];
+
+        std::recursive_mutex processingLock;
+
+        /** Adds the samples of one channel to the partial histograms of the channel */
+        void countSamples (const float* samples, int numSamples, float* channelCounts);
+
+        /** Sends the normalized histograms to the target. Returns false if no memory block was available */
+        bool publishHistograms();
+
+        void recalculateTimebase();
+
+        void recalculateMemory();
+
+        void updateGUIChannels();
+
+        void updateGUIBins();
+
+        void updateGUIAccumulation();
+    };
+}
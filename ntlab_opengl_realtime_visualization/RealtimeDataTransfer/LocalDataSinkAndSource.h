@@ -87,7 +87,9 @@ namespace ntlab
 
         void applySettingToCollector (VisualizationTarget& target, const juce::String& setting, const juce::var& value) override
         {
-            collectors[target.targetIdx]->applySettingFromTarget (setting, value);
+            // settings might be sent by a target before its collector has been registered
+            if (auto* collector = collectors[target.targetIdx])
+                collector->applySettingFromTarget (setting, value);
         }
 
         void applySettingToTarget (DataCollector &dataCollector, const juce::String& setting, const juce::var& value) override
@@ -0,0 +1,417 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "LoudnessDataCollector.h"
+
+namespace ntlab
+{
+    void LoudnessDataCollector::setChannels (int numChannels, juce::StringArray channelNames)
+    {
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+
+        this->numChannels = numChannels;
+        this->channelNames = channelNames;
+        channelWeights.assign (static_cast<size_t> (numChannels), 1.0);
+
+        updateGUIChannels();
+        recalculateMemory();
+    }
+
+    void LoudnessDataCollector::setChannelWeights (const juce::Array<float>& weights)
+    {
+        // You need to pass one weight per channel
+        jassert (weights.size() == numChannels);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+
+        for (int n = 0; n < std::min (numChannels, weights.size()); ++n)
+            channelWeights[static_cast<size_t> (n)] = weights[n];
+    }
+
+    void LoudnessDataCollector::setSampleRate (double newSampleRate)
+    {
+        jassert (newSampleRate > 0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        sampleRate = newSampleRate;
+        numSamplesPerBlock = std::max (1, juce::roundToInt (0.1 * sampleRate));
+
+        recalculateMemory();
+    }
+
+    void LoudnessDataCollector::resetIntegratedLoudness()
+    {
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+
+        std::fill (gatingHistogram.begin(), gatingHistogram.end(), 0u);
+        std::fill (truePeakMax.begin(),     truePeakMax.end(),     0.0f);
+    }
+
+    void LoudnessDataCollector::pushChannelsSamples (juce::AudioBuffer<float>& bufferToPush)
+    {
+        if ((bufferToPush.getNumChannels() != numChannels) || (numSamplesPerBlock == 0))
+            return;
+
+        if (processingLock.try_lock())
+        {
+            const int numSamples = bufferToPush.getNumSamples();
+
+            // A buffer might span the end of a 100 ms block and is longer than the scratch buffer in most cases, so
+            // it is processed in segments
+            for (int start = 0; start < numSamples;)
+            {
+                const int numSamplesInSegment = std::min ({ chunkSize, numSamples - start, numSamplesPerBlock - numSamplesInBlock });
+
+                for (int n = 0; n < numChannels; ++n)
+                {
+                    const float* samples = bufferToPush.getReadPointer (n, start);
+
+                    auto& truePeak = truePeakSinceLastFrame[static_cast<size_t> (n)];
+                    truePeak = std::max (truePeak, truePeakDetectors[static_cast<size_t> (n)].process (samples, numSamplesInSegment));
+
+                    kWeightingFilters[static_cast<size_t> (n)].process (samples, filteredSamples, numSamplesInSegment);
+
+                    double sumOfSquares = 0.0;
+                    for (int i = 0; i < numSamplesInSegment; ++i)
+                        sumOfSquares += filteredSamples[i] * filteredSamples[i];
+
+                    channelEnergies[static_cast<size_t> (n)] += sumOfSquares;
+                }
+
+                start             += numSamplesInSegment;
+                numSamplesInBlock += numSamplesInSegment;
+
+                if (numSamplesInBlock >= numSamplesPerBlock)
+                    finishBlock();
+            }
+
+            processingLock.unlock();
+        }
+    }
+
+    void LoudnessDataCollector::applySettingFromTarget (const juce::String& setting, const juce::var& value)
+    {
+        if (setting == settingResetIntegratedLoudness)
+        {
+            if (value.isBool() || value.isInt())
+                resetIntegratedLoudness();
+        }
+    }
+
+    void LoudnessDataCollector::finishBlock()
+    {
+        double weightedEnergy = 0.0;
+        for (int n = 0; n < numChannels; ++n)
+            weightedEnergy += channelWeights[static_cast<size_t> (n)] * channelEnergies[static_cast<size_t> (n)];
+
+        weightedEnergy /= numSamplesInBlock;
+
+        std::fill (channelEnergies.begin(), channelEnergies.end(), 0.0);
+        numSamplesInBlock = 0;
+
+        newestBlockIdx = (newestBlockIdx + 1) % numBlocksShortTerm;
+        blockEnergies[newestBlockIdx] = weightedEnergy;
+        numBlocksAvailable = std::min (numBlocksAvailable + 1, numBlocksShortTerm);
+
+        auto meanOfLastBlocks = [this] (int numBlocks)
+        {
+            double sum = 0.0;
+            for (int b = 0; b < numBlocks; ++b)
+                sum += blockEnergies[(newestBlockIdx - b + numBlocksShortTerm) % numBlocksShortTerm];
+
+            return sum / numBlocks;
+        };
+
+        double momentaryEnergy = 0.0;
+        double shortTermEnergy = 0.0;
+
+        // The 400 ms momentary window is also the gating block of the integrated loudness, with an overlap of 75 %
+        if (numBlocksAvailable >= numBlocksMomentary)
+        {
+            momentaryEnergy = meanOfLastBlocks (numBlocksMomentary);
+
+            const double blockLoudness = -0.691 + 10.0 * std::log10 (momentaryEnergy);
+            if (blockLoudness >= absoluteGate)
+            {
+                const int bin = static_cast<int> ((blockLoudness - absoluteGate) / gatingHistogramResolution);
+                ++gatingHistogram[static_cast<size_t> (std::min (bin, numGatingHistogramBins - 1))];
+            }
+        }
+
+        if (numBlocksAvailable >= numBlocksShortTerm)
+            shortTermEnergy = meanOfLastBlocks (numBlocksShortTerm);
+
+        publishFrame (momentaryEnergy, shortTermEnergy, computeIntegratedEnergy());
+    }
+
+    double LoudnessDataCollector::computeIntegratedEnergy()
+    {
+        // First pass: The mean energy of all blocks above the absolute gate sets the relative gate
+        juce::uint64 numBlocks = 0;
+        double sumOfEnergies = 0.0;
+
+        for (size_t b = 0; b < gatingHistogram.size(); ++b)
+        {
+            numBlocks     += gatingHistogram[b];
+            sumOfEnergies += gatingHistogram[b] * gatingHistogramEnergies[b];
+        }
+
+        if (numBlocks == 0)
+            return 0.0;
+
+        const double relativeThreshold = -0.691 + 10.0 * std::log10 (sumOfEnergies / numBlocks) + relativeGate;
+        const auto firstBinAboveThreshold = static_cast<size_t> (juce::jlimit (0, numGatingHistogramBins, static_cast<int> (std::ceil ((relativeThreshold - absoluteGate) / gatingHistogramResolution))));
+
+        // Second pass: The mean energy of all blocks above the relative gate
+        numBlocks = 0;
+        sumOfEnergies = 0.0;
+
+        for (size_t b = firstBinAboveThreshold; b < gatingHistogram.size(); ++b)
+        {
+            numBlocks     += gatingHistogram[b];
+            sumOfEnergies += gatingHistogram[b] * gatingHistogramEnergies[b];
+        }
+
+        return numBlocks > 0 ? sumOfEnergies / numBlocks : 0.0;
+    }
+
+    void LoudnessDataCollector::publishFrame (double momentaryEnergy, double shortTermEnergy, double integratedEnergy)
+    {
+        auto* block = startWriting();
+
+        // If the frame could not be sent, the true peak is held until the next frame
+        if (block == nullptr)
+            return;
+
+        if (block->getSize() == (firstTruePeak + numValuesPerChannel * numChannels) * sizeof (float))
+        {
+            auto* values = static_cast<float*> (block->getData());
+
+            values[momentaryLoudness]  = energyToLoudness (momentaryEnergy);
+            values[shortTermLoudness]  = energyToLoudness (shortTermEnergy);
+            values[integratedLoudness] = energyToLoudness (integratedEnergy);
+
+            for (int n = 0; n < numChannels; ++n)
+            {
+                const auto ch = static_cast<size_t> (n);
+                truePeakMax[ch] = std::max (truePeakMax[ch], truePeakSinceLastFrame[ch]);
+
+                values[firstTruePeak + numValuesPerChannel * n]     = gainToDB (truePeakSinceLastFrame[ch]);
+                values[firstTruePeak + numValuesPerChannel * n + 1] = gainToDB (truePeakMax[ch]);
+
+                truePeakSinceLastFrame[ch] = 0.0f;
+            }
+        }
+        else
+        {
+            block->fillWith (0);
+        }
+
+        finishedWriting();
+    }
+
+    void LoudnessDataCollector::recalculateMemory()
+    {
+        const auto nc = static_cast<size_t> (numChannels);
+
+        kWeightingFilters.resize (nc);
+        truePeakDetectors.resize (nc);
+
+        for (auto& filter : kWeightingFilters)
+        {
+            if (sampleRate > 0.0)
+                filter.setSampleRate (sampleRate);
+            else
+                filter.reset();
+        }
+
+        for (auto& detector : truePeakDetectors)
+            detector.reset();
+
+        channelEnergies.       assign (nc, 0.0);
+        truePeakSinceLastFrame.assign (nc, 0.0f);
+        truePeakMax.           assign (nc, 0.0f);
+
+        if (gatingHistogramEnergies.empty())
+        {
+            gatingHistogramEnergies.resize (numGatingHistogramBins);
+            for (int b = 0; b < numGatingHistogramBins; ++b)
+            {
+                const double binCenterLoudness = absoluteGate + (b + 0.5) * gatingHistogramResolution;
+                gatingHistogramEnergies[static_cast<size_t> (b)] = std::pow (10.0, (binCenterLoudness + 0.691) / 10.0);
+            }
+        }
+
+        gatingHistogram.assign (numGatingHistogramBins, 0u);
+        std::fill (std::begin (blockEnergies), std::end (blockEnergies), 0.0);
+        newestBlockIdx = 0;
+        numBlocksAvailable = 0;
+        numSamplesInBlock = 0;
+
+        resizeMemoryBlock ((firstTruePeak + numValuesPerChannel * numChannels) * sizeof (float));
+    }
+
+    void LoudnessDataCollector::updateAllGUIParameters()
+    {
+        updateGUIChannels();
+    }
+
+    void LoudnessDataCollector::updateGUIChannels()
+    {
+        juce::var ns (numChannels);
+        juce::var cn (channelNames);
+        sink->applySettingToTarget (*this, settingNumChannels, ns);
+        sink->applySettingToTarget (*this, settingChannelNames, cn);
+    }
+
+    float LoudnessDataCollector::energyToLoudness (double energy)
+    {
+        if (energy <= 0.0)
+            return minusInfinityDB;
+
+        return juce::jmax (minusInfinityDB, static_cast<float> (-0.691 + 10.0 * std::log10 (energy)));
+    }
+
+    float LoudnessDataCollector::gainToDB (float gain)
+    {
+        return juce::Decibels::gainToDecibels (gain, minusInfinityDB);
+    }
+
+    const juce::String LoudnessDataCollector::settingNumChannels             ("numChannels");
+    const juce::String LoudnessDataCollector::settingChannelNames            ("channelNames");
+    const juce::String LoudnessDataCollector::settingResetIntegratedLoudness ("resetIntegratedLoudness");
+
+#if JUCE_UNIT_TESTS
+    /**
+     * Measures the stereo 1 kHz sine sequences of the EBU Tech 3341 minimum requirements test, which check the
+     * loudness of a constant level as well as the relative and the absolute gate of the integrated loudness.
+     */
+    class LoudnessDataCollectorTests : public juce::UnitTest
+    {
+    public:
+        LoudnessDataCollectorTests() : juce::UnitTest ("LoudnessDataCollector", "ntlab") {}
+
+        void runTest() override
+        {
+            beginTest ("Constant level");
+            {
+                auto frame = measure ({{-23.0f, 20.0}});
+                expectWithinAbsoluteError (frame[LoudnessDataCollector::momentaryLoudness],  -23.0f, 0.1f);
+                expectWithinAbsoluteError (frame[LoudnessDataCollector::shortTermLoudness],  -23.0f, 0.1f);
+                expectWithinAbsoluteError (frame[LoudnessDataCollector::integratedLoudness], -23.0f, 0.1f);
+            }
+
+            beginTest ("Relative gate");
+            {
+                // Without the gate, the quiet parts would lower the integrated loudness to about -24.2 LUFS
+                auto frame = measure ({{-36.0f, 10.0}, {-23.0f, 60.0}, {-36.0f, 10.0}});
+                expectWithinAbsoluteError (frame[LoudnessDataCollector::integratedLoudness], -23.0f, 0.1f);
+            }
+
+            beginTest ("Absolute gate");
+            {
+                auto frame = measure ({{-72.0f, 10.0}, {-36.0f, 10.0}, {-23.0f, 60.0}, {-36.0f, 10.0}, {-72.0f, 10.0}});
+                expectWithinAbsoluteError (frame[LoudnessDataCollector::integratedLoudness], -23.0f, 0.1f);
+            }
+
+            beginTest ("Below the absolute gate");
+            {
+                auto frame = measure ({{-75.0f, 10.0}});
+                expectEquals (frame[LoudnessDataCollector::integratedLoudness], LoudnessDataCollector::minusInfinityDB);
+            }
+        }
+
+    private:
+        static constexpr double sampleRate = 48000.0;
+        static constexpr int blockSize = 480;
+
+        struct Segment
+        {
+            float  levelInDBFS;
+            double lengthInSeconds;
+        };
+
+        struct NullSink : public RealtimeDataSink
+        {
+            juce::Result registerDataCollector (DataCollector&) override { return juce::Result::ok(); }
+            void applySettingToTarget (DataCollector&, const juce::String&, const juce::var&) override {}
+        };
+
+        /** Pushes a 1 kHz sine with the same level in both channels and returns the last frame sent */
+        std::vector<float> measure (std::initializer_list<Segment> segments)
+        {
+            NullSink sink;
+            LoudnessDataCollector collector;
+            collector.sink = &sink;
+            collector.setChannels (2);
+            collector.setSampleRate (sampleRate);
+
+            juce::AudioBuffer<float> buffer (2, blockSize);
+
+            // The memory blocks take the size of a frame when they have been read, so both are read once before
+            for (int i = 0; i < 2; ++i)
+            {
+                buffer.clear();
+                collector.pushChannelsSamples (buffer);
+                collector.startReading();
+                collector.finishedReading();
+            }
+
+            collector.setSampleRate (sampleRate);
+
+            juce::int64 sampleIdx = 0;
+            for (auto& segment : segments)
+            {
+                const float amplitude = juce::Decibels::decibelsToGain (segment.levelInDBFS);
+                const auto numBlocks = static_cast<int> (segment.lengthInSeconds * sampleRate / blockSize);
+
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    for (int i = 0; i < blockSize; ++i, ++sampleIdx)
+                    {
+                        const float s = amplitude * static_cast<float> (std::sin (juce::MathConstants<double>::twoPi * 1000.0 * sampleIdx / sampleRate));
+                        buffer.setSample (0, i, s);
+                        buffer.setSample (1, i, s);
+                    }
+
+                    collector.pushChannelsSamples (buffer);
+                }
+            }
+
+            auto& block = collector.startReading();
+            const auto* values = static_cast<const float*> (block.getData());
+            std::vector<float> frame (values, values + block.getSize() / sizeof (float));
+            collector.finishedReading();
+
+            expectEquals (static_cast<int> (frame.size()), LoudnessDataCollector::firstTruePeak + 2 * LoudnessDataCollector::numValuesPerChannel);
+            frame.resize (static_cast<size_t> (LoudnessDataCollector::firstTruePeak + 2 * LoudnessDataCollector::numValuesPerChannel), 0.0f);
+
+            return frame;
+        }
+    };
+
+    static LoudnessDataCollectorTests loudnessDataCollectorTests;
+#endif
+}
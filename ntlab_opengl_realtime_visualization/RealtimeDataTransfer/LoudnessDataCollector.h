@@ -0,0 +1,168 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "RealtimeDataSink.h"
+#include "DataCollector.h"
+#include "../DSP/KWeightingFilter.h"
+#include "../DSP/TruePeakDetector.h"
+
+namespace ntlab
+{
+    /**
+     * An object that measures the loudness and the true peak of a realtime stream as specified by ITU-R BS.1770 and
+     * EBU R128 and periodically sends the results to a corresponding VisualizationTarget, normally a
+     * LoudnessMeterComponent.
+     *
+     * The signal is K-weighted and its energy is accumulated in blocks of 100 ms. From these, the momentary loudness
+     * (400 ms window), the short-term loudness (3 s window) and the gated integrated loudness are computed. For the
+     * integrated loudness, the loudness of each 400 ms block is counted in a histogram with a resolution of 0.1 LU,
+     * so that the measurement can run for an unlimited time without allocating memory. The true peak of each channel
+     * is estimated by 4x oversampling.
+     *
+     * A frame of values is sent every 100 ms, its layout is described by FrameLayout. All loudness values are in
+     * LUFS, all peak values are in dBTP. Values that can't be computed yet are set to minusInfinityDB.
+     *
+     * @see RealtimeDataSink, @see VisualisationDataSource, @see VisualizationTarget, @see LoudnessMeterComponent
+     */
+    class LoudnessDataCollector : public DataCollector
+    {
+    public:
+        static const juce::String settingNumChannels;
+        static const juce::String settingChannelNames;
+        static const juce::String settingResetIntegratedLoudness;
+
+        /** The indices of the values in each frame sent */
+        enum FrameLayout
+        {
+            momentaryLoudness  = 0,
+            shortTermLoudness  = 1,
+            integratedLoudness = 2,
+
+            /** Followed by the true peak of each channel since the last frame and the maximum since the last reset */
+            firstTruePeak      = 3,
+            numValuesPerChannel = 2
+        };
+
+        /** The value sent for loudness and peak values that can't be computed yet */
+        static constexpr float minusInfinityDB = -100.0f;
+
+        /**
+         * Specify an identifier extension to map the DataCollector to the corresponding target.
+         * The Identifier will automatically be prepended by "Loudness"
+         */
+        LoudnessDataCollector (const juce::String identifierExtension = "1") : DataCollector ("Loudness" + identifierExtension) {};
+
+        virtual ~LoudnessDataCollector () {};
+
+        /**
+         * Sets the number of channels measured. The channel weights are set to 1 for all channels, which matches
+         * mono and stereo signals. Keep in mind that the next call to pushChannelSamples will expect a matching new
+         * number of channels so better don't call this while realtime sample processing is running.
+         * @param numChannels    The new number of channels measured
+         * @param channelNames   An Array of size numChannels containing the names to be displayed for each channel
+         */
+        void setChannels (int numChannels, juce::StringArray channelNames = juce::StringArray());
+
+        /**
+         * Sets the weight of each channel when summing up the channel energies. BS.1770 specifies 1.41 for the
+         * surround channels and 0 for the LFE channel. The array passed must contain a weight for each channel.
+         */
+        void setChannelWeights (const juce::Array<float>& weights);
+
+        /** Sets the sample rate used. No data will be sent until the sample rate was set. */
+        void setSampleRate (double newSampleRate);
+
+        /** Restarts the measurement of the integrated loudness and the maximum true peak */
+        void resetIntegratedLoudness();
+
+        /** Pushes an audio buffer holding as much channels as set by setChannels to the sample queue */
+        void pushChannelsSamples (juce::AudioBuffer<float>& bufferToPush);
+
+        /**
+         * Updates all parameters relevant for the Visualization. Call this after (re-)connecting if your collector
+         * to sink connection is network based to keep both ends in sync.
+         */
+        void updateAllGUIParameters();
+
+        void applySettingFromTarget (const juce::String& setting, const juce::var& value) override;
+
+    private:
+
+        // Channels
+        int                           numChannels = 0;
+        juce::StringArray             channelNames;
+        std::vector<double>           channelWeights;
+        std::vector<KWeightingFilter> kWeightingFilters;
+        std::vector<TruePeakDetector> truePeakDetectors;
+
+        // Energy of the current 100 ms block
+        double              sampleRate = 0.0;
+        int                 numSamplesPerBlock = 0;
+        int                 numSamplesInBlock = 0;
+        std::vector<double> channelEnergies;
+
+        // The weighted mean square of the last 30 blocks of 100 ms
+        static constexpr int numBlocksMomentary = 4;
+        static constexpr int numBlocksShortTerm = 30;
+        double blockEnergies[numBlocksShortTerm];
+        int    newestBlockIdx = 0;
+        int    numBlocksAvailable = 0;
+
+        // Histogram of the loudness of all 400 ms gating blocks above the absolute gate
+        static constexpr double absoluteGate = -70.0;
+        static constexpr double relativeGate = -10.0;
+        static constexpr double gatingHistogramResolution = 0.1;
+        static const int numGatingHistogramBins = 800;
+        std::vector<juce::uint32> gatingHistogram;
+        std::vector<double>       gatingHistogramEnergies; // the energy corresponding to the center of each bin
+
+        // True peak values
+        std::vector<float> truePeakSinceLastFrame;
+        std::vector<float> truePeakMax;
+
+        // Scratch buffer for the filtered samples, so that no allocation takes place on the realtime thread
+        static const int chunkSize = 256;
+        float filteredSamples[chunkSize];
+
+        std::recursive_mutex processingLock;
+
+        void finishBlock();
+
+        double computeIntegratedEnergy();
+
+        void publishFrame (double momentaryEnergy, double shortTermEnergy, double integratedEnergy);
+
+        void recalculateMemory();
+
+        void updateGUIChannels();
+
+        static float energyToLoudness (double energy);
+        static float gainToDB (float gain);
+    };
+}
@@ -29,16 +29,24 @@ namespace ntlab
 {
     void OscilloscopeDataCollector::setChannels (int numChannels, juce::StringArray channelNames)
     {
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
         this->numChannels = numChannels;
         this->channelNames = channelNames;
 
         updateGUIChannels();
         recalculateMemory();
+
+        preProcessing.prepare (numChannels);
+
+        if (inputSampleRate > 0.0)
+            recalculateDecimation();
     }
 
     void OscilloscopeDataCollector::setTimeViewed (double timeViewedInSeconds)
     {
         jassert (timeViewedInSeconds > 0.0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
         tView = timeViewedInSeconds;
         recalculateNumSamples();
     }
@@ -46,34 +54,123 @@ namespace ntlab
     void OscilloscopeDataCollector::setSampleRate (double newSampleRate)
     {
         jassert (newSampleRate > 0);
-        tSample = 1.0 / newSampleRate;
-        recalculateNumSamples();
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        inputSampleRate = newSampleRate;
+        recalculateDecimation();
+    }
+
+    void OscilloscopeDataCollector::setVisualBandwidth (double bandwidthInHz)
+    {
+        jassert (bandwidthInHz >= 0.0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        visualBandwidth = bandwidthInHz;
+
+        // the decimation will be calculated as soon as the sample rate is set
+        if (inputSampleRate > 0.0)
+            recalculateDecimation();
+    }
+
+    void OscilloscopeDataCollector::setPreFilterCoefficients (const std::vector<Biquad::Coefficients>& coefficients)
+    {
+        preProcessing.setFilterCoefficients (coefficients);
     }
 
     void OscilloscopeDataCollector::enableTriggering (bool isTriggered, int channelToUse)
     {
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
         triggeringEnabled = isTriggered;
         triggerChannel = channelToUse;
         updateGUITriggering();
     }
 
-    void OscilloscopeDataCollector::pushChannelsSamples (juce::AudioBuffer<float> &bufferToPush)
+    void OscilloscopeDataCollector::setMaxNumPointsPerLine (int maxNumPoints)
     {
-        if (currentWriteBlock == nullptr)
-            currentWriteBlock = startWriting();
+        jassert (maxNumPoints >= 0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        if (maxNumPoints == maxNumPointsPerLine)
+            return;
+
+        maxNumPointsPerLine = maxNumPoints;
+
+        // the number of samples will be calculated as soon as the sample rate is set
+        if (tSample != 1.0)
+            recalculateNumSamples();
+    }
+
+    void OscilloscopeDataCollector::setChunkSize (int numPointsPerChunkToUse)
+    {
+        jassert (numPointsPerChunkToUse >= 0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        chunkSize = numPointsPerChunkToUse;
+
+        // the chunks will be calculated as soon as the sample rate is set
+        if (tSample != 1.0)
+            recalculateNumSamples();
+    }
 
-        if (currentWriteBlock != nullptr)
+    void OscilloscopeDataCollector::pushChannelsSamples (juce::AudioBuffer<float> &bufferToPush)
+    {
+        // The settings thread holds the lock while changing the level of detail or the memory layout
+        if (processingLock.try_lock())
         {
-            size_t blockSizeInBytes = currentWriteBlock->getSize();
+            // An unmatching buffer is passed on directly, collectSamples will fill the block with zeros
             if (bufferToPush.getNumChannels() != numChannels)
+                collectSamples (bufferToPush);
+            else
+                preProcessing.process (bufferToPush, [this] (juce::AudioBuffer<float>& processedSamples) { collectSamples (processedSamples); });
+
+            processingLock.unlock();
+        }
+    }
+
+    void OscilloscopeDataCollector::pushChannelsSamples (const juce::int16* const* channelData, int numChannelsToPush, int numSamples)
+    {
+        if (numChannelsToPush != numChannels)
+        {
+            // The samples are converted into the processing buffer, which only holds the number of channels set
+            jassertfalse;
+            return;
+        }
+
+        // The lock is recursive, so the float version called for each converted chunk takes it again
+        if (processingLock.try_lock())
+        {
+            const float q15Scaling = 1.0f / 32768.0f;
+            auto& processingBuffer = preProcessing.getProcessingBuffer();
+
+            for (int start = 0; start < numSamples; start += DecimatingFilterChain::maxNumSamplesPerChunk)
             {
-                fillUnmatchingBlockWithZeros (blockSizeInBytes);
-                return;
+                const int numSamplesInChunk = std::min (DecimatingFilterChain::maxNumSamplesPerChunk, numSamples - start);
+
+                for (int n = 0; n < numChannels; ++n)
+                {
+                    const juce::int16* readPtr = channelData[n] + start;
+                    float* writePtr = processingBuffer.getWritePointer (n);
+
+                    for (int i = 0; i < numSamplesInChunk; ++i)
+                        writePtr[i] = readPtr[i] * q15Scaling;
+                }
+
+                // decimation and filtering work in place, so the converted chunk can be passed on directly
+                juce::AudioBuffer<float> convertedSamples (processingBuffer.getArrayOfWritePointers(), numChannels, numSamplesInChunk);
+                pushChannelsSamples (convertedSamples);
             }
 
-            if (blockSizeInBytes  != expectedNumBytesForMemoryBlock)
+            processingLock.unlock();
+        }
+    }
+
+    void OscilloscopeDataCollector::collectSamples (juce::AudioBuffer<float>& bufferToPush)
+    {
+        if (acquireWriteBlock())
+        {
+            if (bufferToPush.getNumChannels() != numChannels)
             {
-                fillUnmatchingBlockWithZeros (blockSizeInBytes);
+                fillUnmatchingBlockWithZeros (currentWriteBlock->getSize());
                 return;
             }
 
@@ -82,48 +179,139 @@ namespace ntlab
             if (triggeringEnabled && !foundTriggerInCurrentBlock)
             {
                 const float *tc = bufferToPush.getReadPointer (triggerChannel);
-                for (int i = 1; i < numSamplesInBuffer; ++i)
+                const int i = VectorKernels::findRisingZeroCrossing (tc, numSamplesInBuffer);
+
+                if (i > 0)
                 {
-                    if ((tc[i - 1] <= 0.0f) && (tc[i] > 0.0f))
-                    {
-                        foundTriggerInCurrentBlock = true;
-                        int numSamplesAvailable = numSamplesInBuffer - i;
-                        int numSamplesToCopy = std::min (numSamplesAvailable, (numSamplesExpected - numSamplesInCurrentBlock));
-
-                        for (int n = 0; n < numChannels; ++n)
-                        {
-                            float *writePtr = static_cast<float*> (currentWriteBlock->getData()) + channelOffset[n];
-                            juce::FloatVectorOperations::copy (writePtr, bufferToPush.getReadPointer (n) + i, numSamplesToCopy);
-                        }
-
-                        numSamplesInCurrentBlock = numSamplesToCopy;
-                        break;
-                    }
+                    foundTriggerInCurrentBlock = true;
+                    int numSamplesAvailable = numSamplesInBuffer - i;
+                    int numSamplesToCopy = std::min (numSamplesAvailable, (numSamplesExpected - numSamplesInCurrentBlock));
+
+                    writeSamplesToBlocks (bufferToPush, i, numSamplesToCopy);
                 }
             }
             else
             {
                 int numSamplesToCopy = std::min (numSamplesInBuffer, (numSamplesExpected - numSamplesInCurrentBlock));
-                for (int n = 0; n < numChannels; ++n)
-                {
-                    float *writePtr = static_cast<float*> (currentWriteBlock->getData()) + channelOffset[n] + numSamplesInCurrentBlock;
-                    juce::FloatVectorOperations::copy (writePtr, bufferToPush.getReadPointer (n), numSamplesToCopy);
-                }
-                numSamplesInCurrentBlock += numSamplesToCopy;
+                writeSamplesToBlocks (bufferToPush, 0, numSamplesToCopy);
             }
 
-            if (numSamplesInCurrentBlock == numSamplesExpected)
+            // The block might have been sent with the last chunk or have been unavailable for the next chunk
+            if ((numSamplesInCurrentBlock == numSamplesExpected) && (currentWriteBlock != nullptr))
                 prepareForNextSampleBlock();
 
         }
     }
 
+    void OscilloscopeDataCollector::writeSamplesToBlocks (juce::AudioBuffer<float>& buffer, int startSample, int numSamplesToWrite)
+    {
+        if (numSamplesPerChunk == 0)
+        {
+            writeSamples (buffer, startSample, numSamplesToWrite);
+            return;
+        }
+
+        while (numSamplesToWrite > 0)
+        {
+            // If no block is available, the remaining samples are dropped just like a whole buffer without chunks
+            if (! acquireWriteBlock())
+                return;
+
+            const int numSamplesLeftInChunk = numSamplesPerChunk - (numSamplesInCurrentBlock % numSamplesPerChunk);
+            const int numSamplesInSegment = std::min (numSamplesToWrite, numSamplesLeftInChunk);
+
+            writeSamples (buffer, startSample, numSamplesInSegment);
+
+            startSample       += numSamplesInSegment;
+            numSamplesToWrite -= numSamplesInSegment;
+
+            // The last chunk of a frame is sent by prepareForNextSampleBlock
+            const bool completedChunk = (numSamplesInCurrentBlock % numSamplesPerChunk) == 0;
+            if (! completedChunk || (numSamplesInCurrentBlock == numSamplesExpected))
+                continue;
+
+            // Keep adding chunks to the block while the target hasn't read the last one, as long as the block has space
+            const bool blockIsFull = getNumPointsForSamples (numSamplesInCurrentBlock) - firstPointInBlock >= numPointsPerBlock;
+            if (lastBlockWasRead() || blockIsFull)
+                sendWriteBlock();
+        }
+    }
+
+    bool OscilloscopeDataCollector::acquireWriteBlock()
+    {
+        if (currentWriteBlock == nullptr)
+        {
+            currentWriteBlock = startWriting();
+
+            if (currentWriteBlock == nullptr)
+                return false;
+
+            firstPointInBlock = (numSamplesPerChunk > 0) ? getNumPointsForSamples (numSamplesInCurrentBlock) : 0;
+        }
+
+        // Changing the settings restarts the frame, which might leave a block behind that doesn't match anymore
+        const int blockCapacity = (numSamplesPerChunk > 0) ? numPointsPerBlock : numPointsExpected;
+        const int pointIdxInBlock = getNumPointsForSamples (numSamplesInCurrentBlock) - firstPointInBlock;
+
+        if ((currentWriteBlock->getSize() != expectedNumBytesForMemoryBlock) || (pointIdxInBlock < 0) || (pointIdxInBlock > blockCapacity))
+        {
+            fillUnmatchingBlockWithZeros (currentWriteBlock->getSize());
+            return false;
+        }
+
+        return true;
+    }
+
+    float* OscilloscopeDataCollector::getChannelWritePointer (int channel)
+    {
+        if (numSamplesPerChunk > 0)
+            return Frame<ChunkLayout> (*currentWriteBlock, numChannels, numPointsPerBlock).getChannel (channel);
+
+        return Frame<Layout> (*currentWriteBlock, numChannels, numPointsExpected).getChannel (channel);
+    }
+
+    int OscilloscopeDataCollector::getNumValuesPerChannelInBlock() const
+    {
+        return (numSamplesPerChunk > 0) ? numPointsPerBlock : numPointsExpected;
+    }
+
+    int OscilloscopeDataCollector::getNumPointsForSamples (int numSamples) const
+    {
+        if (numSamplesPerBucket == 1)
+            return numSamples;
+
+        return 2 * ((numSamples + numSamplesPerBucket - 1) / numSamplesPerBucket);
+    }
+
+    void OscilloscopeDataCollector::sendWriteBlock()
+    {
+        if (numSamplesPerChunk > 0)
+        {
+            Frame<ChunkLayout> chunk (*currentWriteBlock, numChannels, numPointsPerBlock);
+
+            // A block of unmatching size is sent filled with zeros, which the target ignores
+            if (chunk.isValid())
+            {
+                const int numPoints = getNumPointsForSamples (numSamplesInCurrentBlock) - firstPointInBlock;
+
+                auto& header = chunk.getHeader();
+                header.chunkIndex = ++chunkIndex;
+                header.firstPoint = firstPointInBlock;
+                header.numPoints  = juce::isPositiveAndNotGreaterThan (numPoints, numPointsPerBlock) ? numPoints : 0;
+            }
+        }
+
+        finishedWriting();
+        currentWriteBlock = nullptr;
+    }
+
     void OscilloscopeDataCollector::applySettingFromTarget (const juce::String& setting, const juce::var& value)
     {
         if (setting == settingTimeViewed)
         {
             if (value.isDouble())
             {
+                std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
                 tView = value;
                 recalculateNumSamples();
             }
@@ -133,6 +321,21 @@ namespace ntlab
             if (value.isBool())
                 enableTriggering (value);
         }
+        else if (setting == settingMaxNumPointsPerLine)
+        {
+            if (value.isInt())
+                setMaxNumPointsPerLine (value);
+        }
+        else if (setting == settingPreFilterCoefficients)
+        {
+            if (value.isString())
+                setPreFilterCoefficients (BiquadFilterChain::coefficientsFromString (value.toString()));
+        }
+    }
+
+    void OscilloscopeDataCollector::writeSamples (juce::AudioBuffer<float>& buffer, int startSample, int numSamplesToWrite)
+    {
+        writeSamplesForChannels<0> (buffer, startSample, numSamplesToWrite);
     }
 
     void OscilloscopeDataCollector::fillUnmatchingBlockWithZeros (size_t blockSizeInBytes)
@@ -143,8 +346,7 @@ namespace ntlab
 
     void OscilloscopeDataCollector::prepareForNextSampleBlock()
     {
-        finishedWriting();
-        currentWriteBlock = nullptr;
+        sendWriteBlock();
         foundTriggerInCurrentBlock = false;
         numSamplesInCurrentBlock = 0;
     }
@@ -155,20 +357,60 @@ namespace ntlab
         jassert (tSample != 1);
         numSamplesExpected = juce::roundToInt (tView / tSample);
         numSamplesInCurrentBlock = 0;
+
+        // Each bucket results in two points, its minimum and maximum
+        if ((maxNumPointsPerLine >= 2) && (numSamplesExpected > maxNumPointsPerLine))
+        {
+            const int maxNumBuckets = maxNumPointsPerLine / 2;
+            numSamplesPerBucket = (numSamplesExpected + maxNumBuckets - 1) / maxNumBuckets;
+            numPointsExpected = 2 * ((numSamplesExpected + numSamplesPerBucket - 1) / numSamplesPerBucket);
+        }
+        else
+        {
+            numSamplesPerBucket = 1;
+            numPointsExpected = numSamplesExpected;
+        }
+
+        if (chunkSize > 0)
+        {
+            numSamplesPerChunk = (numSamplesPerBucket == 1) ? chunkSize : ((chunkSize + 1) / 2) * numSamplesPerBucket;
+            numPointsPerChunk = std::min (getNumPointsForSamples (numSamplesPerChunk), numPointsExpected);
+        }
+        else
+        {
+            numSamplesPerChunk = 0;
+            numPointsPerChunk = 0;
+        }
+
         updateGUITimebase();
         recalculateMemory();
     }
 
-    void OscilloscopeDataCollector::recalculateMemory()
+    void OscilloscopeDataCollector::recalculateDecimation()
     {
-        expectedNumBytesForMemoryBlock = numChannels * numSamplesExpected * sizeof (float);
-        resizeMemoryBlock (expectedNumBytesForMemoryBlock);
+        const int numStages = HalfBandDecimator::getNumStagesForBandwidth (inputSampleRate, visualBandwidth);
+        preProcessing.prepareDecimation (numStages);
+
+        tSample = preProcessing.getDecimationFactor() / inputSampleRate;
+        recalculateNumSamples();
+    }
 
-        channelOffset.resize (numChannels);
-        for (int i = 0; i < numChannels; ++i)
+    void OscilloscopeDataCollector::recalculateMemory()
+    {
+        // With chunks, the memory needed is bounded by the chunk size instead of the time frame viewed
+        if (numSamplesPerChunk > 0)
+        {
+            numPointsPerBlock = std::min (numPointsExpected, maxNumChunksPerBlock * numPointsPerChunk);
+            expectedNumBytesForMemoryBlock = ChunkLayout::getNumBytes (numChannels, numPointsPerBlock);
+        }
+        else
         {
-            channelOffset.set (i, i * numSamplesExpected);
+            expectedNumBytesForMemoryBlock = Layout::getNumBytes (numChannels, numPointsExpected);
         }
+
+        resizeMemoryBlock (expectedNumBytesForMemoryBlock);
+
+        currentBuckets.resize (static_cast<size_t> (numChannels));
     }
 
     void OscilloscopeDataCollector::updateAllGUIParameters()
@@ -180,12 +422,15 @@ namespace ntlab
 
     void OscilloscopeDataCollector::updateGUITimebase()
     {
-        juce::var ts (tSample);
+        // If the samples are decimated, the points sent are spread equally over the time frame viewed
+        juce::var ts ((numSamplesPerBucket == 1) ? tSample : tView / numPointsExpected);
         juce::var tv (tView);
-        juce::var nse (numSamplesExpected);
+        juce::var nse (numPointsExpected);
+        juce::var npc (numPointsPerChunk);
         sink->applySettingToTarget (*this, settingTSample, ts);
         sink->applySettingToTarget (*this, settingTimeViewed, tv);
         sink->applySettingToTarget (*this, settingNumSamples, nse);
+        sink->applySettingToTarget (*this, settingNumPointsPerChunk, npc);
     }
 
     void OscilloscopeDataCollector::updateGUIChannels()
@@ -208,5 +453,184 @@ namespace ntlab
     const juce::String OscilloscopeDataCollector::settingNumSamples   ("numSamples");
     const juce::String OscilloscopeDataCollector::settingNumChannels  ("numChannels");
     const juce::String OscilloscopeDataCollector::settingChannelNames ("channelNames");
+    const juce::String OscilloscopeDataCollector::settingMaxNumPointsPerLine ("maxNumPointsPerLine");
+    const juce::String OscilloscopeDataCollector::settingPreFilterCoefficients ("preFilterCoefficients");
+    const juce::String OscilloscopeDataCollector::settingNumPointsPerChunk ("numPointsPerChunk");
+
+#if JUCE_UNIT_TESTS
+    /**
+     * Checks that an OscilloscopeDataCollectorT sends the same frames as an OscilloscopeDataCollector with the same
+     * number of channels and logs the time per sample of both, with and without decimating the samples to min/max
+     * pairs. Also checks that Q15 samples arrive in the frames without any loss, just like the same samples pushed as
+     * floats.
+     */
+    class OscilloscopeDataCollectorTests : public juce::UnitTest
+    {
+    public:
+        OscilloscopeDataCollectorTests() : juce::UnitTest ("OscilloscopeDataCollector", "ntlab") {}
+
+        void runTest() override
+        {
+            beginTest ("Compile time channel count");
+
+            compareCollectors (0);
+            compareCollectors (200);
+
+            beginTest ("Q15 input");
+
+            checkQ15RoundTrip();
+        }
+
+    private:
+        static constexpr int numChannels = 8;
+        static constexpr int blockSize = 512;
+        static constexpr int numBlocks = 2000;
+        static constexpr int numSamplesViewed = 4800;
+
+        struct NullSink : public RealtimeDataSink
+        {
+            juce::Result registerDataCollector (DataCollector&) override { return juce::Result::ok(); }
+            void applySettingToTarget (DataCollector&, const juce::String&, const juce::var&) override {}
+        };
+
+        void compareCollectors (int maxNumPointsPerLine)
+        {
+            NullSink sink;
+            OscilloscopeDataCollector runtimeChannels;
+            OscilloscopeDataCollectorT<numChannels> compileTimeChannels;
+
+            runtimeChannels.sink = &sink;
+            runtimeChannels.setChannels (numChannels);
+            compileTimeChannels.sink = &sink;
+            compileTimeChannels.setChannels();
+
+            auto random = getRandom();
+            juce::AudioBuffer<float> buffer (numChannels, blockSize);
+            for (int n = 0; n < numChannels; ++n)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample (n, i, random.nextFloat() * 2.0f - 1.0f);
+
+            for (OscilloscopeDataCollector* collector : { &runtimeChannels, static_cast<OscilloscopeDataCollector*> (&compileTimeChannels) })
+            {
+                collector->setMaxNumPointsPerLine (maxNumPointsPerLine);
+                collector->setSampleRate (48000.0);
+                collector->setTimeViewed (numSamplesViewed / 48000.0);
+
+                // The memory blocks take the size of a frame when they have been read, so both are read once before
+                for (int i = 0; i < 2; ++i)
+                {
+                    collector->pushChannelsSamples (buffer);
+                    collector->startReading();
+                    collector->finishedReading();
+                }
+            }
+
+            const double runtimeTime     = measureNsPerSample (runtimeChannels, buffer);
+            const double compileTimeTime = measureNsPerSample (compileTimeChannels, buffer);
+
+            const auto& runtimeFrame     = runtimeChannels.startReading();
+            const auto& compileTimeFrame = compileTimeChannels.startReading();
+            // Each bucket is sent as a pair of points, so the limit passed is reached exactly
+            const int numPointsExpected = (maxNumPointsPerLine > 0) ? maxNumPointsPerLine : numSamplesViewed;
+            expect (runtimeFrame.getSize() == OscilloscopeDataCollectorT<numChannels>::getNumBytesPerFrame (numPointsExpected));
+            expect (runtimeFrame == compileTimeFrame);
+            runtimeChannels.finishedReading();
+            compileTimeChannels.finishedReading();
+
+            logMessage (juce::String (numChannels) + " channels, " + ((maxNumPointsPerLine > 0) ? "min/max pairs" : "all samples")
+                        + ": runtime channel count " + juce::String (runtimeTime, 3) + " ns, compile time channel count "
+                        + juce::String (compileTimeTime, 3) + " ns per sample and channel");
+        }
+
+        void checkQ15RoundTrip()
+        {
+            constexpr int numQ15Channels = 2;
+
+            NullSink sink;
+            OscilloscopeDataCollector floatInput, q15Input;
+
+            // Random samples including both ends of the Q15 range
+            auto random = getRandom();
+            std::vector<juce::int16> q15Samples (static_cast<size_t> (numQ15Channels * blockSize));
+            for (auto& s : q15Samples)
+                s = static_cast<juce::int16> (random.nextInt (65536) - 32768);
+
+            q15Samples[0] = -32768;
+            q15Samples[1] = 32767;
+
+            const juce::int16* q15ChannelData[numQ15Channels];
+            juce::AudioBuffer<float> buffer (numQ15Channels, blockSize);
+            for (int n = 0; n < numQ15Channels; ++n)
+            {
+                q15ChannelData[n] = q15Samples.data() + n * blockSize;
+
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample (n, i, q15ChannelData[n][i] / 32768.0f);
+            }
+
+            for (OscilloscopeDataCollector* collector : { &floatInput, &q15Input })
+            {
+                collector->sink = &sink;
+                collector->setChannels (numQ15Channels);
+                collector->setMaxNumPointsPerLine (0);
+                collector->setSampleRate (48000.0);
+                collector->setTimeViewed (numSamplesViewed / 48000.0);
+            }
+
+            // The memory blocks take the size of a frame when they have been read, so both are read once before
+            for (int i = 0; i < 2; ++i)
+            {
+                floatInput.pushChannelsSamples (buffer);
+                q15Input.pushChannelsSamples (q15ChannelData, numQ15Channels, blockSize);
+
+                for (OscilloscopeDataCollector* collector : { &floatInput, &q15Input })
+                {
+                    collector->startReading();
+                    collector->finishedReading();
+                }
+            }
+
+            for (int b = 0; b < 2 * numSamplesViewed / blockSize; ++b)
+            {
+                floatInput.pushChannelsSamples (buffer);
+                q15Input.pushChannelsSamples (q15ChannelData, numQ15Channels, blockSize);
+            }
+
+            const auto& floatFrame = floatInput.startReading();
+            const auto& q15Frame   = q15Input.startReading();
+            ConstFrame<OscilloscopeDataCollector::Layout> frame (q15Frame, numQ15Channels, numSamplesViewed);
+            expect (frame.isValid());
+            expect (q15Frame == floatFrame);
+
+            // Each value must map back to exactly the Q15 sample it was converted from
+            int numValuesNotInQ15 = 0;
+            for (int i = 0; frame.isValid() && (i < frame.getNumValues()); ++i)
+            {
+                const float q15Value = frame.getValues()[i] * 32768.0f;
+
+                if ((q15Value != std::round (q15Value)) || (q15Value < -32768.0f) || (q15Value > 32767.0f))
+                    ++numValuesNotInQ15;
+            }
+
+            expectEquals (numValuesNotInQ15, 0);
+
+            floatInput.finishedReading();
+            q15Input.finishedReading();
+        }
+
+        static double measureNsPerSample (OscilloscopeDataCollector& collector, juce::AudioBuffer<float>& buffer)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int b = 0; b < numBlocks; ++b)
+                collector.pushChannelsSamples (buffer);
+
+            const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+            return seconds * 1.0e9 / (numBlocks * static_cast<double> (blockSize * numChannels));
+        }
+    };
+
+    static OscilloscopeDataCollectorTests oscilloscopeDataCollectorTests;
+#endif
 }
 
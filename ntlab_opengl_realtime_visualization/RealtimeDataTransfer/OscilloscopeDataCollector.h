@@ -29,6 +29,9 @@ SOFTWARE.
 #include <juce_audio_basics/juce_audio_basics.h>
 #include "RealtimeDataSink.h"
 #include "DataCollector.h"
+#include "Frame.h"
+#include "../DSP/DecimatingFilterChain.h"
+#include "../DSP/VectorKernels.h"
 
 namespace ntlab
 {
@@ -43,6 +46,23 @@ namespace ntlab
      * viewed and the triggering depending on your use-case. Setting these parameters from either side will result in
      * the same behaviour.
      *
+     * If the number of samples in the time frame viewed exceeds the number of points per line the target can display,
+     * the samples are decimated before being sent. For each bucket of consecutive samples the minimum and maximum
+     * value are sent in the order of their occurrence, so that peaks stay visible. The OscilloscopeComponent requests
+     * this limit automatically based on its width in physical pixels.
+     *
+     * For high input sample rates, an optional decimation stage can be enabled by setting the visual bandwidth needed.
+     * The samples are then lowpass filtered and decimated before any further processing and the sample period sent to
+     * the target is adjusted accordingly.
+     *
+     * Additionally, a chain of biquad filters can be applied to the samples before they are displayed, e.g. to view a
+     * DC-blocked or band-limited version of the signal without changing the audio path. The filter runs after the
+     * optional decimation, so its coefficients have to be designed for the sample period sent to the target.
+     *
+     * For very long time frames, the collector can send each frame in chunks as they are filled instead of sending
+     * complete frames, see setChunkSize. This bounds the memory needed by the collector by the chunk size and the
+     * target starts drawing after the first chunk instead of after the whole time frame viewed.
+     *
      * @see RealtimeDataSink, @see VisualisationDataSource, @see VisualizationTarget, @see OscilloscopeComponent
      */
     class OscilloscopeDataCollector : public DataCollector
@@ -54,6 +74,31 @@ namespace ntlab
         static const juce::String settingNumSamples;
         static const juce::String settingNumChannels;
         static const juce::String settingChannelNames;
+        static const juce::String settingMaxNumPointsPerLine;
+        static const juce::String settingPreFilterCoefficients;
+        static const juce::String settingNumPointsPerChunk;
+
+        /** Each frame holds numSamples values per channel */
+        using Layout = FrameLayout<float>;
+
+        /** The header of each block sent if chunks are enabled */
+        struct ChunkHeader
+        {
+            /** Incremented with every block sent, so that a target can tell new blocks from blocks already seen */
+            juce::uint32 chunkIndex;
+
+            /** The index of the first point in the block within the frame */
+            juce::int32 firstPoint;
+
+            /** The number of valid points per channel in the block */
+            juce::int32 numPoints;
+        };
+
+        /**
+         * If chunks are enabled, each block holds a section of the frame, starting at the first point given by the
+         * header. The values per channel are the capacity of the block, of which only numPoints are valid.
+         */
+        using ChunkLayout = FrameLayout<float, ChunkHeader>;
 
         /**
          * Specify an identifier extension to map the DataCollector to the corresponding target.
@@ -80,12 +125,50 @@ namespace ntlab
         /** Sets the sample rate used. The oscilloscope won't display any data until the sample rate was set. */
         void setSampleRate (double newSampleRate);
 
+        /**
+         * Sets the signal bandwidth that should be visible. If the sample rate is a lot higher than needed for this
+         * bandwidth, the samples are decimated by a power of two before being processed, which reduces the load of
+         * both the collector and the display. The decimation factor is chosen automatically so that the bandwidth
+         * passed is kept. Pass 0 to disable decimation, which is the default. Like the sample rate, this should not
+         * be changed while realtime sample processing is running.
+         */
+        void setVisualBandwidth (double bandwidthInHz);
+
+        /**
+         * Sets the coefficients of the biquad sections applied to all channels before the samples are displayed. Pass
+         * an empty vector to disable filtering, which is the default. This can safely be called while realtime sample
+         * processing is running, the new coefficients are applied with the next buffer pushed without resetting the
+         * filter state.
+         */
+        void setPreFilterCoefficients (const std::vector<Biquad::Coefficients>& coefficients);
+
         /**
          * Enables or disables the triggering. If it is enabled, it will wait for a rising edge on channelToUse
          * before capturing the next frame which will result in a more stable display for most kinds of signals
          */
         void enableTriggering (bool isTriggered, int channelToUse = 0);
 
+        /**
+         * Limits the number of points sent per channel. If more samples fall into the time frame viewed, they will be
+         * decimated by sending the minimum and maximum of each bucket of samples. Pass 0 to disable the limit.
+         * Normally, this is set by the OscilloscopeComponent depending on its size.
+         */
+        void setMaxNumPointsPerLine (int maxNumPoints);
+
+        /**
+         * Sends each frame in chunks of the given number of points per channel as soon as they are filled instead of
+         * sending complete frames. The target assembles the chunks into the lines drawn, so that it shows the current
+         * frame sweeping over the previous one. Chunks completed while the target has not read the last one are
+         * merged into one block as long as it can hold them, the blocks hold up to maxNumChunksPerBlock chunks.
+         * If the points are decimated, the number of points per chunk is rounded up to an even number. Pass 0 to
+         * send complete frames, which is the default. Like the sample rate, this should not be changed while realtime
+         * sample processing is running.
+         */
+        void setChunkSize (int numPointsPerChunkToUse);
+
+        /** The maximum number of chunks merged into one block if the target didn't keep up */
+        static const int maxNumChunksPerBlock = 8;
+
         /**
          * Pushes an audio buffer to the sample queue holding as much channels as should
          * be displayed. If an unmatching channel count will be passed, the internal buffer
@@ -93,6 +176,14 @@ namespace ntlab
          */
         void pushChannelsSamples (juce::AudioBuffer<float> &bufferToPush);
 
+        /**
+         * Pushes 16 bit fixed-point samples in Q15 format, e.g. directly from the DMA buffers of an audio codec on an
+         * embedded sender. The samples are converted chunk-wise into a buffer allocated by setChannels, so this
+         * doesn't allocate either. Unlike the float version, the number of channels passed must match the number of
+         * channels set, otherwise the samples are ignored.
+         */
+        void pushChannelsSamples (const juce::int16* const* channelData, int numChannelsToPush, int numSamples);
+
         /**
          * Updates all parameters relevant for the Visualization. Call this after (re-)connecting if your collector
          * to sink connection is network based to keep both ends in sync.
@@ -101,34 +192,102 @@ namespace ntlab
 
         void applySettingFromTarget (const juce::String& setting, const juce::var& value) override;
 
+    protected:
+
+        /** Copies or decimates the samples passed into the current write block */
+        virtual void writeSamples (juce::AudioBuffer<float>& buffer, int startSample, int numSamplesToWrite);
+
+        /**
+         * The implementation of writeSamples shared by all variants of the collector. If CompileTimeNumChannels is
+         * greater than zero, it is used instead of the runtime channel count, so that the compiler can unroll the
+         * channel loops. The values of all channels are stored one after another in the write block.
+         */
+        template <int CompileTimeNumChannels>
+        void writeSamplesForChannels (juce::AudioBuffer<float>& buffer, int startSample, int numSamplesToWrite);
+
     private:
 
         // Channels
         int                 numChannels = 0;
         juce::StringArray   channelNames;
-        juce::Array<size_t> channelOffset;
 
         // Memory
         juce::MemoryBlock* currentWriteBlock = nullptr;
         size_t             expectedNumBytesForMemoryBlock = 0;
         int                numSamplesInCurrentBlock = 0;
 
+        // Decimation and filtering, applied in chunks before the samples are collected
+        double inputSampleRate = 0.0;
+        double visualBandwidth = 0.0;
+        DecimatingFilterChain preProcessing;
+
         // Time
         double tSample = 1.0;
         double tView = 0.01;
         int    numSamplesExpected = 0;
 
+        // Level of detail. numPointsExpected is the number of values per channel actually sent
+        struct MinMaxBucket
+        {
+            float min, max;
+            int   minIdx, maxIdx;
+        };
+
+        int maxNumPointsPerLine = 0;
+        int numSamplesPerBucket = 1;
+        int numPointsExpected = 0;
+        std::vector<MinMaxBucket> currentBuckets;
+
+        // Chunks. Chunks end at bucket boundaries, so that each bucket is written to a single block
+        int          chunkSize = 0;
+        int          numSamplesPerChunk = 0;
+        int          numPointsPerChunk = 0;
+        int          numPointsPerBlock = 0;
+        int          firstPointInBlock = 0;
+        juce::uint32 chunkIndex = 0;
+
         // Triggering
         bool triggeringEnabled = false;
         bool foundTriggerInCurrentBlock = false;
         int  triggerChannel = 0;
 
+        std::recursive_mutex processingLock;
+
+        /** Collects the samples passed after they have optionally been decimated and filtered */
+        void collectSamples (juce::AudioBuffer<float>& buffer);
+
+        /**
+         * Writes the samples to the current write block. If chunks are enabled, the write block is sent whenever a
+         * chunk is completed and the target has read the last block sent.
+         */
+        void writeSamplesToBlocks (juce::AudioBuffer<float>& buffer, int startSample, int numSamplesToWrite);
+
+        /**
+         * Makes sure a write block with the expected size is held. Returns false if no block is available or if the
+         * block had to be sent filled with zeros because it didn't match the current settings.
+         */
+        bool acquireWriteBlock();
+
+        /** Returns the first value of a channel in the current write block */
+        float* getChannelWritePointer (int channel);
+
+        /** Returns the number of values per channel the current write block holds */
+        int getNumValuesPerChannelInBlock() const;
+
+        /** Returns the number of points the first numSamples samples of a frame result in */
+        int getNumPointsForSamples (int numSamples) const;
+
+        /** Sends the current write block, adding the chunk header if chunks are enabled */
+        void sendWriteBlock();
+
         void fillUnmatchingBlockWithZeros (size_t blockSizeInBytes);
 
         void prepareForNextSampleBlock();
 
         void recalculateNumSamples();
 
+        void recalculateDecimation();
+
         void recalculateMemory();
 
         void updateGUITimebase();
@@ -137,4 +296,129 @@ namespace ntlab
 
         void updateGUITriggering();
     };
+
+    /**
+     * A variant of the OscilloscopeDataCollector with a channel count fixed at compile time, e.g. for mono, stereo or
+     * eight channel configurations. As the channel count is known to the compiler, the loops over all channels on
+     * the realtime thread can be unrolled. Apart from setChannels, which only takes the channel names, it behaves
+     * exactly like the OscilloscopeDataCollector and works with the same OscilloscopeComponent. The size of the frames
+     * and the offsets of the channels in them only depend on the number of values per channel.
+     */
+    template <int NumChannels>
+    class OscilloscopeDataCollectorT : public OscilloscopeDataCollector
+    {
+    public:
+        static_assert (NumChannels > 0, "An OscilloscopeDataCollectorT needs at least one channel");
+
+        /** The number of channels of every frame sent */
+        static constexpr int numFrameChannels = NumChannels;
+
+        /** Returns the size in bytes of a complete frame holding numValuesPerChannel values per channel */
+        static constexpr size_t getNumBytesPerFrame (int numValuesPerChannel) { return Layout::getNumBytes (NumChannels, numValuesPerChannel); }
+
+        /** Returns the size in bytes of a block holding numPointsPerBlock points per channel if chunks are enabled */
+        static constexpr size_t getNumBytesPerChunkBlock (int numPointsPerBlock) { return ChunkLayout::getNumBytes (NumChannels, numPointsPerBlock); }
+
+        /** Returns the index of the first value of a channel below NumChannels among the values of a frame or block */
+        static constexpr size_t getChannelOffset (int channel, int numValuesPerChannel) { return Layout::getChannelOffset (channel, numValuesPerChannel); }
+
+        OscilloscopeDataCollectorT (const juce::String identifierExtension = "1") : OscilloscopeDataCollector (identifierExtension) {};
+
+        /**
+         * Sets the names of the NumChannels channels displayed by the oscilloscope. This has to be called once before
+         * pushing samples, just like OscilloscopeDataCollector::setChannels.
+         */
+        void setChannels (juce::StringArray channelNames = juce::StringArray())
+        {
+            OscilloscopeDataCollector::setChannels (NumChannels, channelNames);
+        }
+
+        /** The number of channels is fixed by NumChannels, use setChannels with the channel names only */
+        void setChannels (int numChannels, juce::StringArray channelNames) = delete;
+
+    protected:
+        void writeSamples (juce::AudioBuffer<float>& buffer, int startSample, int numSamplesToWrite) override
+        {
+            writeSamplesForChannels<NumChannels> (buffer, startSample, numSamplesToWrite);
+        }
+    };
+
+    template <int CompileTimeNumChannels>
+    void OscilloscopeDataCollector::writeSamplesForChannels (juce::AudioBuffer<float>& buffer, int startSample, int numSamplesToWrite)
+    {
+        const int numChannelsToWrite = (CompileTimeNumChannels > 0) ? CompileTimeNumChannels : numChannels;
+        jassert (numChannelsToWrite == numChannels);
+
+        // The channels are stored one after another, so they are addressed from the first channel instead of checking
+        // the block for each channel
+        float* const firstChannel = getChannelWritePointer (0);
+        const int numValuesPerChannel = getNumValuesPerChannelInBlock();
+        auto channelWritePointer = [&] (int n) { return firstChannel + Layout::getChannelOffset (n, numValuesPerChannel); };
+
+        // The block holds the points from firstPointInBlock on, which is only greater than zero if chunks are enabled
+        if (numSamplesPerBucket == 1)
+        {
+            for (int n = 0; n < numChannelsToWrite; ++n)
+                juce::FloatVectorOperations::copy (channelWritePointer (n) + (numSamplesInCurrentBlock - firstPointInBlock), buffer.getReadPointer (n, startSample), numSamplesToWrite);
+
+            numSamplesInCurrentBlock += numSamplesToWrite;
+            return;
+        }
+
+        for (int n = 0; n < numChannelsToWrite; ++n)
+        {
+            const float* readPtr = buffer.getReadPointer (n, startSample);
+            float* writePtr = channelWritePointer (n);
+            auto& bucket = currentBuckets[static_cast<size_t> (n)];
+
+            int sampleIdx = numSamplesInCurrentBlock;
+            int numSamplesLeft = numSamplesToWrite;
+
+            // process the samples bucket-wise, a bucket might span multiple calls to pushChannelsSamples
+            while (numSamplesLeft > 0)
+            {
+                const int idxInBucket = sampleIdx % numSamplesPerBucket;
+                const int numSamplesInSegment = std::min (numSamplesLeft, numSamplesPerBucket - idxInBucket);
+
+                const auto minMax = VectorKernels::findMinMax (readPtr, numSamplesInSegment);
+                const int minIdx = idxInBucket + minMax.minIdx;
+                const int maxIdx = idxInBucket + minMax.maxIdx;
+
+                if (idxInBucket == 0)
+                {
+                    bucket = { minMax.min, minMax.max, minIdx, maxIdx };
+                }
+                else
+                {
+                    if (minMax.min < bucket.min)
+                    {
+                        bucket.min    = minMax.min;
+                        bucket.minIdx = minIdx;
+                    }
+
+                    if (minMax.max > bucket.max)
+                    {
+                        bucket.max    = minMax.max;
+                        bucket.maxIdx = maxIdx;
+                    }
+                }
+
+                readPtr        += numSamplesInSegment;
+                sampleIdx      += numSamplesInSegment;
+                numSamplesLeft -= numSamplesInSegment;
+
+                // write the bucket if it's complete or if it is the last, incomplete bucket of the block
+                if (((sampleIdx % numSamplesPerBucket) == 0) || (sampleIdx == numSamplesExpected))
+                {
+                    const int pointIdx = 2 * ((sampleIdx - 1) / numSamplesPerBucket) - firstPointInBlock;
+                    const bool minFirst = bucket.minIdx <= bucket.maxIdx;
+
+                    writePtr[pointIdx]     = minFirst ? bucket.min : bucket.max;
+                    writePtr[pointIdx + 1] = minFirst ? bucket.max : bucket.min;
+                }
+            }
+        }
+
+        numSamplesInCurrentBlock += numSamplesToWrite;
+    }
 }
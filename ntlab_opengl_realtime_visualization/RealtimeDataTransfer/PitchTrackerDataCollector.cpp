@@ -0,0 +1,336 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "PitchTrackerDataCollector.h"
+
+namespace ntlab
+{
+    void PitchTrackerDataCollector::setAnalysisParameters (int newFFTOrder, int newHopSize)
+    {
+        jassert (newFFTOrder > 2);
+        jassert (newHopSize > 0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        fftOrder = newFFTOrder;
+        hopSize = newHopSize;
+
+        recalculateMemory();
+        updateGUIHistory();
+    }
+
+    void PitchTrackerDataCollector::setFrequencyRange (juce::Range<float> newFrequencyRange)
+    {
+        jassert (newFrequencyRange.getStart() > 0.0f);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        frequencyRange = newFrequencyRange;
+        recalculateMemory();
+    }
+
+    void PitchTrackerDataCollector::setThreshold (double newThreshold)
+    {
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        threshold = static_cast<float> (newThreshold);
+        updateGUIThreshold();
+    }
+
+    void PitchTrackerDataCollector::setHistoryLength (double historyLengthInSeconds)
+    {
+        jassert (historyLengthInSeconds > 0.0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        historyLength = historyLengthInSeconds;
+
+        recalculateMemory();
+        updateGUIHistory();
+    }
+
+    void PitchTrackerDataCollector::setSampleRate (double newSampleRate)
+    {
+        jassert (newSampleRate > 0);
+
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        sampleRate = newSampleRate;
+
+        recalculateMemory();
+        updateGUIHistory();
+    }
+
+    void PitchTrackerDataCollector::pushChannelsSamples (juce::AudioBuffer<float>& bufferToPush)
+    {
+        const int numChannels = bufferToPush.getNumChannels();
+
+        if ((numChannels == 0) || (fft == nullptr) || (sampleRate <= 0.0))
+            return;
+
+        if (processingLock.try_lock())
+        {
+            const int numSamples = bufferToPush.getNumSamples();
+
+            // A buffer might span the end of the ring or a hop, so it is processed in segments
+            for (int start = 0; start < numSamples;)
+            {
+                const int numSamplesInSegment = std::min ({ numSamples - start, fftLength - ringWritePosition, hopSize - numSamplesSinceLastAnalysis });
+                float* ringSegment = inputRing.data() + ringWritePosition;
+
+                juce::FloatVectorOperations::copy (ringSegment, bufferToPush.getReadPointer (0, start), numSamplesInSegment);
+                for (int n = 1; n < numChannels; ++n)
+                    juce::FloatVectorOperations::add (ringSegment, bufferToPush.getReadPointer (n, start), numSamplesInSegment);
+
+                if (numChannels > 1)
+                    juce::FloatVectorOperations::multiply (ringSegment, 1.0f / numChannels, numSamplesInSegment);
+
+                start                       += numSamplesInSegment;
+                ringWritePosition            = (ringWritePosition + numSamplesInSegment) % fftLength;
+                numSamplesCollected          = std::min (numSamplesCollected + numSamplesInSegment, fftLength);
+                numSamplesSinceLastAnalysis += numSamplesInSegment;
+
+                if (numSamplesSinceLastAnalysis == hopSize)
+                {
+                    numSamplesSinceLastAnalysis = 0;
+
+                    if (numSamplesCollected == fftLength)
+                    {
+                        const float pitch = analyzeFrame();
+
+                        if (pitch != unvoicedValue)
+                        {
+                            if (lastVoicedPitch == unvoicedValue)
+                                std::fill (history.begin(), history.end(), pitch);
+
+                            lastVoicedPitch = pitch;
+                        }
+
+                        history[static_cast<size_t> (historyWritePosition)] = lastVoicedPitch;
+                        historyWritePosition = (historyWritePosition + 1) % numValues;
+
+                        publishHistory();
+                    }
+                }
+            }
+
+            processingLock.unlock();
+        }
+    }
+
+    void PitchTrackerDataCollector::applySettingFromTarget (const juce::String& setting, const juce::var& value)
+    {
+        if (setting == settingHistoryLength)
+        {
+            if (value.isDouble())
+                setHistoryLength (value);
+        }
+        else if (setting == settingThreshold)
+        {
+            if (value.isDouble())
+                setThreshold (value);
+        }
+    }
+
+    float PitchTrackerDataCollector::analyzeFrame()
+    {
+        // The oldest sample in the ring is the one that will be overwritten next
+        std::copy (inputRing.begin() + ringWritePosition, inputRing.end(), frame.begin());
+        std::copy (inputRing.begin(), inputRing.begin() + ringWritePosition, frame.begin() + (fftLength - ringWritePosition));
+
+        // The energy of any range of samples can be computed from the prefix sum of the squared samples
+        energyPrefixSum[0] = 0.0;
+        for (int j = 0; j < fftLength; ++j)
+            energyPrefixSum[static_cast<size_t> (j + 1)] = energyPrefixSum[static_cast<size_t> (j)] + frame[static_cast<size_t> (j)] * frame[static_cast<size_t> (j)];
+
+        // Silence has no pitch and would lead to a division by zero in the normalization
+        if (energyPrefixSum[static_cast<size_t> (integrationWindow)] < 1e-10)
+            return unvoicedValue;
+
+        computeDifferenceFunction();
+
+        const float period = findPeriod();
+        if (period <= 0.0f)
+            return unvoicedValue;
+
+        return 69.0f + 12.0f * std::log2 (static_cast<float> (sampleRate) / (period * 440.0f));
+    }
+
+    void PitchTrackerDataCollector::computeDifferenceFunction()
+    {
+        // The difference function d(tau) = sum (x[j] - x[j + tau])^2 over the integration window expands to the sum of
+        // two energies minus twice the cross-correlation of the window with the whole frame. The cross-correlation is
+        // computed in the frequency domain. As both signals are real, the window is transformed in the real part and
+        // the frame in the imaginary part of a single complex FFT.
+        for (int j = 0; j < fftLength; ++j)
+        {
+            const float sample = frame[static_cast<size_t> (j)];
+            fftBuffer[static_cast<size_t> (j)] = std::complex<float> (j < integrationWindow ? sample : 0.0f, sample);
+        }
+
+        fft->perform (fftBuffer.data(), spectrum.data(), false);
+
+        for (int k = 0; k < fftLength; ++k)
+        {
+            const std::complex<float> z        = spectrum[static_cast<size_t> (k)];
+            const std::complex<float> zMirrored = std::conj (spectrum[static_cast<size_t> ((fftLength - k) % fftLength)]);
+
+            const std::complex<float> windowSpectrum = 0.5f * (z + zMirrored);
+            const std::complex<float> frameSpectrum  = std::complex<float> (0.0f, -0.5f) * (z - zMirrored);
+
+            crossSpectrum[static_cast<size_t> (k)] = std::conj (windowSpectrum) * frameSpectrum;
+        }
+
+        fft->perform (crossSpectrum.data(), fftBuffer.data(), true);
+
+        // The difference function for all lags is independent per lag, so this loop can be vectorized
+        const double windowEnergy = energyPrefixSum[static_cast<size_t> (integrationWindow)];
+        const double* prefix = energyPrefixSum.data();
+        const std::complex<float>* correlation = fftBuffer.data();
+        float* difference = normalizedDifference.data();
+
+        for (int tau = 1; tau <= maxPeriod + 1; ++tau)
+            difference[tau] = static_cast<float> (windowEnergy + (prefix[tau + integrationWindow] - prefix[tau]) - 2.0 * correlation[tau].real());
+
+        // The cumulative mean normalization divides each value by the mean of all values for smaller lags
+        difference[0] = 1.0f;
+        double sum = 0.0;
+        for (int tau = 1; tau <= maxPeriod + 1; ++tau)
+        {
+            sum += difference[tau];
+            difference[tau] = (sum > 0.0) ? static_cast<float> (difference[tau] * tau / sum) : 1.0f;
+        }
+    }
+
+    float PitchTrackerDataCollector::findPeriod() const
+    {
+        const float* difference = normalizedDifference.data();
+
+        for (int tau = minPeriod; tau <= maxPeriod; ++tau)
+        {
+            if (difference[tau] < threshold)
+            {
+                // Follow the dip down to its local minimum
+                while ((tau < maxPeriod) && (difference[tau + 1] < difference[tau]))
+                    ++tau;
+
+                // A parabola through the minimum and its neighbours estimates the period with sub-sample accuracy
+                const float left  = difference[tau - 1];
+                const float right = difference[tau + 1];
+                const float curvature = left - 2.0f * difference[tau] + right;
+
+                if (curvature > 0.0f)
+                    return tau + 0.5f * (left - right) / curvature;
+
+                return static_cast<float> (tau);
+            }
+        }
+
+        return 0.0f;
+    }
+
+    void PitchTrackerDataCollector::publishHistory()
+    {
+        auto* block = startWriting();
+
+        // If the history could not be sent now, it will be sent after the next hop
+        if (block == nullptr)
+            return;
+
+        Frame<Layout> outputFrame (*block, 1, static_cast<int> (history.size()));
+
+        if (outputFrame.isValid())
+        {
+            // The oldest value is the one that will be overwritten next
+            auto* values = outputFrame.getValues();
+            const auto numOldValues = history.size() - static_cast<size_t> (historyWritePosition);
+
+            std::copy (history.begin() + historyWritePosition, history.end(), values);
+            std::copy (history.begin(), history.begin() + historyWritePosition, values + numOldValues);
+        }
+        else
+        {
+            block->fillWith (0);
+        }
+
+        finishedWriting();
+    }
+
+    void PitchTrackerDataCollector::recalculateMemory()
+    {
+        fftLength = 1 << fftOrder;
+        integrationWindow = fftLength / 2;
+        fft.reset (new juce::dsp::FFT (fftOrder));
+
+        inputRing.assign (static_cast<size_t> (fftLength), 0.0f);
+        ringWritePosition = 0;
+        numSamplesCollected = 0;
+        numSamplesSinceLastAnalysis = 0;
+
+        frame.                assign (static_cast<size_t> (fftLength), 0.0f);
+        energyPrefixSum.      assign (static_cast<size_t> (fftLength + 1), 0.0);
+        fftBuffer.            assign (static_cast<size_t> (fftLength), {});
+        spectrum.             assign (static_cast<size_t> (fftLength), {});
+        crossSpectrum.        assign (static_cast<size_t> (fftLength), {});
+        normalizedDifference. assign (static_cast<size_t> (integrationWindow + 1), 1.0f);
+
+        // The difference function is valid for lags up to the integration window, the parabolic interpolation needs
+        // one more lag than the longest period searched
+        maxPeriod = integrationWindow - 2;
+        minPeriod = 2;
+
+        if (sampleRate > 0.0)
+        {
+            maxPeriod = juce::jlimit (2, integrationWindow - 2, static_cast<int> (std::ceil  (sampleRate / frequencyRange.getStart())));
+            minPeriod = juce::jlimit (2, maxPeriod,             static_cast<int> (std::floor (sampleRate / frequencyRange.getEnd())));
+            numValues = std::max (2, juce::roundToInt (historyLength * sampleRate / hopSize));
+        }
+
+        history.assign (static_cast<size_t> (std::max (numValues, 1)), unvoicedValue);
+        historyWritePosition = 0;
+        lastVoicedPitch = unvoicedValue;
+
+        resizeMemoryBlock (history.size() * sizeof (float));
+    }
+
+    void PitchTrackerDataCollector::updateAllGUIParameters()
+    {
+        updateGUIHistory();
+        updateGUIThreshold();
+    }
+
+    void PitchTrackerDataCollector::updateGUIHistory()
+    {
+        juce::var nv (numValues);
+        juce::var hl (historyLength);
+        sink->applySettingToTarget (*this, settingNumValues, nv);
+        sink->applySettingToTarget (*this, settingHistoryLength, hl);
+    }
+
+    void PitchTrackerDataCollector::updateGUIThreshold()
+    {
+        juce::var th (static_cast<double> (threshold));
+        sink->applySettingToTarget (*this, settingThreshold, th);
+    }
+
+    const juce::String PitchTrackerDataCollector::settingNumValues     ("numValues");
+    const juce::String PitchTrackerDataCollector::settingHistoryLength ("historyLength");
+    const juce::String PitchTrackerDataCollector::settingThreshold     ("threshold");
+}
@@ -0,0 +1,151 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+#include "RealtimeDataSink.h"
+#include "DataCollector.h"
+#include "Frame.h"
+
+namespace ntlab
+{
+    /**
+     * An object that tracks the fundamental frequency of a realtime stream with the YIN algorithm and periodically
+     * sends the pitch history to a corresponding VisualizationTarget, normally a PitchTrackerComponent.
+     *
+     * All channels pushed are mixed down to mono. Each hop, the YIN difference function of the most recent block of
+     * samples is computed through an FFT based autocorrelation, so that the cost per analysis is O(N log N) instead
+     * of O(N^2). It is normalized by its cumulative mean and the first dip below the threshold is refined by a
+     * parabolic interpolation.
+     *
+     * The pitch values are sent as a roll-mode history with the oldest value first. They are expressed as MIDI note
+     * numbers, with 69 being 440 Hz, so that a linear axis matches the musical perception of pitch. Frames considered
+     * unvoiced repeat the last pitch detected, so that the line doesn't jump between the pitch and a value far off the
+     * note range displayed. When the first pitch is detected, the whole history is filled with it.
+     *
+     * @see RealtimeDataSink, @see VisualisationDataSource, @see VisualizationTarget, @see PitchTrackerComponent
+     */
+    class PitchTrackerDataCollector : public DataCollector
+    {
+    public:
+        static const juce::String settingNumValues;
+        static const juce::String settingHistoryLength;
+        static const juce::String settingThreshold;
+
+        /** The value sent as long as no pitch has been detected since the parameters were changed */
+        static constexpr float unvoicedValue = 0.0f;
+
+        /** Each frame holds a single channel of numValues pitch values, ordered from the oldest to the newest one */
+        using Layout = FrameLayout<float>;
+
+        /**
+         * Specify an identifier extension to map the DataCollector to the corresponding target.
+         * The Identifier will automatically be prepended by "PitchTracker"
+         */
+        PitchTrackerDataCollector (const juce::String identifierExtension = "1") : DataCollector ("PitchTracker" + identifierExtension) {};
+
+        virtual ~PitchTrackerDataCollector() {};
+
+        /**
+         * Sets the order of the FFT and the hop size in samples. Half of the FFT length is used as integration window,
+         * the other half limits the longest period that can be detected. The default is an order of 11 and a hop size of
+         * 256 samples, which tracks pitches down to about 50 Hz at 48 kHz.
+         */
+        void setAnalysisParameters (int newFFTOrder, int newHopSize);
+
+        /** Limits the range of fundamental frequencies searched */
+        void setFrequencyRange (juce::Range<float> newFrequencyRange);
+
+        /**
+         * Sets the threshold of the cumulative mean normalized difference below which a period is accepted. Lower
+         * values reject more unclear frames, higher values accept more noisy frames. Default value: 0.15
+         */
+        void setThreshold (double newThreshold);
+
+        /** Sets the time span in seconds covered by the pitch history sent */
+        void setHistoryLength (double historyLengthInSeconds);
+
+        /** Sets the sample rate used. No data will be sent until the sample rate was set. */
+        void setSampleRate (double newSampleRate);
+
+        /** Pushes an audio buffer to the collector. All channels are mixed down to mono */
+        void pushChannelsSamples (juce::AudioBuffer<float>& bufferToPush);
+
+        /**
+         * Updates all parameters relevant for the Visualization. Call this after (re-)connecting if your collector
+         * to sink connection is network based to keep both ends in sync.
+         */
+        void updateAllGUIParameters();
+
+        void applySettingFromTarget (const juce::String& setting, const juce::var& value) override;
+
+    private:
+
+        // Analysis
+        std::unique_ptr<juce::dsp::FFT> fft;
+        int fftOrder = 11;
+        int fftLength = 0;
+        int integrationWindow = 0;
+        int hopSize = 256;
+        int minPeriod = 0, maxPeriod = 0;
+        juce::Range<float> frequencyRange {50.0f, 2000.0f};
+        float threshold = 0.15f;
+        double sampleRate = 0.0;
+
+        // The most recent fftLength samples
+        std::vector<float> inputRing;
+        int ringWritePosition = 0;
+        int numSamplesCollected = 0;
+        int numSamplesSinceLastAnalysis = 0;
+
+        // Scratch buffers, allocated when the parameters change
+        std::vector<float>               frame;
+        std::vector<double>              energyPrefixSum;
+        std::vector<std::complex<float>> fftBuffer, spectrum, crossSpectrum;
+        std::vector<float>               normalizedDifference;
+
+        // Pitch history, as ring buffer
+        double historyLength = 5.0;
+        int numValues = 0;
+        std::vector<float> history;
+        int historyWritePosition = 0;
+        float lastVoicedPitch = unvoicedValue;
+
+        std::recursive_mutex processingLock;
+
+        float analyzeFrame();
+        void  computeDifferenceFunction();
+        float findPeriod() const;
+        void  publishHistory();
+
+        void recalculateMemory();
+
+        void updateGUIHistory();
+        void updateGUIThreshold();
+    };
+}
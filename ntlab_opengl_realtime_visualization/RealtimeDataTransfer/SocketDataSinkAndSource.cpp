@@ -0,0 +1,633 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#include "SocketDataSinkAndSource.h"
+
+namespace ntlab
+{
+    bool SocketProtocol::writeMessage (juce::StreamingSocket& socket, MessageType type, int collectorIdx, const void* payload, size_t payloadSize)
+    {
+        jassert (payloadSize <= maxPayloadSize);
+
+        const juce::uint32 header[] = { juce::ByteOrder::swapIfBigEndian (magicNumber),
+                                        juce::ByteOrder::swapIfBigEndian (static_cast<juce::uint32> (type)),
+                                        juce::ByteOrder::swapIfBigEndian (static_cast<juce::uint32> (collectorIdx)),
+                                        juce::ByteOrder::swapIfBigEndian (static_cast<juce::uint32> (payloadSize)) };
+        static_assert (sizeof (header) == headerSize, "Unexpected header size");
+
+        return writeAll (socket, header, headerSize) && writeAll (socket, payload, payloadSize);
+    }
+
+    bool SocketProtocol::readMessage (juce::StreamingSocket& socket, MessageType& type, int& collectorIdx, juce::MemoryBlock& payload)
+    {
+        juce::uint32 header[4];
+
+        if (socket.read (header, static_cast<int> (headerSize), true) != static_cast<int> (headerSize))
+            return false;
+
+        if (juce::ByteOrder::swapIfBigEndian (header[0]) != magicNumber)
+            return false;
+
+        const auto payloadSize = static_cast<size_t> (juce::ByteOrder::swapIfBigEndian (header[3]));
+        if (payloadSize > maxPayloadSize)
+            return false;
+
+        type = static_cast<MessageType> (juce::ByteOrder::swapIfBigEndian (header[1]));
+        collectorIdx = static_cast<int> (juce::ByteOrder::swapIfBigEndian (header[2]));
+
+        // Only reallocates if the frame size changed
+        if (payload.getSize() != payloadSize)
+            payload.setSize (payloadSize);
+
+        if (payloadSize == 0)
+            return true;
+
+        return socket.read (payload.getData(), static_cast<int> (payloadSize), true) == static_cast<int> (payloadSize);
+    }
+
+    juce::MemoryBlock SocketProtocol::encodeSetting (const juce::String& setting, const juce::var& value)
+    {
+        juce::MemoryOutputStream stream;
+        stream.writeString (setting);
+        value.writeToStream (stream);
+
+        return stream.getMemoryBlock();
+    }
+
+    void SocketProtocol::decodeSetting (const juce::MemoryBlock& payload, juce::String& setting, juce::var& value)
+    {
+        juce::MemoryInputStream stream (payload, false);
+        setting = stream.readString();
+        value = juce::var::readFromStream (stream);
+    }
+
+    bool SocketProtocol::writeAll (juce::StreamingSocket& socket, const void* data, size_t numBytes)
+    {
+        auto* bytes = static_cast<const char*> (data);
+
+        while (numBytes > 0)
+        {
+            const int numBytesWritten = socket.write (bytes, static_cast<int> (numBytes));
+            if (numBytesWritten <= 0)
+                return false;
+
+            bytes    += numBytesWritten;
+            numBytes -= static_cast<size_t> (numBytesWritten);
+        }
+
+        return true;
+    }
+
+    void SocketProtocol::MessageQueue::add (MessageType type, int collectorIdx, juce::MemoryBlock payload)
+    {
+        std::lock_guard<std::mutex> scopedLock (lock);
+        queuedMessages.push_back ({ type, collectorIdx, std::move (payload) });
+    }
+
+    void SocketProtocol::MessageQueue::clear()
+    {
+        std::lock_guard<std::mutex> scopedLock (lock);
+        queuedMessages.clear();
+    }
+
+    bool SocketProtocol::MessageQueue::sendAll (juce::StreamingSocket& socket)
+    {
+        // The queue is only locked while taking the messages, not while sending them
+        {
+            std::lock_guard<std::mutex> scopedLock (lock);
+            messagesToSend.swap (queuedMessages);
+        }
+
+        bool success = true;
+        for (auto& message : messagesToSend)
+        {
+            success = writeMessage (socket, message.type, message.collectorIdx, message.payload.getData(), message.payload.getSize());
+            if (! success)
+                break;
+        }
+
+        messagesToSend.clear();
+        return success;
+    }
+
+    //==================================================================================================================
+    SocketDataSink::SocketDataSink (const juce::String& hostName, int portNumber)
+      : juce::Thread ("SocketDataSink"),
+        hostName (hostName),
+        portNumber (portNumber)
+    {
+        for (auto& flag : frameReady)
+            flag = false;
+    }
+
+    SocketDataSink::~SocketDataSink()
+    {
+        signalThreadShouldExit();
+        socket.close();
+        stopThread (2 * connectionTimeoutMs);
+
+        for (auto* collector : collectors)
+        {
+            collector->dataBlockReady = [] (int) {};
+            collector->sink = nullptr;
+        }
+    }
+
+    juce::Result SocketDataSink::registerDataCollector (DataCollector& dataCollector)
+    {
+        // Register all collectors before starting the sink
+        jassert (! isThreadRunning());
+
+        if (collectors.size() == maxNumCollectors)
+        {
+            jassertfalse;
+            return juce::Result::fail ("Failed to register " + dataCollector.id + ", the maximum number of collectors is reached");
+        }
+
+        dataCollector.sinkIdx = collectors.size();
+        dataCollector.sink = this;
+
+        // This is called from the realtime thread, so it only raises the flag polled by the network thread
+        dataCollector.dataBlockReady = [this] (int sinkIdx) { frameReady[static_cast<size_t> (sinkIdx)] = true; };
+
+        collectors.add (&dataCollector);
+        latestSettings.add (juce::NamedValueSet());
+
+        return juce::Result::ok();
+    }
+
+    void SocketDataSink::applySettingToTarget (DataCollector& dataCollector, const juce::String& setting, const juce::var& value)
+    {
+        std::lock_guard<std::mutex> scopedLock (settingsLock);
+        latestSettings.getReference (dataCollector.sinkIdx).set (setting, value);
+
+        if (connected)
+            outgoingMessages.add (SocketProtocol::settingToTarget, dataCollector.sinkIdx, SocketProtocol::encodeSetting (setting, value));
+    }
+
+    void SocketDataSink::start()
+    {
+        startThread();
+    }
+
+    void SocketDataSink::run()
+    {
+        while (! threadShouldExit())
+        {
+            if (! connected)
+            {
+                if (! socket.connect (hostName, portNumber, connectionTimeoutMs))
+                {
+                    wait (connectionTimeoutMs);
+                    continue;
+                }
+
+                connected = sendRegistrationAndSettings();
+            }
+
+            if (connected)
+                connected = receiveMessages() && outgoingMessages.sendAll (socket) && sendFrames();
+
+            if (! connected)
+            {
+                socket.close();
+                continue;
+            }
+
+            wait (pollIntervalMs);
+        }
+
+        connected = false;
+    }
+
+    bool SocketDataSink::sendRegistrationAndSettings()
+    {
+        for (int i = 0; i < collectors.size(); ++i)
+        {
+            const auto& id = collectors[i]->id;
+            if (! SocketProtocol::writeMessage (socket, SocketProtocol::registerCollector, i, id.toRawUTF8(), id.getNumBytesAsUTF8()))
+                return false;
+        }
+
+        // Settings sent while not being connected are replaced by the latest value of each setting
+        {
+            std::lock_guard<std::mutex> scopedLock (settingsLock);
+            outgoingMessages.clear();
+
+            for (int i = 0; i < collectors.size(); ++i)
+                for (auto& setting : latestSettings.getReference (i))
+                    outgoingMessages.add (SocketProtocol::settingToTarget, i, SocketProtocol::encodeSetting (setting.name.toString(), setting.value));
+        }
+
+        // The most recent frame of each collector is sent right after the settings
+        for (int i = 0; i < collectors.size(); ++i)
+            frameReady[static_cast<size_t> (i)] = true;
+
+        return true;
+    }
+
+    bool SocketDataSink::sendFrames()
+    {
+        for (int i = 0; i < collectors.size(); ++i)
+        {
+            if (! frameReady[static_cast<size_t> (i)].exchange (false))
+                continue;
+
+            // The frame is copied, so that the collector can swap its blocks again while the frame is being sent
+            auto* collector = collectors.getUnchecked (i);
+            auto& block = collector->startReading();
+            frameToSend.replaceAll (block.getData(), block.getSize());
+            collector->finishedReading();
+
+            if (! SocketProtocol::writeMessage (socket, SocketProtocol::frame, i, frameToSend.getData(), frameToSend.getSize()))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool SocketDataSink::receiveMessages()
+    {
+        for (;;)
+        {
+            const int ready = socket.waitUntilReady (true, 0);
+            if (ready == 0)
+                return true;
+
+            SocketProtocol::MessageType type;
+            int collectorIdx;
+
+            if ((ready < 0) || ! SocketProtocol::readMessage (socket, type, collectorIdx, receivedPayload))
+                return false;
+
+            if ((type != SocketProtocol::settingToCollector) || ! juce::isPositiveAndBelow (collectorIdx, collectors.size()))
+            {
+                // The source seems to use a different protocol version
+                jassertfalse;
+                continue;
+            }
+
+            juce::String setting;
+            juce::var value;
+            SocketProtocol::decodeSetting (receivedPayload, setting, value);
+
+            collectors[collectorIdx]->applySettingFromTarget (setting, value);
+        }
+    }
+
+    //==================================================================================================================
+    SocketDataSource::SocketDataSource (int portNumber)
+      : juce::Thread ("SocketDataSource"),
+        portNumber (portNumber)
+    {}
+
+    SocketDataSource::~SocketDataSource()
+    {
+        signalThreadShouldExit();
+
+        // Closing the sockets unblocks the network thread if it waits for a connection or a message
+        listener.close();
+
+        {
+            std::lock_guard<std::mutex> scopedLock (connectionLock);
+            if (connection != nullptr)
+                connection->close();
+        }
+
+        stopThread (1000);
+        cancelPendingUpdate();
+    }
+
+    void SocketDataSource::registerVisualizationTarget (VisualizationTarget& visualizationTargetToAdd)
+    {
+        // Register all targets before starting the source
+        jassert (! isThreadRunning());
+
+        visualizationTargetToAdd.targetIdx = channels.size();
+        visualizationTargetToAdd.setDataSource (this);
+
+        auto* channel = channels.add (new TargetChannel);
+        channel->target = &visualizationTargetToAdd;
+    }
+
+    bool SocketDataSource::start()
+    {
+        if (! listener.createListener (portNumber))
+            return false;
+
+        startThread();
+        return true;
+    }
+
+    juce::MemoryBlock& SocketDataSource::startReading (VisualizationTarget& target)
+    {
+        auto* channel = channels[target.targetIdx];
+        channel->lock.lock();
+
+        if (channel->hasPendingBlock)
+        {
+            channel->readBlock.swapWith (channel->pendingBlock);
+            channel->hasPendingBlock = false;
+        }
+
+        return channel->readBlock;
+    }
+
+    void SocketDataSource::finishedReading (VisualizationTarget& target)
+    {
+        channels[target.targetIdx]->lock.unlock();
+    }
+
+    void SocketDataSource::applySettingToCollector (VisualizationTarget& target, const juce::String& setting, const juce::var& value)
+    {
+        auto* channel = channels[target.targetIdx];
+
+        std::lock_guard<std::mutex> scopedLock (settingsLock);
+        channel->latestSettings.set (setting, value);
+
+        const int collectorIdx = channel->collectorIdx;
+        if (collectorIdx >= 0)
+            outgoingMessages.add (SocketProtocol::settingToCollector, collectorIdx, SocketProtocol::encodeSetting (setting, value));
+    }
+
+    void SocketDataSource::run()
+    {
+        while (! threadShouldExit())
+        {
+            if (connection == nullptr)
+            {
+                // Blocks until a sink connects or the listener is closed
+                std::unique_ptr<juce::StreamingSocket> newConnection (listener.waitForNextConnection());
+                if (newConnection == nullptr)
+                    continue;
+
+                {
+                    std::lock_guard<std::mutex> scopedLock (connectionLock);
+                    connection = std::move (newConnection);
+                }
+
+                outgoingMessages.clear();
+                connected = true;
+            }
+
+            const int ready = connection->waitUntilReady (true, pollIntervalMs);
+
+            SocketProtocol::MessageType type;
+            int collectorIdx;
+
+            bool success = ready >= 0;
+            if (success && (ready == 1))
+                success = SocketProtocol::readMessage (*connection, type, collectorIdx, receivedPayload) && handleMessage (type, collectorIdx);
+
+            if (success)
+                success = outgoingMessages.sendAll (*connection);
+
+            if (! success)
+                closeConnection();
+        }
+
+        closeConnection();
+    }
+
+    bool SocketDataSource::handleMessage (SocketProtocol::MessageType type, int collectorIdx)
+    {
+        if (type == SocketProtocol::registerCollector)
+        {
+            if (! juce::isPositiveAndBelow (collectorIdx, SocketDataSink::maxNumCollectors))
+                return false;
+
+            const auto id = juce::String::fromUTF8 (static_cast<const char*> (receivedPayload.getData()), static_cast<int> (receivedPayload.getSize()));
+
+            int targetIdx = -1;
+            for (int i = 0; i < channels.size(); ++i)
+                if (channels[i]->target->id.toString() == id)
+                    targetIdx = i;
+
+            // Seems that the identifier strings of collector and target don't match
+            if (targetIdx == -1)
+            {
+                DBG ("SocketDataSource: No target found for collector " + id);
+            }
+
+            while (targetIdxForCollector.size() <= collectorIdx)
+                targetIdxForCollector.add (-1);
+
+            targetIdxForCollector.set (collectorIdx, targetIdx);
+
+            if (targetIdx == -1)
+                return true;
+
+            // Send all settings applied by the target so far to its collector
+            auto* channel = channels[targetIdx];
+
+            std::lock_guard<std::mutex> scopedLock (settingsLock);
+            channel->collectorIdx = collectorIdx;
+
+            for (auto& setting : channel->latestSettings)
+                outgoingMessages.add (SocketProtocol::settingToCollector, collectorIdx, SocketProtocol::encodeSetting (setting.name.toString(), setting.value));
+
+            return true;
+        }
+
+        // Messages of collectors without a matching target are dropped
+        if (! juce::isPositiveAndBelow (collectorIdx, targetIdxForCollector.size()))
+            return true;
+
+        const int targetIdx = targetIdxForCollector.getUnchecked (collectorIdx);
+        if (targetIdx < 0)
+            return true;
+
+        if (type == SocketProtocol::frame)
+        {
+            // The received block is swapped in, so the memory of the previous pending frame is used for the next one
+            auto* channel = channels[targetIdx];
+
+            std::lock_guard<std::mutex> scopedLock (channel->lock);
+            channel->pendingBlock.swapWith (receivedPayload);
+            channel->hasPendingBlock = true;
+
+            return true;
+        }
+
+        if (type == SocketProtocol::settingToTarget)
+        {
+            SettingForTarget settingForTarget { targetIdx, {}, {} };
+            SocketProtocol::decodeSetting (receivedPayload, settingForTarget.setting, settingForTarget.value);
+
+            {
+                std::lock_guard<std::mutex> scopedLock (settingsLock);
+                settingsForTargets.push_back (std::move (settingForTarget));
+            }
+
+            triggerAsyncUpdate();
+            return true;
+        }
+
+        // The sink seems to use a different protocol version
+        jassertfalse;
+        return false;
+    }
+
+    void SocketDataSource::handleAsyncUpdate()
+    {
+        std::vector<SettingForTarget> settings;
+
+        {
+            std::lock_guard<std::mutex> scopedLock (settingsLock);
+            settings.swap (settingsForTargets);
+        }
+
+        for (auto& s : settings)
+            channels[s.targetIdx]->target->applySettingFromCollector (s.setting, s.value);
+    }
+
+    void SocketDataSource::closeConnection()
+    {
+        {
+            std::lock_guard<std::mutex> scopedLock (connectionLock);
+            connection.reset();
+        }
+
+        connected = false;
+        targetIdxForCollector.clearQuick();
+
+        std::lock_guard<std::mutex> scopedLock (settingsLock);
+        for (auto* channel : channels)
+            channel->collectorIdx = -1;
+    }
+
+#if JUCE_UNIT_TESTS
+    /**
+     * Sends messages over a socket connection on the local machine and checks that type, collector index and payload
+     * arrive unchanged, that settings survive their encoding and that corrupted or incomplete messages are rejected.
+     */
+    class SocketProtocolTests : public juce::UnitTest
+    {
+    public:
+        SocketProtocolTests() : juce::UnitTest ("SocketProtocol", "ntlab") {}
+
+        void runTest() override
+        {
+            beginTest ("Connection");
+
+            juce::StreamingSocket listener;
+            int port = firstPort;
+            while ((port < firstPort + numPortsToTry) && ! listener.createListener (port, "127.0.0.1"))
+                ++port;
+
+            expect (port < firstPort + numPortsToTry, "No free port to listen on");
+
+            juce::StreamingSocket sender;
+            expect (sender.connect ("127.0.0.1", port, 1000));
+
+            std::unique_ptr<juce::StreamingSocket> receiver (listener.waitForNextConnection());
+            expect (receiver != nullptr);
+
+            if (! sender.isConnected() || (receiver == nullptr))
+                return;
+
+            beginTest ("Frame messages");
+
+            // Sizes are kept below the socket buffer size, as sender and receiver run on the same thread
+            for (int numValues : { 0, 1, 37, 4096 })
+            {
+                std::vector<float> values (static_cast<size_t> (numValues));
+                for (size_t i = 0; i < values.size(); ++i)
+                    values[i] = static_cast<float> (i) * 0.25f - 100.0f;
+
+                const int collectorIdx = numValues % SocketDataSink::maxNumCollectors;
+                expect (SocketProtocol::writeMessage (sender, SocketProtocol::frame, collectorIdx, values.data(), values.size() * sizeof (float)));
+
+                SocketProtocol::MessageType type;
+                int receivedCollectorIdx = -1;
+                juce::MemoryBlock payload;
+                expect (SocketProtocol::readMessage (*receiver, type, receivedCollectorIdx, payload));
+
+                expect (type == SocketProtocol::frame);
+                expectEquals (receivedCollectorIdx, collectorIdx);
+                expect (payload.getSize() == values.size() * sizeof (float));
+                expect (payload.matches (values.data(), values.size() * sizeof (float)));
+            }
+
+            beginTest ("Setting messages");
+
+            for (const juce::var& value : { juce::var (0.5), juce::var (42), juce::var ("[-1, 1]") })
+            {
+                const auto encoded = SocketProtocol::encodeSetting ("amplitudeRange", value);
+                expect (SocketProtocol::writeMessage (sender, SocketProtocol::settingToTarget, 3, encoded.getData(), encoded.getSize()));
+
+                SocketProtocol::MessageType type;
+                int collectorIdx = -1;
+                juce::MemoryBlock payload;
+                expect (SocketProtocol::readMessage (*receiver, type, collectorIdx, payload));
+                expect (type == SocketProtocol::settingToTarget);
+                expectEquals (collectorIdx, 3);
+
+                juce::String setting;
+                juce::var decodedValue;
+                SocketProtocol::decodeSetting (payload, setting, decodedValue);
+                expectEquals (setting, juce::String ("amplitudeRange"));
+                expect (decodedValue == value);
+            }
+
+            beginTest ("Invalid messages");
+
+            SocketProtocol::MessageType type;
+            int collectorIdx;
+            juce::MemoryBlock payload;
+
+            writeHeader (sender, SocketProtocol::magicNumber + 1, 0);
+            expect (! SocketProtocol::readMessage (*receiver, type, collectorIdx, payload), "Wrong magic number accepted");
+
+            writeHeader (sender, SocketProtocol::magicNumber, static_cast<juce::uint32> (SocketProtocol::maxPayloadSize + 1));
+            expect (! SocketProtocol::readMessage (*receiver, type, collectorIdx, payload), "Oversized payload accepted");
+
+            // The connection breaks before the announced payload is complete
+            writeHeader (sender, SocketProtocol::magicNumber, 100);
+            const char incompletePayload[10] = {};
+            sender.write (incompletePayload, static_cast<int> (sizeof (incompletePayload)));
+            sender.close();
+            expect (! SocketProtocol::readMessage (*receiver, type, collectorIdx, payload), "Incomplete payload accepted");
+        }
+
+    private:
+        static constexpr int firstPort = 52800;
+        static constexpr int numPortsToTry = 100;
+
+        static void writeHeader (juce::StreamingSocket& socket, juce::uint32 magicNumber, juce::uint32 payloadSize)
+        {
+            const juce::uint32 header[] = { juce::ByteOrder::swapIfBigEndian (magicNumber),
+                                            juce::ByteOrder::swapIfBigEndian (static_cast<juce::uint32> (SocketProtocol::frame)),
+                                            0,
+                                            juce::ByteOrder::swapIfBigEndian (payloadSize) };
+
+            socket.write (header, static_cast<int> (sizeof (header)));
+        }
+    };
+
+    static SocketProtocolTests socketProtocolTests;
+#endif
+}
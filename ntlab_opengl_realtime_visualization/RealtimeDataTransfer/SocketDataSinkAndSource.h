@@ -0,0 +1,246 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include "RealtimeDataSink.h"
+#include "VisualizationDataSource.h"
+#include <array>
+#include <atomic>
+
+namespace ntlab
+{
+    /**
+     * The message format shared by the SocketDataSink and the SocketDataSource. Each message consists of a header of
+     * headerSize bytes, holding a magic number, the message type, the index of the collector on the sender side and
+     * the payload size, followed by the payload itself. All header fields are sent as little endian 32 bit integers.
+     * Frames are sent as they are, settings as their name followed by the value written by juce::var::writeToStream.
+     */
+    class SocketProtocol
+    {
+    public:
+        enum MessageType : juce::uint32
+        {
+            /** Sent by the sink after connecting, one per collector. The payload is the collector identifier */
+            registerCollector = 1,
+
+            /** A frame sent from a collector to its target */
+            frame = 2,
+
+            /** A setting sent from a collector to its target */
+            settingToTarget = 3,
+
+            /** A setting sent from a target to its collector */
+            settingToCollector = 4
+        };
+
+        static const juce::uint32 magicNumber = 0x6e746c62;
+        static const size_t headerSize = 16;
+
+        /** Messages announcing a bigger payload are considered as corrupted and close the connection */
+        static const size_t maxPayloadSize = 1 << 26;
+
+        /** Writes a complete message. Returns false if the connection broke */
+        static bool writeMessage (juce::StreamingSocket& socket, MessageType type, int collectorIdx, const void* payload, size_t payloadSize);
+
+        /** Blocks until a complete message was read. Returns false if the connection broke or the message was invalid */
+        static bool readMessage (juce::StreamingSocket& socket, MessageType& type, int& collectorIdx, juce::MemoryBlock& payload);
+
+        static juce::MemoryBlock encodeSetting (const juce::String& setting, const juce::var& value);
+
+        static void decodeSetting (const juce::MemoryBlock& payload, juce::String& setting, juce::var& value);
+
+        /**
+         * A queue of non-realtime messages like settings. Messages can be added from any thread, they are sent by the
+         * thread managing the connection.
+         */
+        class MessageQueue
+        {
+        public:
+            void add (MessageType type, int collectorIdx, juce::MemoryBlock payload);
+
+            void clear();
+
+            /** Sends all messages queued so far. Returns false if the connection broke */
+            bool sendAll (juce::StreamingSocket& socket);
+
+        private:
+            struct Message
+            {
+                MessageType type;
+                int collectorIdx;
+                juce::MemoryBlock payload;
+            };
+
+            std::mutex lock;
+            std::vector<Message> queuedMessages, messagesToSend;
+        };
+
+    private:
+        static bool writeAll (juce::StreamingSocket& socket, const void* data, size_t numBytes);
+    };
+
+    /**
+     * A RealtimeDataSink sending the frames of all collectors over a TCP connection to a SocketDataSource, e.g. from
+     * a GUI-less sender running on an embedded device to a visualization application on another machine. It only
+     * depends on juce_core, the connection is managed by a background thread which (re-)connects to the host passed
+     * as long as the sink exists.
+     *
+     * To use it, register all collectors, then call start. The collectors only notify the sink about a new frame by
+     * setting an atomic flag, so the realtime thread never touches the socket. The network thread polls these flags
+     * every pollIntervalMs, copies the most recent frame of each collector and sends it. If the connection is slower
+     * than the collectors, frames are dropped, never queued. The last value of each setting sent to a target is kept
+     * and sent again after reconnecting. Settings received from targets are applied on the network thread.
+     */
+    class SocketDataSink : public RealtimeDataSink, private juce::Thread
+    {
+    public:
+        static const int maxNumCollectors = 64;
+        static const int pollIntervalMs = 5;
+        static const int connectionTimeoutMs = 1000;
+
+        /** Creates a sink that connects to a SocketDataSource listening on the host and port passed */
+        SocketDataSink (const juce::String& hostName, int portNumber);
+
+        ~SocketDataSink();
+
+        /** Registers a collector. All collectors must be registered before calling start */
+        juce::Result registerDataCollector (DataCollector& dataCollector) override;
+
+        void applySettingToTarget (DataCollector& dataCollector, const juce::String& setting, const juce::var& value) override;
+
+        /** Starts the network thread, which will try to connect until it succeeds */
+        void start();
+
+        /** Returns true if the sink is currently connected to a source */
+        bool isConnected() const { return connected; }
+
+    private:
+        const juce::String hostName;
+        const int portNumber;
+
+        juce::StreamingSocket socket;
+        std::atomic<bool> connected { false };
+
+        juce::Array<DataCollector*> collectors;
+        std::array<std::atomic<bool>, maxNumCollectors> frameReady;
+        juce::MemoryBlock frameToSend, receivedPayload;
+
+        std::mutex settingsLock;
+        juce::Array<juce::NamedValueSet> latestSettings;
+        SocketProtocol::MessageQueue outgoingMessages;
+
+        void run() override;
+
+        bool sendRegistrationAndSettings();
+
+        bool sendFrames();
+
+        bool receiveMessages();
+    };
+
+    /**
+     * A VisualizationDataSource receiving frames from a SocketDataSink over a TCP connection. It listens on the port
+     * passed and accepts one sink at a time, a new sink can connect as soon as the previous one disconnected. Targets
+     * are mapped to the collectors of the sink by their identifier.
+     *
+     * To use it, register all targets, then call start. Each target reads the most recent frame received, frames
+     * arriving while a target is reading are held back until it has finished. Settings received from collectors are
+     * applied on the message thread, just like settings sent by the targets, which are queued and sent by the network
+     * thread. The last value of each setting sent to a collector is kept and sent again after a sink connected.
+     */
+    class SocketDataSource : public VisualizationDataSource, private juce::Thread, private juce::AsyncUpdater
+    {
+    public:
+        static const int pollIntervalMs = 5;
+
+        SocketDataSource (int portNumber);
+
+        ~SocketDataSource();
+
+        /** Registers a target. All targets must be registered before calling start */
+        void registerVisualizationTarget (VisualizationTarget& visualizationTargetToAdd) override;
+
+        /** Starts listening for a sink to connect. Returns false if the port couldn't be opened */
+        bool start();
+
+        /** Returns true if a sink is currently connected */
+        bool isConnected() const { return connected; }
+
+        juce::MemoryBlock& startReading (VisualizationTarget& target) override;
+
+        void finishedReading (VisualizationTarget& target) override;
+
+        void applySettingToCollector (VisualizationTarget& target, const juce::String& setting, const juce::var& value) override;
+
+    private:
+        struct TargetChannel
+        {
+            VisualizationTarget* target;
+
+            // The index of the corresponding collector on the sink side, -1 if the collector is unknown
+            std::atomic<int> collectorIdx { -1 };
+
+            std::mutex lock;
+            juce::MemoryBlock readBlock, pendingBlock;
+            bool hasPendingBlock = false;
+
+            juce::NamedValueSet latestSettings;
+        };
+
+        struct SettingForTarget
+        {
+            int targetIdx;
+            juce::String setting;
+            juce::var value;
+        };
+
+        const int portNumber;
+
+        juce::StreamingSocket listener;
+
+        // The connection is only replaced by the network thread, the lock allows closing it from the destructor
+        std::mutex connectionLock;
+        std::unique_ptr<juce::StreamingSocket> connection;
+        std::atomic<bool> connected { false };
+
+        juce::OwnedArray<TargetChannel> channels;
+        juce::Array<int> targetIdxForCollector;
+        juce::MemoryBlock receivedPayload;
+
+        std::mutex settingsLock;
+        std::vector<SettingForTarget> settingsForTargets;
+        SocketProtocol::MessageQueue outgoingMessages;
+
+        void run() override;
+
+        void handleAsyncUpdate() override;
+
+        void closeConnection();
+
+        bool handleMessage (SocketProtocol::MessageType type, int collectorIdx);
+    };
+}
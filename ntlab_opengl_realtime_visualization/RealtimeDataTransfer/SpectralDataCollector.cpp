@@ -28,7 +28,7 @@ SOFTWARE.
 namespace ntlab
 {
 
-    SpectralDataCollector::SpectralDataCollector (const juce::String identifierExtension) : DataCollector ("SpectralAnalyzer" + identifierExtension) {}
+    SpectralDataCollector::SpectralDataCollector (const juce::String identifierExtension) : FFTDataCollector ("SpectralAnalyzer" + identifierExtension) {}
 
     void SpectralDataCollector::setChannels (int numChannels, juce::StringArray &channelNames)
     {
@@ -42,10 +42,7 @@ namespace ntlab
     void SpectralDataCollector::setFFTOrder (int newFFTOrder)
     {
         std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
-        fftOrder = newFFTOrder;
-        numSamplesExpected = 1 << fftOrder;
-        fft.reset (new juce::dsp::FFT (fftOrder));
-        windowingFunction.reset (new juce::dsp::WindowingFunction<float> (static_cast<size_t> (numSamplesExpected), juce::dsp::WindowingFunction<float>::hamming));
+        prepareFFT (newFFTOrder, juce::dsp::WindowingFunction<float>::rectangular);
         recalculateMemory();
 
         updateGUIFFTOrder();
@@ -61,34 +58,34 @@ namespace ntlab
         sampleRate = newSampleRate;
         startFrequency = newStartFrequency;
 
-        updateGUIFrequencySpan();
+        recalculateDecimation();
     }
 
-    void SpectralDataCollector::pushChannelsSamples (juce::AudioBuffer<float> &bufferToPush)
+    void SpectralDataCollector::setVisualBandwidth (double bandwidthInHz)
     {
-        if (bufferToPush.getNumChannels() != numChannels)
-            return;
+        jassert (bandwidthInHz >= 0.0);
+        visualBandwidth = bandwidthInHz;
 
-        if (processingLock.try_lock ())
-        {
-            int numSamplesInPassedBuffer = bufferToPush.getNumSamples();
-            int numSamplesToCopy = std::min (numSamplesInPassedBuffer, (numSamplesExpected - numSamplesInSampleBuffer));
+        // the decimation will be calculated as soon as the sample rate is set
+        if (sampleRate > 0.0)
+            recalculateDecimation();
+    }
 
-            for (int n = 0; n < numChannels; ++n)
-            {
-                auto writePtr = sampleBuffer.get() + channelOffset[n] + numSamplesInSampleBuffer;
-                auto readPtr = bufferToPush.getReadPointer (n);
+    void SpectralDataCollector::setMaxNumPointsPerLine (int maxNumPoints)
+    {
+        jassert (maxNumPoints >= 0);
 
-                // todo: speedup through simd usage?
-                for (int s = 0; s < numSamplesToCopy; ++s)
-                    writePtr[s] = std::complex<float> (readPtr[s], 0.0f);
-            }
-            numSamplesInSampleBuffer += numSamplesToCopy;
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
 
-            if (numSamplesInSampleBuffer >= numSamplesExpected)
-                processFFT();
+        if (maxNumPoints == maxNumPointsPerLine)
+            return;
 
-            processingLock.unlock();
+        maxNumPointsPerLine = maxNumPoints;
+
+        if (fftOrder != 0)
+        {
+            recalculateMemory();
+            updateGUINumBinsPerLine();
         }
     }
 
@@ -102,77 +99,116 @@ namespace ntlab
     void SpectralDataCollector::applySettingFromTarget (const juce::String &setting, const juce::var &value)
     {
         if (setting == settingFFTOrder)
+        {
             if (value.isInt())
                 setFFTOrder (value);
+        }
+        else if (setting == settingMaxNumPointsPerLine)
+        {
+            if (value.isInt())
+                setMaxNumPointsPerLine (value);
+        }
+        else if (setting == settingPreFilterCoefficients)
+        {
+            if (value.isString())
+                setPreFilterCoefficients (BiquadFilterChain::coefficientsFromString (value.toString()));
+        }
     }
 
     void SpectralDataCollector::recalculateMemory ()
     {
         std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
-        numSamplesAllChannels = numChannels * numSamplesExpected;
-        expectedNumBytesForMemoryBlock = numSamplesAllChannels * sizeof (float);
+
+        // The bins from DC up to half the sample rate, the last value of a line always holds the bin at half the
+        // sample rate on its own
+        const int numBinsBelowHalfSampleRate = numSamplesExpected / 2;
+
+        numBinsPooled = 1;
+        if (maxNumPointsPerLine > 0)
+            while (((numBinsBelowHalfSampleRate / numBinsPooled + 1) > maxNumPointsPerLine) && (numBinsPooled < numBinsBelowHalfSampleRate))
+                numBinsPooled *= 2;
+
+        numBinsPerLine = (numSamplesExpected > 0) ? numBinsBelowHalfSampleRate / numBinsPooled + 1 : 0;
+        numValuesAllChannels = numChannels * numBinsPerLine;
+        expectedNumBytesForMemoryBlock = Layout::getNumBytes (numChannels, numBinsPerLine);
         resizeMemoryBlock (expectedNumBytesForMemoryBlock);
 
-        sampleBuffer.  allocate (numSamplesAllChannels, true);
-        spectralBuffer.allocate (numSamplesAllChannels, true);
+        prepareChannels (numChannels);
+    }
 
-        channelOffset.resize (numChannels);
-        for (int i = 0; i < numChannels; ++i)
-        {
-            channelOffset.set (i, i * numSamplesExpected);
-        }
+    void SpectralDataCollector::recalculateDecimation()
+    {
+        std::lock_guard<std::recursive_mutex> scopedLock (processingLock);
+        prepareDecimation (HalfBandDecimator::getNumStagesForBandwidth (sampleRate, visualBandwidth));
+
+        updateGUIFrequencySpan();
     }
 
-    void SpectralDataCollector::processFFT ()
+    void SpectralDataCollector::processSpectra ()
     {
-        if (processingLock.try_lock())
+        if (currentWriteBlock == nullptr)
         {
-            for (int c = 0; c < numChannels; ++c)
-                fft->perform (sampleBuffer.get() + channelOffset[c], spectralBuffer.get() + channelOffset[c], false);
+            currentWriteBlock = startWriting();
 
-            if (currentWriteBlock == nullptr)
+            if (currentWriteBlock != nullptr)
             {
-                currentWriteBlock = startWriting();
-
-                if (currentWriteBlock != nullptr)
-                {
-                    juce::FloatVectorOperations::clear (static_cast<float*> (currentWriteBlock->getData()), static_cast<int> (currentWriteBlock->getSize() / sizeof (float)));
-                }
+                juce::FloatVectorOperations::clear (static_cast<float*> (currentWriteBlock->getData()), static_cast<int> (currentWriteBlock->getSize() / sizeof (float)));
             }
+        }
 
 
-            if (currentWriteBlock != nullptr)
-            {
-                if (currentWriteBlock->getSize() == expectedNumBytesForMemoryBlock)
-                {
-                    float *writePtr = static_cast<float*> (currentWriteBlock->getData());
-
-                    // todo: speedup through simd usage?
-                    for (int n = 0; n < numSamplesAllChannels; ++n)
-                        writePtr[n] += std::abs (spectralBuffer[n]);
+        if (currentWriteBlock != nullptr)
+        {
+            Frame<Layout> frame (*currentWriteBlock, numChannels, numBinsPerLine);
 
-                    ++numFFTSCalculated;
+            if (frame.isValid())
+            {
+                float *writePtr = frame.getValues();
+                const int numSpectrumBins = getNumSpectrumBins();
 
-                    if (numFFTSCalculated == numFFTSToAverage)
+                if (numBinsPooled == 1)
+                {
+                    for (int c = 0; c < numChannels; ++c)
+                        VectorKernels::addMagnitudes (frame.getChannel (c), getSpectrum (c), numSpectrumBins);
+                }
+                else
+                {
+                    // combine neighbouring bins by their maximum magnitude
+                    for (int c = 0; c < numChannels; ++c)
                     {
-                        juce::FloatVectorOperations::multiply (writePtr, 2.0f / (numSamplesExpected * numFFTSToAverage), numSamplesAllChannels);
-                        finishedWriting();
-                        currentWriteBlock = nullptr;
-                        numFFTSCalculated = 0;
+                        const std::complex<float>* bins = getSpectrum (c);
+                        float* channelWritePtr = frame.getChannel (c);
+
+                        for (int b = 0; b < numBinsPerLine; ++b)
+                        {
+                            float maxMagnitude = 0.0f;
+                            const int endBin = std::min ((b + 1) * numBinsPooled, numSpectrumBins);
+                            for (int k = b * numBinsPooled; k < endBin; ++k)
+                                maxMagnitude = std::max (maxMagnitude, std::abs (bins[k]));
+
+                            channelWritePtr[b] += maxMagnitude;
+                        }
                     }
+                }
 
+                ++numFFTSCalculated;
 
-                }
-                else
+                if (numFFTSCalculated == numFFTSToAverage)
                 {
+                    juce::FloatVectorOperations::multiply (writePtr, 2.0f / (numSamplesExpected * numFFTSToAverage), numValuesAllChannels);
                     finishedWriting();
                     currentWriteBlock = nullptr;
+                    numFFTSCalculated = 0;
                 }
 
+
+            }
+            else
+            {
+                finishedWriting();
+                currentWriteBlock = nullptr;
             }
 
-            numSamplesInSampleBuffer = 0;
-            processingLock.unlock();
         }
     }
 
@@ -188,6 +224,14 @@ namespace ntlab
     {
         juce::var fo (fftOrder);
         sink->applySettingToTarget (*this, settingFFTOrder, fo);
+
+        updateGUINumBinsPerLine();
+    }
+
+    void SpectralDataCollector::updateGUINumBinsPerLine()
+    {
+        juce::var nb (numBinsPerLine);
+        sink->applySettingToTarget (*this, settingNumBinsPerLine, nb);
     }
 
     void SpectralDataCollector::updateGUIFrequencySpan()
@@ -195,7 +239,8 @@ namespace ntlab
         // Have you called updateAllGUIParameters before setting the sample rate?
         jassert (sampleRate > 0.0);
 
-        double endFrequency = sampleRate + startFrequency;
+        // The spectrum covers the decimated sample rate, starting at the start frequency
+        double endFrequency = sampleRate / getDecimationFactor() + startFrequency;
         juce::var sf (startFrequency);
         juce::var ef (endFrequency);
         sink->applySettingToTarget (*this, settingStartFrequency, sf);
@@ -206,4 +251,93 @@ namespace ntlab
     const juce::String SpectralDataCollector::settingStartFrequency ("startFrequency");
     const juce::String SpectralDataCollector::settingEndFrequency   ("endFrequency");
     const juce::String SpectralDataCollector::settingFFTOrder       ("fftOrder");
+    const juce::String SpectralDataCollector::settingMaxNumPointsPerLine ("maxNumPointsPerLine");
+    const juce::String SpectralDataCollector::settingNumBinsPerLine      ("numBinsPerLine");
+    const juce::String SpectralDataCollector::settingPreFilterCoefficients ("preFilterCoefficients");
+
+#if JUCE_UNIT_TESTS
+    /**
+     * Checks that the frames only hold the bins from DC up to half the sample rate, both with all bins and with
+     * neighbouring bins combined, and that sines placed exactly on a bin show up with their amplitude.
+     */
+    class SpectralDataCollectorTests : public juce::UnitTest
+    {
+    public:
+        SpectralDataCollectorTests() : juce::UnitTest ("SpectralDataCollector", "ntlab") {}
+
+        void runTest() override
+        {
+            beginTest ("All bins");
+            checkFrame (0, 1);
+
+            beginTest ("Combined bins");
+            checkFrame (numBinsBelowHalfSampleRate / 4 + 1, 4);
+        }
+
+    private:
+        static constexpr int fftOrder = 8;
+        static constexpr int fftLength = 1 << fftOrder;
+        static constexpr int numBinsBelowHalfSampleRate = fftLength / 2;
+        static constexpr int numChannels = 2;
+
+        struct NullSink : public RealtimeDataSink
+        {
+            juce::Result registerDataCollector (DataCollector&) override { return juce::Result::ok(); }
+            void applySettingToTarget (DataCollector&, const juce::String&, const juce::var&) override {}
+        };
+
+        void checkFrame (int maxNumPointsPerLine, int numBinsPooled)
+        {
+            // Each channel holds a sine placed exactly on a bin, so that no other bin is affected
+            const int sineBins[numChannels] = { 10, 40 };
+            const float sineAmplitudes[numChannels] = { 0.5f, 0.25f };
+
+            NullSink sink;
+            SpectralDataCollector collector ("Test");
+            collector.sink = &sink;
+
+            juce::StringArray channelNames ({ "sine 10", "sine 40" });
+            collector.setChannels (numChannels, channelNames);
+            collector.setFFTOrder (fftOrder);
+            collector.setMaxNumPointsPerLine (maxNumPointsPerLine);
+            collector.setSampleRate (48000.0);
+
+            juce::AudioBuffer<float> buffer (numChannels, fftLength);
+            for (int c = 0; c < numChannels; ++c)
+                for (int i = 0; i < fftLength; ++i)
+                    buffer.setSample (c, i, sineAmplitudes[c] * std::sin (juce::MathConstants<float>::twoPi * sineBins[c] * i / fftLength));
+
+            // The memory blocks take the size of a frame when they have been read, so both are read once before. Each
+            // buffer pushed results in one FFT, a frame averages three of them
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int f = 0; f < 3; ++f)
+                    collector.pushChannelsSamples (buffer);
+
+                collector.startReading();
+                collector.finishedReading();
+            }
+
+            const int numValuesPerChannel = numBinsBelowHalfSampleRate / numBinsPooled + 1;
+            ConstFrame<SpectralDataCollector::Layout> frame (collector.startReading(), numChannels);
+            expectEquals (frame.getNumValuesPerChannel(), numValuesPerChannel);
+
+            if (frame.getNumValuesPerChannel() == numValuesPerChannel)
+            {
+                for (int c = 0; c < numChannels; ++c)
+                {
+                    const float* magnitudes = frame.getChannel (c);
+                    const int sineValue = sineBins[c] / numBinsPooled;
+
+                    for (int b = 0; b < numValuesPerChannel; ++b)
+                        expectWithinAbsoluteError (magnitudes[b], (b == sineValue) ? sineAmplitudes[c] : 0.0f, 1.0e-4f);
+                }
+            }
+
+            collector.finishedReading();
+        }
+    };
+
+    static SpectralDataCollectorTests spectralDataCollectorTests;
+#endif
 }
\ No newline at end of file
@@ -29,7 +29,8 @@ SOFTWARE.
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_dsp/juce_dsp.h>
 #include "RealtimeDataSink.h"
-#include "DataCollector.h"
+#include "FFTDataCollector.h"
+#include "Frame.h"
 
 namespace ntlab
 {
@@ -40,12 +41,24 @@ namespace ntlab
      * connection to a VisualizationDataSource instance which then feeds the OscilloscopeComponent. Take a look at the
      * example code that comes with the module for a more detailled explanation.
      *
-     * Currently this implementation uses a hamming window for windowing the data in the time domain and averages over
+     * Currently this implementation transforms the data without windowing it in the time domain and averages over
      * three fft results before updating the display. These might become adjustable values in future.
      *
+     * If the FFT has more bins than the target can display, neighbouring bins are combined by taking their maximum
+     * magnitude, so that narrow peaks stay visible. The SpectralAnalyzerComponent requests this limit automatically
+     * based on its width in physical pixels.
+     *
+     * As the input is real, the bins of the negative frequencies only mirror the magnitudes of the non-negative ones.
+     * Therefore the frames only hold the N / 2 + 1 bins from DC up to half the sample rate for an FFT length of N,
+     * each of the two frame buffers takes 4 * C * (N / 2 + 1) bytes for C channels. The SpectralAnalyzerComponent
+     * mirrors them itself if the negative frequencies should be displayed.
+     *
+     * For high input sample rates, the samples can be decimated before being transformed by setting the visual
+     * bandwidth needed. The frequency span sent to the target is adjusted to the decimated sample rate automatically.
+     *
      * @see RealtimeDataSink, @see VisualisationDataSource, @see VisualizationTarge, @see SpectralAnalyzerComponent
      */
-    class SpectralDataCollector : public DataCollector
+    class SpectralDataCollector : public FFTDataCollector
     {
     public:
         static const juce::String settingNumChannels;
@@ -53,6 +66,15 @@ namespace ntlab
         static const juce::String settingStartFrequency;
         static const juce::String settingEndFrequency;
         static const juce::String settingFFTOrder;
+        static const juce::String settingMaxNumPointsPerLine;
+        static const juce::String settingNumBinsPerLine;
+        static const juce::String settingPreFilterCoefficients;
+
+        /**
+         * Each frame holds numBinsPerLine magnitudes per channel, equally spaced from DC up to and including half the
+         * sample rate
+         */
+        using Layout = FrameLayout<float>;
 
         /**
          * Specifiy an identifier extension to map the DataCollector to the corresponding target.
@@ -86,11 +108,20 @@ namespace ntlab
         void setSampleRate (double newSampleRate, double newStartFrequency = 0.0);
 
         /**
-         * Pushes an audio buffer to the sample queue holding as much channels as should
-         * be displayed. If an unmatching channel count will be passed, the internal buffer
-         * will be filled with zeros.
+         * Sets the signal bandwidth above the start frequency that should be visible. If the sample rate is a lot
+         * higher than needed for this bandwidth, the samples are lowpass filtered and decimated by a power of two
+         * before being transformed, so that the FFT resolves the bandwidth of interest finer and less samples need
+         * to be transformed. The decimation factor is chosen automatically so that the bandwidth passed is kept.
+         * Pass 0 to disable decimation, which is the default.
          */
-        void pushChannelsSamples (juce::AudioBuffer<float> &bufferToPush);
+        void setVisualBandwidth (double bandwidthInHz);
+
+        /**
+         * Limits the number of magnitude values sent per channel. If the FFT has more bins of non-negative frequencies,
+         * a power of two number of neighbouring bins is combined to one value by taking their maximum. Pass 0 to
+         * disable the limit. Normally, this is set by the SpectralAnalyzerComponent depending on its size.
+         */
+        void setMaxNumPointsPerLine (int maxNumPoints);
 
         /**
          * Updates all parameters relevant for the Visualization. Call this after (re-)connecting if your collector
@@ -102,39 +133,39 @@ namespace ntlab
 
     private:
 
-        std::unique_ptr<juce::dsp::FFT> fft;
-        std::unique_ptr<juce::dsp::WindowingFunction<float>> windowingFunction;
-        int fftOrder = 0;
         double sampleRate = 0.0;
         double startFrequency = 0.0;
+        double visualBandwidth = 0.0;
 
-        int numSamplesExpected = 0;
         static const int numFFTSToAverage = 3;
+
+        // Level of detail
+        int maxNumPointsPerLine = 0;
+        int numBinsPooled = 1;
+        int numBinsPerLine = 0;
+        int numValuesAllChannels = 0;
         int numFFTSCalculated = 0;
 
         // Channels
         int                 numChannels = 0;
         juce::StringArray   channelNames;
-        juce::Array<size_t> channelOffset;
 
         // Memory
-        juce::HeapBlock<std::complex<float>> sampleBuffer;
-        juce::HeapBlock<std::complex<float>> spectralBuffer;
         juce::MemoryBlock* currentWriteBlock = nullptr;
         size_t             expectedNumBytesForMemoryBlock = 0;
-        int                numSamplesInSampleBuffer = 0;
-        int                numSamplesAllChannels = 0;
-
-        std::recursive_mutex processingLock;
 
         void recalculateMemory();
 
-        void processFFT();
+        void recalculateDecimation();
+
+        void processSpectra() override;
 
         void updateGUIChannels();
 
         void updateGUIFFTOrder();
 
+        void updateGUINumBinsPerLine();
+
         void updateGUIFrequencySpan();
     };
 }
\ No newline at end of file
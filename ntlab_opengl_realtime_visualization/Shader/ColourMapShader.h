@@ -0,0 +1,178 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Attributes.h"
+#include "Uniforms.h"
+#include "TextureShader.h"
+
+namespace ntlab
+{
+    /**
+     * A class to manage a shader dedicated to draw single channel density textures, e.g. histograms, through a colour
+     * map. The density is read from the alpha channel of the density texture and used to look up the colour in the
+     * first row of the colour map texture. Texels with a density of zero are drawn fully transparent. The horizontal
+     * texture coordinate wraps around, so passing coordinates > 1 tiles the density texture horizontally.
+     */
+    class ColourMapShader2D : public juce::OpenGLShaderProgram
+    {
+    public:
+
+        /** The vertex layout expected by this shader. Positions are passed in normalized device coordinates */
+        using Vertex = TextureShader2D::Vertex;
+
+    private:
+        /** Holds all Attributes for drawing colour mapped quads with the ColourMapShader2D */
+        class Attributes : public ntlab::OpenGLAttributes {
+
+        public:
+
+            Attributes (juce::OpenGLContext& openGLContext, juce::OpenGLShaderProgram& shaderProgram)
+            {
+                position.    reset (createAttribute (openGLContext, shaderProgram, "aPosition"));
+                textureCoord.reset (createAttribute (openGLContext, shaderProgram, "aTextureCoord"));
+            }
+
+            void enable (juce::OpenGLContext& openGLContext) override
+            {
+                if (position.get() != nullptr)
+                {
+                    openGLContext.extensions.glVertexAttribPointer (position->attributeID, 2, GL_FLOAT, GL_FALSE, sizeof (Vertex), 0);
+                    openGLContext.extensions.glEnableVertexAttribArray (position->attributeID);
+                }
+
+                if (textureCoord.get() != nullptr)
+                {
+                    openGLContext.extensions.glVertexAttribPointer (textureCoord->attributeID, 2, GL_FLOAT, GL_FALSE, sizeof (Vertex), (GLvoid*) (sizeof (float) * 2));
+                    openGLContext.extensions.glEnableVertexAttribArray (textureCoord->attributeID);
+                }
+            }
+
+            void disable (juce::OpenGLContext& openGLContext) override
+            {
+                if (position.get() != nullptr)
+                    openGLContext.extensions.glDisableVertexAttribArray (position->attributeID);
+
+                if (textureCoord.get() != nullptr)
+                    openGLContext.extensions.glDisableVertexAttribArray (textureCoord->attributeID);
+            }
+
+            std::unique_ptr<juce::OpenGLShaderProgram::Attribute> position, textureCoord;
+        };
+
+        /** Holds all Uniforms for drawing colour mapped quads with the ColourMapShader2D */
+        class Uniforms : public ntlab::OpenGLUniforms {
+
+        public:
+
+            Uniforms (juce::OpenGLContext& openGLContext, juce::OpenGLShaderProgram& shaderProgram)
+            {
+                density.  reset (createUniform (openGLContext, shaderProgram, "uDensity"));
+                colourMap.reset (createUniform (openGLContext, shaderProgram, "uColourMap"));
+            }
+
+            std::unique_ptr<juce::OpenGLShaderProgram::Uniform> density, colourMap;
+        };
+
+    public:
+
+        /**
+         * Creates a new ColourMapShader2D or returns a nullptr in case of any error. You need to take ownership of the
+         * object returned.
+         */
+        static ColourMapShader2D* create (juce::OpenGLContext &context)
+        {
+            std::unique_ptr<ColourMapShader2D> newShader (new ColourMapShader2D (context));
+
+            if (   newShader->addVertexShader   (juce::OpenGLHelpers::translateVertexShaderToV3   (vertex))
+                && newShader->addFragmentShader (juce::OpenGLHelpers::translateFragmentShaderToV3 (fragment))
+                && newShader->link())
+            {
+                newShader->use();
+
+                newShader->uniforms.reset   (new Uniforms   (context, *newShader));
+                newShader->attributes.reset (new Attributes (context, *newShader));
+
+                return newShader.release();
+            }
+
+            DBG (newShader->getLastError());
+            // Something went wrong during shader compilation. Hopefully the debug string will help you finding out what
+            jassertfalse;
+
+            return nullptr;
+        }
+
+        /**
+         * Binds the density texture to texture unit 0 and the colour map texture to texture unit 1 and lets the shader
+         * sample from them. Call unbindTextures after your draw call.
+         */
+        void bindTextures (juce::OpenGLContext& context, GLuint densityTextureID, GLuint colourMapTextureID)
+        {
+            context.extensions.glActiveTexture (GL_TEXTURE1);
+            glBindTexture (GL_TEXTURE_2D, colourMapTextureID);
+            context.extensions.glActiveTexture (GL_TEXTURE0);
+            glBindTexture (GL_TEXTURE_2D, densityTextureID);
+
+            if (uniforms->density.get() != nullptr)
+                uniforms->density->set (static_cast<GLint> (0));
+
+            if (uniforms->colourMap.get() != nullptr)
+                uniforms->colourMap->set (static_cast<GLint> (1));
+        }
+
+        /** Releases the textures bound by bindTextures */
+        void unbindTextures (juce::OpenGLContext& context)
+        {
+            context.extensions.glActiveTexture (GL_TEXTURE1);
+            glBindTexture (GL_TEXTURE_2D, 0);
+            context.extensions.glActiveTexture (GL_TEXTURE0);
+            glBindTexture (GL_TEXTURE_2D, 0);
+        }
+
+        /** Needs to be called before every call to GLDrawArrays if the ColourMapShader is used to draw them */
+        void enableAttributes (juce::OpenGLContext &context)
+        {
+            attributes->enable (context);
+        }
+
+        /** Needs to be called after every call to GLDrawArrays*/
+        void disableAttributes (juce::OpenGLContext &context)
+        {
+            attributes->disable (context);
+        }
+
+    private:
+
+        std::unique_ptr<Uniforms>   uniforms;
+        std::unique_ptr<Attributes> attributes;
+
+        ColourMapShader2D (juce::OpenGLContext &context) : juce::OpenGLShaderProgram (context) {};
+
+        static const juce::String vertex;
+        static const juce::String fragment;
+    };
+}
@@ -67,7 +67,8 @@ namespace ntlab
             {
                 if (coord2d.get() != nullptr)
                 {
-                    openGLContext.extensions.glVertexAttribPointer (coord2d->attributeID, 3, GL_FLOAT, GL_FALSE, sizeof (juce::Point<float>), 0);
+                    const auto stride = static_cast<GLsizei> (sizeof (juce::Point<float>) * vertexStride);
+                    openGLContext.extensions.glVertexAttribPointer (coord2d->attributeID, 3, GL_FLOAT, GL_FALSE, stride, 0);
                     openGLContext.extensions.glEnableVertexAttribArray (coord2d->attributeID);
                 }
             }
@@ -79,6 +80,9 @@ namespace ntlab
             }
 
             std::unique_ptr<juce::OpenGLShaderProgram::Attribute> coord2d;
+
+            // Only every nth point in the buffer is used as vertex if this is greater than one
+            int vertexStride = 1;
         };
 
         /** Holds all Uniforms for drawing the 2D line with the Line2DShader */
@@ -211,9 +215,14 @@ namespace ntlab
                                        lineColour.getFloatAlpha());
         }
 
-        /** Needs to be called before every call to GLDrawArrays if the LineShader is used to draw them */
-        void enableAttributes (juce::OpenGLContext &context)
+        /**
+         * Needs to be called before every call to GLDrawArrays if the LineShader is used to draw them. If
+         * useEveryNthPoint is greater than one, points are skipped, which allows drawing a decimated version of a
+         * line without touching the buffer. Divide the number of vertices to draw by the same value in this case.
+         */
+        void enableAttributes (juce::OpenGLContext &context, int useEveryNthPoint = 1)
         {
+            attributes->vertexStride = juce::jmax (1, useEveryNthPoint);
             attributes->enable (context);
         }
 
@@ -0,0 +1,61 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "TextShader.h"
+
+namespace ntlab
+{
+    const juce::String TextShader2D::vertex =
+#if JUCE_IOS || JUCE_ANDROID
+            "precision mediump float;\n"
+#endif
+              "attribute vec2 aPosition;\n"
+              "attribute vec2 aTextureCoord;\n"
+              "attribute vec4 aColour;\n"
+              "uniform vec2 uViewportSize;\n"
+              "varying vec2 vTextureCoord;\n"
+              "varying vec4 vColour;\n"
+              "\n"
+              "void main (void) {\n"
+              "  vTextureCoord = aTextureCoord;\n"
+              "  vColour = aColour;\n"
+              "  gl_Position = vec4 ((aPosition.x / uViewportSize.x) * 2.0 - 1.0, 1.0 - (aPosition.y / uViewportSize.y) * 2.0, 0, 1);\n"
+              "}";
+
+    const juce::String TextShader2D::fragment =
+#if JUCE_IOS || JUCE_ANDROID
+            "precision mediump float;\n"
+#endif
+              "uniform sampler2D uTexture;\n"
+              "uniform float uSmoothing;\n"
+              "varying vec2 vTextureCoord;\n"
+              "varying vec4 vColour;\n"
+              "\n"
+              "void main (void) {\n"
+              "  float distance = texture2D (uTexture, vTextureCoord).a;\n"
+              "  float alpha = smoothstep (0.5 - uSmoothing, 0.5 + uSmoothing, distance);\n"
+              "  gl_FragColor = vec4 (vColour.rgb, vColour.a * alpha);\n"
+              "}";
+}
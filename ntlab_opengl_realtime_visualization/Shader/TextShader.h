@@ -0,0 +1,203 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Attributes.h"
+#include "Uniforms.h"
+
+namespace ntlab
+{
+    /**
+     * A class to manage a shader dedicated to draw batched text from a signed distance field glyph atlas. Each glyph
+     * is drawn as two triangles, the text colour is passed per vertex, so that a whole set of labels with different
+     * colours can be drawn with a single draw call.
+     * @see SDFGlyphAtlas
+     */
+    class TextShader2D : public juce::OpenGLShaderProgram
+    {
+    public:
+
+        /**
+         * The vertex layout expected by this shader. Positions are passed in pixels relative to the top left corner of
+         * the current viewport, texture coordinates refer to the glyph atlas texture.
+         */
+        struct Vertex
+        {
+            float x, y;
+            float u, v;
+            float r, g, b, a;
+        };
+
+    private:
+        /** Holds all Attributes for drawing text with the TextShader2D */
+        class Attributes : public ntlab::OpenGLAttributes {
+
+        public:
+
+            Attributes (juce::OpenGLContext& openGLContext, juce::OpenGLShaderProgram& shaderProgram)
+            {
+                position.    reset (createAttribute (openGLContext, shaderProgram, "aPosition"));
+                textureCoord.reset (createAttribute (openGLContext, shaderProgram, "aTextureCoord"));
+                colour.      reset (createAttribute (openGLContext, shaderProgram, "aColour"));
+            }
+
+            void enable (juce::OpenGLContext& openGLContext) override
+            {
+                if (position.get() != nullptr)
+                {
+                    openGLContext.extensions.glVertexAttribPointer (position->attributeID, 2, GL_FLOAT, GL_FALSE, sizeof (Vertex), 0);
+                    openGLContext.extensions.glEnableVertexAttribArray (position->attributeID);
+                }
+
+                if (textureCoord.get() != nullptr)
+                {
+                    openGLContext.extensions.glVertexAttribPointer (textureCoord->attributeID, 2, GL_FLOAT, GL_FALSE, sizeof (Vertex), (GLvoid*) (sizeof (float) * 2));
+                    openGLContext.extensions.glEnableVertexAttribArray (textureCoord->attributeID);
+                }
+
+                if (colour.get() != nullptr)
+                {
+                    openGLContext.extensions.glVertexAttribPointer (colour->attributeID, 4, GL_FLOAT, GL_FALSE, sizeof (Vertex), (GLvoid*) (sizeof (float) * 4));
+                    openGLContext.extensions.glEnableVertexAttribArray (colour->attributeID);
+                }
+            }
+
+            void disable (juce::OpenGLContext& openGLContext) override
+            {
+                if (position.get() != nullptr)
+                    openGLContext.extensions.glDisableVertexAttribArray (position->attributeID);
+
+                if (textureCoord.get() != nullptr)
+                    openGLContext.extensions.glDisableVertexAttribArray (textureCoord->attributeID);
+
+                if (colour.get() != nullptr)
+                    openGLContext.extensions.glDisableVertexAttribArray (colour->attributeID);
+            }
+
+            std::unique_ptr<juce::OpenGLShaderProgram::Attribute> position, textureCoord, colour;
+        };
+
+        /** Holds all Uniforms for drawing text with the TextShader2D */
+        class Uniforms : public ntlab::OpenGLUniforms {
+
+        public:
+
+            Uniforms (juce::OpenGLContext& openGLContext, juce::OpenGLShaderProgram& shaderProgram)
+            {
+                texture.     reset (createUniform (openGLContext, shaderProgram, "uTexture"));
+                viewportSize.reset (createUniform (openGLContext, shaderProgram, "uViewportSize"));
+                smoothing.   reset (createUniform (openGLContext, shaderProgram, "uSmoothing"));
+            }
+
+            std::unique_ptr<juce::OpenGLShaderProgram::Uniform> texture, viewportSize, smoothing;
+        };
+
+    public:
+
+        /**
+         * Creates a new TextShader2D or returns a nullptr in case of any error. You need to take ownership of the
+         * object returned.
+         */
+        static TextShader2D* create (juce::OpenGLContext &context)
+        {
+            std::unique_ptr<TextShader2D> newShader (new TextShader2D (context));
+
+            if (   newShader->addVertexShader   (juce::OpenGLHelpers::translateVertexShaderToV3   (vertex))
+                && newShader->addFragmentShader (juce::OpenGLHelpers::translateFragmentShaderToV3 (fragment))
+                && newShader->link())
+            {
+                newShader->use();
+
+                newShader->uniforms.reset   (new Uniforms   (context, *newShader));
+                newShader->attributes.reset (new Attributes (context, *newShader));
+
+                return newShader.release();
+            }
+
+            DBG (newShader->getLastError());
+            // Something went wrong during shader compilation. Hopefully the debug string will help you finding out what
+            jassertfalse;
+
+            return nullptr;
+        }
+
+        /**
+         * Binds the glyph atlas texture passed to texture unit 0 and lets the shader sample from it. Call unbindTexture
+         * after your draw call.
+         */
+        void bindGlyphAtlas (juce::OpenGLContext& context, GLuint textureID)
+        {
+            context.extensions.glActiveTexture (GL_TEXTURE0);
+            glBindTexture (GL_TEXTURE_2D, textureID);
+
+            if (uniforms->texture.get() != nullptr)
+                uniforms->texture->set (static_cast<GLint> (0));
+        }
+
+        /** Releases the texture bound by bindGlyphAtlas */
+        void unbindGlyphAtlas()
+        {
+            glBindTexture (GL_TEXTURE_2D, 0);
+        }
+
+        /** Sets the size of the current viewport in pixels, needed to map the pixel positions to the viewport */
+        void setViewportSize (int width, int height)
+        {
+            uniforms->viewportSize->set (static_cast<GLfloat> (width), static_cast<GLfloat> (height));
+        }
+
+        /**
+         * Sets the width of the anti-aliased edge in distance field units. Use SDFGlyphAtlas::getSmoothingForTextHeight
+         * to get a value matching the text height drawn.
+         */
+        void setSmoothing (float smoothing)
+        {
+            uniforms->smoothing->set (smoothing);
+        }
+
+        /** Needs to be called before every call to GLDrawArrays if the TextShader is used to draw them */
+        void enableAttributes (juce::OpenGLContext &context)
+        {
+            attributes->enable (context);
+        }
+
+        /** Needs to be called after every call to GLDrawArrays*/
+        void disableAttributes (juce::OpenGLContext &context)
+        {
+            attributes->disable (context);
+        }
+
+    private:
+
+        std::unique_ptr<Uniforms>   uniforms;
+        std::unique_ptr<Attributes> attributes;
+
+        TextShader2D (juce::OpenGLContext &context) : juce::OpenGLShaderProgram (context) {};
+
+        static const juce::String vertex;
+        static const juce::String fragment;
+    };
+}
@@ -0,0 +1,171 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "Attributes.h"
+#include "Uniforms.h"
+
+namespace ntlab
+{
+    /**
+     * A class to manage a shader dedicated to draw textured 2D quads, e.g. to composite pre-rendered layers into
+     * the current viewport. It expects premultiplied alpha texture data as created by juce::OpenGLTexture or
+     * juce::OpenGLFrameBuffer.
+     */
+    class TextureShader2D : public juce::OpenGLShaderProgram
+    {
+    public:
+
+        /** The vertex layout expected by this shader. Positions are passed in normalized device coordinates */
+        struct Vertex
+        {
+            float x, y;
+            float u, v;
+        };
+
+    private:
+        /** Holds all Attributes for drawing textured quads with the TextureShader2D */
+        class Attributes : public ntlab::OpenGLAttributes {
+
+        public:
+
+            Attributes (juce::OpenGLContext& openGLContext, juce::OpenGLShaderProgram& shaderProgram)
+            {
+                position.    reset (createAttribute (openGLContext, shaderProgram, "aPosition"));
+                textureCoord.reset (createAttribute (openGLContext, shaderProgram, "aTextureCoord"));
+            }
+
+            void enable (juce::OpenGLContext& openGLContext) override
+            {
+                if (position.get() != nullptr)
+                {
+                    openGLContext.extensions.glVertexAttribPointer (position->attributeID, 2, GL_FLOAT, GL_FALSE, sizeof (Vertex), 0);
+                    openGLContext.extensions.glEnableVertexAttribArray (position->attributeID);
+                }
+
+                if (textureCoord.get() != nullptr)
+                {
+                    openGLContext.extensions.glVertexAttribPointer (textureCoord->attributeID, 2, GL_FLOAT, GL_FALSE, sizeof (Vertex), (GLvoid*) (sizeof (float) * 2));
+                    openGLContext.extensions.glEnableVertexAttribArray (textureCoord->attributeID);
+                }
+            }
+
+            void disable (juce::OpenGLContext& openGLContext) override
+            {
+                if (position.get() != nullptr)
+                    openGLContext.extensions.glDisableVertexAttribArray (position->attributeID);
+
+                if (textureCoord.get() != nullptr)
+                    openGLContext.extensions.glDisableVertexAttribArray (textureCoord->attributeID);
+            }
+
+            std::unique_ptr<juce::OpenGLShaderProgram::Attribute> position, textureCoord;
+        };
+
+        /** Holds all Uniforms for drawing textured quads with the TextureShader2D */
+        class Uniforms : public ntlab::OpenGLUniforms {
+
+        public:
+
+            Uniforms (juce::OpenGLContext& openGLContext, juce::OpenGLShaderProgram& shaderProgram)
+            {
+                texture.reset (createUniform (openGLContext, shaderProgram, "uTexture"));
+            }
+
+            std::unique_ptr<juce::OpenGLShaderProgram::Uniform> texture;
+        };
+
+    public:
+
+        /**
+         * Creates a new TextureShader2D or returns a nullptr in case of any error. You need to take ownership of the
+         * object returned.
+         */
+        static TextureShader2D* create (juce::OpenGLContext &context)
+        {
+            std::unique_ptr<TextureShader2D> newShader (new TextureShader2D (context));
+
+            if (   newShader->addVertexShader   (juce::OpenGLHelpers::translateVertexShaderToV3   (vertex))
+                && newShader->addFragmentShader (juce::OpenGLHelpers::translateFragmentShaderToV3 (fragment))
+                && newShader->link())
+            {
+                newShader->use();
+
+                newShader->uniforms.reset   (new Uniforms   (context, *newShader));
+                newShader->attributes.reset (new Attributes (context, *newShader));
+
+                return newShader.release();
+            }
+
+            DBG (newShader->getLastError());
+            // Something went wrong during shader compilation. Hopefully the debug string will help you finding out what
+            jassertfalse;
+
+            return nullptr;
+        }
+
+        /**
+         * Binds the texture passed to texture unit 0 and lets the shader sample from it. Call unbindTexture after
+         * your draw call.
+         */
+        void bindTexture (juce::OpenGLContext& context, GLuint textureID)
+        {
+            context.extensions.glActiveTexture (GL_TEXTURE0);
+            glBindTexture (GL_TEXTURE_2D, textureID);
+
+            if (uniforms->texture.get() != nullptr)
+                uniforms->texture->set (static_cast<GLint> (0));
+        }
+
+        /** Releases the texture bound by bindTexture */
+        void unbindTexture()
+        {
+            glBindTexture (GL_TEXTURE_2D, 0);
+        }
+
+        /** Needs to be called before every call to GLDrawArrays if the TextureShader is used to draw them */
+        void enableAttributes (juce::OpenGLContext &context)
+        {
+            attributes->enable (context);
+        }
+
+        /** Needs to be called after every call to GLDrawArrays*/
+        void disableAttributes (juce::OpenGLContext &context)
+        {
+            attributes->disable (context);
+        }
+
+    private:
+
+        std::unique_ptr<Uniforms>   uniforms;
+        std::unique_ptr<Attributes> attributes;
+
+        TextureShader2D (juce::OpenGLContext &context) : juce::OpenGLShaderProgram (context) {};
+
+        static const juce::String vertex;
+        static const juce::String fragment;
+    };
+}
@@ -0,0 +1,264 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "AsyncBufferUploader.h"
+
+namespace ntlab
+{
+    AsyncBufferUploader::AsyncBufferUploader() : juce::Thread ("Async Buffer Uploader") {}
+
+    AsyncBufferUploader::~AsyncBufferUploader()
+    {
+        // Call release on the GL thread before deleting the uploader, otherwise the GL resources are leaked
+        jassert (uploadsInFlight.empty());
+
+        signalThreadShouldExit();
+        copyJobAvailable.signal();
+        waitForThreadToExit (-1);
+    }
+
+    void AsyncBufferUploader::uploadBuffer (const void* owner, std::shared_ptr<void> dataHolder, const void* data, size_t numBytes, GLenum usage, BufferReadyCallback onBufferReady)
+    {
+        std::unique_ptr<Upload> upload (new Upload);
+        upload->owner         = owner;
+        upload->dataHolder    = std::move (dataHolder);
+        upload->data          = data;
+        upload->numBytes      = numBytes;
+        upload->usage         = usage;
+        upload->onBufferReady = std::move (onBufferReady);
+
+        std::lock_guard<std::mutex> scopedLock (newUploadsLock);
+        newUploads.push_back (std::move (upload));
+
+        // the copy thread is only started if the uploader is actually used
+        if (!isThreadRunning())
+            startThread();
+    }
+
+    void AsyncBufferUploader::processUploads (juce::OpenGLContext& context)
+    {
+        if (!extraFunctionsInitialised)
+        {
+            extraFunctions.initialise();
+            extraFunctionsInitialised = true;
+        }
+
+        takeNewUploads();
+
+        for (auto it = uploadsInFlight.begin(); it != uploadsInFlight.end();)
+        {
+            auto& upload = **it;
+
+            if (upload.state == UploadState::queued)
+            {
+                if (upload.cancelled)
+                {
+                    it = uploadsInFlight.erase (it);
+                    continue;
+                }
+
+                if (startUpload (context, upload))
+                {
+                    it = uploadsInFlight.erase (it);
+                    continue;
+                }
+            }
+            else if ((upload.state == UploadState::copying) && upload.copied)
+            {
+                finishCopy (context, upload);
+            }
+            else if ((upload.state == UploadState::waitingForGPU) && extraFunctions.isSignaled (upload.fence))
+            {
+                extraFunctions.glDeleteSync (upload.fence);
+                upload.fence = nullptr;
+
+                if (upload.cancelled)
+                    context.extensions.glDeleteBuffers (1, &upload.bufferID);
+                else
+                    upload.onBufferReady (context, upload.bufferID);
+
+                it = uploadsInFlight.erase (it);
+                continue;
+            }
+
+            ++it;
+        }
+    }
+
+    bool AsyncBufferUploader::hasPendingUploads() const
+    {
+        return !uploadsInFlight.empty();
+    }
+
+    void AsyncBufferUploader::cancelUploads (juce::OpenGLContext&, const void* owner)
+    {
+        takeNewUploads();
+
+        // The uploads are only marked here, as the copy thread might still write to the mapped memory. They are
+        // deleted by processUploads as soon as possible.
+        for (auto& upload : uploadsInFlight)
+            if (upload->owner == owner)
+                upload->cancelled = true;
+    }
+
+    void AsyncBufferUploader::release (juce::OpenGLContext& context)
+    {
+        takeNewUploads();
+
+        for (auto& upload : uploadsInFlight)
+            deleteUpload (context, *upload);
+
+        uploadsInFlight.clear();
+
+        {
+            std::lock_guard<std::mutex> scopedLock (copyQueueLock);
+            copyQueue.clear();
+        }
+
+        signalThreadShouldExit();
+        copyJobAvailable.signal();
+        waitForThreadToExit (-1);
+
+        extraFunctionsInitialised = false;
+    }
+
+    void AsyncBufferUploader::takeNewUploads()
+    {
+        std::lock_guard<std::mutex> scopedLock (newUploadsLock);
+
+        for (auto& upload : newUploads)
+            uploadsInFlight.push_back (std::move (upload));
+
+        newUploads.clear();
+    }
+
+    bool AsyncBufferUploader::startUpload (juce::OpenGLContext& context, Upload& upload)
+    {
+        const auto numBytes = static_cast<GLsizeiptr> (upload.numBytes);
+
+        context.extensions.glGenBuffers (1, &upload.bufferID);
+        context.extensions.glBindBuffer (GL_ARRAY_BUFFER, upload.bufferID);
+
+        if (extraFunctions.isAvailable() && (numBytes > 0))
+        {
+            // only allocate the storage here, the data will be copied by the copy thread
+            context.extensions.glBufferData (GL_ARRAY_BUFFER, numBytes, nullptr, upload.usage);
+            upload.mappedMemory = extraFunctions.glMapBufferRange (GL_ARRAY_BUFFER, 0, numBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        }
+
+        if (upload.mappedMemory != nullptr)
+        {
+            upload.state = UploadState::copying;
+
+            {
+                std::lock_guard<std::mutex> scopedLock (copyQueueLock);
+                copyQueue.push_back (&upload);
+            }
+
+            copyJobAvailable.signal();
+            context.extensions.glBindBuffer (GL_ARRAY_BUFFER, 0);
+            return false;
+        }
+
+        // no mapping possible, so do a synchronous upload
+        context.extensions.glBufferData (GL_ARRAY_BUFFER, numBytes, upload.data, upload.usage);
+        context.extensions.glBindBuffer (GL_ARRAY_BUFFER, 0);
+
+        if (extraFunctions.isAvailable())
+        {
+            upload.fence = extraFunctions.glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            upload.state = UploadState::waitingForGPU;
+            return false;
+        }
+
+        // without fences the buffer is handed over directly, the driver will synchronize its first use
+        upload.onBufferReady (context, upload.bufferID);
+        return true;
+    }
+
+    void AsyncBufferUploader::finishCopy (juce::OpenGLContext& context, Upload& upload)
+    {
+        context.extensions.glBindBuffer (GL_ARRAY_BUFFER, upload.bufferID);
+
+        // The data store might have been corrupted while being mapped, e.g. by a display mode change. In this case,
+        // the data is uploaded again the synchronous way.
+        if (extraFunctions.glUnmapBuffer (GL_ARRAY_BUFFER) == GL_FALSE)
+            context.extensions.glBufferSubData (GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr> (upload.numBytes), upload.data);
+
+        context.extensions.glBindBuffer (GL_ARRAY_BUFFER, 0);
+
+        upload.mappedMemory = nullptr;
+        upload.dataHolder.reset();
+        upload.fence = extraFunctions.glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        upload.state = UploadState::waitingForGPU;
+    }
+
+    void AsyncBufferUploader::deleteUpload (juce::OpenGLContext& context, Upload& upload)
+    {
+        if (upload.state == UploadState::copying)
+        {
+            // the mapped memory must not be unmapped while the copy thread is still writing to it
+            while (!upload.copied && isThreadRunning())
+                copyFinished.wait (10);
+
+            context.extensions.glBindBuffer (GL_ARRAY_BUFFER, upload.bufferID);
+            extraFunctions.glUnmapBuffer (GL_ARRAY_BUFFER);
+            context.extensions.glBindBuffer (GL_ARRAY_BUFFER, 0);
+        }
+
+        if (upload.fence != nullptr)
+            extraFunctions.glDeleteSync (upload.fence);
+
+        if (upload.bufferID != 0)
+            context.extensions.glDeleteBuffers (1, &upload.bufferID);
+    }
+
+    void AsyncBufferUploader::run()
+    {
+        while (!threadShouldExit())
+        {
+            Upload* upload = nullptr;
+
+            {
+                std::lock_guard<std::mutex> scopedLock (copyQueueLock);
+                if (!copyQueue.empty())
+                {
+                    upload = copyQueue.front();
+                    copyQueue.pop_front();
+                }
+            }
+
+            if (upload == nullptr)
+            {
+                copyJobAvailable.wait (100);
+                continue;
+            }
+
+            std::memcpy (upload->mappedMemory, upload->data, upload->numBytes);
+            upload->copied = true;
+            copyFinished.signal();
+        }
+    }
+}
@@ -0,0 +1,149 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_opengl/juce_opengl.h>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "GLExtraFunctions.h"
+
+namespace ntlab
+{
+    /**
+     * Uploads large vertex buffers without stalling the render thread. For each upload a new buffer is allocated and
+     * mapped on the GL thread, a background thread copies the data into the mapped memory and the buffer is unmapped
+     * on the GL thread after that. A fence marks the point at which the GPU has finished the transfer and only then
+     * the new buffer is handed to its owner, who can swap it for the buffer used before. So the GL thread only ever
+     * does a constant amount of work per upload, no matter how big the buffer is.
+     *
+     * If the functions needed for buffer mapping and fences are not available, the data is uploaded directly on the
+     * GL thread instead.
+     *
+     * You don't create an instance yourself, use WindowOpenGLContext::getAsyncBufferUploader.
+     */
+    class AsyncBufferUploader : private juce::Thread
+    {
+    public:
+
+        /**
+         * Called on the GL thread as soon as the buffer is ready to use. The receiver takes ownership of the buffer and
+         * is responsible for deleting it.
+         */
+        typedef std::function<void (juce::OpenGLContext&, GLuint)> BufferReadyCallback;
+
+        AsyncBufferUploader();
+
+        /** Make sure to call release on the GL thread before destructing the instance */
+        ~AsyncBufferUploader();
+
+        /**
+         * Queues the upload of the data passed into a new GL_ARRAY_BUFFER. Can be called from any thread. The owner
+         * pointer is only used to identify the uploads to cancel if the owner goes away before they finished.
+         */
+        template <typename ElementType>
+        void uploadBuffer (const void* owner, std::vector<ElementType>&& data, GLenum usage, BufferReadyCallback onBufferReady)
+        {
+            auto dataHolder = std::make_shared<std::vector<ElementType>> (std::move (data));
+            auto* dataPtr = dataHolder->data();
+            auto numBytes = dataHolder->size() * sizeof (ElementType);
+
+            uploadBuffer (owner, std::move (dataHolder), dataPtr, numBytes, usage, std::move (onBufferReady));
+        }
+
+        /** Advances all pending uploads. Called by the WindowOpenGLContext once per frame on the GL thread. */
+        void processUploads (juce::OpenGLContext& context);
+
+        /** Returns true if there are uploads that have not been finished yet. Must be called on the GL thread. */
+        bool hasPendingUploads() const;
+
+        /**
+         * Cancels all uploads queued by the owner passed. The callbacks of cancelled uploads won't be invoked and their
+         * buffers will be deleted. Must be called on the GL thread.
+         */
+        void cancelUploads (juce::OpenGLContext& context, const void* owner);
+
+        /** Cancels all uploads and stops the copy thread. Must be called on the GL thread. */
+        void release (juce::OpenGLContext& context);
+
+    private:
+
+        enum class UploadState
+        {
+            queued,
+            copying,
+            waitingForGPU
+        };
+
+        struct Upload
+        {
+            const void* owner;
+            std::shared_ptr<void> dataHolder;
+            const void* data;
+            size_t numBytes;
+            GLenum usage;
+            BufferReadyCallback onBufferReady;
+
+            UploadState state = UploadState::queued;
+            bool cancelled = false;
+            GLuint bufferID = 0;
+            void* mappedMemory = nullptr;
+            std::atomic<bool> copied {false};
+            GLExtraFunctions::SyncHandle fence = nullptr;
+        };
+
+        GLExtraFunctions extraFunctions;
+        bool extraFunctionsInitialised = false;
+
+        // Filled from any thread, moved to the uploads in flight on the GL thread
+        std::mutex newUploadsLock;
+        std::vector<std::unique_ptr<Upload>> newUploads;
+
+        // Only accessed on the GL thread
+        std::list<std::unique_ptr<Upload>> uploadsInFlight;
+
+        // The uploads whose buffers have been mapped and wait for the copy thread
+        std::mutex copyQueueLock;
+        std::deque<Upload*> copyQueue;
+        juce::WaitableEvent copyJobAvailable, copyFinished;
+
+        void uploadBuffer (const void* owner, std::shared_ptr<void> dataHolder, const void* data, size_t numBytes, GLenum usage, BufferReadyCallback onBufferReady);
+
+        void takeNewUploads();
+        /** Returns true if the upload was completed synchronously because buffer mapping is not available */
+        bool startUpload (juce::OpenGLContext& context, Upload& upload);
+        void finishCopy (juce::OpenGLContext& context, Upload& upload);
+        void deleteUpload (juce::OpenGLContext& context, Upload& upload);
+
+        void run() override;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AsyncBufferUploader)
+    };
+}
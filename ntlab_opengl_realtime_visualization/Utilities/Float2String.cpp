@@ -24,8 +24,220 @@ SOFTWARE.
 
 
 #include "Float2String.h"
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
 
 namespace ntlab
 {
     constexpr char Float2String::siPrefixes[11][3];
+    constexpr double Float2String::powersOfTen[];
+
+    char* Float2String::writeFixedLength (char* buffer, double number, int overallNumberOfDigits)
+    {
+        auto writeString = [buffer] (const char* string)
+        {
+            auto end = std::copy (string, string + std::strlen (string), buffer);
+            *end = '\0';
+            return end;
+        };
+
+        if (std::isnan (number))
+            return writeString ("NaN");
+
+        if (std::isinf (number))
+            return writeString ("Inf");
+
+        // if you are hitting this assert, the number is too big to be displayed by this number of digits and will
+        // be displayed wrong
+        jassert (number < multiplyByPowerOfTen (1.0, overallNumberOfDigits));
+
+        overallNumberOfDigits = juce::jlimit (1, maxNumberOfDigits, overallNumberOfDigits);
+
+        const bool isNegative = number < 0.0;
+        double magnitude = std::abs (number);
+
+        // prevents too small number to be displayed in exponential writing
+        if (magnitude < multiplyByPowerOfTen (1.0, -overallNumberOfDigits))
+            magnitude = 0.0;
+
+        // numbers that don't fit into a 64 bit integer are displayed wrong anyway, see the assert above. Note that
+        // 1e18 - 1 is not representable as a double, so the clamp uses the next smaller double instead
+        magnitude = std::min (magnitude, std::nextafter (powersOfTen[maxPowerOfTen], 0.0));
+
+        // a leading zero counts as an integer digit, just like the leading zero of 0.123
+        int numIntegerDigits = 1;
+        while ((numIntegerDigits < maxPowerOfTen) && (magnitude >= powersOfTen[numIntegerDigits]))
+            ++numIntegerDigits;
+
+        int numDecimals = std::max (0, overallNumberOfDigits - numIntegerDigits);
+        auto scaled = static_cast<juce::uint64> (std::llround (magnitude * powersOfTen[numDecimals]));
+
+        // rounding might carry over into an additional integer digit (e.g. 9.9996 -> 10.000), in this case one decimal
+        // less is needed to keep the number of digits
+        if ((numDecimals > 0) && (static_cast<double> (scaled) >= powersOfTen[numIntegerDigits + numDecimals]))
+        {
+            --numDecimals;
+            scaled = static_cast<juce::uint64> (std::llround (magnitude * powersOfTen[numDecimals]));
+        }
+
+        char digits[maxStringLength];
+        auto numDigits = static_cast<int> (std::to_chars (digits, digits + maxStringLength, scaled).ptr - digits);
+
+        // fractions need leading zeros, e.g. 5 with three decimals has to be written as 0.005
+        const int numLeadingZeros = std::max (0, numDecimals + 1 - numDigits);
+        const int numDigitsOverall = numDigits + numLeadingZeros;
+        const int decimalPointPosition = numDigitsOverall - numDecimals;
+
+        char* position = buffer;
+
+        if (isNegative && (scaled != 0))
+            *position++ = '-';
+
+        for (int i = 0; i < numDigitsOverall; ++i)
+        {
+            if (i == decimalPointPosition)
+                *position++ = '.';
+
+            *position++ = (i < numLeadingZeros) ? '0' : digits[i - numLeadingZeros];
+        }
+
+        *position = '\0';
+        return position;
+    }
+
+    juce::String Float2String::withSIPrefixCached (double number, int overallNumberOfDigits, SIPrefix desiredPrefix)
+    {
+        if (std::isnan (number))
+            return "NaN";
+
+        if (std::isinf (number))
+            return "Inf";
+
+        // A direct mapped cache, an entry is simply replaced by the next string with the same hash
+        struct CacheEntry
+        {
+            double number = 0.0;
+            int overallNumberOfDigits = 0;
+            int prefix = 0;
+            bool isValid = false;
+            juce::String string;
+        };
+
+        static const int cacheSizeLog2 = 6;
+        thread_local std::array<CacheEntry, 1 << cacheSizeLog2> cache;
+
+        juce::uint64 bits;
+        std::memcpy (&bits, &number, sizeof (bits));
+        juce::uint64 hash = bits ^ (static_cast<juce::uint64> (overallNumberOfDigits) << 8) ^ static_cast<juce::uint64> (desiredPrefix + siPrefixArrayOffset);
+        auto& entry = cache[(hash * 0x9E3779B97F4A7C15ull) >> (64 - cacheSizeLog2)];
+
+        if (entry.isValid && (entry.number == number) && (entry.overallNumberOfDigits == overallNumberOfDigits) && (entry.prefix == desiredPrefix))
+            return entry.string;
+
+        int prefixIdx = desiredPrefix;
+        int exponentBase10 = prefixIdx * 3;
+
+        char buffer[maxStringLength];
+        char* end = writeFixedLength (buffer, multiplyByPowerOfTen (number, -exponentBase10), overallNumberOfDigits);
+
+        for (const char* prefix = siPrefixes[prefixIdx + siPrefixArrayOffset]; *prefix != '\0'; ++prefix)
+            *end++ = *prefix;
+
+        *end = '\0';
+
+        entry.number                = number;
+        entry.overallNumberOfDigits = overallNumberOfDigits;
+        entry.prefix                = desiredPrefix;
+        entry.isValid               = true;
+        entry.string                = juce::String (juce::CharPointer_UTF8 (buffer));
+
+        return entry.string;
+    }
+
+#if JUCE_UNIT_TESTS
+    /**
+     * Checks the conversions against known strings and compares the time needed per tick label with the stream based
+     * conversion Float2String used before, both for labels that are converted and for labels taken from the cache.
+     */
+    class Float2StringTests : public juce::UnitTest
+    {
+    public:
+        Float2StringTests() : juce::UnitTest ("Float2String", "ntlab") {}
+
+        void runTest() override
+        {
+            beginTest ("Fixed length");
+
+            expectEquals (Float2String::withFixedLength (1.23456, 4),  juce::String ("1.235"));
+            expectEquals (Float2String::withFixedLength (-0.0123, 3),  juce::String ("-0.01"));
+            expectEquals (Float2String::withFixedLength (0.0, 3),      juce::String ("0.00"));
+            expectEquals (Float2String::withFixedLength (42.0f, 2),    juce::String ("42"));
+            expectEquals (Float2String::withFixedLength (9.9996, 4),   juce::String ("10.00"));
+            expectEquals (Float2String::withFixedLength (std::nan (""), 4), juce::String ("NaN"));
+
+            beginTest ("SI prefix");
+
+            expectEquals (Float2String::withSIPrefix (1500.0, 3),                        juce::String ("1.50k"));
+            expectEquals (Float2String::withSIPrefix (1500.0, 4, Float2String::kilo),    juce::String ("1.500k"));
+            expectEquals (Float2String::withSIPrefix (0.25, 3, Float2String::none),      juce::String ("0.25"));
+            expectEquals (Float2String::withSIPrefix (2.0e-6, 3),                        juce::String (juce::CharPointer_UTF8 ("2.00\xce\xbc")));
+            expectEquals (Float2String::withSIPrefix (-3.3e9f, 3),                       juce::String ("-3.30G"));
+
+            beginTest ("Time per label");
+
+            std::vector<double> values (numLabels);
+            auto random = getRandom();
+            for (auto& v : values)
+                v = (random.nextFloat() - 0.5f) * 2000.0f;
+
+            const double streamTime    = measureNsPerLabel (values, [] (double v) { return withStream (v, 4); });
+            const double convertedTime = measureNsPerLabel (values, [] (double v) { return Float2String::withSIPrefix (v, 4, Float2String::none); });
+
+            // a plot typically redraws the same few labels, these are taken from the cache after the first round
+            std::vector<double> unchangedValues (values.begin(), values.begin() + 10);
+            const double cachedTime = measureNsPerLabel (unchangedValues, [] (double v) { return Float2String::withSIPrefix (v, 4, Float2String::none); });
+
+            logMessage ("Stream based: " + juce::String (streamTime, 1) + " ns, converted: " + juce::String (convertedTime, 1) + " ns, cached: " + juce::String (cachedTime, 1) + " ns per label");
+
+            expectLessThan (convertedTime, streamTime);
+            expectLessThan (cachedTime, convertedTime);
+        }
+
+    private:
+        static constexpr int numLabels = 1000;
+        static constexpr int numRounds = 20;
+
+        /** The conversion used before, kept as the reference to compare with */
+        static juce::String withStream (double number, int overallNumberOfDigits)
+        {
+            std::ostringstream stream;
+            stream << std::fixed << std::setprecision (std::max (0, overallNumberOfDigits - 1)) << number;
+            return juce::String (stream.str());
+        }
+
+        template <typename Conversion>
+        static double measureNsPerLabel (const std::vector<double>& values, Conversion&& conversion)
+        {
+            int totalLength = 0;
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int round = 0; round < numRounds; ++round)
+                for (auto v : values)
+                    totalLength += conversion (v).length();
+
+            const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+
+            // makes sure the conversions are not optimised away
+            jassert (totalLength > 0);
+            juce::ignoreUnused (totalLength);
+
+            return seconds * 1.0e9 / (numRounds * static_cast<double> (values.size()));
+        }
+    };
+
+    static Float2StringTests float2StringTests;
+#endif
 }
@@ -27,15 +27,16 @@ SOFTWARE.
 
 #include <juce_core/juce_core.h>
 #include <cmath>
-#include <sstream>
-#include <iomanip>
 
 
 namespace ntlab
 {
     /**
-     * A quickly implemented class to manage some more sophisticated conversions from float numbers to strings,
-     * including finding/adding SI prefixes to those numbers. Not optimized for speed in any way.
+     * A class to manage some more sophisticated conversions from float numbers to strings, including finding/adding SI
+     * prefixes to those numbers. As it is used to create the tick labels of plots for each update, the conversion is
+     * based on integer math and std::to_chars instead of streams. Additionally, the last strings created by
+     * withSIPrefix are kept in a small per-thread cache, so that labels not changing between two updates won't be
+     * converted again.
      */
     class Float2String
     {
@@ -62,52 +63,9 @@ namespace ntlab
         {
             static_assert (std::is_floating_point<FloatType>::value, "Only floating point types are allowed for Float2String");
 
-            if (std::isnan (floatNumber))
-                return "NaN";
-
-            if (std::isinf (floatNumber))
-                return "Inf";
-
-            // if you are hitting this assert, the number is too big to be displayed by this number of digits and will
-            // be displayed wrong
-            jassert (floatNumber < std::pow (10, overallNumberOfDigits));
-
-            // prevents too small number to be displayed in exponential writing
-            if (std::abs (floatNumber) < std::pow (10, -overallNumberOfDigits))
-                floatNumber = FloatType (0);
-
-            // todo: I'm sure this can be done better
-            std::ostringstream os;
-            os << std::setprecision (overallNumberOfDigits) << floatNumber;
-            auto numberAsStdString = os.str();
-
-            juce::String returnString;
-            returnString.preallocateBytes (overallNumberOfDigits + 2);
-
-            int numPlacesAppended = 0;
-            bool hasDecimalDot = false;
-            for (char& c : numberAsStdString)
-            {
-                returnString += c;
-                if (c == '.')
-                    hasDecimalDot = true;
-                else
-                    ++numPlacesAppended;
-                if (c == '-')
-                    ++overallNumberOfDigits;
-                if (numPlacesAppended == overallNumberOfDigits)
-                    break;
-            }
-
-            if (int numPlacesMissing = overallNumberOfDigits - numPlacesAppended)
-            {
-                if (!hasDecimalDot)
-                    returnString += '.';
-
-                returnString += juce::String::repeatedString ("0", numPlacesMissing);
-            }
-
-            return returnString;
+            char buffer[maxStringLength];
+            writeFixedLength (buffer, static_cast<double> (floatNumber), overallNumberOfDigits);
+            return juce::String (buffer);
         }
 
         /** Returns the best fitting SIPrefix to display the number passed */
@@ -116,7 +74,7 @@ namespace ntlab
         {
             // scaling the number before conversion shifts it into a range resulting in the desired number of digits
             // before the decimal point
-            floatNumber *= std::pow (10, 3 - maxNumberOfDigitsBeforeDecimalPoint);
+            floatNumber = static_cast<FloatType> (multiplyByPowerOfTen (floatNumber, 3 - maxNumberOfDigitsBeforeDecimalPoint));
 
             // to figure out the range of the base 10 exponent si prefix we get the base 2 exponent and scale it by a
             // conversion to the corresponding prefix idx
@@ -148,25 +106,43 @@ namespace ntlab
         template <typename FloatType>
         static juce::String withSIPrefix (FloatType floatNumber, int overallNumberOfDigits, SIPrefix desiredPrefix)
         {
-            if (std::isnan (floatNumber))
-                return "NaN";
-
-            if (std::isinf (floatNumber))
-                return "Inf";
-
-            int prefixIdx = desiredPrefix;
-            int exponentBase10 = prefixIdx * 3;
-
-            prefixIdx += siPrefixArrayOffset;
-            floatNumber /= std::pow (10, exponentBase10);
+            static_assert (std::is_floating_point<FloatType>::value, "Only floating point types are allowed for Float2String");
 
-            return withFixedLength (floatNumber, overallNumberOfDigits) + siPrefixes[prefixIdx];
+            return withSIPrefixCached (static_cast<double> (floatNumber), overallNumberOfDigits, desiredPrefix);
         }
 
     private:
         static constexpr double base2ExponentToPrefixIdxConversionFactor = 0.100343331887994; // log10 (2) / 3
         static constexpr char siPrefixes[11][3] = {"f", "p", "n", "μ", "m", "", "k", "M", "G", "T", "P"};
         static const int siPrefixArrayOffset = 5;
+
+        // Enough for a sign, 19 digits, the decimal point, an si prefix and the terminating null
+        static const int maxStringLength = 32;
+        static const int maxNumberOfDigits = 18;
+        static const int maxPowerOfTen = 18;
+        static constexpr double powersOfTen[maxPowerOfTen + 1] =
+        {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18
+        };
+
+        /** Returns value * 10^exponent, using a lookup table instead of std::pow for all exponents in the table */
+        static double multiplyByPowerOfTen (double value, int exponent)
+        {
+            if ((exponent >= 0) && (exponent <= maxPowerOfTen))
+                return value * powersOfTen[exponent];
+
+            if ((exponent < 0) && (exponent >= -maxPowerOfTen))
+                return value / powersOfTen[-exponent];
+
+            return value * std::pow (10.0, exponent);
+        }
+
+        /**
+         * Writes the number to the buffer with the number of digits given, followed by a terminating null. Returns a
+         * pointer to the terminating null, so that further characters can be appended.
+         */
+        static char* writeFixedLength (char* buffer, double number, int overallNumberOfDigits);
+
+        static juce::String withSIPrefixCached (double number, int overallNumberOfDigits, SIPrefix desiredPrefix);
     };
 }
-
@@ -0,0 +1,351 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "FrameCapture.h"
+
+namespace ntlab
+{
+    FrameCapture::FrameCapture (const juce::File& destination, Format format, int captureEveryNthFrame, int framesPerSecond)
+        :   juce::Thread ("Frame Capture Writer"),
+            destination (destination),
+            format (format),
+            captureEveryNthFrame (juce::jmax (1, captureEveryNthFrame)),
+            framesPerSecond (juce::jmax (1, framesPerSecond))
+    {
+        if (format == pngSequence)
+            destination.createDirectory();
+
+        startThread();
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        // Call finish on the GL thread before deleting the capture instance, otherwise the GL resources are leaked
+        jassert (!glResourcesCreated);
+
+        signalThreadShouldExit();
+        slotMapped.signal();
+        waitForThreadToExit (-1);
+    }
+
+    void FrameCapture::captureFrame (juce::OpenGLContext& context, int width, int height)
+    {
+        if (!glResourcesCreated)
+            createGLResources (context);
+
+        recycleWrittenSlots (context);
+        mapFinishedSlots (context, false);
+
+        if (((frameCounter++ % captureEveryNthFrame) != 0) || (width <= 0) || (height <= 0))
+            return;
+
+        auto& slot = slots[nextCaptureSlot];
+
+        // the writer thread can't keep up, dropping this frame is better than stalling the render thread
+        if (slot.state != available)
+        {
+            ++numFramesDropped;
+            return;
+        }
+
+        const int numBytes = width * height * 4;
+        slot.width  = width;
+        slot.height = height;
+
+        if (asyncReadbackAvailable)
+        {
+            context.extensions.glBindBuffer (GL_PIXEL_PACK_BUFFER, slot.pixelBuffer);
+
+            if (slot.allocatedBytes != numBytes)
+            {
+                context.extensions.glBufferData (GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr> (numBytes), nullptr, GL_STREAM_READ);
+                slot.allocatedBytes = numBytes;
+            }
+
+            // with a pixel pack buffer bound the last argument is an offset into that buffer and the call returns
+            // without waiting for the transfer to finish
+            glReadPixels (0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            context.extensions.glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+
+            slot.fence = glFunctions.glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            slot.state = readbackPending;
+        }
+        else
+        {
+            slot.cpuBuffer.resize (static_cast<size_t> (numBytes));
+            glReadPixels (0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, slot.cpuBuffer.data());
+            slot.pixels = slot.cpuBuffer.data();
+            slot.state = mapped;
+            slotMapped.signal();
+
+            nextMapSlot = (nextCaptureSlot + 1) % numSlots;
+        }
+
+        nextCaptureSlot = (nextCaptureSlot + 1) % numSlots;
+    }
+
+    void FrameCapture::finish (juce::OpenGLContext& context)
+    {
+        if (!glResourcesCreated)
+            return;
+
+        mapFinishedSlots (context, true);
+
+        // the writer thread writes all mapped slots before exiting
+        signalThreadShouldExit();
+        slotMapped.signal();
+        waitForThreadToExit (-1);
+
+        recycleWrittenSlots (context);
+
+        for (auto& slot : slots)
+        {
+            if (slot.pixelBuffer != 0)
+                context.extensions.glDeleteBuffers (1, &slot.pixelBuffer);
+
+            slot.pixelBuffer = 0;
+            slot.allocatedBytes = 0;
+        }
+
+        glResourcesCreated = false;
+    }
+
+    void FrameCapture::createGLResources (juce::OpenGLContext& context)
+    {
+        asyncReadbackAvailable = glFunctions.initialise();
+
+        if (asyncReadbackAvailable)
+        {
+            for (auto& slot : slots)
+                context.extensions.glGenBuffers (1, &slot.pixelBuffer);
+        }
+        else
+        {
+            DBG ("FrameCapture: Pixel buffer mapping or fences are not supported by this context, reading back frames synchronously");
+        }
+
+        glResourcesCreated = true;
+    }
+
+    void FrameCapture::recycleWrittenSlots (juce::OpenGLContext& context)
+    {
+        for (auto& slot : slots)
+        {
+            if (slot.state != written)
+                continue;
+
+            if (asyncReadbackAvailable && (slot.pixels != nullptr))
+            {
+                context.extensions.glBindBuffer (GL_PIXEL_PACK_BUFFER, slot.pixelBuffer);
+                glFunctions.glUnmapBuffer (GL_PIXEL_PACK_BUFFER);
+                context.extensions.glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+            }
+
+            slot.pixels = nullptr;
+            slot.state = available;
+        }
+    }
+
+    void FrameCapture::mapFinishedSlots (juce::OpenGLContext& context, bool waitForPendingReadbacks)
+    {
+        // slots are mapped strictly in the order they were captured, so the writer thread can process them in order
+        for (int i = 0; i < numSlots; ++i)
+        {
+            auto& slot = slots[nextMapSlot];
+
+            if (slot.state != readbackPending)
+                return;
+
+            if (waitForPendingReadbacks)
+                glFunctions.waitUntilSignaled (slot.fence);
+            else if (!glFunctions.isSignaled (slot.fence))
+                return;
+
+            mapSlot (context, slot);
+            nextMapSlot = (nextMapSlot + 1) % numSlots;
+        }
+    }
+
+    void FrameCapture::mapSlot (juce::OpenGLContext& context, ReadbackSlot& slot)
+    {
+        glFunctions.glDeleteSync (slot.fence);
+        slot.fence = nullptr;
+
+        context.extensions.glBindBuffer (GL_PIXEL_PACK_BUFFER, slot.pixelBuffer);
+        slot.pixels = static_cast<const juce::uint8*> (glFunctions.glMapBufferRange (GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr> (slot.width * slot.height * 4), GL_MAP_READ_BIT));
+        context.extensions.glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+
+        // a slot that could not be mapped is still passed to the writer thread, which will skip it
+        slot.state = mapped;
+        slotMapped.signal();
+    }
+
+    void FrameCapture::run()
+    {
+        while (true)
+        {
+            auto& slot = slots[nextWriteSlot];
+
+            if (slot.state == mapped)
+            {
+                if (slot.pixels != nullptr)
+                    writeFrame (slot);
+                else
+                    ++numFramesDropped;
+
+                slot.state = written;
+                nextWriteSlot = (nextWriteSlot + 1) % numSlots;
+                continue;
+            }
+
+            if (threadShouldExit())
+                break;
+
+            slotMapped.wait (100);
+        }
+
+        videoStream.reset();
+    }
+
+    void FrameCapture::writeFrame (const ReadbackSlot& slot)
+    {
+        switch (format)
+        {
+            case pngSequence:
+                writePNG (slot);
+                break;
+
+            case y4mVideo:
+                writeY4M (slot);
+                break;
+        }
+    }
+
+    void FrameCapture::writePNG (const ReadbackSlot& slot)
+    {
+        juce::Image image (juce::Image::ARGB, slot.width, slot.height, false);
+        {
+            juce::Image::BitmapData bitmap (image, juce::Image::BitmapData::writeOnly);
+
+            for (int y = 0; y < slot.height; ++y)
+            {
+                // OpenGL rows start at the bottom of the frame
+                const juce::uint8* source = slot.pixels + (slot.height - 1 - y) * slot.width * 4;
+
+                for (int x = 0; x < slot.width; ++x)
+                {
+                    reinterpret_cast<juce::PixelARGB*> (bitmap.getPixelPointer (x, y))->setARGB (255, source[0], source[1], source[2]);
+                    source += 4;
+                }
+            }
+        }
+
+        auto file = destination.getChildFile ("frame_" + juce::String (numFramesWritten.load()).paddedLeft ('0', 6) + ".png");
+        file.deleteFile();
+
+        juce::FileOutputStream stream (file);
+        if (!stream.openedOk())
+        {
+            DBG ("FrameCapture: Could not open " << file.getFullPathName() << " for writing");
+            ++numFramesDropped;
+            return;
+        }
+
+        juce::PNGImageFormat pngFormat;
+        pngFormat.writeImageToStream (image, stream);
+        ++numFramesWritten;
+    }
+
+    void FrameCapture::writeY4M (const ReadbackSlot& slot)
+    {
+        if (videoStream == nullptr)
+        {
+            // 4:2:0 chroma subsampling needs an even frame size
+            videoWidth  = slot.width  & ~1;
+            videoHeight = slot.height & ~1;
+
+            destination.deleteFile();
+            videoStream.reset (new juce::FileOutputStream (destination));
+
+            if (!videoStream->openedOk())
+            {
+                DBG ("FrameCapture: Could not open " << destination.getFullPathName() << " for writing");
+                videoStream.reset();
+                ++numFramesDropped;
+                return;
+            }
+
+            *videoStream << "YUV4MPEG2 W" << videoWidth << " H" << videoHeight << " F" << framesPerSecond << ":1 Ip A1:1 C420jpeg\n";
+            yuvBuffer.resize (static_cast<size_t> (videoWidth * videoHeight + 2 * (videoWidth / 2) * (videoHeight / 2)));
+        }
+
+        // all frames of a video need the same size, so bigger frames are cropped and smaller frames are dropped
+        if ((slot.width < videoWidth) || (slot.height < videoHeight))
+        {
+            ++numFramesDropped;
+            return;
+        }
+
+        juce::uint8* yPlane = yuvBuffer.data();
+        juce::uint8* uPlane = yPlane + videoWidth * videoHeight;
+        juce::uint8* vPlane = uPlane + (videoWidth / 2) * (videoHeight / 2);
+
+        // Full range BT.601 conversion in 8 bit fixed point, the chroma values are averaged over 2x2 pixels
+        for (int y = 0; y < videoHeight; y += 2)
+        {
+            // OpenGL rows start at the bottom of the frame
+            const juce::uint8* sourceRows[2] = { slot.pixels + (slot.height - 1 - y) * slot.width * 4,
+                                                 slot.pixels + (slot.height - 2 - y) * slot.width * 4 };
+
+            for (int x = 0; x < videoWidth; x += 2)
+            {
+                int rSum = 0, gSum = 0, bSum = 0;
+
+                for (int row = 0; row < 2; ++row)
+                {
+                    for (int column = 0; column < 2; ++column)
+                    {
+                        const juce::uint8* p = sourceRows[row] + (x + column) * 4;
+                        const int r = p[0], g = p[1], b = p[2];
+
+                        yPlane[(y + row) * videoWidth + x + column] = static_cast<juce::uint8> ((77 * r + 150 * g + 29 * b + 128) >> 8);
+
+                        rSum += r;
+                        gSum += g;
+                        bSum += b;
+                    }
+                }
+
+                const int chromaIdx = (y / 2) * (videoWidth / 2) + x / 2;
+                uPlane[chromaIdx] = static_cast<juce::uint8> (juce::jlimit (0, 255, 128 + (-43 * rSum -  85 * gSum + 128 * bSum) / 1024));
+                vPlane[chromaIdx] = static_cast<juce::uint8> (juce::jlimit (0, 255, 128 + (128 * rSum - 107 * gSum -  21 * bSum) / 1024));
+            }
+        }
+
+        *videoStream << "FRAME\n";
+        videoStream->write (yuvBuffer.data(), yuvBuffer.size());
+        ++numFramesWritten;
+    }
+}
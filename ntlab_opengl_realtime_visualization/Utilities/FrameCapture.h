@@ -0,0 +1,152 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_graphics/juce_graphics.h>
+#include <juce_opengl/juce_opengl.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "GLExtraFunctions.h"
+
+namespace ntlab
+{
+    /**
+     * Records the frames rendered by an OpenGL context without stalling the render thread. Each captured frame is read
+     * back into one of a small ring of pixel buffer objects. A fence marks the point at which the transfer has
+     * finished, so the buffer is only mapped once the GPU is done with it. The mapped memory is then handed to a
+     * background thread that converts and writes the frame to disk and is unmapped on the GL thread after that.
+     * If the writer thread can't keep up and all buffers are in use, frames are dropped instead of blocking rendering.
+     *
+     * You usually don't need to create an instance yourself, use WindowOpenGLContext::startFrameCapture instead.
+     */
+    class FrameCapture : private juce::Thread
+    {
+    public:
+
+        enum Format
+        {
+            /** Writes one PNG file per frame into the destination directory */
+            pngSequence,
+
+            /** Writes all frames into a single uncompressed YUV4MPEG2 (4:2:0) file */
+            y4mVideo
+        };
+
+        /**
+         * Creates a capture instance and starts the writer thread.
+         * @param destination          a directory for pngSequence or a file for y4mVideo
+         * @param format               the output format
+         * @param captureEveryNthFrame only every nth frame rendered is captured
+         * @param framesPerSecond      the frame rate written to the y4m header, ignored for png sequences
+         */
+        FrameCapture (const juce::File& destination, Format format, int captureEveryNthFrame = 1, int framesPerSecond = 60);
+
+        /** Make sure to call finish on the GL thread before destructing the instance */
+        ~FrameCapture();
+
+        /**
+         * Starts the read back of the current frame. Call this on the GL thread after all rendering for the frame has
+         * been done but before the buffers are swapped. Width and height are the size of the framebuffer in pixels.
+         */
+        void captureFrame (juce::OpenGLContext& context, int width, int height);
+
+        /**
+         * Waits for all pending read backs, writes all remaining frames to disk and releases all GL resources. Must be
+         * called on the GL thread. As this blocks until all frames have been written, only call it when stopping the
+         * capture.
+         */
+        void finish (juce::OpenGLContext& context);
+
+        /** Returns the number of frames that have been written to disk */
+        int getNumFramesWritten() const { return numFramesWritten; }
+
+        /** Returns the number of frames that were skipped because all read back buffers were busy */
+        int getNumFramesDropped() const { return numFramesDropped; }
+
+    private:
+
+        enum SlotState
+        {
+            available,
+            readbackPending,
+            mapped,
+            written
+        };
+
+        struct ReadbackSlot
+        {
+            GLuint pixelBuffer = 0;
+            GLExtraFunctions::SyncHandle fence = nullptr;
+            std::atomic<int> state {available};
+            int width = 0;
+            int height = 0;
+            int allocatedBytes = 0;
+
+            // points to the mapped pixel buffer or to cpuBuffer if no pixel buffer objects are available
+            const juce::uint8* pixels = nullptr;
+            std::vector<juce::uint8> cpuBuffer;
+        };
+
+        static const int numSlots = 4;
+        std::array<ReadbackSlot, numSlots> slots;
+
+        GLExtraFunctions glFunctions;
+        bool glResourcesCreated = false;
+        bool asyncReadbackAvailable = false;
+        int frameCounter = 0;
+        int nextCaptureSlot = 0;
+        int nextMapSlot = 0;
+
+        const juce::File destination;
+        const Format format;
+        const int captureEveryNthFrame;
+        const int framesPerSecond;
+
+        // Writer thread state
+        juce::WaitableEvent slotMapped;
+        int nextWriteSlot = 0;
+        std::unique_ptr<juce::FileOutputStream> videoStream;
+        int videoWidth = 0;
+        int videoHeight = 0;
+        std::vector<juce::uint8> yuvBuffer;
+        std::atomic<int> numFramesWritten {0};
+        std::atomic<int> numFramesDropped {0};
+
+        void createGLResources (juce::OpenGLContext& context);
+        void recycleWrittenSlots (juce::OpenGLContext& context);
+        void mapFinishedSlots (juce::OpenGLContext& context, bool waitForPendingReadbacks);
+        void mapSlot (juce::OpenGLContext& context, ReadbackSlot& slot);
+
+        void run() override;
+        void writeFrame (const ReadbackSlot& slot);
+        void writePNG (const ReadbackSlot& slot);
+        void writeY4M (const ReadbackSlot& slot);
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FrameCapture)
+    };
+}
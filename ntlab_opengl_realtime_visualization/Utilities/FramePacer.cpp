@@ -0,0 +1,139 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "FramePacer.h"
+#include <thread>
+
+namespace ntlab
+{
+    FramePacer::FramePacer() {}
+
+    void FramePacer::setTargetFrameRate (double framesPerSecond)
+    {
+        // a frame rate of zero or below makes no sense
+        jassert (framesPerSecond > 0.0);
+
+        framePeriodMs = 1000.0 / juce::jmax (1.0, framesPerSecond);
+    }
+
+    void FramePacer::setAdaptiveQualityEnabled (bool shouldBeEnabled)
+    {
+        adaptiveQualityEnabled = shouldBeEnabled;
+
+        if (!shouldBeEnabled)
+            qualityTier = fullQuality;
+    }
+
+    void FramePacer::setLateLatchingEnabled (bool shouldBeEnabled)
+    {
+        lateLatchingEnabled = shouldBeEnabled;
+    }
+
+    bool FramePacer::isLateLatchingEnabled() const
+    {
+        return lateLatchingEnabled;
+    }
+
+    FramePacer::QualityTier FramePacer::getQualityTier() const
+    {
+        return static_cast<QualityTier> (qualityTier.load());
+    }
+
+    int FramePacer::getDecimationFactor (QualityTier tier)
+    {
+        switch (tier)
+        {
+            case decimatedBy2: return 2;
+            case decimatedBy4: return 4;
+            default:           return 1;
+        }
+    }
+
+    double FramePacer::getAverageRenderTimeMs() const
+    {
+        return averageRenderTimeMs;
+    }
+
+    void FramePacer::waitForLateLatchPoint()
+    {
+        if (!lateLatchingEnabled)
+            return;
+
+        // The render callback is invoked right after the buffer swap of the last frame returned, which blocks until
+        // the vertical blank, so the time left until the next one is roughly one frame period. If the last frame was
+        // over budget, the render time estimation is obviously too optimistic, so don't sleep at all.
+        const double period = framePeriodMs;
+        if (lastRenderTimeMs > period)
+            return;
+
+        const double expectedRenderTimeMs = juce::jmax (averageRenderTimeMs.load(), lastRenderTimeMs);
+        const double sleepTimeMs = period * (1.0 - safetyMarginRatio) - expectedRenderTimeMs;
+
+        if (sleepTimeMs > 0.0)
+            std::this_thread::sleep_for (std::chrono::microseconds (static_cast<juce::int64> (sleepTimeMs * 1000.0)));
+    }
+
+    void FramePacer::frameStarted()
+    {
+        frameStartTicks = juce::Time::getHighResolutionTicks();
+    }
+
+    void FramePacer::frameFinished()
+    {
+        lastRenderTimeMs = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - frameStartTicks) * 1000.0;
+        averageRenderTimeMs = averageRenderTimeMs + smoothingCoefficient * (lastRenderTimeMs - averageRenderTimeMs);
+
+        if (!adaptiveQualityEnabled)
+            return;
+
+        const double period = framePeriodMs;
+
+        if (averageRenderTimeMs > period)
+        {
+            numFramesWithHeadroom = 0;
+
+            if ((++numFramesOverBudget >= numFramesBeforeLowering) && (qualityTier < numQualityTiers - 1))
+            {
+                ++qualityTier;
+                numFramesOverBudget = 0;
+            }
+        }
+        else if (averageRenderTimeMs < period * headroomRatio)
+        {
+            numFramesOverBudget = 0;
+
+            if ((++numFramesWithHeadroom >= numFramesBeforeRaising) && (qualityTier > fullQuality))
+            {
+                --qualityTier;
+                numFramesWithHeadroom = 0;
+            }
+        }
+        else
+        {
+            numFramesOverBudget   = 0;
+            numFramesWithHeadroom = 0;
+        }
+    }
+}
@@ -0,0 +1,119 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+
+namespace ntlab
+{
+    /**
+     * Measures the time needed to render each frame of a WindowOpenGLContext and reacts if it exceeds the frame
+     * budget, that is the period of the target frame rate. If adaptive quality is enabled, the quality tier is
+     * lowered step by step as long as the render time stays above the budget and raised again if there is plenty of
+     * headroom. Rendering targets query the current tier and reduce their work accordingly.
+     *
+     * If late latching is enabled, the render thread sleeps at the beginning of each frame until just enough time is
+     * left to prepare and render the frame before the next vertical blank. The realtime data is then fetched as late
+     * as possible, which reduces the latency between the samples and their display. As the render time is measured
+     * continuously, the sleep time shrinks automatically if rendering gets slower, so no frames are dropped.
+     *
+     * You don't create an instance yourself, use WindowOpenGLContext::getFramePacer.
+     */
+    class FramePacer
+    {
+    public:
+
+        enum QualityTier
+        {
+            /** Everything is drawn as configured */
+            fullQuality = 0,
+
+            /** Lines are drawn with a width of one pixel */
+            thinLines,
+
+            /** Lines are drawn with a width of one pixel and only every second vertex is drawn */
+            decimatedBy2,
+
+            /** Lines are drawn with a width of one pixel and only every fourth vertex is drawn */
+            decimatedBy4,
+
+            numQualityTiers
+        };
+
+        FramePacer();
+
+        /** Sets the frame rate whose period is used as budget, which should match the refresh rate of the display */
+        void setTargetFrameRate (double framesPerSecond);
+
+        /** Enables or disables lowering the quality tier if the budget is exceeded. Disabled by default. */
+        void setAdaptiveQualityEnabled (bool shouldBeEnabled);
+
+        /** Enables or disables sleeping until just before the next vertical blank. Disabled by default. */
+        void setLateLatchingEnabled (bool shouldBeEnabled);
+
+        bool isLateLatchingEnabled() const;
+
+        /** Returns the quality tier targets should render the current frame with. Can be called from any thread. */
+        QualityTier getQualityTier() const;
+
+        /** Returns the number of vertices that are skipped + 1 for the quality tier passed */
+        static int getDecimationFactor (QualityTier tier);
+
+        /** Returns the smoothed time needed to render a frame in milliseconds */
+        double getAverageRenderTimeMs() const;
+
+        /** Called on the GL thread. Sleeps until the late latch point if late latching is enabled. */
+        void waitForLateLatchPoint();
+
+        /** Called on the GL thread when the actual rendering work for a frame starts */
+        void frameStarted();
+
+        /** Called on the GL thread when everything for a frame has been submitted */
+        void frameFinished();
+
+    private:
+        std::atomic<double> framePeriodMs {1000.0 / 60.0};
+        std::atomic<bool> adaptiveQualityEnabled {false};
+        std::atomic<bool> lateLatchingEnabled {false};
+        std::atomic<int> qualityTier {fullQuality};
+        std::atomic<double> averageRenderTimeMs {0.0};
+
+        // Only accessed on the GL thread
+        juce::int64 frameStartTicks = 0;
+        double lastRenderTimeMs = 0.0;
+        int numFramesOverBudget = 0;
+        int numFramesWithHeadroom = 0;
+
+        static constexpr double smoothingCoefficient     = 0.1;
+        static constexpr double safetyMarginRatio        = 0.2;
+        static constexpr double headroomRatio            = 0.5;
+        static constexpr int numFramesBeforeLowering     = 10;
+        static constexpr int numFramesBeforeRaising      = 120;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FramePacer)
+    };
+}
@@ -0,0 +1,152 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_opengl/juce_opengl.h>
+
+// Some constants needed for buffer mapping and synchronization that might not be declared by the GL headers included
+// by JUCE on all platforms
+#ifndef GL_PIXEL_PACK_BUFFER
+ #define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+ #define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_MAP_READ_BIT
+ #define GL_MAP_READ_BIT 0x0001
+#endif
+#ifndef GL_MAP_WRITE_BIT
+ #define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_INVALIDATE_BUFFER_BIT
+ #define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
+#endif
+#ifndef GL_COPY_READ_BUFFER
+ #define GL_COPY_READ_BUFFER 0x8F36
+#endif
+#ifndef GL_COPY_WRITE_BUFFER
+ #define GL_COPY_WRITE_BUFFER 0x8F37
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+ #define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+ #define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_ALREADY_SIGNALED
+ #define GL_ALREADY_SIGNALED 0x911A
+#endif
+#ifndef GL_CONDITION_SATISFIED
+ #define GL_CONDITION_SATISFIED 0x911C
+#endif
+
+#if defined (JUCE_GLAPIENTRY)
+ #define NTLAB_GLAPIENTRY JUCE_GLAPIENTRY
+#elif JUCE_WINDOWS
+ #define NTLAB_GLAPIENTRY __stdcall
+#else
+ #define NTLAB_GLAPIENTRY
+#endif
+
+namespace ntlab
+{
+    /**
+     * Some OpenGL functions needed for asynchronous buffer transfers that are not part of
+     * juce::OpenGLExtensionFunctions. They are loaded at runtime, so call initialise on the GL thread with the
+     * context being active and check the return value before using them.
+     */
+    struct GLExtraFunctions
+    {
+        /** The sync object type, declared as void pointer as GLsync might be unknown to the GL headers used */
+        typedef void* SyncHandle;
+
+        /**
+         * Loads all functions. Returns false if one of them is not available, which is the case for OpenGL versions
+         * older than 3.0 or OpenGL ES versions older than 3.0
+         */
+        bool initialise()
+        {
+            glMapBufferRange = reinterpret_cast<MapBufferRange> (juce::OpenGLHelpers::getExtensionFunction ("glMapBufferRange"));
+            glUnmapBuffer    = reinterpret_cast<UnmapBuffer>    (juce::OpenGLHelpers::getExtensionFunction ("glUnmapBuffer"));
+            glFenceSync      = reinterpret_cast<FenceSync>      (juce::OpenGLHelpers::getExtensionFunction ("glFenceSync"));
+            glClientWaitSync = reinterpret_cast<ClientWaitSync> (juce::OpenGLHelpers::getExtensionFunction ("glClientWaitSync"));
+            glDeleteSync     = reinterpret_cast<DeleteSync>     (juce::OpenGLHelpers::getExtensionFunction ("glDeleteSync"));
+
+            glCopyBufferSubData = reinterpret_cast<CopyBufferSubData> (juce::OpenGLHelpers::getExtensionFunction ("glCopyBufferSubData"));
+
+            return isAvailable();
+        }
+
+        /** Returns true if all functions have been loaded successfully */
+        bool isAvailable() const
+        {
+            return (glMapBufferRange != nullptr)
+                && (glUnmapBuffer    != nullptr)
+                && (glFenceSync      != nullptr)
+                && (glClientWaitSync != nullptr)
+                && (glDeleteSync     != nullptr);
+        }
+
+        /**
+         * Returns true if buffer to buffer copies are available. This is checked independently of isAvailable, as
+         * glCopyBufferSubData requires OpenGL 3.1 while all other functions are part of OpenGL 3.0
+         */
+        bool isCopyBufferAvailable() const
+        {
+            return glCopyBufferSubData != nullptr;
+        }
+
+        /** Returns true if the GPU has finished all commands issued before the fence was created. Won't block. */
+        bool isSignaled (SyncHandle fence) const
+        {
+            auto result = glClientWaitSync (fence, 0, 0);
+            return (result == GL_ALREADY_SIGNALED) || (result == GL_CONDITION_SATISFIED);
+        }
+
+        /** Blocks until the GPU has finished all commands issued before the fence was created */
+        void waitUntilSignaled (SyncHandle fence) const
+        {
+            const juce::uint64 oneSecondInNanoseconds = 1000000000;
+            while (!isSignaled (fence))
+                glClientWaitSync (fence, GL_SYNC_FLUSH_COMMANDS_BIT, oneSecondInNanoseconds);
+        }
+
+        typedef void*      (NTLAB_GLAPIENTRY *MapBufferRange) (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+        typedef GLboolean  (NTLAB_GLAPIENTRY *UnmapBuffer)    (GLenum target);
+        typedef SyncHandle (NTLAB_GLAPIENTRY *FenceSync)      (GLenum condition, GLbitfield flags);
+        typedef GLenum     (NTLAB_GLAPIENTRY *ClientWaitSync) (SyncHandle sync, GLbitfield flags, juce::uint64 timeout);
+        typedef void       (NTLAB_GLAPIENTRY *DeleteSync)     (SyncHandle sync);
+        typedef void       (NTLAB_GLAPIENTRY *CopyBufferSubData) (GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+
+        MapBufferRange glMapBufferRange = nullptr;
+        UnmapBuffer    glUnmapBuffer    = nullptr;
+        FenceSync      glFenceSync      = nullptr;
+        ClientWaitSync glClientWaitSync = nullptr;
+        DeleteSync     glDeleteSync     = nullptr;
+
+        CopyBufferSubData glCopyBufferSubData = nullptr;
+    };
+}
@@ -0,0 +1,185 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "GLResourcePool.h"
+#include "WindowOpenGLContext.h"
+
+namespace ntlab
+{
+    GLResourcePool::GLResourcePool() {}
+
+    GLResourcePool::~GLResourcePool()
+    {
+        // All contexts should have been closed before, otherwise the resources can't be deleted as there is no
+        // context left that could be made active to delete them
+        jassert (shaders.empty());
+        jassert (alphaTextures.empty());
+    }
+
+    GLuint GLResourcePool::getAlphaTexture (const juce::String& name, const juce::uint8* pixels, int width, int height)
+    {
+        std::lock_guard<std::mutex> scopedLock (resourcesLock);
+
+        auto existingTexture = alphaTextures.find (name);
+        if (existingTexture != alphaTextures.end())
+            return existingTexture->second;
+
+        // juce::OpenGLTexture can only be released by the context that created it, which might be closed before the
+        // other contexts of the group, so the texture is managed manually here
+        GLuint textureID = 0;
+        glGenTextures (1, &textureID);
+        glBindTexture (GL_TEXTURE_2D, textureID);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glPixelStorei (GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D (GL_TEXTURE_2D, 0, GL_ALPHA, width, height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, pixels);
+        glBindTexture (GL_TEXTURE_2D, 0);
+
+        alphaTextures[name] = textureID;
+        return textureID;
+    }
+
+    void GLResourcePool::attachSharingResources (WindowOpenGLContext& windowContext, juce::Component& topLevelComponent)
+    {
+        {
+            std::lock_guard<std::mutex> scopedLock (contextsLock);
+
+            if (nativeContextToShareWith != nullptr)
+            {
+                windowContext.openGLContext.setNativeSharedContext (nativeContextToShareWith);
+            }
+            else if (firstContextAttaching)
+            {
+                // there is no native context to share with yet, this context will be attached by attachPendingContexts
+                pendingAttachments.push_back ({&windowContext, &topLevelComponent});
+                return;
+            }
+            else
+            {
+                firstContextAttaching = true;
+            }
+        }
+
+        windowContext.openGLContext.attachTo (topLevelComponent);
+    }
+
+    void GLResourcePool::cancelPendingAttachment (WindowOpenGLContext& windowContext)
+    {
+        std::lock_guard<std::mutex> scopedLock (contextsLock);
+
+        pendingAttachments.erase (std::remove_if (pendingAttachments.begin(),
+                                                  pendingAttachments.end(),
+                                                  [&windowContext] (const PendingAttachment& p) { return p.windowContext == &windowContext; }),
+                                  pendingAttachments.end());
+    }
+
+    void GLResourcePool::attachPendingContexts()
+    {
+        std::vector<PendingAttachment> attachmentsToProcess;
+        void* nativeContext;
+        {
+            std::lock_guard<std::mutex> scopedLock (contextsLock);
+            attachmentsToProcess.swap (pendingAttachments);
+            nativeContext = nativeContextToShareWith;
+        }
+
+        for (auto& p : attachmentsToProcess)
+        {
+            if (nativeContext != nullptr)
+                p.windowContext->openGLContext.setNativeSharedContext (nativeContext);
+
+            p.windowContext->openGLContext.attachTo (*p.topLevelComponent);
+        }
+    }
+
+    void GLResourcePool::contextCreated (juce::OpenGLContext& context)
+    {
+        std::lock_guard<std::mutex> scopedLock (contextsLock);
+
+        activeContexts.addIfNotAlreadyThere (&context);
+
+        if (nativeContextToShareWith == nullptr)
+            nativeContextToShareWith = context.getRawContext();
+
+        if (!pendingAttachments.empty())
+        {
+            std::weak_ptr<GLResourcePool> weakThis (shared_from_this());
+            juce::MessageManager::callAsync ([weakThis] ()
+            {
+                if (auto pool = weakThis.lock())
+                    pool->attachPendingContexts();
+            });
+        }
+    }
+
+    void GLResourcePool::contextClosing (juce::OpenGLContext& context)
+    {
+        std::lock_guard<std::mutex> scopedLock (contextsLock);
+
+        activeContexts.removeFirstMatchingValue (&context);
+
+        // The shader programs keep a reference to the context that created them, so they can't outlive it
+        releaseShadersCreatedBy (context);
+
+        if (activeContexts.isEmpty())
+        {
+            // this is the last context of the group, it's the last chance to delete the shared resources
+            releaseAllResources();
+            nativeContextToShareWith = nullptr;
+            firstContextAttaching = false;
+        }
+        else if (nativeContextToShareWith == context.getRawContext())
+        {
+            nativeContextToShareWith = activeContexts.getFirst()->getRawContext();
+        }
+    }
+
+    void GLResourcePool::releaseShadersCreatedBy (juce::OpenGLContext& context)
+    {
+        std::lock_guard<std::mutex> scopedLock (resourcesLock);
+
+        for (auto it = shaders.begin(); it != shaders.end();)
+        {
+            if (it->second.creatingContext == &context)
+                it = shaders.erase (it);
+            else
+                ++it;
+        }
+    }
+
+    void GLResourcePool::releaseAllResources()
+    {
+        std::lock_guard<std::mutex> scopedLock (resourcesLock);
+
+        shaders.clear();
+
+        for (auto& t : alphaTextures)
+            glDeleteTextures (1, &t.second);
+
+        alphaTextures.clear();
+    }
+}
@@ -0,0 +1,145 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <juce_opengl/juce_opengl.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ntlab
+{
+    class WindowOpenGLContext;
+
+    /**
+     * Holds OpenGL resources that are shared between all WindowOpenGLContexts of a group. The native contexts of the
+     * group are created as shared contexts, so shader programs, buffers and textures created by one of them can be
+     * used by all of them. This way, components displayed in multiple top level windows don't need to create their
+     * own copies of e.g. the same shader program.
+     *
+     * As the uniforms of a shared shader program are shared too, the rendering of all windows of a group is
+     * serialized through the render lock, so that two windows never draw with the same program at the same time.
+     *
+     * You don't create a pool yourself, every WindowOpenGLContext creates one or uses the pool of the context it was
+     * constructed to share resources with.
+     */
+    class GLResourcePool : public std::enable_shared_from_this<GLResourcePool>
+    {
+    public:
+
+        GLResourcePool();
+
+        ~GLResourcePool();
+
+        /**
+         * Returns the shader registered under the name passed or creates it with ShaderType::create if it doesn't exist
+         * yet. The shader is owned by the pool. As a juce::OpenGLShaderProgram keeps a reference to the context that
+         * created it, it gets deleted when this context closes and will be re-created on the next call by one of the
+         * remaining contexts. Therefore you should call this in every render callback instead of storing the pointer.
+         * Must be called on the GL thread of one of the contexts of the group. Returns a nullptr if the shader could
+         * not be created.
+         */
+        template <typename ShaderType>
+        ShaderType* getShader (const juce::String& name, juce::OpenGLContext& context)
+        {
+            std::lock_guard<std::mutex> scopedLock (resourcesLock);
+
+            auto& entry = shaders[name];
+            if (entry.shader == nullptr)
+            {
+                entry.shader.reset (ShaderType::create (context));
+                entry.creatingContext = &context;
+            }
+
+            return dynamic_cast<ShaderType*> (entry.shader.get());
+        }
+
+        /**
+         * Returns the ID of the single channel alpha texture registered under the name passed or creates it from the
+         * pixels passed if it doesn't exist yet. The texture is owned by the pool and stays valid until the last
+         * context of the group is closed. Must be called on the GL thread of one of the contexts of the group.
+         */
+        GLuint getAlphaTexture (const juce::String& name, const juce::uint8* pixels, int width, int height);
+
+        /** Returns the lock that serializes the rendering of all contexts of this group */
+        std::mutex& getRenderLock() { return renderLock; }
+
+    private:
+        friend class WindowOpenGLContext;
+
+        struct PendingAttachment
+        {
+            WindowOpenGLContext* windowContext;
+            juce::Component* topLevelComponent;
+        };
+
+        struct SharedShader
+        {
+            std::unique_ptr<juce::OpenGLShaderProgram> shader;
+            juce::OpenGLContext* creatingContext = nullptr;
+        };
+
+        std::mutex resourcesLock;
+        std::map<juce::String, SharedShader> shaders;
+        std::map<juce::String, GLuint> alphaTextures;
+
+        std::mutex renderLock;
+
+        // The native context new contexts of this group will share their resources with
+        std::mutex contextsLock;
+        juce::Array<juce::OpenGLContext*> activeContexts;
+        void* nativeContextToShareWith = nullptr;
+        bool firstContextAttaching = false;
+        std::vector<PendingAttachment> pendingAttachments;
+
+        /**
+         * Attaches the context to the component if possible. If the first context of the group has not been created
+         * yet, attaching is delayed until then, as there is no native context to share resources with before.
+         */
+        void attachSharingResources (WindowOpenGLContext& windowContext, juce::Component& topLevelComponent);
+
+        /** Removes a context that is waiting to be attached from the pending attachments */
+        void cancelPendingAttachment (WindowOpenGLContext& windowContext);
+
+        /** Called on the message thread to attach all contexts waiting for the first context being created */
+        void attachPendingContexts();
+
+        /**
+         * Called by all contexts of the group when they are created and before they close. The closing context must
+         * hold the render lock while calling contextClosing.
+         */
+        void contextCreated (juce::OpenGLContext& context);
+        void contextClosing (juce::OpenGLContext& context);
+
+        void releaseShadersCreatedBy (juce::OpenGLContext& context);
+        void releaseAllResources();
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GLResourcePool)
+    };
+}
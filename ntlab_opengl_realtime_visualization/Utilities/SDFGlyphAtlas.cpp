@@ -0,0 +1,278 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "SDFGlyphAtlas.h"
+
+namespace ntlab
+{
+    SDFGlyphAtlas::SDFGlyphAtlas()
+    {
+        juce::Array<juce::juce_wchar> characters;
+        for (juce::juce_wchar c = firstASCIICharacter; c <= lastASCIICharacter; ++c)
+            characters.add (c);
+
+        // micro sign, greek small letter mu, degree sign and ohm sign
+        const juce::juce_wchar nonASCIICharacters[] = {0x00B5, 0x03BC, 0x00B0, 0x03A9};
+        for (auto c : nonASCIICharacters)
+        {
+            additionalCharacters.emplace_back (c, characters.size());
+            characters.add (c);
+        }
+
+        juce::Font font (static_cast<float> (glyphHeight * oversampling));
+        const int cellHeight = glyphHeight + 2 * spread;
+
+        // Place all glyph cells in rows to know the atlas height needed
+        std::vector<juce::Rectangle<int>> cells;
+        std::vector<float> advances;
+        int x = 0, y = 0;
+        for (auto c : characters)
+        {
+            float advance = font.getStringWidthFloat (juce::String::charToString (c)) / oversampling;
+            int cellWidth = static_cast<int> (std::ceil (advance)) + 2 * spread;
+
+            if (x + cellWidth > atlasWidth)
+            {
+                x = 0;
+                y += cellHeight;
+            }
+
+            cells.emplace_back (x, y, cellWidth, cellHeight);
+            advances.push_back (advance);
+            x += cellWidth;
+        }
+
+        atlasHeight = juce::nextPowerOfTwo (y + cellHeight);
+        distanceField.calloc (static_cast<size_t> (atlasWidth * atlasHeight));
+
+        const float normalization = 1.0f / glyphHeight;
+        std::vector<bool>  inside;
+        std::vector<float> signedDistance;
+
+        for (int i = 0; i < characters.size(); ++i)
+        {
+            auto& cell = cells[i];
+            const int width  = cell.getWidth()  * oversampling;
+            const int height = cell.getHeight() * oversampling;
+
+            juce::Image glyphImage (juce::Image::SingleChannel, width, height, true);
+            {
+                juce::Graphics g (glyphImage);
+                g.setColour (juce::Colours::white);
+                g.setFont (font);
+                g.drawSingleLineText (juce::String::charToString (characters[i]), spread * oversampling, juce::roundToInt (spread * oversampling + font.getAscent()));
+            }
+
+            juce::Image::BitmapData bitmap (glyphImage, juce::Image::BitmapData::readOnly);
+            inside.assign (static_cast<size_t> (width * height), false);
+            for (int py = 0; py < height; ++py)
+                for (int px = 0; px < width; ++px)
+                    inside[py * width + px] = *bitmap.getPixelPointer (px, py) >= 128;
+
+            computeSignedDistance (inside, signedDistance, width, height);
+
+            // Downsample to the atlas resolution and map the distance range of [-spread, spread] atlas pixels to [0, 255]
+            for (int cy = 0; cy < cell.getHeight(); ++cy)
+            {
+                for (int cx = 0; cx < cell.getWidth(); ++cx)
+                {
+                    float distance = 0.0f;
+                    for (int oy = 0; oy < oversampling; ++oy)
+                        for (int ox = 0; ox < oversampling; ++ox)
+                            distance += signedDistance[(cy * oversampling + oy) * width + cx * oversampling + ox];
+
+                    distance /= oversampling * oversampling * oversampling;
+
+                    float value = 0.5f + distance / (2.0f * spread);
+                    distanceField[(cell.getY() + cy) * atlasWidth + cell.getX() + cx] = static_cast<juce::uint8> (juce::jlimit (0, 255, juce::roundToInt (value * 255.0f)));
+                }
+            }
+
+            Glyph glyph;
+            glyph.u0      = cell.getX()      / static_cast<float> (atlasWidth);
+            glyph.v0      = cell.getY()      / static_cast<float> (atlasHeight);
+            glyph.u1      = cell.getRight()  / static_cast<float> (atlasWidth);
+            glyph.v1      = cell.getBottom() / static_cast<float> (atlasHeight);
+            glyph.xOffset = -spread * normalization;
+            glyph.yOffset = -spread * normalization;
+            glyph.width   = cell.getWidth()  * normalization;
+            glyph.height  = cell.getHeight() * normalization;
+            glyph.advance = advances[i]      * normalization;
+
+            glyphs.push_back (glyph);
+        }
+
+        fallbackGlyphIdx = '?' - firstASCIICharacter;
+    }
+
+    const SDFGlyphAtlas::Glyph& SDFGlyphAtlas::getGlyph (juce::juce_wchar character) const
+    {
+        if ((character >= firstASCIICharacter) && (character <= lastASCIICharacter))
+            return glyphs[character - firstASCIICharacter];
+
+        for (auto& c : additionalCharacters)
+        {
+            if (c.first == character)
+                return glyphs[c.second];
+        }
+
+        return glyphs[fallbackGlyphIdx];
+    }
+
+    float SDFGlyphAtlas::getStringWidth (const juce::String& text, float textHeight) const
+    {
+        float width = 0.0f;
+        for (auto t = text.getCharPointer(); !t.isEmpty();)
+            width += getGlyph (t.getAndAdvance()).advance;
+
+        return width * textHeight;
+    }
+
+    float SDFGlyphAtlas::addText (std::vector<TextShader2D::Vertex>& vertices, const juce::String& text, float x, float y, float textHeight, juce::Colour colour) const
+    {
+        const float r = colour.getFloatRed();
+        const float g = colour.getFloatGreen();
+        const float b = colour.getFloatBlue();
+        const float a = colour.getFloatAlpha();
+
+        const float startX = x;
+
+        for (auto t = text.getCharPointer(); !t.isEmpty();)
+        {
+            auto character = t.getAndAdvance();
+            auto& glyph = getGlyph (character);
+
+            if (character != ' ')
+            {
+                const float left   = x + glyph.xOffset * textHeight;
+                const float top    = y + glyph.yOffset * textHeight;
+                const float right  = left + glyph.width  * textHeight;
+                const float bottom = top  + glyph.height * textHeight;
+
+                const TextShader2D::Vertex topLeft     {left,  top,    glyph.u0, glyph.v0, r, g, b, a};
+                const TextShader2D::Vertex topRight    {right, top,    glyph.u1, glyph.v0, r, g, b, a};
+                const TextShader2D::Vertex bottomLeft  {left,  bottom, glyph.u0, glyph.v1, r, g, b, a};
+                const TextShader2D::Vertex bottomRight {right, bottom, glyph.u1, glyph.v1, r, g, b, a};
+
+                vertices.insert (vertices.end(), {topLeft, bottomLeft, topRight, topRight, bottomLeft, bottomRight});
+            }
+
+            x += glyph.advance * textHeight;
+        }
+
+        return x - startX;
+    }
+
+    float SDFGlyphAtlas::getSmoothingForTextHeight (float textHeight) const
+    {
+        // One screen pixel covers glyphHeight / textHeight atlas pixels, one atlas pixel is a distance of
+        // 1 / (2 * spread). Half a pixel of smoothing on each side of the outline gives one pixel of anti-aliasing
+        if (textHeight <= 0.0f)
+            return 0.5f;
+
+        return juce::jmin (0.5f, glyphHeight / (4.0f * spread * textHeight));
+    }
+
+    void SDFGlyphAtlas::computeSignedDistance (const std::vector<bool>& inside, std::vector<float>& signedDistance, int width, int height)
+    {
+        struct Offset
+        {
+            int dx, dy;
+            int distanceSquared() const { return dx * dx + dy * dy; }
+        };
+
+        const Offset zero  {0, 0};
+        const Offset empty {9999, 9999};
+
+        const size_t numPixels = static_cast<size_t> (width * height);
+        std::vector<Offset> toInside (numPixels), toOutside (numPixels);
+        for (size_t i = 0; i < numPixels; ++i)
+        {
+            toInside[i]  = inside[i] ? zero  : empty;
+            toOutside[i] = inside[i] ? empty : zero;
+        }
+
+        auto sweep = [width, height] (std::vector<Offset>& grid)
+        {
+            auto compare = [&] (Offset& p, int x, int y, int ox, int oy)
+            {
+                const int nx = x + ox;
+                const int ny = y + oy;
+                if ((nx < 0) || (ny < 0) || (nx >= width) || (ny >= height))
+                    return;
+
+                Offset other = grid[ny * width + nx];
+                other.dx += ox;
+                other.dy += oy;
+
+                if (other.distanceSquared() < p.distanceSquared())
+                    p = other;
+            };
+
+            for (int y = 0; y < height; ++y)
+            {
+                for (int x = 0; x < width; ++x)
+                {
+                    auto& p = grid[y * width + x];
+                    compare (p, x, y, -1,  0);
+                    compare (p, x, y,  0, -1);
+                    compare (p, x, y, -1, -1);
+                    compare (p, x, y,  1, -1);
+                }
+
+                for (int x = width - 1; x >= 0; --x)
+                    compare (grid[y * width + x], x, y, 1, 0);
+            }
+
+            for (int y = height - 1; y >= 0; --y)
+            {
+                for (int x = width - 1; x >= 0; --x)
+                {
+                    auto& p = grid[y * width + x];
+                    compare (p, x, y,  1, 0);
+                    compare (p, x, y,  0, 1);
+                    compare (p, x, y, -1, 1);
+                    compare (p, x, y,  1, 1);
+                }
+
+                for (int x = 0; x < width; ++x)
+                    compare (grid[y * width + x], x, y, -1, 0);
+            }
+        };
+
+        sweep (toInside);
+        sweep (toOutside);
+
+        // The distances are measured between pixel centers, the outline is assumed half way between two pixels
+        signedDistance.resize (numPixels);
+        for (size_t i = 0; i < numPixels; ++i)
+        {
+            if (inside[i])
+                signedDistance[i] =   std::sqrt (static_cast<float> (toOutside[i].distanceSquared())) - 0.5f;
+            else
+                signedDistance[i] = -(std::sqrt (static_cast<float> (toInside[i].distanceSquared())) - 0.5f);
+        }
+    }
+}
@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2018 Janos Buttgereit
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_graphics/juce_graphics.h>
+#include <vector>
+#include "../Shader/TextShader.h"
+
+namespace ntlab
+{
+    /**
+     * A signed distance field glyph atlas, holding all printable ASCII characters and some additional glyphs needed to
+     * display units and SI prefixes. The glyphs are rasterized once on construction, so use it through a
+     * juce::SharedResourcePointer to share a single atlas between all instances needing it. Upload the distance field
+     * returned by getDistanceField as an alpha texture and draw the vertices created by addText with a TextShader2D.
+     *
+     * As the atlas stores the distance to the glyph outline instead of its coverage, text can be drawn at any size with
+     * sharp edges by simply scaling the glyph quads.
+     */
+    class SDFGlyphAtlas
+    {
+    public:
+
+        /**
+         * Texture coordinates and metrics of a single glyph. All metrics are normalized to the text height, the offsets
+         * are relative to the top left corner of the glyph cell
+         */
+        struct Glyph
+        {
+            float u0, v0, u1, v1;
+            float xOffset, yOffset;
+            float width, height;
+            float advance;
+        };
+
+        /** Rasterizes all glyphs and computes the distance field. This takes some time, so don't call it too often. */
+        SDFGlyphAtlas();
+
+        /** Returns the glyph for a character. If the character is not part of the atlas a question mark is returned */
+        const Glyph& getGlyph (juce::juce_wchar character) const;
+
+        /** Returns the width in pixels a string drawn with the given text height would occupy */
+        float getStringWidth (const juce::String& text, float textHeight) const;
+
+        /**
+         * Appends two triangles per glyph to the vertex vector passed, with x and y specifying the top left corner of the
+         * text. Returns the width of the text added.
+         */
+        float addText (std::vector<TextShader2D::Vertex>& vertices, const juce::String& text, float x, float y, float textHeight, juce::Colour colour) const;
+
+        /**
+         * Returns the smoothing value that should be passed to TextShader2D::setSmoothing to get roughly one pixel of
+         * anti-aliasing at the given text height in pixels.
+         */
+        float getSmoothingForTextHeight (float textHeight) const;
+
+        /** Returns a pointer to the distance field, stored as one byte per texel with the first row being the top row */
+        const juce::uint8* getDistanceField() const { return distanceField.getData(); }
+
+        int getWidth()  const { return atlasWidth; }
+        int getHeight() const { return atlasHeight; }
+
+    private:
+
+        // The glyph height and the maximum distance encoded in atlas pixels. The glyphs are rasterized with a higher
+        // resolution and the distance field is then downsampled to get some sub pixel accuracy
+        static const int glyphHeight    = 32;
+        static const int spread         = 4;
+        static const int oversampling   = 2;
+        static const int atlasWidth     = 512;
+
+        static const int firstASCIICharacter = 32;
+        static const int lastASCIICharacter  = 126;
+
+        int atlasHeight = 0;
+        juce::HeapBlock<juce::uint8> distanceField;
+
+        std::vector<Glyph> glyphs;
+        std::vector<std::pair<juce::juce_wchar, int>> additionalCharacters;
+        int fallbackGlyphIdx = 0;
+
+        /**
+         * Computes the signed distance field for a binary coverage map with 8SSEDT. Returns the distance in pixels,
+         * positive values are inside the glyph
+         */
+        static void computeSignedDistance (const std::vector<bool>& inside, std::vector<float>& signedDistance, int width, int height);
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SDFGlyphAtlas)
+    };
+}
@@ -28,6 +28,13 @@ namespace ntlab
 {
 
     WindowOpenGLContext::WindowOpenGLContext ()
+      : resourcePool (std::make_shared<GLResourcePool>())
+    {
+        openGLContext.setRenderer (this);
+    }
+
+    WindowOpenGLContext::WindowOpenGLContext (WindowOpenGLContext& contextToShareResourcesWith)
+      : resourcePool (contextToShareResourcesWith.resourcePool)
     {
         openGLContext.setRenderer (this);
     }
@@ -36,16 +43,21 @@ namespace ntlab
     {
         // make sure all your OpenGLRenderer targets have been removed before the shared context is closing
         jassert (renderingTargets.size() == 0);
+
+        resourcePool->cancelPendingAttachment (*this);
     }
 
     void WindowOpenGLContext::setTopLevelParentComponent (juce::Component& topLevelComponent)
     {
         this->topLevelComponent = &topLevelComponent;
-        openGLContext.attachTo (topLevelComponent);
+
+        // Attaching might be delayed until another context of the group has created the native context to share with
+        resourcePool->attachSharingResources (*this, topLevelComponent);
     }
 
     void WindowOpenGLContext::detachTopLevelParentComponent ()
     {
+        resourcePool->cancelPendingAttachment (*this);
         openGLContext.detach();
     }
 
@@ -69,8 +81,13 @@ namespace ntlab
 
         executeOnGLThread ([targetToRemove](juce::OpenGLContext&) {targetToRemove->openGLContextClosing(); });
 
-        std::lock_guard<std::mutex> scopedLock (renderingTargetsLock);
-        renderingTargets.removeFirstMatchingValue (targetToRemove);
+        {
+            std::lock_guard<std::mutex> scopedLock (renderingTargetsLock);
+            renderingTargets.removeFirstMatchingValue (targetToRemove);
+        }
+
+        // A preparation started before the target was removed might still be running
+        waitForFramePreparations();
     }
 
     void WindowOpenGLContext::executeOnGLThread (std::function<void (juce::OpenGLContext&)>&& lambdaToExecute)
@@ -112,9 +129,101 @@ namespace ntlab
                                      juce::roundToInt (renderingScale * targetBoundsRelativeToGLRenderingParent.getHeight()));
     }
 
-    void WindowOpenGLContext::newOpenGLContextCreated ()
+    void WindowOpenGLContext::startFrameCapture (const juce::File& destination, FrameCapture::Format format, int captureEveryNthFrame, int framesPerSecond)
+    {
+        // The capture instance is created here to start the writer thread, but only accessed on the GL thread after that
+        auto* newFrameCapture = new FrameCapture (destination, format, captureEveryNthFrame, framesPerSecond);
+
+        executeOnGLThread ([this, newFrameCapture] (juce::OpenGLContext& openGLContext)
+        {
+            if (frameCapture != nullptr)
+                frameCapture->finish (openGLContext);
+
+            frameCapture.reset (newFrameCapture);
+        });
+
+        frameCaptureRunning = true;
+        openGLContext.triggerRepaint();
+    }
+
+    void WindowOpenGLContext::stopFrameCapture()
+    {
+        executeOnGLThread ([this] (juce::OpenGLContext& openGLContext)
+        {
+            if (frameCapture != nullptr)
+                frameCapture->finish (openGLContext);
+
+            frameCapture.reset();
+        });
+
+        frameCaptureRunning = false;
+        openGLContext.triggerRepaint();
+    }
+
+    bool WindowOpenGLContext::isCapturingFrames() const
+    {
+        return frameCaptureRunning;
+    }
+
+    void WindowOpenGLContext::setUseAsyncBufferUploads (bool shouldUseAsyncBufferUploads)
+    {
+        useAsyncBufferUploads = shouldUseAsyncBufferUploads;
+    }
+
+    bool WindowOpenGLContext::isUsingAsyncBufferUploads() const
+    {
+        return useAsyncBufferUploads;
+    }
+
+    AsyncBufferUploader& WindowOpenGLContext::getAsyncBufferUploader()
+    {
+        return asyncBufferUploader;
+    }
+
+    FramePacer& WindowOpenGLContext::getFramePacer()
     {
+        return framePacer;
+    }
 
+    GLResourcePool& WindowOpenGLContext::getResourcePool()
+    {
+        return *resourcePool;
+    }
+
+    void WindowOpenGLContext::startFramePreparations()
+    {
+        // must be called with the renderingTargetsLock held
+        for (auto* target : renderingTargets)
+        {
+            auto* preparation = dynamic_cast<ParallelFramePreparation*> (target);
+            if ((preparation == nullptr) || !dynamic_cast<juce::Component*> (target)->isVisible())
+                continue;
+
+            {
+                std::lock_guard<std::mutex> scopedLock (framePreparationLock);
+                ++numFramePreparationsPending;
+            }
+
+            framePreparationPool.addJob ([this, preparation] ()
+            {
+                preparation->prepareNextFrame();
+
+                std::lock_guard<std::mutex> scopedLock (framePreparationLock);
+                if (--numFramePreparationsPending == 0)
+                    framePreparationsFinished.notify_all();
+            });
+        }
+    }
+
+    void WindowOpenGLContext::waitForFramePreparations()
+    {
+        std::unique_lock<std::mutex> scopedLock (framePreparationLock);
+        framePreparationsFinished.wait (scopedLock, [this] () { return numFramePreparationsPending == 0; });
+    }
+
+    void WindowOpenGLContext::newOpenGLContextCreated ()
+    {
+        resourcePool->contextCreated (openGLContext);
     }
 
     void WindowOpenGLContext::renderOpenGL ()
@@ -122,6 +231,18 @@ namespace ntlab
         if (topLevelComponent == nullptr)
             return;
 
+        // The jobs below and the targets access the data written by the preparations started after the last frame
+        waitForFramePreparations();
+
+        // With late latching, the frame is prepared right before rendering instead of after the previous frame, so
+        // the freshest data is displayed. This sleep must not block the other windows of the group.
+        const bool lateLatching = framePacer.isLateLatchingEnabled();
+        framePacer.waitForLateLatchPoint();
+        framePacer.frameStarted();
+
+        // Shared shader programs share their uniforms too, so only one window of the group may render at a time
+        std::lock_guard<std::mutex> renderLock (resourcePool->getRenderLock());
+
         {
             std::lock_guard<std::mutex> scopedLock (executeInRenderCallbackLock);
             // Execute all pending jobs that should be executed on the OpenGL thread
@@ -131,8 +252,18 @@ namespace ntlab
             executeInRenderCallback.clear();
         }
 
+        // Uploads that finished will be handed to their targets before they render
+        asyncBufferUploader.processUploads (openGLContext);
+
         {
             std::lock_guard<std::mutex> scopedLock (renderingTargetsLock);
+
+            if (lateLatching)
+            {
+                startFramePreparations();
+                waitForFramePreparations();
+            }
+
             for (auto* target : renderingTargets)
             {
                 auto* component = dynamic_cast<juce::Component*> (target);
@@ -140,12 +271,41 @@ namespace ntlab
                 if (component->isVisible())
                     target->renderOpenGL();
             }
+
+            // Everything has been submitted, so the workers can prepare the next frame while the GPU is busy
+            if (!lateLatching)
+                startFramePreparations();
+        }
+
+        framePacer.frameFinished();
+
+        // All targets have been rendered, so the frame is complete at this point
+        if (frameCapture != nullptr)
+        {
+            auto renderingScale = openGLContext.getRenderingScale();
+            frameCapture->captureFrame (openGLContext,
+                                        juce::roundToInt (renderingScale * topLevelComponent->getWidth()),
+                                        juce::roundToInt (renderingScale * topLevelComponent->getHeight()));
         }
 
+        // Keep rendering until all uploads have been handed to their targets, even if nothing else triggers a repaint
+        if (asyncBufferUploader.hasPendingUploads())
+            openGLContext.triggerRepaint();
+
     }
 
     void WindowOpenGLContext::openGLContextClosing ()
     {
+        if (frameCapture != nullptr)
+        {
+            frameCapture->finish (openGLContext);
+            frameCapture.reset();
+            frameCaptureRunning = false;
+        }
+
+        asyncBufferUploader.release (openGLContext);
 
+        std::lock_guard<std::mutex> renderLock (resourcePool->getRenderLock());
+        resourcePool->contextClosing (openGLContext);
     }
 }
\ No newline at end of file
@@ -25,14 +25,45 @@ SOFTWARE.
 
 
 #include <juce_opengl/juce_opengl.h>
+#include <atomic>
+#include <condition_variable>
+#include "AsyncBufferUploader.h"
+#include "FrameCapture.h"
+#include "FramePacer.h"
+#include "GLResourcePool.h"
 
 namespace ntlab
 {
     class WindowOpenGLContext :  private juce::OpenGLRenderer
     {
     public:
+
+        /**
+         * Rendering targets that additionally inherit from this class get prepareNextFrame called on a worker thread
+         * right after each frame has been submitted. This way the CPU work needed to prepare the vertex data of all
+         * targets runs in parallel while the GPU is busy with the previous frame, and the GL thread only has to upload
+         * and draw the prepared data. The GL thread waits for all preparations to be finished before rendering the
+         * next frame. If late latching is enabled in the FramePacer, the preparations are started right before
+         * rendering instead, so that the freshest data is displayed.
+         */
+        class ParallelFramePreparation
+        {
+        public:
+            virtual ~ParallelFramePreparation() {}
+
+            /** Called on a worker thread, so don't call any OpenGL functions from here */
+            virtual void prepareNextFrame() = 0;
+        };
+
         WindowOpenGLContext();
 
+        /**
+         * Creates a context that shares its GL resources with the context passed, e.g. to render into a second top
+         * level window. All contexts created this way form a group that uses the same GLResourcePool and whose native
+         * contexts are created as shared contexts.
+         */
+        WindowOpenGLContext (WindowOpenGLContext& contextToShareResourcesWith);
+
         ~WindowOpenGLContext();
 
         void setTopLevelParentComponent (juce::Component& topLevelComponent);
@@ -49,17 +80,82 @@ namespace ntlab
 
         juce::Rectangle<int> getComponentClippingBoundsRelativeToGLRenderingTarget (juce::Component* targetComponent);
 
+        /**
+         * Starts recording the frames rendered into the window, either every frame or every nth frame. The frames are
+         * read back asynchronously and written to disk on a background thread, so that recording doesn't stall
+         * rendering. A capture that is already running will be stopped first.
+         * @see FrameCapture
+         */
+        void startFrameCapture (const juce::File& destination, FrameCapture::Format format, int captureEveryNthFrame = 1, int framesPerSecond = 60);
+
+        /**
+         * Stops a running frame capture. The GL thread will wait until all frames captured so far have been written
+         * before rendering the next frame.
+         */
+        void stopFrameCapture();
+
+        /** Returns true if a frame capture has been started and not yet stopped */
+        bool isCapturingFrames() const;
+
+        /**
+         * Enables or disables uploading large buffers through the AsyncBufferUploader. If enabled, rendering targets
+         * like Plot2D pass their static data to the uploader instead of uploading it on the GL thread and switch to the
+         * new buffers once they are ready. This keeps the frame rate steady during heavy transfers at the cost of the
+         * new data being displayed a few frames later. Disabled by default.
+         */
+        void setUseAsyncBufferUploads (bool shouldUseAsyncBufferUploads);
+
+        /** Returns true if rendering targets should use the AsyncBufferUploader for large transfers */
+        bool isUsingAsyncBufferUploads() const;
+
+        /** Returns the uploader used for large transfers if isUsingAsyncBufferUploads returns true */
+        AsyncBufferUploader& getAsyncBufferUploader();
+
+        /**
+         * Returns the frame pacer that measures the render time of this context. Use it to set the target frame rate,
+         * to enable adaptive quality or late latching. Rendering targets query the quality tier to render with from it.
+         */
+        FramePacer& getFramePacer();
+
+        /**
+         * Returns the pool holding the resources that are shared with all other contexts of this context's group.
+         * Rendering targets should get their shaders and static textures from here.
+         */
+        GLResourcePool& getResourcePool();
+
         juce::OpenGLContext openGLContext;
 
     private:
+        friend class GLResourcePool;
+
         juce::Component* topLevelComponent = nullptr;
 
+        std::shared_ptr<GLResourcePool> resourcePool;
+
         juce::Array<juce::OpenGLRenderer*> renderingTargets;
         std::mutex renderingTargetsLock;
 
         std::vector<std::function<void(juce::OpenGLContext&)>> executeInRenderCallback;
         std::mutex executeInRenderCallbackLock;
 
+        // Worker threads preparing the next frame of all targets inheriting from ParallelFramePreparation
+        juce::ThreadPool framePreparationPool {juce::jmax (1, juce::SystemStats::getNumCpus() - 1)};
+        int numFramePreparationsPending = 0;
+        std::mutex framePreparationLock;
+        std::condition_variable framePreparationsFinished;
+
+        void startFramePreparations();
+        void waitForFramePreparations();
+
+        // Only accessed on the GL thread
+        std::unique_ptr<FrameCapture> frameCapture;
+        std::atomic<bool> frameCaptureRunning {false};
+
+        FramePacer framePacer;
+
+        AsyncBufferUploader asyncBufferUploader;
+        std::atomic<bool> useAsyncBufferUploads {false};
+
         // OpenGL related member functions
         void newOpenGLContextCreated() override;
         void renderOpenGL() override;
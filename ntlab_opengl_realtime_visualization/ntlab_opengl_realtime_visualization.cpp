@@ -22,20 +22,60 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include "RealtimeDataTransfer/EyeDiagramDataCollector.cpp"
+#include "RealtimeDataTransfer/GoniometerDataCollector.cpp"
+#include "RealtimeDataTransfer/HistogramDataCollector.cpp"
+#include "RealtimeDataTransfer/LoudnessDataCollector.cpp"
 #include "RealtimeDataTransfer/OscilloscopeDataCollector.cpp"
+#include "RealtimeDataTransfer/SocketDataSinkAndSource.cpp"
+
+#if JUCE_MODULE_AVAILABLE_juce_dsp
+
+#include "RealtimeDataTransfer/CrossCorrelationDataCollector.cpp"
+#include "RealtimeDataTransfer/FFTDataCollector.cpp"
+#include "RealtimeDataTransfer/PitchTrackerDataCollector.cpp"
 #include "RealtimeDataTransfer/SpectralDataCollector.cpp"
 
+#endif
+
+#include "DSP/BiquadFilterChain.cpp"
+#include "DSP/DecimatingFilterChain.cpp"
+#include "DSP/HalfBandDecimator.cpp"
+#include "DSP/KWeightingFilter.cpp"
+#if JUCE_MODULE_AVAILABLE_juce_dsp
+#include "DSP/RealFFT.cpp"
+#endif
+#include "DSP/TruePeakDetector.cpp"
+#include "DSP/VectorKernels.cpp"
+
 #include "Utilities/Float2String.cpp"
 
 #if JUCE_MODULE_AVAILABLE_juce_opengl
 
+#include "Utilities/AsyncBufferUploader.cpp"
+#include "Utilities/FrameCapture.cpp"
+#include "Utilities/FramePacer.cpp"
+#include "Utilities/GLResourcePool.cpp"
 #include "Utilities/WindowOpenGLContext.cpp"
+#include "Utilities/SDFGlyphAtlas.cpp"
 
 #include "2DPlot/Plot2D.cpp"
 
+#include "GUIComponents/EyeDiagramComponent.cpp"
+#include "GUIComponents/GoniometerComponent.cpp"
+#include "GUIComponents/HistogramComponent.cpp"
+#include "GUIComponents/LoudnessMeterComponent.cpp"
 #include "GUIComponents/OscilloscopeComponent.cpp"
+
+#if JUCE_MODULE_AVAILABLE_juce_dsp
+#include "GUIComponents/CrossCorrelationComponent.cpp"
+#include "GUIComponents/PitchTrackerComponent.cpp"
 #include "GUIComponents/SpectralAnalyzerComponent.cpp"
+#endif
 
+#include "Shader/ColourMapShader.cpp"
 #include "Shader/LineShader.cpp"
+#include "Shader/TextureShader.cpp"
+#include "Shader/TextShader.cpp"
 
 #endif
@@ -39,7 +39,7 @@ SOFTWARE.
   website:          www.github.com/janosgit
   license:          MIT
 
-  dependencies:     juce_dsp
+  dependencies:     juce_audio_basics, juce_data_structures
 
  END_JUCE_MODULE_DECLARATION
 
@@ -48,14 +48,41 @@ SOFTWARE.
 #pragma once
 
 #include "RealtimeDataTransfer/DataCollector.h"
+#include "RealtimeDataTransfer/EyeDiagramDataCollector.h"
+#include "RealtimeDataTransfer/Frame.h"
+#include "RealtimeDataTransfer/GoniometerDataCollector.h"
+#include "RealtimeDataTransfer/HistogramDataCollector.h"
 #include "RealtimeDataTransfer/LocalDataSinkAndSource.h"
+#include "RealtimeDataTransfer/LoudnessDataCollector.h"
 #include "RealtimeDataTransfer/OscilloscopeDataCollector.h"
 #include "RealtimeDataTransfer/RealtimeDataSink.h"
-#include "RealtimeDataTransfer/SpectralDataCollector.h"
+#include "RealtimeDataTransfer/SocketDataSinkAndSource.h"
 #include "RealtimeDataTransfer/VisualizationDataSource.h"
 
+// The FFT based collectors are only available if the juce_dsp module is added to the project. A lean sender, e.g. on
+// an embedded device, can leave it out if it only needs the time domain collectors
+#if JUCE_MODULE_AVAILABLE_juce_dsp
+
+#include "RealtimeDataTransfer/CrossCorrelationDataCollector.h"
+#include "RealtimeDataTransfer/FFTDataCollector.h"
+#include "RealtimeDataTransfer/PitchTrackerDataCollector.h"
+#include "RealtimeDataTransfer/SpectralDataCollector.h"
+
+#endif
+
 #include "Buffers/SwappableBuffer.h"
 
+#include "DSP/Biquad.h"
+#include "DSP/BiquadFilterChain.h"
+#include "DSP/DecimatingFilterChain.h"
+#include "DSP/HalfBandDecimator.h"
+#include "DSP/KWeightingFilter.h"
+#if JUCE_MODULE_AVAILABLE_juce_dsp
+#include "DSP/RealFFT.h"
+#endif
+#include "DSP/TruePeakDetector.h"
+#include "DSP/VectorKernels.h"
+
 #include "Utilities/Float2String.h"
 #include "Utilities/SerializableRange.h"
 
@@ -63,16 +90,34 @@ SOFTWARE.
 // running on a system with any GUI
 #if JUCE_MODULE_AVAILABLE_juce_opengl
 
+#include "Utilities/GLExtraFunctions.h"
+#include "Utilities/AsyncBufferUploader.h"
+#include "Utilities/FrameCapture.h"
+#include "Utilities/FramePacer.h"
+#include "Utilities/GLResourcePool.h"
 #include "Utilities/WindowOpenGLContext.h"
+#include "Utilities/SDFGlyphAtlas.h"
 
 #include "2DPlot/Plot2D.h"
 
+#include "GUIComponents/EyeDiagramComponent.h"
+#include "GUIComponents/GoniometerComponent.h"
+#include "GUIComponents/HistogramComponent.h"
+#include "GUIComponents/LoudnessMeterComponent.h"
 #include "GUIComponents/OscilloscopeComponent.h"
+
+#if JUCE_MODULE_AVAILABLE_juce_dsp
+#include "GUIComponents/CrossCorrelationComponent.h"
+#include "GUIComponents/PitchTrackerComponent.h"
 #include "GUIComponents/SpectralAnalyzerComponent.h"
+#endif
 
 #include "Shader/Attributes.h"
 #include "Shader/Uniforms.h"
+#include "Shader/ColourMapShader.h"
 #include "Shader/LineShader.h"
+#include "Shader/TextureShader.h"
+#include "Shader/TextShader.h"
 
 #endif
 